@@ -60,5 +60,13 @@ void FPU_IRQHandler(void);
 void SRAMC_ECCSE_IRQHandler(void);
 /* this function handles SysTick exception */
 void SysTick_Handler(void);
+/* this function handles DMA0 channel2 exception */
+void DMA0_Channel2_IRQHandler(void);
+/* this function handles DMA0 channel0 exception */
+void DMA0_Channel0_IRQHandler(void);
+/* this function handles EXTI10_15 exception */
+void EXTI10_15_IRQHandler(void);
+/* this function handles SPI1 exception */
+void SPI1_IRQHandler(void);
 
 #endif /* GD32E502_IT_H */
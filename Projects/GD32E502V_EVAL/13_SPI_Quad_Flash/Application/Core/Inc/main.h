@@ -0,0 +1,71 @@
+/*!
+    \file    main.h
+    \brief   the header file of main
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef MAIN_H
+#define MAIN_H
+
+/* the demos which follow the write and read test, 1 runs one at each boot, the build can set
+   them as well. The erases of each demo destroy the data of its area of the flash. */
+#ifndef FLASH_READ_BENCHMARK_ENABLE
+#define FLASH_READ_BENCHMARK_ENABLE         0       /* polled and DMA reads of 64 KB */
+#endif
+#ifndef FLASH_SMALL_READ_BENCHMARK_ENABLE
+#define FLASH_SMALL_READ_BENCHMARK_ENABLE   0       /* 16-byte reads with each quad read */
+#endif
+#ifndef FLASH_QUEUE_TEST_ENABLE
+#define FLASH_QUEUE_TEST_ENABLE             0       /* erases and programs the sector at 0x001000 */
+#endif
+#ifndef FLASH_ERASE_TEST_ENABLE
+#define FLASH_ERASE_TEST_ENABLE             0       /* erases and programs 200 KB at 0x040000 */
+#endif
+#ifndef FLASH_SUSPEND_TEST_ENABLE
+#define FLASH_SUSPEND_TEST_ENABLE           0       /* erases the 64 KB block at 0x080000 */
+#endif
+#ifndef KV_TEST_ENABLE
+#define KV_TEST_ENABLE                      0       /* formats the 8 sectors at 0x1E0000 */
+#endif
+#ifndef COWFS_TEST_ENABLE
+#define COWFS_TEST_ENABLE                   0       /* formats the 512 KB at 0x100000 */
+#endif
+#ifndef FLASH_CACHE_TEST_ENABLE
+#define FLASH_CACHE_TEST_ENABLE             0       /* erases and programs the sector at 0x001000 */
+#endif
+#ifndef SPI_BUS_TEST_ENABLE
+#define SPI_BUS_TEST_ENABLE                 0       /* a second device on PB1 shares the bus */
+#endif
+#ifndef SPI_SLAVE_TEST_ENABLE
+#define SPI_SLAVE_TEST_ENABLE               0       /* PE14, PA2, PB1 wired to PC6, PD14, PD13 */
+#endif
+
+#endif /* MAIN_H */
@@ -34,6 +34,10 @@ OF SUCH DAMAGE.
 
 #include "gd32e502_it.h"
 #include "systick.h"
+#include "gd25qxx.h"
+#include "flash_queue.h"
+#include "spi_bus.h"
+#include "spi_slave.h"
 
 #define SRAM_ECC_ERROR_HANDLE(s)    do{}while(1)
 #define FLASH_ECC_ERROR_HANDLE(s)   do{}while(1)
@@ -186,4 +190,61 @@ void SRAMC_ECCSE_IRQHandler(void)
 void SysTick_Handler(void)
 {
     delay_decrement();
+    /* advance the erase and program operations of the SPI flash */
+    flash_queue_poll();
+}
+
+/*!
+    \brief      this function handles DMA0 channel2 exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA0_Channel2_IRQHandler(void)
+{
+    if(SET == dma_interrupt_flag_get(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, DMA_INT_FLAG_FTF)) {
+        dma_interrupt_flag_clear(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, DMA_INT_FLAG_G);
+        spi_bus_dma_complete();
+    }
+}
+
+/*!
+    \brief      this function handles DMA0 channel0 exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA0_Channel0_IRQHandler(void)
+{
+    if(SET == dma_interrupt_flag_get(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL, DMA_INT_FLAG_FTF)) {
+        dma_interrupt_flag_clear(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL, DMA_INT_FLAG_G);
+        spi_slave_dma_irq();
+    }
+}
+
+/*!
+    \brief      this function handles EXTI10_15 exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void EXTI10_15_IRQHandler(void)
+{
+    if(RESET != exti_interrupt_flag_get(SPI_SLAVE_NSS_EXTI_LINE)) {
+        exti_interrupt_flag_clear(SPI_SLAVE_NSS_EXTI_LINE);
+        spi_slave_nss_irq();
+    }
+}
+
+/*!
+    \brief      this function handles SPI1 exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void SPI1_IRQHandler(void)
+{
+    if(SET == spi_i2s_interrupt_flag_get(SPI_SLAVE_SPI, SPI_I2S_INT_FLAG_RXORERR)) {
+        spi_slave_error_irq();
+    }
 }
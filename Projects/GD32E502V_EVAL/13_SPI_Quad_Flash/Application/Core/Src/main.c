@@ -33,10 +33,18 @@ OF SUCH DAMAGE.
 */
 
 #include "gd32e502.h"
+#include "main.h"
 #include "systick.h"
 #include <stdio.h>
 #include "gd32e502v_eval.h"
 #include "gd25qxx.h"
+#include "flash_queue.h"
+#include "kvstore.h"
+#include "cowfs.h"
+#if FLASH_CACHE_ENABLE
+#include "flash_cache.h"
+#endif /* FLASH_CACHE_ENABLE */
+#include "spi_slave.h"
 
 #define BUFFER_SIZE              256
 #define TX_BUFFER_SIZE           (countof(tx_buffer) - 1)
@@ -44,9 +52,33 @@ OF SUCH DAMAGE.
 
 #define countof(a)               (sizeof(a) / sizeof(*(a)))
 
-#define SFLASH_ID                0xC84015
 #define FLASH_WRITE_ADDRESS      0x000000
 #define FLASH_READ_ADDRESS       FLASH_WRITE_ADDRESS
+#define BENCH_BUFFER_SIZE        4096U
+#define BENCH_READS              16U
+#define SMALL_READ_SIZE          16U
+#define SMALL_READS              1000U
+#define QUEUE_TEST_ADDRESS       0x001000
+#define ERASE_TEST_ADDRESS       0x040000
+#define ERASE_TEST_SIZE          (200U * 1024U)
+#define STREAM_PRODUCER_MS       10U
+#define SUSPEND_TEST_ADDRESS     0x080000
+#define SUSPEND_TEST_READ_SIZE   256U
+#define KV_TEST_ADDRESS          0x1E0000
+#define KV_TEST_SECTORS          8U
+#define KV_TEST_KEYS             16U
+#define KV_TEST_UPDATES          1000U
+#define FS_TEST_ADDRESS          0x100000
+#define FS_TEST_BLOCKS           128U
+#define FS_TEST_CHUNKS           16U
+#define CACHE_TEST_RECORDS       20U
+#define CACHE_TEST_RECORD_SIZE   24U
+#define CACHE_TEST_READS         1000U
+#define BUS_TEST_ADDRESS         0x000000
+#define BUS_TEST_CHUNKS          16U
+#define BUS_TEST_MESSAGE_SIZE    4U
+#define SLAVE_TEST_FRAMES        200U
+#define SLAVE_TEST_MAX_FRAME     512U
 
 uint32_t int_device_serial[3];
 uint8_t led_count;
@@ -54,13 +86,32 @@ uint8_t led_count;
 uint8_t tx_buffer[BUFFER_SIZE];
 uint8_t rx_buffer[BUFFER_SIZE];
 uint32_t flash_id = 0;
+ErrStatus flash_status = ERROR;
 uint16_t i = 0;
 uint8_t  is_successful = 0;
+uint8_t bench_buffer[BENCH_BUFFER_SIZE];
+__IO uint8_t queue_done = 0U;
 
 void turn_on_led(uint8_t led_num);
 void get_chip_serial_num(void);
 ErrStatus memory_compare(uint8_t *src, uint8_t *dst, uint16_t length);
 void test_status_led_init(void);
+void flash_param_print(void);
+void flash_read_benchmark(void);
+void flash_small_read_benchmark(void);
+void flash_queue_test(void);
+void flash_queue_done(void *context);
+void flash_erase_test(void);
+void flash_suspend_test(void);
+void kv_test(void);
+void cowfs_test(void);
+#if FLASH_CACHE_ENABLE
+void flash_cache_test(void);
+#endif /* FLASH_CACHE_ENABLE */
+void spi_bus_test(void);
+void spi_bus_stats_print(const char *name, spi_bus_device_struct *device, uint32_t elapsed);
+void spi_slave_test(void);
+uint32_t spi_slave_frame_check(spi_slave_frame_struct *frame, uint8_t first);
 
 /*!
     \brief      main function
@@ -79,8 +130,11 @@ int main(void)
     /* USART parameter configuration */
     gd_eval_com_init(EVAL_COM);
 
-    /* configure SPI GPIO and parameter */
-    spi_flash_init();
+    /* configure SPI0 and the DMA of the bus shared by the flash and the other devices */
+    spi_bus_init();
+    nvic_irq_enable(SPI_BUS_DMA_RX_IRQn, 0, 0);
+    /* configure the flash on the bus */
+    flash_status = spi_flash_init();
 
     printf("\n\r###############################################################################\n\r");
     printf("\n\rGD32E502V-EVAL System is Starting up...\n\r");
@@ -97,9 +151,11 @@ int main(void)
     /* get flash id */
     flash_id = spi_flash_read_id();
     printf("\n\rThe Flash_ID:0x%X\n\r\n\r", flash_id);
+    /* the commands chosen by spi_flash_init() */
+    flash_param_print();
 
-    /* flash id is correct */
-    if(SFLASH_ID == flash_id) {
+    /* the flash is described by its SFDP table or is a known part */
+    if(SUCCESS == flash_status) {
         printf("\n\rWrite to tx_buffer:\n\r\n\r");
 
         /* printf tx_buffer value */
@@ -141,9 +197,59 @@ int main(void)
         if(0 == is_successful) {
             printf("\n\rSPI-GD25Q16 Test Passed!\n\r");
         }
+
+#if FLASH_READ_BENCHMARK_ENABLE
+        /* compare the polled and the DMA reads */
+        flash_read_benchmark();
+#endif /* FLASH_READ_BENCHMARK_ENABLE */
+
+#if FLASH_SMALL_READ_BENCHMARK_ENABLE
+        /* compare the command overhead of the quad reads */
+        flash_small_read_benchmark();
+#endif /* FLASH_SMALL_READ_BENCHMARK_ENABLE */
+
+#if FLASH_QUEUE_TEST_ENABLE
+        /* erase and program through the queue polled by SysTick */
+        flash_queue_test();
+#endif /* FLASH_QUEUE_TEST_ENABLE */
+
+#if FLASH_ERASE_TEST_ENABLE
+        /* erase with block erases and erase ahead of a stream */
+        flash_erase_test();
+#endif /* FLASH_ERASE_TEST_ENABLE */
+
+#if FLASH_SUSPEND_TEST_ENABLE
+        /* read while a block erase is suspended */
+        flash_suspend_test();
+#endif /* FLASH_SUSPEND_TEST_ENABLE */
+
+#if KV_TEST_ENABLE
+        /* update keys of the key-value store */
+        kv_test();
+#endif /* KV_TEST_ENABLE */
+
+#if COWFS_TEST_ENABLE
+        /* stream a file through the copy-on-write file system */
+        cowfs_test();
+#endif /* COWFS_TEST_ENABLE */
+
+#if FLASH_CACHE_TEST_ENABLE && FLASH_CACHE_ENABLE
+        /* re-read small records through the read cache */
+        flash_cache_test();
+#endif /* FLASH_CACHE_TEST_ENABLE && FLASH_CACHE_ENABLE */
+
+#if SPI_BUS_TEST_ENABLE
+        /* share the bus between bulk flash reads and a latency-sensitive device */
+        spi_bus_test();
+#endif /* SPI_BUS_TEST_ENABLE */
+
+#if SPI_SLAVE_TEST_ENABLE
+        /* send frames from SPI0 to the SPI1 slave at increasing clocks */
+        spi_slave_test();
+#endif /* SPI_SLAVE_TEST_ENABLE */
     } else {
-        /* spi flash read id fail */
-        printf("\n\rSPI Flash: Read ID Fail!\n\r");
+        /* spi flash detection fail */
+        printf("\n\rSPI Flash: Unknown Flash, No SFDP Table!\n\r");
     }
 
     while(1) {
@@ -158,6 +264,9 @@ int main(void)
             led_count = 0;
         }
 
+        /* collect the key-value store while idle */
+        kv_gc_step();
+
         delay_ms(500);
     }
 }
@@ -237,6 +346,648 @@ ErrStatus memory_compare(uint8_t *src, uint8_t *dst, uint16_t length)
     return SUCCESS;
 }
 
+/*!
+    \brief      print the flash parameters read from the SFDP table or from the table of known parts
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_param_print(void)
+{
+    static const char *source[] = {"defaults", "table of known parts", "SFDP"};
+    const spi_flash_param_struct *param = spi_flash_param_get();
+    uint32_t index;
+
+    printf("Flash parameters from %s: %u KB, page %u bytes, chip erase %u ms\n\r", source[param->source],
+           param->capacity >> 10, param->page_size, param->chip_erase_ms);
+    for(index = 0U; (index < SPI_FLASH_ERASE_TYPES) && (0U != param->erase[index].size); index++) {
+        printf("Erase 0x%02X: %u KB, %u ms\n\r", param->erase[index].instruction,
+               param->erase[index].size >> 10, param->erase[index].time_ms);
+    }
+    printf("Read 0x%02X with %u dummy clocks, quad I/O read 0x%02X, quad enable method %u\n\r\n\r",
+           param->read_instruction, param->read_dummy_clocks, param->io_read_instruction, param->quad_enable);
+}
+
+/*!
+    \brief      compare the throughput and the CPU load of the polled and the DMA reads
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_read_benchmark(void)
+{
+    static const char *const method_name[4] = {"SPI polled ", "QSPI polled", "SPI DMA    ", "QSPI DMA   "};
+    uint32_t bytes = BENCH_BUFFER_SIZE * BENCH_READS;
+    uint32_t method, read, address;
+    uint32_t start, call, total, busy;
+
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    printf("\n\rRead benchmark, %u KB per method:\n\r", bytes / 1024U);
+    for(method = 0U; method < 4U; method++) {
+        busy = 0U;
+        start = DWT->CYCCNT;
+        for(read = 0U; read < BENCH_READS; read++) {
+            address = FLASH_READ_ADDRESS + read * BENCH_BUFFER_SIZE;
+            call = DWT->CYCCNT;
+            switch(method) {
+            case 0:
+                spi_flash_buffer_read(bench_buffer, address, BENCH_BUFFER_SIZE);
+                break;
+            case 1:
+                qspi_flash_buffer_read(bench_buffer, address, BENCH_BUFFER_SIZE);
+                break;
+            case 2:
+                spi_flash_buffer_read_dma(bench_buffer, address, BENCH_BUFFER_SIZE, NULL, NULL);
+                break;
+            default:
+                qspi_flash_buffer_read_dma(bench_buffer, address, BENCH_BUFFER_SIZE, NULL, NULL);
+                break;
+            }
+            busy += DWT->CYCCNT - call;
+            /* the CPU is free while the DMA reads, this wait is not counted as busy */
+            while(SET == spi_flash_dma_busy()) {
+            }
+        }
+        total = DWT->CYCCNT - start;
+        printf("%s: %u KB/s, CPU %u%%\n\r", method_name[method],
+               (uint32_t)(((uint64_t)bytes * SystemCoreClock) / total / 1024U),
+               (uint32_t)(((uint64_t)busy * 100U) / total));
+    }
+}
+
+/*!
+    \brief      measure small random reads with the quad output read, the quad I/O read and the
+                quad I/O read in continuous read mode
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_small_read_benchmark(void)
+{
+    static const char *const method_name[3] = {"Quad output     ", "Quad I/O        ", "Quad I/O, no cmd"};
+    uint32_t method, read, address;
+    uint32_t cycles[3];
+    uint8_t errors = 0U;
+
+    for(method = 0U; method < 3U; method++) {
+        if(2U == method) {
+            qspi_flash_continuous_read_enable();
+        }
+        address = 0U;
+        cycles[method] = DWT->CYCCNT;
+        for(read = 0U; read < SMALL_READS; read++) {
+            /* pseudo-random addresses in the first 64 KB */
+            address = (address * 1103515245U + 12345U) & 0xFFF0U;
+            if(0U == method) {
+                qspi_flash_buffer_read(rx_buffer, FLASH_READ_ADDRESS + address, SMALL_READ_SIZE);
+            } else {
+                qspi_flash_io_read(rx_buffer, FLASH_READ_ADDRESS + address, SMALL_READ_SIZE);
+            }
+        }
+        cycles[method] = DWT->CYCCNT - cycles[method];
+    }
+
+    /* the continuous read mode ends before the other commands */
+    spi_flash_buffer_read(bench_buffer, FLASH_READ_ADDRESS + 0x40U, SMALL_READ_SIZE);
+    qspi_flash_io_read(rx_buffer, FLASH_READ_ADDRESS + 0x40U, SMALL_READ_SIZE);
+    if(ERROR == memory_compare(bench_buffer, rx_buffer, SMALL_READ_SIZE)) {
+        errors++;
+    }
+    qspi_flash_continuous_read_disable();
+    qspi_flash_io_read(rx_buffer, FLASH_READ_ADDRESS + 0x40U, SMALL_READ_SIZE);
+    if(ERROR == memory_compare(bench_buffer, rx_buffer, SMALL_READ_SIZE)) {
+        errors++;
+    }
+
+    printf("\n\rSmall reads, %u reads of %u bytes, %u errors:\n\r", SMALL_READS, SMALL_READ_SIZE, errors);
+    for(method = 0U; method < 3U; method++) {
+        printf("%s: %u ns per read, %d ns saved\n\r", method_name[method],
+               (uint32_t)(((uint64_t)cycles[method] * 1000U) / (SystemCoreClock / 1000000U) / SMALL_READS),
+               (int32_t)((((int64_t)cycles[0] - (int64_t)cycles[method]) * 1000) / (int64_t)(SystemCoreClock / 1000000U) / (int64_t)SMALL_READS));
+    }
+}
+
+/*!
+    \brief      erase and program a sector through the queue while the main loop keeps running
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_queue_test(void)
+{
+    uint32_t start, loops = 0U;
+
+    queue_done = 0U;
+    start = DWT->CYCCNT;
+    flash_queue_sector_erase(QUEUE_TEST_ADDRESS, NULL, NULL);
+    flash_queue_write(tx_buffer, QUEUE_TEST_ADDRESS, BUFFER_SIZE, flash_queue_done, NULL);
+    /* the CPU is free while the flash erases and programs, SysTick polls the queue */
+    while(0U == queue_done) {
+        loops++;
+    }
+    start = DWT->CYCCNT - start;
+
+    spi_flash_buffer_read(rx_buffer, QUEUE_TEST_ADDRESS, BUFFER_SIZE);
+    printf("\n\rQueue: erase and program in %u us, %u main loops meanwhile, data %s\n\r",
+           start / (SystemCoreClock / 1000000U), loops,
+           (SUCCESS == memory_compare(tx_buffer, rx_buffer, BUFFER_SIZE)) ? "matches" : "differs");
+}
+
+/*!
+    \brief      erase 200 KB with sector erases and with the range erase, then write 200 KB
+                from a producer with and without the erase ahead of the stream
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_erase_test(void)
+{
+    flash_stream_struct stream;
+    uint32_t offset, commands;
+    uint32_t sector_ms, range_ms, inline_ms, stream_ms;
+
+    /* 50 sector erases against the largest aligned erases */
+    sector_ms = DWT->CYCCNT;
+    for(offset = 0U; offset < ERASE_TEST_SIZE; offset += SPI_FLASH_SECTOR_SIZE) {
+        spi_flash_sector_erase(ERASE_TEST_ADDRESS + offset);
+    }
+    sector_ms = (DWT->CYCCNT - sector_ms) / (SystemCoreClock / 1000U);
+    range_ms = DWT->CYCCNT;
+    commands = spi_flash_range_erase(ERASE_TEST_ADDRESS, ERASE_TEST_SIZE);
+    range_ms = (DWT->CYCCNT - range_ms) / (SystemCoreClock / 1000U);
+
+    /* the producer needs STREAM_PRODUCER_MS per block, each block is erased when it is written */
+    inline_ms = DWT->CYCCNT;
+    for(offset = 0U; offset < ERASE_TEST_SIZE; offset += BENCH_BUFFER_SIZE) {
+        delay_ms(STREAM_PRODUCER_MS);
+        bench_buffer[0] = (uint8_t)(offset >> 12);
+        spi_flash_range_erase(ERASE_TEST_ADDRESS + offset, BENCH_BUFFER_SIZE);
+        spi_flash_buffer_write(bench_buffer, ERASE_TEST_ADDRESS + offset, BENCH_BUFFER_SIZE);
+    }
+    inline_ms = (DWT->CYCCNT - inline_ms) / (SystemCoreClock / 1000U);
+
+    /* the same through a stream, the next area is erased while the producer works */
+    queue_done = 1U;
+    stream_ms = DWT->CYCCNT;
+    flash_stream_open(&stream, ERASE_TEST_ADDRESS, ERASE_TEST_SIZE);
+    for(offset = 0U; offset < ERASE_TEST_SIZE; offset += BENCH_BUFFER_SIZE) {
+        delay_ms(STREAM_PRODUCER_MS);
+        /* the buffer is refilled once its previous data is programmed */
+        while(0U == queue_done) {
+        }
+        bench_buffer[0] = (uint8_t)(offset >> 12);
+        queue_done = 0U;
+        while(ERROR == flash_stream_write(&stream, bench_buffer, BENCH_BUFFER_SIZE, flash_queue_done, NULL)) {
+        }
+    }
+    while(0U != flash_queue_count()) {
+    }
+    stream_ms = (DWT->CYCCNT - stream_ms) / (SystemCoreClock / 1000U);
+
+    spi_flash_buffer_read(rx_buffer, ERASE_TEST_ADDRESS + ERASE_TEST_SIZE - BENCH_BUFFER_SIZE, 1U);
+    printf("\n\rErase 200 KB: %u ms with 50 sector erases, %u ms with %u range erase commands\n\r",
+           sector_ms, range_ms, commands);
+    printf("Write 200 KB: %u ms erasing each block, %u ms with erase ahead, last block %s\n\r",
+           inline_ms, stream_ms,
+           (rx_buffer[0] == (uint8_t)((ERASE_TEST_SIZE - BENCH_BUFFER_SIZE) >> 12)) ? "matches" : "differs");
+}
+
+/*!
+    \brief      completion callback of the queue test
+    \param[in]  context: unused
+    \param[out] none
+    \retval     none
+*/
+void flash_queue_done(void *context)
+{
+    (void)context;
+    queue_done = 1U;
+}
+
+/*!
+    \brief      read 256 bytes every millisecond while a 64 KB block is erased, with the erase
+                suspended for each read, and compare with a read that waits for the erase
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_suspend_test(void)
+{
+    uint32_t start, latency, max_latency = 0U, total_latency = 0U, reads = 0U;
+    uint32_t suspended_ms, wait_us, erase_ms;
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+
+    /* the reads suspend the erase, the queue resumes it in between */
+    queue_done = 0U;
+    suspended_ms = DWT->CYCCNT;
+    flash_queue_range_erase(SUSPEND_TEST_ADDRESS, SPI_FLASH_BLOCK64_SIZE, flash_queue_done, NULL);
+    while(0U == queue_done) {
+        start = DWT->CYCCNT;
+        while(ERROR == flash_queue_read(rx_buffer, FLASH_READ_ADDRESS, SUSPEND_TEST_READ_SIZE)) {
+        }
+        latency = DWT->CYCCNT - start;
+        total_latency += latency;
+        if(latency > max_latency) {
+            max_latency = latency;
+        }
+        reads++;
+        delay_ms(1U);
+    }
+    suspended_ms = (DWT->CYCCNT - suspended_ms) / (SystemCoreClock / 1000U);
+
+    /* the same erase, a single read waits for its end */
+    queue_done = 0U;
+    erase_ms = DWT->CYCCNT;
+    flash_queue_range_erase(SUSPEND_TEST_ADDRESS, SPI_FLASH_BLOCK64_SIZE, flash_queue_done, NULL);
+    delay_ms(1U);
+    start = DWT->CYCCNT;
+    while(0U != flash_queue_count()) {
+    }
+    spi_flash_buffer_read(rx_buffer, FLASH_READ_ADDRESS, SUSPEND_TEST_READ_SIZE);
+    wait_us = (DWT->CYCCNT - start) / cycles_per_us;
+    erase_ms = (DWT->CYCCNT - erase_ms) / (SystemCoreClock / 1000U);
+
+    printf("\n\rRead during a 64 KB erase: %u reads, max %u us, avg %u us with suspend, %u us waiting\n\r",
+           reads, max_latency / cycles_per_us, (0U != reads) ? (total_latency / reads / cycles_per_us) : 0U,
+           wait_us);
+    printf("64 KB erase: %u ms with the reads, %u ms alone\n\r", suspended_ms, erase_ms);
+}
+
+/*!
+    \brief      update keys of the key-value store, measure the latency and the write amplification
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void kv_test(void)
+{
+    kv_stats_struct stats;
+    char key[KV_KEY_MAX + 1U];
+    uint32_t update, length;
+    uint32_t call, put_cycles = 0U, get_cycles = 0U;
+    uint8_t errors = 0U;
+
+    if(SUCCESS != kv_init(KV_TEST_ADDRESS, KV_TEST_SECTORS)) {
+        printf("\n\rKV store: mount failed\n\r");
+        return;
+    }
+    for(update = 0U; update < KV_TEST_UPDATES; update++) {
+        sprintf(key, "key%02u", update % KV_TEST_KEYS);
+        tx_buffer[0] = (uint8_t)update;
+        tx_buffer[1] = (uint8_t)(update >> 8);
+        call = DWT->CYCCNT;
+        if(SUCCESS != kv_put(key, tx_buffer, 32U)) {
+            errors++;
+        }
+        put_cycles += DWT->CYCCNT - call;
+        call = DWT->CYCCNT;
+        if((SUCCESS != kv_get(key, rx_buffer, BUFFER_SIZE, &length)) || (32U != length)
+                || (ERROR == memory_compare(tx_buffer, rx_buffer, 32U))) {
+            errors++;
+        }
+        get_cycles += DWT->CYCCNT - call;
+    }
+
+    /* the last values must survive a remount */
+    kv_init(KV_TEST_ADDRESS, KV_TEST_SECTORS);
+    sprintf(key, "key%02u", (KV_TEST_UPDATES - 1U) % KV_TEST_KEYS);
+    if((SUCCESS != kv_get(key, rx_buffer, BUFFER_SIZE, &length))
+            || (rx_buffer[0] != (uint8_t)(KV_TEST_UPDATES - 1U)) || (rx_buffer[1] != (uint8_t)((KV_TEST_UPDATES - 1U) >> 8))) {
+        errors++;
+    }
+    kv_stats_get(&stats);
+    printf("\n\rKV store: put %u us, get %u us, %u errors after remount, %u keys, %u free sectors, erase count %u to %u\n\r",
+           put_cycles / KV_TEST_UPDATES / (SystemCoreClock / 1000000U),
+           get_cycles / KV_TEST_UPDATES / (SystemCoreClock / 1000000U),
+           errors, stats.keys, stats.free_sectors, stats.erase_min, stats.erase_max);
+
+    /* the statistics restart at each mount, measure the amplification on a second pass */
+    for(update = 0U; update < KV_TEST_UPDATES; update++) {
+        sprintf(key, "key%02u", update % KV_TEST_KEYS);
+        kv_put(key, tx_buffer, 32U);
+    }
+    kv_stats_get(&stats);
+    printf("KV store: %u user bytes, %u flash bytes, write amplification %u.%02u, %u collections\n\r",
+           stats.user_bytes, stats.flash_bytes, stats.flash_bytes / stats.user_bytes,
+           (stats.flash_bytes % stats.user_bytes) * 100U / stats.user_bytes, stats.collections);
+}
+
+/*!
+    \brief      write and read a file through the file system, compare with the raw read
+                throughput and check that uncommitted changes do not survive a remount
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void cowfs_test(void)
+{
+    static cowfs_file_struct file;
+    cowfs_stats_struct stats;
+    uint32_t chunk, write_cycles, read_cycles, raw_cycles;
+    uint32_t bytes = BENCH_BUFFER_SIZE * FS_TEST_CHUNKS;
+    uint8_t errors = 0U;
+
+    if((SUCCESS != cowfs_mount(FS_TEST_ADDRESS, FS_TEST_BLOCKS)) && (SUCCESS != cowfs_format(FS_TEST_ADDRESS, FS_TEST_BLOCKS))) {
+        printf("\n\rFile system: format failed\n\r");
+        return;
+    }
+
+    /* write the file, the chunks differ by their first byte */
+    write_cycles = DWT->CYCCNT;
+    cowfs_open(&file, "bench", COWFS_MODE_WRITE | COWFS_MODE_TRUNCATE);
+    for(chunk = 0U; chunk < FS_TEST_CHUNKS; chunk++) {
+        bench_buffer[0] = (uint8_t)chunk;
+        if(BENCH_BUFFER_SIZE != cowfs_write(&file, bench_buffer, BENCH_BUFFER_SIZE)) {
+            errors++;
+        }
+    }
+    if(SUCCESS != cowfs_close(&file)) {
+        errors++;
+    }
+    write_cycles = DWT->CYCCNT - write_cycles;
+
+    read_cycles = DWT->CYCCNT;
+    cowfs_open(&file, "bench", COWFS_MODE_READ);
+    for(chunk = 0U; chunk < FS_TEST_CHUNKS; chunk++) {
+        if((BENCH_BUFFER_SIZE != cowfs_read(&file, bench_buffer, BENCH_BUFFER_SIZE)) || ((uint8_t)chunk != bench_buffer[0])) {
+            errors++;
+        }
+    }
+    cowfs_close(&file);
+    read_cycles = DWT->CYCCNT - read_cycles;
+
+    raw_cycles = DWT->CYCCNT;
+    for(chunk = 0U; chunk < FS_TEST_CHUNKS; chunk++) {
+        qspi_flash_buffer_read(bench_buffer, FS_TEST_ADDRESS + chunk * BENCH_BUFFER_SIZE, BENCH_BUFFER_SIZE);
+    }
+    raw_cycles = DWT->CYCCNT - raw_cycles;
+
+    /* overwrite the first chunk without commit, a remount drops it (Host/cowfs_fuzz.c cuts the power) */
+    cowfs_open(&file, "bench", COWFS_MODE_WRITE);
+    bench_buffer[0] = 0xA5U;
+    cowfs_write(&file, bench_buffer, BENCH_BUFFER_SIZE);
+    cowfs_mount(FS_TEST_ADDRESS, FS_TEST_BLOCKS);
+    cowfs_open(&file, "bench", COWFS_MODE_READ);
+    if((BENCH_BUFFER_SIZE != cowfs_read(&file, bench_buffer, BENCH_BUFFER_SIZE)) || (0U != bench_buffer[0])) {
+        errors++;
+    }
+    cowfs_close(&file);
+
+    cowfs_stats_get(&stats);
+    printf("\n\rFile system: write %u KB/s, read %u KB/s, raw read %u KB/s\n\r",
+           (uint32_t)(((uint64_t)bytes * SystemCoreClock) / write_cycles / 1024U),
+           (uint32_t)(((uint64_t)bytes * SystemCoreClock) / read_cycles / 1024U),
+           (uint32_t)(((uint64_t)bytes * SystemCoreClock) / raw_cycles / 1024U));
+    printf("File system: %u errors, %u files, %u free blocks, revision %u\n\r",
+           errors, stats.files, stats.free_blocks, stats.revision);
+}
+
+#if FLASH_CACHE_ENABLE
+/*!
+    \brief      re-read small records with and without the read cache, then check that an
+                erase and a program of the cached area are seen by the next read
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_cache_test(void)
+{
+    flash_cache_stats_struct stats;
+    uint32_t read, address, direct_cycles, cached_cycles;
+    uint8_t errors = 0U;
+
+    flash_cache_invalidate_all();
+    flash_cache_stats_clear();
+
+    /* the same records in the same order, first from the flash and then through the cache */
+    direct_cycles = DWT->CYCCNT;
+    for(read = 0U; read < CACHE_TEST_READS; read++) {
+        address = FLASH_READ_ADDRESS + ((read * 7U) % CACHE_TEST_RECORDS) * 200U;
+        spi_flash_buffer_read(rx_buffer, address, CACHE_TEST_RECORD_SIZE);
+    }
+    direct_cycles = DWT->CYCCNT - direct_cycles;
+    cached_cycles = DWT->CYCCNT;
+    for(read = 0U; read < CACHE_TEST_READS; read++) {
+        address = FLASH_READ_ADDRESS + ((read * 7U) % CACHE_TEST_RECORDS) * 200U;
+        flash_cache_read(rx_buffer, address, CACHE_TEST_RECORD_SIZE);
+    }
+    cached_cycles = DWT->CYCCNT - cached_cycles;
+
+    /* the erase and the program of the driver drop the stale lines */
+    for(address = 0U; address < BUFFER_SIZE; address += FLASH_CACHE_LINE_SIZE) {
+        flash_cache_read(&rx_buffer[address], QUEUE_TEST_ADDRESS + address, FLASH_CACHE_LINE_SIZE);
+    }
+    spi_flash_sector_erase(QUEUE_TEST_ADDRESS);
+    tx_buffer[0] = 0x5AU;
+    spi_flash_buffer_write(tx_buffer, QUEUE_TEST_ADDRESS, BUFFER_SIZE);
+    for(address = 0U; address < BUFFER_SIZE; address += FLASH_CACHE_LINE_SIZE) {
+        flash_cache_read(&rx_buffer[address], QUEUE_TEST_ADDRESS + address, FLASH_CACHE_LINE_SIZE);
+    }
+    if(ERROR == memory_compare(tx_buffer, rx_buffer, BUFFER_SIZE)) {
+        errors++;
+    }
+
+    flash_cache_stats_get(&stats);
+    printf("\n\rRead cache: %u records of %u bytes in %u us direct, %u us cached, %u errors\n\r",
+           CACHE_TEST_READS, CACHE_TEST_RECORD_SIZE,
+           direct_cycles / (SystemCoreClock / 1000000U), cached_cycles / (SystemCoreClock / 1000000U), errors);
+    printf("Read cache: %u hits, %u misses, %u prefetched, %u prefetch hits, %u bypasses, %u invalidations\n\r",
+           stats.hits, stats.misses, stats.prefetches, stats.prefetch_hits, stats.bypasses, stats.invalidations);
+}
+#endif /* FLASH_CACHE_ENABLE */
+
+/*!
+    \brief      read the flash with bulk transfers of the lowest priority while short messages of
+                a higher priority are sent to a second device, then print the statistics
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_test(void)
+{
+    static spi_bus_device_struct sensor_device;
+    static spi_bus_transfer_struct bulk[2], message;
+    static uint8_t bulk_command[2][4];
+    static uint8_t message_tx[BUS_TEST_MESSAGE_SIZE], message_rx[BUS_TEST_MESSAGE_SIZE];
+    uint32_t chunk, slot, start, elapsed, messages = 0U;
+    uint8_t errors = 0U;
+
+    /* a device on PB1, 12.5 MHz, mode 3, served before the flash */
+    rcu_periph_clock_enable(RCU_GPIOB);
+    spi_bus_device_init(&sensor_device, GPIOB, GPIO_PIN_1, SPI_PSC_8, SPI_CK_PL_HIGH_PH_2EDGE, 1U);
+    spi_bus_stats_clear(&spi_flash_device);
+    /* the bulk transfers send a plain read, the flash must not wait for a quad I/O address */
+    qspi_flash_continuous_read_disable();
+
+    /* the reference of the bulk reads */
+    spi_flash_buffer_read(rx_buffer, BUS_TEST_ADDRESS, BUFFER_SIZE);
+
+    for(slot = 0U; slot < BUS_TEST_MESSAGE_SIZE; slot++) {
+        message_tx[slot] = 0xA5U;
+    }
+    message.device = &sensor_device;
+    message.tx = message_tx;
+    message.rx = message_rx;
+    message.length = BUS_TEST_MESSAGE_SIZE;
+    message.done = 1U;
+
+    /* two bulk reads are queued at any time, the messages jump ahead of the second one */
+    start = DWT->CYCCNT;
+    for(chunk = 0U; chunk < BUS_TEST_CHUNKS + 2U; chunk++) {
+        slot = chunk % 2U;
+        if(chunk >= 2U) {
+            while(0U == bulk[slot].done) {
+                if(0U != message.done) {
+                    spi_bus_submit(&message);
+                    messages++;
+                }
+            }
+            if(ERROR == memory_compare(&bench_buffer[slot * (BENCH_BUFFER_SIZE / 2U)], rx_buffer, BUFFER_SIZE)) {
+                errors++;
+            }
+        }
+        if(chunk >= BUS_TEST_CHUNKS) {
+            continue;
+        }
+        /* read from memory instruction and the 24-bit address */
+        bulk_command[slot][0] = 0x03U;
+        bulk_command[slot][1] = (uint8_t)(BUS_TEST_ADDRESS >> 16);
+        bulk_command[slot][2] = (uint8_t)(BUS_TEST_ADDRESS >> 8);
+        bulk_command[slot][3] = (uint8_t)BUS_TEST_ADDRESS;
+        bulk[slot].device = &spi_flash_device;
+        bulk[slot].command = bulk_command[slot];
+        bulk[slot].command_length = 4U;
+        bulk[slot].tx = NULL;
+        bulk[slot].rx = &bench_buffer[slot * (BENCH_BUFFER_SIZE / 2U)];
+        bulk[slot].length = BENCH_BUFFER_SIZE / 2U;
+        bulk[slot].callback = NULL;
+        spi_bus_submit(&bulk[slot]);
+    }
+    while(0U == message.done) {
+    }
+    elapsed = DWT->CYCCNT - start;
+
+    printf("\n\rSPI bus: %u flash reads of %u bytes, %u messages, %u errors\n\r",
+           BUS_TEST_CHUNKS, BENCH_BUFFER_SIZE / 2U, messages, errors);
+    spi_bus_stats_print("flash", &spi_flash_device, elapsed);
+    spi_bus_stats_print("sensor", &sensor_device, elapsed);
+}
+
+/*!
+    \brief      print the throughput and the waits of a device of the bus
+    \param[in]  name: name of the device
+    \param[in]  device: device structure
+    \param[in]  elapsed: CPU cycles of the measure
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_stats_print(const char *name, spi_bus_device_struct *device, uint32_t elapsed)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+    spi_bus_stats_struct *stats = &device->stats;
+
+    printf("SPI bus %s: %u transfers, %u KB/s, bus busy %u%%, wait avg %u us, max %u us\n\r",
+           name, stats->transfers,
+           (uint32_t)(((uint64_t)stats->bytes * SystemCoreClock) / elapsed / 1024U),
+           (uint32_t)(((uint64_t)stats->busy_cycles * 100U) / elapsed),
+           (0U != stats->transfers) ? (stats->wait_cycles / stats->transfers / cycles_per_us) : 0U,
+           stats->max_wait_cycles / cycles_per_us);
+}
+
+/*!
+    \brief      send frames of varied lengths from the bus to the SPI1 slave at each clock and
+                check them, PE14 (SCK), PA2 (MOSI) and PB1 (CS) are wired to PC6, PD14 and PD13
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_slave_test(void)
+{
+    static const uint32_t prescale[] = {SPI_PSC_16, SPI_PSC_8, SPI_PSC_4, SPI_PSC_2};
+    static spi_bus_device_struct host_device;
+    static spi_bus_transfer_struct transfer;
+    spi_slave_frame_struct frame;
+    spi_slave_stats_struct stats;
+    uint32_t speed, sent, received, errors, length, start, cycles;
+
+    spi_slave_init(SPI_CK_PL_LOW_PH_1EDGE);
+    nvic_irq_enable(SPI_SLAVE_DMA_IRQn, 0, 0);
+    nvic_irq_enable(SPI_SLAVE_NSS_IRQn, 0, 0);
+    nvic_irq_enable(SPI_SLAVE_IRQn, 0, 0);
+
+    /* frame n starts with the byte n and counts up */
+    for(length = 0U; length < BENCH_BUFFER_SIZE; length++) {
+        bench_buffer[length] = (uint8_t)length;
+    }
+
+    printf("\n\rSPI slave: %u frames of 1 to %u bytes at each clock\n\r", SLAVE_TEST_FRAMES, SLAVE_TEST_MAX_FRAME);
+    for(speed = 0U; speed < countof(prescale); speed++) {
+        spi_bus_device_init(&host_device, GPIOB, GPIO_PIN_1, prescale[speed], SPI_CK_PL_LOW_PH_1EDGE, 1U);
+        spi_slave_stats_clear();
+        received = 0U;
+        errors = 0U;
+        cycles = 0U;
+
+        for(sent = 0U; sent < SLAVE_TEST_FRAMES; sent++) {
+            transfer.device = &host_device;
+            transfer.command_length = 0U;
+            transfer.tx = &bench_buffer[sent % 256U];
+            transfer.rx = NULL;
+            transfer.length = 1U + (sent * 37U) % SLAVE_TEST_MAX_FRAME;
+            transfer.callback = NULL;
+            start = DWT->CYCCNT;
+            spi_bus_submit(&transfer);
+            while(0U == transfer.done) {
+            }
+            cycles += DWT->CYCCNT - start;
+
+            /* the NSS interrupt has queued the frame, it is checked in place and released */
+            while(SUCCESS == spi_slave_frame_get(&frame)) {
+                if(((frame.length + frame.wrap_length) != 1U + (received * 37U) % SLAVE_TEST_MAX_FRAME)
+                        || (0U != spi_slave_frame_check(&frame, (uint8_t)received))) {
+                    errors++;
+                }
+                if(SUCCESS != spi_slave_frame_release(&frame)) {
+                    errors++;
+                }
+                received++;
+            }
+        }
+
+        spi_slave_stats_get(&stats);
+        printf("SPI slave PCLK/%u: %u KB/s, %u of %u frames, %u errors, overruns %u SPI, %u ring, %u queue\n\r",
+               2U << (prescale[speed] >> 3), (uint32_t)(((uint64_t)stats.bytes * SystemCoreClock) / cycles / 1024U),
+               received, SLAVE_TEST_FRAMES, errors, stats.spi_overruns, stats.ring_overruns, stats.queue_overruns);
+    }
+}
+
+/*!
+    \brief      check that the bytes of a frame count up from a first value
+    \param[in]  frame: the frame in the ring
+    \param[in]  first: value of the first byte
+    \param[out] none
+    \retval     number of bytes that differ
+*/
+uint32_t spi_slave_frame_check(spi_slave_frame_struct *frame, uint8_t first)
+{
+    uint32_t index, errors = 0U;
+
+    for(index = 0U; index < frame->length; index++) {
+        if(frame->data[index] != (uint8_t)(first + index)) {
+            errors++;
+        }
+    }
+    first += (uint8_t)frame->length;
+    for(index = 0U; index < frame->wrap_length; index++) {
+        if(frame->wrap_data[index] != (uint8_t)(first + index)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
 #ifdef __GNUC__
 /* retarget the C library printf function to the usart, in Eclipse GCC environment */
 int __io_putchar(int ch)
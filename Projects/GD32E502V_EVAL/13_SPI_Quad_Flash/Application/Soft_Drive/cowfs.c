@@ -0,0 +1,677 @@
+/*!
+    \file    cowfs.c
+    \brief   copy-on-write file system on the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "cowfs.h"
+#include "gd25qxx.h"
+
+/* the first two blocks hold the metadata: a directory of the files written as revisions in
+   slots, each revision protected by a CRC. Mounting takes the valid revision with the highest
+   number, a revision torn by a power cut fails its CRC and the one before it is used. A file
+   is a list of data blocks kept in an index block. Changed data is never programmed over the
+   committed data: it goes to erased blocks, the new list goes to a new index block and only
+   the next metadata revision makes them part of the file. The replaced blocks become free
+   once that revision is written, the blocks of a commit a power cut interrupted are simply
+   not referenced and found free by the next mount. */
+
+#define COWFS_MAGIC         0x53464F43U         /* "COFS" */
+#define COWFS_SLOT_SIZE     512U                /* bytes of a metadata slot */
+#define COWFS_SLOTS         (COWFS_BLOCK_SIZE / COWFS_SLOT_SIZE)        /* slots of a metadata block */
+#define COWFS_DATA_BLOCK    2U                  /* first block which is not metadata */
+#define COWFS_COPY_SIZE     256U                /* bytes of the copy buffer, one page */
+
+/* directory entry */
+typedef struct {
+    char name[COWFS_NAME_MAX + 1U];     /* zero terminated name, empty for a free entry */
+    uint32_t size;                      /* bytes of the file */
+    uint16_t index;                     /* block holding the list of the data blocks, COWFS_NONE for an empty file */
+    uint16_t reserved;
+} cowfs_entry_struct;
+
+/* metadata revision */
+typedef struct {
+    uint32_t magic;                     /* COWFS_MAGIC */
+    uint32_t crc;                       /* CRC-32 of the revision number and the entries */
+    uint32_t revision;                  /* number of the revision, the highest one is the current */
+    uint32_t reserved;
+    cowfs_entry_struct entry[COWFS_FILES_MAX];
+} cowfs_meta_struct;
+
+static uint32_t fs_base = 0U;
+static uint32_t fs_blocks = 0U;
+static uint32_t fs_slot = 0U;
+static uint32_t fs_cursor = COWFS_DATA_BLOCK;
+static cowfs_meta_struct fs_meta;
+static uint8_t fs_used[COWFS_BLOCKS_MAX / 8U];
+static uint8_t fs_buffer[COWFS_COPY_SIZE];
+static cowfs_stats_struct fs_stats;
+
+static uint32_t cowfs_block_addr(uint32_t block);
+static uint32_t cowfs_block_count(uint32_t size);
+static uint32_t cowfs_meta_crc(void);
+static void cowfs_meta_write(void);
+static FlagStatus cowfs_blank_check(uint32_t address, uint32_t length);
+static int32_t cowfs_entry_find(const char *name);
+static uint16_t cowfs_block_alloc(void);
+static void cowfs_block_release(cowfs_file_struct *file, uint16_t block);
+static void cowfs_block_copy(uint16_t from, uint16_t to, uint32_t start, uint32_t end);
+static void cowfs_fresh_flush(cowfs_file_struct *file);
+
+/*!
+    \brief      create an empty file system, the files of a previous one are lost
+    \param[in]  base_addr: address of the first block, block aligned
+    \param[in]  block_count: number of blocks, 4 to COWFS_BLOCKS_MAX
+    \param[out] none
+    \retval     SUCCESS or ERROR if the parameters are wrong
+*/
+ErrStatus cowfs_format(uint32_t base_addr, uint32_t block_count)
+{
+    uint32_t entry;
+
+    if((0U != (base_addr % COWFS_BLOCK_SIZE)) || (block_count < 4U) || (block_count > COWFS_BLOCKS_MAX)) {
+        return ERROR;
+    }
+    fs_base = base_addr;
+    fs_blocks = block_count;
+    rcu_periph_clock_enable(RCU_CRC);
+    crc_deinit();
+    /* cowfs_read() reads the data blocks with the quad output read */
+    qspi_flash_quad_enable();
+
+    /* the revisions of the second block would be newer than the first revision written */
+    spi_flash_sector_erase(cowfs_block_addr(1U));
+    memset(&fs_meta, 0, sizeof(fs_meta));
+    for(entry = 0U; entry < COWFS_FILES_MAX; entry++) {
+        fs_meta.entry[entry].index = COWFS_NONE;
+    }
+    fs_slot = 0U;
+    cowfs_meta_write();
+    return cowfs_mount(base_addr, block_count);
+}
+
+/*!
+    \brief      mount the file system from the last complete metadata commit
+    \param[in]  base_addr: address of the first block, block aligned
+    \param[in]  block_count: number of blocks, 4 to COWFS_BLOCKS_MAX
+    \param[out] none
+    \retval     SUCCESS or ERROR if there is no valid file system
+*/
+ErrStatus cowfs_mount(uint32_t base_addr, uint32_t block_count)
+{
+    uint32_t slot;
+    uint32_t best = COWFS_SLOTS * 2U;
+    uint32_t revision = 0U;
+    uint32_t entry;
+    uint32_t count;
+    uint32_t i;
+    uint16_t index;
+    uint16_t block;
+
+    if((0U != (base_addr % COWFS_BLOCK_SIZE)) || (block_count < 4U) || (block_count > COWFS_BLOCKS_MAX)) {
+        return ERROR;
+    }
+    fs_base = base_addr;
+    fs_blocks = 0U;
+    rcu_periph_clock_enable(RCU_CRC);
+    crc_deinit();
+    /* cowfs_read() reads the data blocks with the quad output read */
+    qspi_flash_quad_enable();
+    memset(&fs_stats, 0, sizeof(fs_stats));
+
+    /* find the last complete revision */
+    for(slot = 0U; slot < (COWFS_SLOTS * 2U); slot++) {
+        spi_flash_buffer_read((uint8_t *)&fs_meta, fs_base + slot * COWFS_SLOT_SIZE, sizeof(fs_meta));
+        if((COWFS_MAGIC == fs_meta.magic) && (fs_meta.crc == cowfs_meta_crc())
+                && ((COWFS_SLOTS * 2U == best) || (fs_meta.revision > revision))) {
+            best = slot;
+            revision = fs_meta.revision;
+        }
+    }
+    if(COWFS_SLOTS * 2U == best) {
+        return ERROR;
+    }
+    spi_flash_buffer_read((uint8_t *)&fs_meta, fs_base + best * COWFS_SLOT_SIZE, sizeof(fs_meta));
+
+    /* the next revision goes to the next blank slot, a torn revision leaves its slot programmed */
+    for(fs_slot = best + 1U; 0U != (fs_slot % COWFS_SLOTS); fs_slot++) {
+        if(SET == cowfs_blank_check(fs_base + fs_slot * COWFS_SLOT_SIZE, COWFS_SLOT_SIZE)) {
+            break;
+        }
+    }
+    fs_slot %= COWFS_SLOTS * 2U;
+
+    /* the blocks of the files are used, the others are free */
+    memset(fs_used, 0, sizeof(fs_used));
+    fs_used[0] = 0x03U;
+    for(entry = 0U; entry < COWFS_FILES_MAX; entry++) {
+        index = fs_meta.entry[entry].index;
+        if(('\0' == fs_meta.entry[entry].name[0]) || (COWFS_NONE == index)) {
+            continue;
+        }
+        count = cowfs_block_count(fs_meta.entry[entry].size);
+        if((index < COWFS_DATA_BLOCK) || (index >= block_count) || (count > COWFS_FILE_BLOCKS)) {
+            return ERROR;
+        }
+        fs_used[index / 8U] |= (uint8_t)(1U << (index % 8U));
+        for(i = 0U; i < count; i++) {
+            if(0U == (i % (COWFS_COPY_SIZE / 2U))) {
+                spi_flash_buffer_read(fs_buffer, cowfs_block_addr(index) + i * 2U, COWFS_COPY_SIZE);
+            }
+            block = ((uint16_t *)fs_buffer)[i % (COWFS_COPY_SIZE / 2U)];
+            if((block < COWFS_DATA_BLOCK) || (block >= block_count)) {
+                return ERROR;
+            }
+            fs_used[block / 8U] |= (uint8_t)(1U << (block % 8U));
+        }
+    }
+    fs_blocks = block_count;
+    fs_cursor = COWFS_DATA_BLOCK;
+    return SUCCESS;
+}
+
+/*!
+    \brief      open a file
+    \param[in]  name: zero terminated name, 1 to COWFS_NAME_MAX characters
+    \param[in]  mode: open mode, one or more parameters can be selected which are shown as below:
+      \arg        COWFS_MODE_READ: the file can be read
+      \arg        COWFS_MODE_WRITE: the file can be written, it is created if missing
+      \arg        COWFS_MODE_TRUNCATE: the file is emptied, with COWFS_MODE_WRITE
+    \param[out] file: the open file
+    \retval     SUCCESS or ERROR if the file is missing or the directory is full
+*/
+ErrStatus cowfs_open(cowfs_file_struct *file, const char *name, uint8_t mode)
+{
+    int32_t entry;
+    uint32_t count;
+    uint32_t i;
+
+    if((NULL == name) || ('\0' == name[0]) || (strlen(name) > COWFS_NAME_MAX) || (0U == fs_blocks)) {
+        return ERROR;
+    }
+    entry = cowfs_entry_find(name);
+    if(entry < 0) {
+        if(0U == (mode & COWFS_MODE_WRITE)) {
+            return ERROR;
+        }
+        /* the new file is committed empty */
+        entry = cowfs_entry_find("");
+        if(entry < 0) {
+            return ERROR;
+        }
+        strcpy(fs_meta.entry[entry].name, name);
+        fs_meta.entry[entry].size = 0U;
+        fs_meta.entry[entry].index = COWFS_NONE;
+        cowfs_meta_write();
+    }
+
+    memset(file, 0, sizeof(*file));
+    file->entry = (uint8_t)entry;
+    file->mode = mode;
+    file->size = fs_meta.entry[entry].size;
+    file->fresh = COWFS_NONE;
+    count = cowfs_block_count(file->size);
+    if(0U != count) {
+        spi_flash_buffer_read((uint8_t *)file->blocks, cowfs_block_addr(fs_meta.entry[entry].index), (uint16_t)(count * 2U));
+    }
+    if((0U != (mode & COWFS_MODE_WRITE)) && (0U != (mode & COWFS_MODE_TRUNCATE))) {
+        for(i = 0U; i < count; i++) {
+            cowfs_block_release(file, file->blocks[i]);
+        }
+        file->size = 0U;
+        file->dirty = 1U;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      read from the position of a file
+    \param[in]  file: the open file
+    \param[in]  length: bytes to read
+    \param[out] buffer: the data
+    \retval     bytes read, less than length at the end of the file
+*/
+uint32_t cowfs_read(cowfs_file_struct *file, void *buffer, uint32_t length)
+{
+    uint8_t *data = (uint8_t *)buffer;
+    uint32_t offset;
+    uint32_t chunk;
+    uint32_t done;
+
+    if(0U == (file->mode & COWFS_MODE_READ)) {
+        return 0U;
+    }
+    cowfs_fresh_flush(file);
+    if(length > (file->size - file->position)) {
+        length = file->size - file->position;
+    }
+    /* one read command per block, the data goes straight to the buffer */
+    for(done = 0U; done < length; done += chunk) {
+        offset = file->position % COWFS_BLOCK_SIZE;
+        chunk = COWFS_BLOCK_SIZE - offset;
+        if(chunk > (length - done)) {
+            chunk = length - done;
+        }
+        qspi_flash_buffer_read(&data[done], cowfs_block_addr(file->blocks[file->position / COWFS_BLOCK_SIZE]) + offset,
+                               (uint16_t)chunk);
+        file->position += chunk;
+    }
+    return length;
+}
+
+/*!
+    \brief      write at the position of a file, the data is part of the file once committed
+    \param[in]  file: the open file
+    \param[in]  buffer: the data
+    \param[in]  length: bytes to write
+    \param[out] none
+    \retval     bytes written, less than length if the file or the file system is full
+*/
+uint32_t cowfs_write(cowfs_file_struct *file, const void *buffer, uint32_t length)
+{
+    const uint8_t *data = (const uint8_t *)buffer;
+    uint32_t block;
+    uint32_t offset;
+    uint32_t chunk;
+    uint32_t done;
+    uint32_t valid;
+
+    if(0U == (file->mode & COWFS_MODE_WRITE)) {
+        return 0U;
+    }
+    for(done = 0U; done < length; done += chunk) {
+        block = file->position / COWFS_BLOCK_SIZE;
+        offset = file->position % COWFS_BLOCK_SIZE;
+        if(block >= COWFS_FILE_BLOCKS) {
+            break;
+        }
+        /* a byte of the fresh block can be programmed once, going back needs another block */
+        if((COWFS_NONE != file->fresh) && ((block != file->fresh_block) || (offset < file->fresh_fill))) {
+            cowfs_fresh_flush(file);
+        }
+        if(COWFS_NONE == file->fresh) {
+            file->fresh = cowfs_block_alloc();
+            if(COWFS_NONE == file->fresh) {
+                break;
+            }
+            valid = file->size - block * COWFS_BLOCK_SIZE;
+            file->fresh_block = (uint16_t)block;
+            file->fresh_fill = 0U;
+            file->fresh_old = (uint16_t)((block < cowfs_block_count(file->size)) ?
+                                         ((valid < COWFS_BLOCK_SIZE) ? valid : COWFS_BLOCK_SIZE) : 0U);
+        }
+        /* the data before the position comes from the replaced block */
+        if(offset > file->fresh_fill) {
+            cowfs_block_copy(file->blocks[block], file->fresh, file->fresh_fill, offset);
+        }
+        chunk = COWFS_BLOCK_SIZE - offset;
+        if(chunk > (length - done)) {
+            chunk = length - done;
+        }
+        spi_flash_buffer_write((uint8_t *)&data[done], cowfs_block_addr(file->fresh) + offset, (uint16_t)chunk);
+        file->fresh_fill = (uint16_t)(offset + chunk);
+        file->position += chunk;
+        if(file->position > file->size) {
+            file->size = file->position;
+        }
+        file->dirty = 1U;
+    }
+    return done;
+}
+
+/*!
+    \brief      set the position of a file
+    \param[in]  file: the open file
+    \param[in]  position: the position, up to the size of the file
+    \param[out] none
+    \retval     SUCCESS or ERROR if the position is after the end of the file
+*/
+ErrStatus cowfs_seek(cowfs_file_struct *file, uint32_t position)
+{
+    if(position > file->size) {
+        return ERROR;
+    }
+    file->position = position;
+    return SUCCESS;
+}
+
+/*!
+    \brief      commit the changes of a file in one metadata revision
+    \param[in]  file: the open file
+    \param[out] none
+    \retval     SUCCESS or ERROR if no block is left for the index
+*/
+ErrStatus cowfs_sync(cowfs_file_struct *file)
+{
+    cowfs_entry_struct *entry = &fs_meta.entry[file->entry];
+    uint16_t index = COWFS_NONE;
+    uint32_t count;
+    uint32_t i;
+
+    if((0U == (file->mode & COWFS_MODE_WRITE)) || (0U == file->dirty)) {
+        return SUCCESS;
+    }
+    cowfs_fresh_flush(file);
+    count = cowfs_block_count(file->size);
+    if(0U != count) {
+        index = cowfs_block_alloc();
+        if(COWFS_NONE == index) {
+            return ERROR;
+        }
+        spi_flash_buffer_write((uint8_t *)file->blocks, cowfs_block_addr(index), (uint16_t)(count * 2U));
+    }
+    if(COWFS_NONE != entry->index) {
+        cowfs_block_release(file, entry->index);
+    }
+    entry->size = file->size;
+    entry->index = index;
+    cowfs_meta_write();
+
+    /* the replaced blocks are no longer referenced */
+    for(i = 0U; i < sizeof(fs_used); i++) {
+        fs_used[i] &= (uint8_t)~file->release[i];
+    }
+    memset(file->release, 0, sizeof(file->release));
+    memset(file->owned, 0, sizeof(file->owned));
+    file->dirty = 0U;
+    return SUCCESS;
+}
+
+/*!
+    \brief      commit the changes of a file and close it
+    \param[in]  file: the open file
+    \param[out] none
+    \retval     SUCCESS or ERROR if the changes could not be committed
+*/
+ErrStatus cowfs_close(cowfs_file_struct *file)
+{
+    ErrStatus status;
+
+    status = cowfs_sync(file);
+    file->mode = 0U;
+    return status;
+}
+
+/*!
+    \brief      remove a file which is not open
+    \param[in]  name: zero terminated name
+    \param[out] none
+    \retval     SUCCESS or ERROR if the file is missing
+*/
+ErrStatus cowfs_remove(const char *name)
+{
+    int32_t entry;
+    uint16_t index;
+    uint32_t count;
+    uint32_t i;
+    uint16_t block;
+
+    if((NULL == name) || ('\0' == name[0])) {
+        return ERROR;
+    }
+    entry = cowfs_entry_find(name);
+    if(entry < 0) {
+        return ERROR;
+    }
+    index = fs_meta.entry[entry].index;
+    count = cowfs_block_count(fs_meta.entry[entry].size);
+    memset(&fs_meta.entry[entry], 0, sizeof(fs_meta.entry[entry]));
+    fs_meta.entry[entry].index = COWFS_NONE;
+    cowfs_meta_write();
+
+    /* the index block is still intact, it gives the blocks to free */
+    if(COWFS_NONE != index) {
+        for(i = 0U; i < count; i++) {
+            spi_flash_buffer_read((uint8_t *)&block, cowfs_block_addr(index) + i * 2U, 2U);
+            fs_used[block / 8U] &= (uint8_t)~(1U << (block % 8U));
+        }
+        fs_used[index / 8U] &= (uint8_t)~(1U << (index % 8U));
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the statistics of the file system
+    \param[in]  none
+    \param[out] stats: the statistics
+    \retval     none
+*/
+void cowfs_stats_get(cowfs_stats_struct *stats)
+{
+    uint32_t block;
+    uint32_t entry;
+
+    fs_stats.revision = fs_meta.revision;
+    fs_stats.free_blocks = 0U;
+    for(block = COWFS_DATA_BLOCK; block < fs_blocks; block++) {
+        if(0U == (fs_used[block / 8U] & (1U << (block % 8U)))) {
+            fs_stats.free_blocks++;
+        }
+    }
+    fs_stats.files = 0U;
+    for(entry = 0U; entry < COWFS_FILES_MAX; entry++) {
+        if('\0' != fs_meta.entry[entry].name[0]) {
+            fs_stats.files++;
+        }
+    }
+    *stats = fs_stats;
+}
+
+/*!
+    \brief      get the flash address of a block
+    \param[in]  block: the block
+    \param[out] none
+    \retval     the address
+*/
+static uint32_t cowfs_block_addr(uint32_t block)
+{
+    return fs_base + (block * COWFS_BLOCK_SIZE);
+}
+
+/*!
+    \brief      get the number of blocks of a file
+    \param[in]  size: bytes of the file
+    \param[out] none
+    \retval     the number of blocks
+*/
+static uint32_t cowfs_block_count(uint32_t size)
+{
+    return (size + COWFS_BLOCK_SIZE - 1U) / COWFS_BLOCK_SIZE;
+}
+
+/*!
+    \brief      compute the CRC of the metadata in RAM with the CRC unit
+    \param[in]  none
+    \param[out] none
+    \retval     the CRC of the revision number and the entries
+*/
+static uint32_t cowfs_meta_crc(void)
+{
+    crc_data_register_reset();
+    return crc_block_data_calculate((void *)&fs_meta.revision, (sizeof(fs_meta) - 8U) / 4U, INPUT_FORMAT_WORD);
+}
+
+/*!
+    \brief      write the metadata in RAM as a new revision, the other block is erased when
+                the current one is full
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void cowfs_meta_write(void)
+{
+    /* the other block only holds older revisions */
+    if(0U == (fs_slot % COWFS_SLOTS)) {
+        spi_flash_sector_erase(fs_base + fs_slot * COWFS_SLOT_SIZE);
+        fs_stats.erases++;
+    }
+    fs_meta.magic = COWFS_MAGIC;
+    fs_meta.revision++;
+    fs_meta.reserved = 0xFFFFFFFFU;
+    fs_meta.crc = cowfs_meta_crc();
+    spi_flash_buffer_write((uint8_t *)&fs_meta, fs_base + fs_slot * COWFS_SLOT_SIZE, sizeof(fs_meta));
+    fs_slot = (fs_slot + 1U) % (COWFS_SLOTS * 2U);
+}
+
+/*!
+    \brief      check that a flash area is erased
+    \param[in]  address: address of the area
+    \param[in]  length: bytes of the area, a multiple of COWFS_COPY_SIZE
+    \param[out] none
+    \retval     SET if all the bytes are 0xFF, RESET otherwise
+*/
+static FlagStatus cowfs_blank_check(uint32_t address, uint32_t length)
+{
+    uint32_t offset;
+    uint32_t i;
+
+    for(offset = 0U; offset < length; offset += COWFS_COPY_SIZE) {
+        spi_flash_buffer_read(fs_buffer, address + offset, COWFS_COPY_SIZE);
+        for(i = 0U; i < COWFS_COPY_SIZE; i++) {
+            if(0xFFU != fs_buffer[i]) {
+                return RESET;
+            }
+        }
+    }
+    return SET;
+}
+
+/*!
+    \brief      find the directory entry of a file
+    \param[in]  name: zero terminated name, an empty name finds a free entry
+    \param[out] none
+    \retval     the entry, -1 if not found
+*/
+static int32_t cowfs_entry_find(const char *name)
+{
+    int32_t entry;
+
+    for(entry = 0; entry < (int32_t)COWFS_FILES_MAX; entry++) {
+        if(0 == strncmp(fs_meta.entry[entry].name, name, COWFS_NAME_MAX + 1U)) {
+            return entry;
+        }
+    }
+    return -1;
+}
+
+/*!
+    \brief      allocate and erase a free block, the search goes round the flash to spread the wear
+    \param[in]  none
+    \param[out] none
+    \retval     the block, COWFS_NONE if the file system is full
+*/
+static uint16_t cowfs_block_alloc(void)
+{
+    uint32_t block;
+    uint32_t n;
+
+    for(n = COWFS_DATA_BLOCK; n < fs_blocks; n++) {
+        block = fs_cursor;
+        fs_cursor = (fs_cursor + 1U < fs_blocks) ? (fs_cursor + 1U) : COWFS_DATA_BLOCK;
+        if(0U == (fs_used[block / 8U] & (1U << (block % 8U)))) {
+            fs_used[block / 8U] |= (uint8_t)(1U << (block % 8U));
+            spi_flash_sector_erase(cowfs_block_addr(block));
+            fs_stats.erases++;
+            return (uint16_t)block;
+        }
+    }
+    return COWFS_NONE;
+}
+
+/*!
+    \brief      release a block replaced in a file
+    \param[in]  file: the open file
+    \param[in]  block: the block
+    \param[out] none
+    \retval     none
+*/
+static void cowfs_block_release(cowfs_file_struct *file, uint16_t block)
+{
+    uint8_t bit = (uint8_t)(1U << (block % 8U));
+
+    /* a block written since the last commit is free at once, a committed one after the next commit */
+    if(0U != (file->owned[block / 8U] & bit)) {
+        file->owned[block / 8U] &= (uint8_t)~bit;
+        fs_used[block / 8U] &= (uint8_t)~bit;
+    } else {
+        file->release[block / 8U] |= bit;
+    }
+}
+
+/*!
+    \brief      copy a part of a block to an erased block
+    \param[in]  from: the source block
+    \param[in]  to: the erased block
+    \param[in]  start: offset of the first byte
+    \param[in]  end: offset after the last byte
+    \param[out] none
+    \retval     none
+*/
+static void cowfs_block_copy(uint16_t from, uint16_t to, uint32_t start, uint32_t end)
+{
+    uint32_t chunk;
+
+    while(start < end) {
+        /* the chunks stay inside a page so that each one is one program command */
+        chunk = COWFS_COPY_SIZE - (start % COWFS_COPY_SIZE);
+        if(chunk > (end - start)) {
+            chunk = end - start;
+        }
+        spi_flash_buffer_read(fs_buffer, cowfs_block_addr(from) + start, (uint16_t)chunk);
+        spi_flash_buffer_write(fs_buffer, cowfs_block_addr(to) + start, (uint16_t)chunk);
+        start += chunk;
+    }
+}
+
+/*!
+    \brief      complete the fresh block of a file and put it in the list of blocks
+    \param[in]  file: the open file
+    \param[out] none
+    \retval     none
+*/
+static void cowfs_fresh_flush(cowfs_file_struct *file)
+{
+    if(COWFS_NONE == file->fresh) {
+        return;
+    }
+    /* the rest of the replaced block follows the written data */
+    if(file->fresh_old > file->fresh_fill) {
+        cowfs_block_copy(file->blocks[file->fresh_block], file->fresh, file->fresh_fill, file->fresh_old);
+    }
+    if(0U != file->fresh_old) {
+        cowfs_block_release(file, file->blocks[file->fresh_block]);
+    }
+    file->blocks[file->fresh_block] = file->fresh;
+    file->owned[file->fresh / 8U] |= (uint8_t)(1U << (file->fresh % 8U));
+    file->fresh = COWFS_NONE;
+}
@@ -0,0 +1,98 @@
+/*!
+    \file    cowfs.h
+    \brief   the header file of the copy-on-write file system on the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef COWFS_H
+#define COWFS_H
+
+#include "gd32e502.h"
+
+#define COWFS_BLOCK_SIZE              0x1000U             /* erase unit of the GD25Q16 */
+#define COWFS_BLOCKS_MAX              256U                /* blocks a file system can use, 2 of them hold the metadata */
+#define COWFS_FILES_MAX               16U                 /* files of the file system */
+#define COWFS_NAME_MAX                15U                 /* characters of a file name */
+#define COWFS_FILE_BLOCKS             128U                /* blocks of a file, 512 KB */
+#define COWFS_NONE                    0xFFFFU             /* no block */
+
+/* open modes, combined with OR */
+#define COWFS_MODE_READ               0x01U               /* cowfs_read() is allowed */
+#define COWFS_MODE_WRITE              0x02U               /* cowfs_write() is allowed, the file is created if missing */
+#define COWFS_MODE_TRUNCATE           0x04U               /* the file is emptied, with COWFS_MODE_WRITE */
+
+/* open file structure, allocated by the application */
+typedef struct {
+    uint8_t entry;                      /* directory entry of the file */
+    uint8_t mode;                       /* open mode, 0 when the file is closed */
+    uint8_t dirty;                      /* the file changed since the last commit */
+    uint32_t size;                      /* bytes of the file */
+    uint32_t position;                  /* position of the next read or write */
+    uint16_t fresh;                     /* erased block being written, COWFS_NONE if none */
+    uint16_t fresh_block;               /* block of the file the fresh block replaces */
+    uint16_t fresh_fill;                /* bytes programmed at the start of the fresh block */
+    uint16_t fresh_old;                 /* bytes of the replaced block which are still part of the file */
+    uint16_t blocks[COWFS_FILE_BLOCKS];                 /* blocks of the file */
+    uint8_t owned[COWFS_BLOCKS_MAX / 8U];               /* blocks written since the last commit */
+    uint8_t release[COWFS_BLOCKS_MAX / 8U];             /* committed blocks replaced, freed by the next commit */
+} cowfs_file_struct;
+
+/* file system statistics structure */
+typedef struct {
+    uint32_t revision;                  /* number of the last metadata commit */
+    uint32_t erases;                    /* blocks erased since the mount */
+    uint32_t free_blocks;               /* blocks which can be allocated */
+    uint32_t files;                     /* files of the file system */
+} cowfs_stats_struct;
+
+/* function declarations */
+/* create an empty file system */
+ErrStatus cowfs_format(uint32_t base_addr, uint32_t block_count);
+/* mount the file system from the last complete metadata commit */
+ErrStatus cowfs_mount(uint32_t base_addr, uint32_t block_count);
+/* open a file */
+ErrStatus cowfs_open(cowfs_file_struct *file, const char *name, uint8_t mode);
+/* read from the position of a file */
+uint32_t cowfs_read(cowfs_file_struct *file, void *buffer, uint32_t length);
+/* write at the position of a file */
+uint32_t cowfs_write(cowfs_file_struct *file, const void *buffer, uint32_t length);
+/* set the position of a file */
+ErrStatus cowfs_seek(cowfs_file_struct *file, uint32_t position);
+/* commit the changes of a file */
+ErrStatus cowfs_sync(cowfs_file_struct *file);
+/* commit the changes of a file and close it */
+ErrStatus cowfs_close(cowfs_file_struct *file);
+/* remove a file which is not open */
+ErrStatus cowfs_remove(const char *name);
+/* get the statistics of the file system */
+void cowfs_stats_get(cowfs_stats_struct *stats);
+
+#endif /* COWFS_H */
@@ -0,0 +1,276 @@
+/*!
+    \file    flash_cache.c
+    \brief   SRAM read cache of the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "flash_cache.h"
+#include "gd25qxx.h"
+
+#if FLASH_CACHE_ENABLE
+
+/* each line holds FLASH_CACHE_LINE_SIZE aligned bytes of the flash. A miss replaces the least
+   recently used line, and when it follows a miss on the previous line the next lines are
+   read in the same command, saving the instruction and the address of each. The driver
+   drops the lines of the areas it programs or erases, when it starts and again when it ends,
+   so the cache never returns stale data. The cache runs within a claim of the flash, the
+   queue poll of the SysTick interrupt, which drops lines as well, waits for its end. */
+
+#define FLASH_CACHE_INVALID 0xFFFFFFFFU         /* tag of an empty line */
+
+/* cache line structure */
+typedef struct {
+    uint32_t tag;                       /* flash address of the line, FLASH_CACHE_INVALID if empty */
+    uint32_t used;                      /* access stamp, the lowest one is the least recently used */
+    uint8_t prefetched;                 /* the line was read ahead and not used yet */
+    uint8_t data[FLASH_CACHE_LINE_SIZE];
+} flash_cache_line_struct;
+
+static flash_cache_line_struct cache_line[FLASH_CACHE_LINES];
+static uint32_t cache_stamp = 0U;
+static uint32_t cache_last_miss = FLASH_CACHE_INVALID;
+static uint8_t cache_ready = 0U;
+static flash_cache_stats_struct cache_stats;
+
+static flash_cache_line_struct *flash_cache_lookup(uint32_t tag);
+static flash_cache_line_struct *flash_cache_fill(uint32_t tag);
+
+/*!
+    \brief      read the flash through the cache
+    \param[in]  read_addr: flash's internal address to read from
+    \param[in]  num_byte_to_read: number of bytes to read from the flash
+    \param[out] pbuffer: pointer to the buffer that receives the data read from the flash
+    \retval     none
+*/
+void flash_cache_read(uint8_t *pbuffer, uint32_t read_addr, uint32_t num_byte_to_read)
+{
+    flash_cache_line_struct *line;
+    uint32_t offset;
+    uint32_t chunk;
+
+    spi_flash_claim();
+    if(0U == cache_ready) {
+        flash_cache_invalidate_all();
+    }
+    /* large reads would only push the small records out */
+    if(num_byte_to_read >= FLASH_CACHE_BYPASS) {
+        cache_stats.bypasses++;
+        while(0U != num_byte_to_read) {
+            chunk = (num_byte_to_read > 0x8000U) ? 0x8000U : num_byte_to_read;
+            spi_flash_buffer_read(pbuffer, read_addr, (uint16_t)chunk);
+            pbuffer += chunk;
+            read_addr += chunk;
+            num_byte_to_read -= chunk;
+        }
+        spi_flash_release();
+        return;
+    }
+
+    while(0U != num_byte_to_read) {
+        offset = read_addr & (FLASH_CACHE_LINE_SIZE - 1U);
+        chunk = FLASH_CACHE_LINE_SIZE - offset;
+        if(chunk > num_byte_to_read) {
+            chunk = num_byte_to_read;
+        }
+        line = flash_cache_lookup(read_addr - offset);
+        if(NULL != line) {
+            cache_stats.hits++;
+            if(0U != line->prefetched) {
+                line->prefetched = 0U;
+                cache_stats.prefetch_hits++;
+            }
+        } else {
+            cache_stats.misses++;
+            line = flash_cache_fill(read_addr - offset);
+        }
+        line->used = ++cache_stamp;
+        memcpy(pbuffer, &line->data[offset], chunk);
+        pbuffer += chunk;
+        read_addr += chunk;
+        num_byte_to_read -= chunk;
+    }
+    spi_flash_release();
+}
+
+/*!
+    \brief      drop the lines of a flash area, called by the driver when a program or an erase
+                starts and when it ends
+    \param[in]  addr: flash's internal address of the area
+    \param[in]  length: bytes of the area
+    \param[out] none
+    \retval     none
+*/
+void flash_cache_invalidate(uint32_t addr, uint32_t length)
+{
+    uint32_t line;
+    uint32_t start = addr & ~(FLASH_CACHE_LINE_SIZE - 1U);
+
+    if(0U == cache_ready) {
+        return;
+    }
+    /* the queue poll does not drop lines in the middle of a read of the cache */
+    spi_flash_claim();
+    for(line = 0U; line < FLASH_CACHE_LINES; line++) {
+        if((FLASH_CACHE_INVALID != cache_line[line].tag) && (cache_line[line].tag >= start)
+                && (cache_line[line].tag < (addr + length))) {
+            /* an invalid line is the LRU victim and no longer counts as prefetched */
+            cache_line[line].tag = FLASH_CACHE_INVALID;
+            cache_line[line].used = 0U;
+            cache_line[line].prefetched = 0U;
+            cache_stats.invalidations++;
+        }
+    }
+    /* the next read of the area is not part of a sequence */
+    if((FLASH_CACHE_INVALID != cache_last_miss) && (cache_last_miss >= start) && (cache_last_miss < (addr + length))) {
+        cache_last_miss = FLASH_CACHE_INVALID;
+    }
+    spi_flash_release();
+}
+
+/*!
+    \brief      drop all the lines
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_cache_invalidate_all(void)
+{
+    uint32_t line;
+
+    spi_flash_claim();
+    for(line = 0U; line < FLASH_CACHE_LINES; line++) {
+        if((0U != cache_ready) && (FLASH_CACHE_INVALID != cache_line[line].tag)) {
+            cache_stats.invalidations++;
+        }
+        cache_line[line].tag = FLASH_CACHE_INVALID;
+        cache_line[line].used = 0U;
+        cache_line[line].prefetched = 0U;
+    }
+    cache_last_miss = FLASH_CACHE_INVALID;
+    cache_ready = 1U;
+    spi_flash_release();
+}
+
+/*!
+    \brief      get the cache statistics
+    \param[in]  none
+    \param[out] stats: the statistics
+    \retval     none
+*/
+void flash_cache_stats_get(flash_cache_stats_struct *stats)
+{
+    *stats = cache_stats;
+}
+
+/*!
+    \brief      clear the cache statistics
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_cache_stats_clear(void)
+{
+    memset(&cache_stats, 0, sizeof(cache_stats));
+}
+
+/*!
+    \brief      find the line of a flash address
+    \param[in]  tag: flash address of the line
+    \param[out] none
+    \retval     the line, NULL if it is not in the cache
+*/
+static flash_cache_line_struct *flash_cache_lookup(uint32_t tag)
+{
+    uint32_t line;
+
+    for(line = 0U; line < FLASH_CACHE_LINES; line++) {
+        if(tag == cache_line[line].tag) {
+            return &cache_line[line];
+        }
+    }
+    return NULL;
+}
+
+/*!
+    \brief      read a missing line, and the next ones if the misses are sequential, in one
+                command, a program or an erase in progress is suspended for the read
+    \param[in]  tag: flash address of the line
+    \param[out] none
+    \retval     the line
+*/
+static flash_cache_line_struct *flash_cache_fill(uint32_t tag)
+{
+    flash_cache_line_struct *first = NULL;
+    flash_cache_line_struct *line;
+    ErrStatus suspended;
+    uint32_t count = 1U;
+    uint32_t n;
+    uint32_t i;
+
+    /* read ahead the lines which follow and are not in the cache yet */
+    if((tag - FLASH_CACHE_LINE_SIZE) == cache_last_miss) {
+        while((count <= FLASH_CACHE_PREFETCH) && (count < FLASH_CACHE_LINES)
+                && (NULL == flash_cache_lookup(tag + count * FLASH_CACHE_LINE_SIZE))) {
+            count++;
+        }
+    }
+    cache_last_miss = tag + (count - 1U) * FLASH_CACHE_LINE_SIZE;
+
+    /* the busy flash does not answer a read, the lines would hold what the bus floats to */
+    suspended = spi_flash_read_suspend();
+    spi_flash_start_read_sequence(tag);
+    for(n = 0U; n < count; n++) {
+        /* the least recently used line, an empty line has the stamp 0 */
+        line = &cache_line[0];
+        for(i = 1U; i < FLASH_CACHE_LINES; i++) {
+            if(cache_line[i].used < line->used) {
+                line = &cache_line[i];
+            }
+        }
+        line->tag = tag + n * FLASH_CACHE_LINE_SIZE;
+        line->prefetched = (0U != n) ? 1U : 0U;
+        /* the lines read ahead share the stamp of the line asked for */
+        line->used = (0U != n) ? cache_stamp : ++cache_stamp;
+        for(i = 0U; i < FLASH_CACHE_LINE_SIZE; i++) {
+            line->data[i] = spi_flash_read_byte();
+        }
+        if(0U == n) {
+            first = line;
+        }
+    }
+    SPI_FLASH_CS_HIGH();
+    spi_flash_read_resume(suspended);
+    cache_stats.prefetches += count - 1U;
+    return first;
+}
+
+#endif /* FLASH_CACHE_ENABLE */
@@ -0,0 +1,76 @@
+/*!
+    \file    flash_cache.h
+    \brief   the header file of the SRAM read cache of the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef FLASH_CACHE_H
+#define FLASH_CACHE_H
+
+#include "gd32e502.h"
+
+/* the cache is built when FLASH_CACHE_ENABLE of gd25qxx.h is not 0 */
+
+/* the geometry can be set from the build */
+#ifndef FLASH_CACHE_LINE_SIZE
+#define FLASH_CACHE_LINE_SIZE         64U                 /* bytes of a line, a power of two */
+#endif
+#ifndef FLASH_CACHE_LINES
+#define FLASH_CACHE_LINES             32U                 /* lines of the cache */
+#endif
+#ifndef FLASH_CACHE_PREFETCH
+#define FLASH_CACHE_PREFETCH          2U                  /* lines read ahead on a sequential miss */
+#endif
+#define FLASH_CACHE_BYPASS            (FLASH_CACHE_LINE_SIZE * 4U)        /* reads from this size go to the flash */
+
+/* read cache statistics structure */
+typedef struct {
+    uint32_t hits;                      /* lines found in the cache */
+    uint32_t misses;                    /* lines read from the flash */
+    uint32_t prefetches;                /* lines read ahead of a sequential access */
+    uint32_t prefetch_hits;             /* lines read ahead which were used */
+    uint32_t bypasses;                  /* reads from FLASH_CACHE_BYPASS bytes, not cached */
+    uint32_t invalidations;             /* lines dropped by a program or an erase */
+} flash_cache_stats_struct;
+
+/* function declarations */
+/* read the flash through the cache */
+void flash_cache_read(uint8_t *pbuffer, uint32_t read_addr, uint32_t num_byte_to_read);
+/* drop the lines of a flash area, called by the driver when a program or an erase starts and ends */
+void flash_cache_invalidate(uint32_t addr, uint32_t length);
+/* drop all the lines */
+void flash_cache_invalidate_all(void);
+/* get the cache statistics */
+void flash_cache_stats_get(flash_cache_stats_struct *stats);
+/* clear the cache statistics */
+void flash_cache_stats_clear(void);
+
+#endif /* FLASH_CACHE_H */
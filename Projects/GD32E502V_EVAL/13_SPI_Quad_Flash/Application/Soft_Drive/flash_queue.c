@@ -0,0 +1,336 @@
+/*!
+    \file    flash_queue.c
+    \brief   asynchronous erase and program queue of the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <stddef.h>
+#include "flash_queue.h"
+
+/* operations are added by the application at queue_head and completed by flash_queue_poll()
+   at queue_tail, each index is written by one side only so no lock is needed */
+static flash_op_struct flash_queue[FLASH_QUEUE_SIZE];
+static __IO uint32_t queue_head = 0U;
+static __IO uint32_t queue_tail = 0U;
+/* the operation at queue_tail has been sent to the flash */
+static uint8_t op_issued = 0U;
+/* flash_queue_poll() is running, a poll from the tick does nothing while the idle loop polls */
+static __IO uint8_t queue_polling = 0U;
+
+static ErrStatus flash_queue_add(flash_op_enum type, uint32_t address, uint8_t *buffer, uint32_t length,
+                                 spi_flash_callback_func callback, void *context);
+static void flash_queue_issue(flash_op_struct *op);
+static uint32_t flash_stream_erase_end(const flash_stream_struct *stream, uint32_t address);
+
+/*!
+    \brief      initialize the queue, the queued operations are dropped
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_queue_init(void)
+{
+    queue_tail = queue_head;
+    op_issued = 0U;
+}
+
+/*!
+    \brief      queue the erase of a sector
+    \param[in]  sector_addr: address of the sector to erase
+    \param[in]  callback: function called when the sector is erased, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the queue is full
+*/
+ErrStatus flash_queue_sector_erase(uint32_t sector_addr, spi_flash_callback_func callback, void *context)
+{
+    return flash_queue_add(FLASH_OP_SECTOR_ERASE, sector_addr, NULL, 1U, callback, context);
+}
+
+/*!
+    \brief      queue the erase of the entire flash
+    \param[in]  callback: function called when the flash is erased, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the queue is full
+*/
+ErrStatus flash_queue_bulk_erase(spi_flash_callback_func callback, void *context)
+{
+    return flash_queue_add(FLASH_OP_BULK_ERASE, 0U, NULL, 1U, callback, context);
+}
+
+/*!
+    \brief      queue the erase of a range, the largest aligned erase command is sent at each step
+    \param[in]  addr: flash's internal address of the range
+    \param[in]  length: bytes of the range, extended to whole sectors
+    \param[in]  callback: function called when the range is erased, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the queue is full
+*/
+ErrStatus flash_queue_range_erase(uint32_t addr, uint32_t length, spi_flash_callback_func callback, void *context)
+{
+    uint32_t end = (addr + length + SPI_FLASH_SECTOR_SIZE - 1U) & ~(SPI_FLASH_SECTOR_SIZE - 1U);
+
+    if(0U == length) {
+        return ERROR;
+    }
+    addr &= ~(SPI_FLASH_SECTOR_SIZE - 1U);
+    return flash_queue_add(FLASH_OP_RANGE_ERASE, addr, NULL, end - addr, callback, context);
+}
+
+/*!
+    \brief      queue the programming of a buffer, the pages are programmed one per poll
+    \param[in]  pbuffer: data to program, it must stay valid until the callback
+    \param[in]  write_addr: flash's internal address to write
+    \param[in]  num_byte_to_write: number of bytes to write to the flash
+    \param[in]  callback: function called when the data is programmed, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the queue is full
+*/
+ErrStatus flash_queue_write(uint8_t *pbuffer, uint32_t write_addr, uint32_t num_byte_to_write,
+                            spi_flash_callback_func callback, void *context)
+{
+    if((NULL == pbuffer) || (0U == num_byte_to_write)) {
+        return ERROR;
+    }
+    return flash_queue_add(FLASH_OP_WRITE, write_addr, pbuffer, num_byte_to_write, callback, context);
+}
+
+/*!
+    \brief      start writing a flash area sequentially, nothing is sent to the flash yet
+    \param[in]  addr: flash's internal address of the area
+    \param[in]  length: bytes of the area
+    \param[out] stream: the writer
+    \retval     none
+*/
+void flash_stream_open(flash_stream_struct *stream, uint32_t addr, uint32_t length)
+{
+    stream->address = addr;
+    stream->end = addr + length;
+    stream->erased = addr & ~(SPI_FLASH_SECTOR_SIZE - 1U);
+}
+
+/*!
+    \brief      queue the next data of a stream: the erase of the area it needs if not queued
+                yet, the programming, and the erase of the area which follows. The flash erases
+                that area while the application prepares the next data instead of when it is
+                written.
+    \param[in]  stream: the writer
+    \param[in]  pbuffer: data to program, it must stay valid until the callback
+    \param[in]  length: bytes to program
+    \param[in]  callback: function called when the data is programmed, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] stream: the writer, advanced by length bytes
+    \retval     SUCCESS, or ERROR if the data goes past the area or the queue has no room for
+                three operations
+*/
+ErrStatus flash_stream_write(flash_stream_struct *stream, uint8_t *pbuffer, uint32_t length,
+                             spi_flash_callback_func callback, void *context)
+{
+    uint32_t data_end = stream->address + length;
+    uint32_t ahead_end;
+
+    if((NULL == pbuffer) || (0U == length) || (data_end > stream->end)
+            || ((FLASH_QUEUE_SIZE - (queue_head - queue_tail)) < 3U)) {
+        return ERROR;
+    }
+    /* the area of the data, erased only if the previous erase ahead did not cover it */
+    if(stream->erased < data_end) {
+        ahead_end = flash_stream_erase_end(stream, data_end);
+        flash_queue_add(FLASH_OP_RANGE_ERASE, stream->erased, NULL, ahead_end - stream->erased, NULL, NULL);
+        stream->erased = ahead_end;
+    }
+    flash_queue_add(FLASH_OP_WRITE, stream->address, pbuffer, length, callback, context);
+    stream->address = data_end;
+
+    /* the area of the next data */
+    if((stream->erased < stream->end) && (stream->erased < (data_end + FLASH_STREAM_AHEAD))) {
+        ahead_end = flash_stream_erase_end(stream, data_end + FLASH_STREAM_AHEAD);
+        flash_queue_add(FLASH_OP_RANGE_ERASE, stream->erased, NULL, ahead_end - stream->erased, NULL, NULL);
+        stream->erased = ahead_end;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      read the flash while operations are queued, an erase or a program in progress is
+                suspended for the read and resumed, so the read does not wait for its end. The
+                area being erased or programmed must not be read.
+    \param[in]  pbuffer: pointer to the buffer that receives the data read from the flash
+    \param[in]  read_addr: flash's internal address to read from
+    \param[in]  num_byte_to_read: number of bytes to read from the flash
+    \param[out] none
+    \retval     SUCCESS, or ERROR if called from an interrupt while the queue is polled
+*/
+ErrStatus flash_queue_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read)
+{
+    if((0U != queue_polling) || (SET == spi_flash_dma_busy())) {
+        return ERROR;
+    }
+    /* the read claims the flash so the tick does not poll the queue while it is suspended */
+    spi_flash_buffer_read(pbuffer, read_addr, num_byte_to_read);
+    return SUCCESS;
+}
+
+/*!
+    \brief      advance the queue, call from a timer tick or from the idle loop
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_queue_poll(void)
+{
+    flash_op_struct *op;
+
+    /* the bus is left to a DMA read, to the transfers of the other devices, to a locked access
+       and to a command sequence of the application, such as a write enable and its program */
+    if((0U != queue_polling) || (SET == spi_flash_dma_busy()) || (SET == spi_bus_busy())
+            || (SET == spi_flash_claimed())) {
+        return;
+    }
+    queue_polling = 1U;
+    while(queue_tail != queue_head) {
+        op = &flash_queue[queue_tail % FLASH_QUEUE_SIZE];
+        /* one status read per poll while the flash is busy, with the operation of the queue or
+           with a program or an erase of the application */
+        if(SET == spi_flash_write_busy()) {
+            break;
+        }
+        op_issued = 0U;
+        if(op->done < op->length) {
+            flash_queue_issue(op);
+            op_issued = 1U;
+            break;
+        }
+        /* the slot is released before the callback, which can queue the next operation */
+        queue_tail++;
+        if(NULL != op->callback) {
+            op->callback(op->context);
+        }
+    }
+    queue_polling = 0U;
+}
+
+/*!
+    \brief      get the number of operations not completed
+    \param[in]  none
+    \param[out] none
+    \retval     number of operations in the queue, the one in progress included
+*/
+uint32_t flash_queue_count(void)
+{
+    return queue_head - queue_tail;
+}
+
+/*!
+    \brief      add an operation to the queue
+    \param[in]  type: operation
+    \param[in]  address: address of the sector or of the first byte to program
+    \param[in]  buffer: data to program
+    \param[in]  length: bytes to program, 1 for an erase
+    \param[in]  callback: function called when the operation is completed, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the queue is full
+*/
+static ErrStatus flash_queue_add(flash_op_enum type, uint32_t address, uint8_t *buffer, uint32_t length,
+                                 spi_flash_callback_func callback, void *context)
+{
+    flash_op_struct *op;
+
+    if((queue_head - queue_tail) >= FLASH_QUEUE_SIZE) {
+        return ERROR;
+    }
+    op = &flash_queue[queue_head % FLASH_QUEUE_SIZE];
+    op->type = type;
+    op->address = address;
+    op->buffer = buffer;
+    op->length = length;
+    op->done = 0U;
+    op->callback = callback;
+    op->context = context;
+    /* the operation is visible to flash_queue_poll() once it is complete */
+    __DMB();
+    queue_head++;
+    return SUCCESS;
+}
+
+/*!
+    \brief      send the next step of an operation to the flash, without waiting for its end
+    \param[in]  op: pointer to the operation
+    \param[out] op: the operation with the step counted as done
+    \retval     none
+*/
+static void flash_queue_issue(flash_op_struct *op)
+{
+    uint32_t chunk;
+
+    switch(op->type) {
+    case FLASH_OP_SECTOR_ERASE:
+        spi_flash_sector_erase_start(op->address);
+        op->done = op->length;
+        break;
+    case FLASH_OP_BULK_ERASE:
+        spi_flash_bulk_erase_start();
+        op->done = op->length;
+        break;
+    case FLASH_OP_RANGE_ERASE:
+        op->done += spi_flash_range_erase_step(op->address + op->done, op->address + op->length);
+        break;
+    default:
+        /* a page program stops at the end of the page */
+        chunk = SPI_FLASH_PAGE_SIZE - ((op->address + op->done) % SPI_FLASH_PAGE_SIZE);
+        if(chunk > (op->length - op->done)) {
+            chunk = op->length - op->done;
+        }
+        spi_flash_page_write_start(&op->buffer[op->done], op->address + op->done, (uint16_t)chunk);
+        op->done += chunk;
+        break;
+    }
+}
+
+/*!
+    \brief      get the end of the erase which covers an address, it stops at a 64 KB boundary
+                so that the erase ahead is made of block erases
+    \param[in]  stream: the writer
+    \param[in]  address: address which must be erased
+    \param[out] none
+    \retval     the end of the erase, sector aligned and within the area of the stream
+*/
+static uint32_t flash_stream_erase_end(const flash_stream_struct *stream, uint32_t address)
+{
+    uint32_t end = (address + SPI_FLASH_BLOCK64_SIZE - 1U) & ~(SPI_FLASH_BLOCK64_SIZE - 1U);
+    uint32_t limit = (stream->end + SPI_FLASH_SECTOR_SIZE - 1U) & ~(SPI_FLASH_SECTOR_SIZE - 1U);
+
+    return (end < limit) ? end : limit;
+}
@@ -0,0 +1,94 @@
+/*!
+    \file    flash_queue.h
+    \brief   the header file of the asynchronous erase and program queue of the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef FLASH_QUEUE_H
+#define FLASH_QUEUE_H
+
+#include "gd32e502.h"
+#include "gd25qxx.h"
+
+#define FLASH_QUEUE_SIZE              8U                  /* operations waiting in the queue */
+#define FLASH_STREAM_AHEAD            SPI_FLASH_BLOCK64_SIZE  /* bytes a stream erases after the data written */
+
+/* flash operation enum */
+typedef enum {
+    FLASH_OP_SECTOR_ERASE = 0,          /* erase a 4 KB sector */
+    FLASH_OP_BULK_ERASE,                /* erase the entire flash */
+    FLASH_OP_RANGE_ERASE,               /* erase a range, one 4, 32 or 64 KB command per step */
+    FLASH_OP_WRITE                      /* program a buffer, page by page */
+} flash_op_enum;
+
+/* flash operation structure */
+typedef struct {
+    flash_op_enum type;                 /* operation */
+    uint32_t address;                   /* address of the sector or of the first byte to program */
+    uint8_t *buffer;                    /* data to program, it must stay valid until the callback */
+    uint32_t length;                    /* bytes to program or of the range to erase, 1 for another erase */
+    uint32_t done;                      /* bytes already sent to the flash */
+    spi_flash_callback_func callback;   /* called when the flash has completed the operation */
+    void *context;                      /* parameter of the callback */
+} flash_op_struct;
+
+/* sequential writer structure */
+typedef struct {
+    uint32_t address;                   /* address of the next byte to write */
+    uint32_t end;                       /* address after the last byte of the stream */
+    uint32_t erased;                    /* address up to which the erases are queued */
+} flash_stream_struct;
+
+/* function declarations */
+/* initialize the queue */
+void flash_queue_init(void);
+/* queue the erase of a sector */
+ErrStatus flash_queue_sector_erase(uint32_t sector_addr, spi_flash_callback_func callback, void *context);
+/* queue the erase of the entire flash */
+ErrStatus flash_queue_bulk_erase(spi_flash_callback_func callback, void *context);
+/* queue the erase of a range with the largest aligned erase commands */
+ErrStatus flash_queue_range_erase(uint32_t addr, uint32_t length, spi_flash_callback_func callback, void *context);
+/* queue the programming of a buffer */
+ErrStatus flash_queue_write(uint8_t *pbuffer, uint32_t write_addr, uint32_t num_byte_to_write,
+                            spi_flash_callback_func callback, void *context);
+/* start writing a flash area sequentially */
+void flash_stream_open(flash_stream_struct *stream, uint32_t addr, uint32_t length);
+/* queue the next data of a stream, the area after it is erased ahead */
+ErrStatus flash_stream_write(flash_stream_struct *stream, uint8_t *pbuffer, uint32_t length,
+                             spi_flash_callback_func callback, void *context);
+/* read the flash, suspending the erase or the program in progress */
+ErrStatus flash_queue_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read);
+/* advance the queue, call from a timer tick or from the idle loop */
+void flash_queue_poll(void);
+/* get the number of operations not completed */
+uint32_t flash_queue_count(void);
+
+#endif /* FLASH_QUEUE_H */
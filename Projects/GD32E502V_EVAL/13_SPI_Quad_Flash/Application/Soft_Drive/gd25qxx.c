@@ -35,74 +35,209 @@ OF SUCH DAMAGE.
 #include "gd25qxx.h"
 #include "gd32e502.h"
 #include <string.h>
+#if FLASH_CACHE_ENABLE
+#include "flash_cache.h"
+#else
+/* without the cache the programs and the erases have no lines to drop */
+#define flash_cache_invalidate(addr, length)
+#define flash_cache_invalidate_all()
+#endif /* FLASH_CACHE_ENABLE */
 
 #define WRITE            0x02     /* write to memory instruction */
 #define QUADWRITE        0x32     /* quad write to memory instruction */
 #define WRSR             0x01     /* write status register instruction */
+#define WRSR2            0x31     /* write status register 2 instruction */
+#define WRSR2_BIT7       0x3E     /* write status register 2 instruction of the parts with QE in bit 7 */
 #define WREN             0x06     /* write enable instruction */
 
 #define READ             0x03     /* read from memory instruction */
+#define FASTREAD         0x0B     /* fast read from memory instruction */
 #define QUADREAD         0x6B     /* read from memory instruction */
+#define QUADIOREAD       0xEB     /* quad I/O fast read instruction */
 #define RDSR             0x05     /* read status register instruction */
+#define RDSR2            0x35     /* read status register 2 instruction */
+#define PES              0x75     /* program/erase suspend instruction */
+#define PER              0x7A     /* program/erase resume instruction */
 #define RDID             0x9F     /* read identification */
+#define RDSFDP           0x5A     /* read SFDP instruction */
 #define SE               0x20     /* sector erase instruction */
+#define BE32             0x52     /* 32 KB block erase instruction */
+#define BE64             0xD8     /* 64 KB block erase instruction */
 #define BE               0xC7     /* bulk erase instruction */
 
 #define WTSR             0x05     /* write status register instruction */
 
 #define WIP_FLAG         0x01     /* write in progress(wip) flag */
+#define SUS_FLAG         0x80     /* suspend flag of the status register 2 */
 #define DUMMY_BYTE       0xA5
 
+#define CRM_ENTER        0x20     /* mode bits of a quad I/O read which keep the continuous read mode */
+#define CRM_EXIT         0xFF     /* mode bits of a quad I/O read which end the continuous read mode */
+
+#define SFDP_SIGNATURE   0x50444653U   /* "SFDP" read as a little-endian word */
+#define SFDP_DWORDS      16U           /* words of the basic parameter table used by the driver */
+
+#define countof(a)       (sizeof(a) / sizeof(*(a)))
+
+/* parameters of the known parts, used when the flash has no usable SFDP table */
+static const spi_flash_param_struct flash_param_table[] = {
+    /* GD25Q16 */
+    {0xC84015U, 0x200000U, 256U, {{0x10000U, 250U, BE64}, {0x8000U, 150U, BE32}, {0x1000U, 50U, SE}, {0U, 0U, 0U}},
+     8000U, QUADREAD, 8U, 1U, QUADIOREAD, 2U, 4U, SPI_FLASH_QE_SR2_BIT1, SPI_FLASH_PARAM_TABLE},
+    /* GD25Q32 */
+    {0xC84016U, 0x400000U, 256U, {{0x10000U, 250U, BE64}, {0x8000U, 150U, BE32}, {0x1000U, 50U, SE}, {0U, 0U, 0U}},
+     10000U, QUADREAD, 8U, 1U, QUADIOREAD, 2U, 4U, SPI_FLASH_QE_SR2_BIT1, SPI_FLASH_PARAM_TABLE},
+    /* GD25Q64 */
+    {0xC84017U, 0x800000U, 256U, {{0x10000U, 250U, BE64}, {0x8000U, 150U, BE32}, {0x1000U, 50U, SE}, {0U, 0U, 0U}},
+     20000U, QUADREAD, 8U, 1U, QUADIOREAD, 2U, 4U, SPI_FLASH_QE_SR2_BIT1, SPI_FLASH_PARAM_TABLE},
+    /* W25Q16 */
+    {0xEF4015U, 0x200000U, 256U, {{0x10000U, 150U, BE64}, {0x8000U, 120U, BE32}, {0x1000U, 45U, SE}, {0U, 0U, 0U}},
+     5000U, QUADREAD, 8U, 1U, QUADIOREAD, 2U, 4U, SPI_FLASH_QE_SR2_BIT1, SPI_FLASH_PARAM_TABLE},
+    /* W25Q32 */
+    {0xEF4016U, 0x400000U, 256U, {{0x10000U, 150U, BE64}, {0x8000U, 120U, BE32}, {0x1000U, 45U, SE}, {0U, 0U, 0U}},
+     10000U, QUADREAD, 8U, 1U, QUADIOREAD, 2U, 4U, SPI_FLASH_QE_SR2_BIT1, SPI_FLASH_PARAM_TABLE}
+};
+/* parameters of the flash in use, set by spi_flash_param_detect() */
+static spi_flash_param_struct flash_param;
+
+/* the flash on the SPI bus */
+spi_bus_device_struct spi_flash_device;
+/* asynchronous read in progress and its completion */
+static __IO uint8_t dma_busy = 0U;
+static uint8_t dma_quad = 0U;
+static spi_flash_callback_func dma_callback = NULL;
+static void *dma_context = NULL;
+
+/* the quad I/O reads keep the flash in continuous read mode, the flash is waiting for an address */
+static uint8_t crm_enabled = 0U;
+static uint8_t crm_active = 0U;
+
+/* command sequences in progress, a queue poll from an interrupt leaves the flash to them */
+static __IO uint32_t flash_claims = 0U;
+/* a program or an erase was started without waiting for its end, the reads suspend it, and
+   the area it changes, whose cache lines are dropped again when it ends */
+static __IO uint8_t write_pending = 0U;
+static uint32_t pending_addr = 0U;
+static uint32_t pending_length = 0U;
+#ifndef GD25QXX_SIM
+/* cycle counter at the last resume of a read, a suspend right after it would starve the operation */
+static uint32_t resume_cycles = 0U;
+static uint8_t resumed = 0U;
+#endif /* GD25QXX_SIM */
+
+static void spi_flash_dma_start(uint8_t *pbuffer, uint16_t num_byte_to_read);
+static void spi_flash_dma_done(void *context);
+static void qspi_flash_continuous_read_exit(void);
+static void qspi_flash_read_command(uint32_t read_addr);
+static void qspi_flash_io_mode_send(uint8_t mode);
+static ErrStatus spi_flash_sfdp_parse(spi_flash_param_struct *param);
+static uint32_t spi_flash_sfdp_dword(const uint8_t *table, uint32_t index);
+static uint16_t spi_flash_erase_time(const spi_flash_param_struct *param, uint32_t size);
+
 /*!
-    \brief      initialize SPI GPIO and parameter
+    \brief      initialize the quad GPIO and register the flash on the SPI bus, spi_bus_init()
+                configures SPI0 before
     \param[in]  none
     \param[out] none
-    \retval     none
+    \retval     SUCCESS, or ERROR if the flash is neither described by SFDP nor a known part
 */
-void spi_flash_init(void)
+ErrStatus spi_flash_init(void)
 {
-    spi_parameter_struct spi_init_struct;
-
     rcu_periph_clock_enable(RCU_GPIOA);
     rcu_periph_clock_enable(RCU_GPIOE);
     rcu_periph_clock_enable(RCU_GPIOB);
-    rcu_periph_clock_enable(RCU_SPI0);
-
-    /* SPI_CLK(PE14), SPI_MISO_IO1(PE13), SPI_MOSI_IO0(PA2), SPI_IO2(PE15) and SPI_IO3(PB10) GPIO pin configuration */
-    gpio_af_set(GPIOA, GPIO_AF_4, GPIO_PIN_2);
-    gpio_mode_set(GPIOA, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_2);
-    gpio_output_options_set(GPIOA, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_2);
 
+    /* SPI_IO2(PE15) and SPI_IO3(PB10) GPIO pin configuration, the bus configures the other pins */
     gpio_af_set(GPIOB, GPIO_AF_4, GPIO_PIN_10);
     gpio_mode_set(GPIOB, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_10);
     gpio_output_options_set(GPIOB, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_10);
 
-    gpio_af_set(GPIOE, GPIO_AF_4, GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15);
-    gpio_mode_set(GPIOE, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15);
-    gpio_output_options_set(GPIOE, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15);
-
-    /* SPI_CS(PA1) GPIO pin configuration */
-    gpio_mode_set(GPIOA, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, GPIO_PIN_1);
-    gpio_output_options_set(GPIOA, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_1);
-
-    /* chip select invalid */
-    SPI_FLASH_CS_HIGH();
+    gpio_af_set(GPIOE, GPIO_AF_4, GPIO_PIN_15);
+    gpio_mode_set(GPIOE, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_15);
+    gpio_output_options_set(GPIOE, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_15);
 
-    /* SPI parameter configuration */
-    spi_init_struct.trans_mode           = SPI_TRANSMODE_FULLDUPLEX;
-    spi_init_struct.device_mode          = SPI_MASTER;
-    spi_init_struct.frame_size           = SPI_FRAMESIZE_8BIT;
-    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
-    spi_init_struct.nss                  = SPI_NSS_SOFT;
-    spi_init_struct.prescale             = SPI_PSC_32;
-    spi_init_struct.endian               = SPI_ENDIAN_MSB;
-    spi_init(SPI0, &spi_init_struct);
+    /* SPI_CS(PA1), 3.125 MHz, mode 0, the flash has the lowest priority of the bus */
+    spi_bus_device_init(&spi_flash_device, GPIOA, GPIO_PIN_1, SPI_PSC_32, SPI_CK_PL_LOW_PH_1EDGE, 0U);
 
     /* enable quad wire SPI_IO2 and SPI_IO3 pin output */
     spi_quad_io23_output_enable(SPI0);
 
-    /* enable SPI */
-    spi_enable(SPI0);
+    /* the commands, sizes and times of the flash */
+    return spi_flash_param_detect();
+}
+
+/*!
+    \brief      read the flash parameters: the entry of the table of known parts matching the
+                identification, then what the SFDP basic parameter table of the flash describes
+    \param[in]  none
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the flash is unknown and keeps the GD25Q16 parameters
+*/
+ErrStatus spi_flash_param_detect(void)
+{
+    spi_flash_param_struct param;
+    uint32_t id, index;
+
+    /* the commands sent before the detection need a 4 KB erase in the list */
+    flash_param = flash_param_table[0];
+    id = spi_flash_read_id();
+
+    param = flash_param_table[0];
+    param.source = SPI_FLASH_PARAM_DEFAULT;
+    for(index = 0U; index < countof(flash_param_table); index++) {
+        if(id == flash_param_table[index].id) {
+            param = flash_param_table[index];
+            break;
+        }
+    }
+    param.id = id;
+    /* the SFDP table overrides the fields it describes */
+    spi_flash_sfdp_parse(&param);
+    flash_param = param;
+
+    return (SPI_FLASH_PARAM_DEFAULT != flash_param.source) ? SUCCESS : ERROR;
+}
+
+/*!
+    \brief      get the parameters of the flash
+    \param[in]  none
+    \param[out] none
+    \retval     parameters set by spi_flash_param_detect()
+*/
+const spi_flash_param_struct *spi_flash_param_get(void)
+{
+    return &flash_param;
+}
+
+/*!
+    \brief      read the SFDP table of the flash
+    \param[in]  pbuffer: pointer to the buffer that receives the data read from the SFDP area
+    \param[in]  read_addr: address in the SFDP area to read from
+    \param[in]  num_byte_to_read: number of bytes to read
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_sfdp_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read)
+{
+    qspi_flash_continuous_read_exit();
+
+    /* select the flash: chip select low */
+    SPI_FLASH_CS_LOW();
+    /* send "read SFDP" instruction, the 24-bit address and 8 dummy clocks */
+    spi_flash_send_byte(RDSFDP);
+    spi_flash_send_byte((read_addr & 0xFF0000) >> 16);
+    spi_flash_send_byte((read_addr & 0xFF00) >> 8);
+    spi_flash_send_byte(read_addr & 0xFF);
+    spi_flash_send_byte(DUMMY_BYTE);
+
+    /* while there is data to be read */
+    while(num_byte_to_read--) {
+        *pbuffer = spi_flash_send_byte(DUMMY_BYTE);
+        pbuffer++;
+    }
+
+    /* select the flash: chip select high */
+    SPI_FLASH_CS_HIGH();
 }
 
 /*!
@@ -113,25 +248,86 @@ void spi_flash_init(void)
 */
 void spi_flash_sector_erase(uint32_t sector_addr)
 {
+    spi_flash_sector_erase_start(sector_addr);
+
+    /* wait the end of flash writing */
+    spi_flash_wait_for_write_end();
+}
+
+/*!
+    \brief      start erasing the specified flash sector without waiting for the end
+    \param[in]  sector_addr: address of the sector to erase
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_sector_erase_start(uint32_t sector_addr)
+{
+    sector_addr &= ~(SPI_FLASH_SECTOR_SIZE - 1U);
+
+    /* the 4 KB erase of the flash */
+    spi_flash_range_erase_step(sector_addr, sector_addr + SPI_FLASH_SECTOR_SIZE);
+}
+
+/*!
+    \brief      start the largest erase which is aligned at an address and ends within a range,
+                without waiting for the end
+    \param[in]  addr: address of the first sector to erase, sector aligned
+    \param[in]  end: address after the last sector to erase, sector aligned
+    \param[out] none
+    \retval     bytes erased by the command, 4 KB or the size of a larger erase of the flash
+*/
+uint32_t spi_flash_range_erase_step(uint32_t addr, uint32_t end)
+{
+    const spi_flash_erase_struct *erase = flash_param.erase;
+
+    /* the erases go by decreasing size down to the 4 KB one */
+    while((SPI_FLASH_SECTOR_SIZE != erase->size) &&
+            ((0U != (addr % erase->size)) || ((end - addr) < erase->size))) {
+        erase++;
+    }
+    spi_flash_claim();
+    flash_cache_invalidate(addr, erase->size);
+
     /* send write enable instruction */
     spi_flash_write_enable();
 
-    /* sector erase */
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
-    /* send sector erase instruction */
-    spi_flash_send_byte(SE);
-    /* send sector_addr high nibble address byte */
-    spi_flash_send_byte((sector_addr & 0xFF0000) >> 16);
-    /* send sector_addr medium nibble address byte */
-    spi_flash_send_byte((sector_addr & 0xFF00) >> 8);
-    /* send sector_addr low nibble address byte */
-    spi_flash_send_byte(sector_addr & 0xFF);
+    /* send the erase instruction and the 24-bit address */
+    spi_flash_send_byte(erase->instruction);
+    spi_flash_send_byte((addr & 0xFF0000) >> 16);
+    spi_flash_send_byte((addr & 0xFF00) >> 8);
+    spi_flash_send_byte(addr & 0xFF);
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
+    pending_addr = addr;
+    pending_length = erase->size;
+    write_pending = 1U;
+    spi_flash_release();
 
-    /* wait the end of flash writing */
-    spi_flash_wait_for_write_end();
+    return erase->size;
+}
+
+/*!
+    \brief      erase the sectors of a range with the largest aligned erase commands
+    \param[in]  addr: flash's internal address of the range
+    \param[in]  length: bytes of the range, extended to whole sectors
+    \param[out] none
+    \retval     number of erase commands
+*/
+uint32_t spi_flash_range_erase(uint32_t addr, uint32_t length)
+{
+    uint32_t end = (addr + length + SPI_FLASH_SECTOR_SIZE - 1U) & ~(SPI_FLASH_SECTOR_SIZE - 1U);
+    uint32_t commands = 0U;
+
+    addr &= ~(SPI_FLASH_SECTOR_SIZE - 1U);
+    while(addr < end) {
+        addr += spi_flash_range_erase_step(addr, end);
+        commands++;
+        /* wait the end of flash writing */
+        spi_flash_wait_for_write_end();
+    }
+    return commands;
 }
 
 /*!
@@ -142,6 +338,23 @@ void spi_flash_sector_erase(uint32_t sector_addr)
 */
 void spi_flash_bulk_erase(void)
 {
+    spi_flash_bulk_erase_start();
+
+    /* wait the end of flash writing */
+    spi_flash_wait_for_write_end();
+}
+
+/*!
+    \brief      start erasing the entire flash without waiting for the end
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_bulk_erase_start(void)
+{
+    spi_flash_claim();
+    flash_cache_invalidate_all();
+
     /* send write enable instruction */
     spi_flash_write_enable();
 
@@ -152,9 +365,10 @@ void spi_flash_bulk_erase(void)
     spi_flash_send_byte(BE);
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
-
-    /* wait the end of flash writing */
-    spi_flash_wait_for_write_end();
+    pending_addr = 0U;
+    pending_length = flash_param.capacity;
+    write_pending = 1U;
+    spi_flash_release();
 }
 
 /*!
@@ -167,8 +381,29 @@ void spi_flash_bulk_erase(void)
 */
 void spi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write)
 {
-    /* enable the write access to the flash */
+    spi_flash_page_write_start(pbuffer, write_addr, num_byte_to_write);
+
+    /* wait the end of flash writing */
+    spi_flash_wait_for_write_end();
+}
+
+/*!
+    \brief      send the data of a page program without waiting for the end of the programming
+    \param[in]  pbuffer: pointer to the buffer
+    \param[in]  write_addr: flash's internal address to write
+    \param[in]  num_byte_to_write: number of bytes to write to the flash, within one page
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_page_write_start(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write)
+{
+    spi_flash_claim();
+    flash_cache_invalidate(write_addr, num_byte_to_write);
+
+    /* enable the write access to the flash, once the previous write has ended */
     spi_flash_write_enable();
+    pending_addr = write_addr;
+    pending_length = num_byte_to_write;
 
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
@@ -192,9 +427,8 @@ void spi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_by
 
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
-
-    /* wait the end of flash writing */
-    spi_flash_wait_for_write_end();
+    write_pending = 1U;
+    spi_flash_release();
 }
 
 /*!
@@ -265,7 +499,8 @@ void spi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_
 }
 
 /*!
-    \brief      read a block of data from the flash
+    \brief      read a block of data from the flash, a program or an erase in progress is
+                suspended for the read
     \param[in]  pbuffer: pointer to the buffer that receives the data read from the flash
     \param[in]  read_addr: flash's internal address to read from
     \param[in]  num_byte_to_read: number of bytes to read from the flash
@@ -274,6 +509,12 @@ void spi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_
 */
 void spi_flash_buffer_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read)
 {
+    ErrStatus suspended;
+
+    spi_flash_claim();
+    suspended = spi_flash_read_suspend();
+    qspi_flash_continuous_read_exit();
+
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
 
@@ -297,6 +538,8 @@ void spi_flash_buffer_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_by
 
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
+    spi_flash_read_resume(suspended);
+    spi_flash_release();
 }
 
 /*!
@@ -309,6 +552,8 @@ uint32_t spi_flash_read_id(void)
 {
     uint32_t temp = 0, temp0 = 0, temp1 = 0, temp2 = 0;
 
+    qspi_flash_continuous_read_exit();
+
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
 
@@ -333,13 +578,16 @@ uint32_t spi_flash_read_id(void)
 }
 
 /*!
-    \brief      start a read data byte (read) sequence from the flash
+    \brief      start a read data byte (read) sequence from the flash, while a program or an
+                erase is in progress the caller suspends it with spi_flash_read_suspend()
     \param[in]  read_addr: flash's internal address to read from
     \param[out] none
     \retval     none
 */
 void spi_flash_start_read_sequence(uint32_t read_addr)
 {
+    qspi_flash_continuous_read_exit();
+
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
 
@@ -374,6 +622,10 @@ uint8_t spi_flash_read_byte(void)
 */
 uint8_t spi_flash_send_byte(uint8_t byte)
 {
+#ifdef GD25QXX_SIM
+    /* the port of the simulated flash gives it the clock and the mode of the bus */
+    return gd25qxx_sim_transfer(byte);
+#else
     /* loop while data register in not emplty */
     while(RESET == spi_i2s_flag_get(SPI0, SPI_FLAG_TBE));
 
@@ -385,6 +637,7 @@ uint8_t spi_flash_send_byte(uint8_t byte)
 
     /* return the byte read from the SPI bus */
     return(spi_i2s_data_receive(SPI0));
+#endif /* GD25QXX_SIM */
 }
 
 /*!
@@ -416,6 +669,9 @@ uint16_t spi_flash_send_halfword(uint16_t half_word)
 */
 void spi_flash_write_enable(void)
 {
+    /* the flash ignores the write enable while a program or an erase is in progress */
+    spi_flash_wait_for_write_end();
+
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
 
@@ -433,24 +689,178 @@ void spi_flash_write_enable(void)
     \retval     none
 */
 void spi_flash_wait_for_write_end(void)
+{
+    /* one status read per poll, the other devices use the bus between the polls */
+    while(SET == spi_flash_write_busy()) {
+    }
+}
+
+/*!
+    \brief      read the write in progress(wip) flag once
+    \param[in]  none
+    \param[out] none
+    \retval     SET if the flash is busy with a write or erase cycle, RESET otherwise
+*/
+FlagStatus spi_flash_write_busy(void)
 {
     uint8_t flash_status = 0;
 
+    qspi_flash_continuous_read_exit();
+
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
 
     /* send "read status register" instruction */
     spi_flash_send_byte(RDSR);
+    flash_status = spi_flash_send_byte(DUMMY_BYTE);
+
+    /* select the flash: chip select high */
+    SPI_FLASH_CS_HIGH();
+
+    if(0U == (flash_status & WIP_FLAG)) {
+        /* also cleared while an operation is suspended, spi_flash_resume() sets it again */
+        if(0U != write_pending) {
+            write_pending = 0U;
+            /* a read during the operation may have cached the area */
+            flash_cache_invalidate(pending_addr, pending_length);
+        }
+        return RESET;
+    }
+    return SET;
+}
+
+/*!
+    \brief      keep the queue poll of an interrupt away from the flash until spi_flash_release(),
+                around the commands which must follow each other such as a write enable and its
+                program, the claims nest
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_claim(void)
+{
+    flash_claims++;
+}
+
+/*!
+    \brief      end a claim of spi_flash_claim()
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_release(void)
+{
+    flash_claims--;
+}
+
+/*!
+    \brief      check whether a command sequence is in progress
+    \param[in]  none
+    \param[out] none
+    \retval     SET between spi_flash_claim() and spi_flash_release(), RESET otherwise
+*/
+FlagStatus spi_flash_claimed(void)
+{
+    return (0U != flash_claims) ? SET : RESET;
+}
+
+/*!
+    \brief      suspend the erase or the program in progress so that the flash can be read,
+                the sector or the page being changed must not be read
+    \param[in]  none
+    \param[out] none
+    \retval     SUCCESS if an operation is suspended, ERROR if there was none to suspend
+*/
+ErrStatus spi_flash_suspend(void)
+{
+    uint8_t flash_status;
+
+    if(RESET == spi_flash_write_busy()) {
+        return ERROR;
+    }
+    /* select the flash: chip select low */
+    SPI_FLASH_CS_LOW();
+    /* send "program/erase suspend" instruction */
+    spi_flash_send_byte(PES);
+    /* select the flash: chip select high */
+    SPI_FLASH_CS_HIGH();
+
+    /* the flash stops within tSUS and clears WIP */
+    spi_flash_wait_for_write_end();
+
+    /* the operation may have completed before the instruction */
+    SPI_FLASH_CS_LOW();
+    spi_flash_send_byte(RDSR2);
+    flash_status = spi_flash_send_byte(DUMMY_BYTE);
+    SPI_FLASH_CS_HIGH();
 
-    /* loop as long as the memory is busy with a write cycle */
-    do {
-        /* send a dummy byte to generate the clock needed by the flash
-        and put the value of the status register in flash_status variable */
-        flash_status = spi_flash_send_byte(DUMMY_BYTE);
-    } while(SET == (flash_status & WIP_FLAG));
+    return (0U != (flash_status & SUS_FLAG)) ? SUCCESS : ERROR;
+}
 
+/*!
+    \brief      resume the erase or the program suspended by spi_flash_suspend()
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_resume(void)
+{
+    qspi_flash_continuous_read_exit();
+
+    /* select the flash: chip select low */
+    SPI_FLASH_CS_LOW();
+    /* send "program/erase resume" instruction */
+    spi_flash_send_byte(PER);
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
+    write_pending = 1U;
+}
+
+/*!
+    \brief      suspend the program or the erase started without waiting for its end before a
+                read, a suspend waits SPI_FLASH_RESUME_US after the previous resume so that the
+                operation progresses between frequent reads. The area being erased or programmed
+                must not be read.
+    \param[in]  none
+    \param[out] none
+    \retval     SUCCESS if an operation is suspended, ERROR if none is in progress
+*/
+ErrStatus spi_flash_read_suspend(void)
+{
+#ifndef GD25QXX_SIM
+    uint32_t spacing = SPI_FLASH_RESUME_US * (SystemCoreClock / 1000000U);
+#endif /* GD25QXX_SIM */
+
+    if(0U == write_pending) {
+        return ERROR;
+    }
+#ifndef GD25QXX_SIM
+    while((0U != resumed) && ((DWT->CYCCNT - resume_cycles) < spacing)) {
+    }
+    resumed = 0U;
+#endif /* GD25QXX_SIM */
+    return spi_flash_suspend();
+}
+
+/*!
+    \brief      resume the operation suspended by spi_flash_read_suspend() after the read
+    \param[in]  suspended: value returned by spi_flash_read_suspend()
+    \param[out] none
+    \retval     none
+*/
+void spi_flash_read_resume(ErrStatus suspended)
+{
+    if(SUCCESS != suspended) {
+        return;
+    }
+    spi_flash_resume();
+#ifndef GD25QXX_SIM
+    /* the cycle counter times the resumes */
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    resume_cycles = DWT->CYCCNT;
+    resumed = 1U;
+#endif /* GD25QXX_SIM */
 }
 
 /*!
@@ -461,19 +871,42 @@ void spi_flash_wait_for_write_end(void)
 */
 void qspi_flash_quad_enable(void)
 {
+    if(SPI_FLASH_QE_NONE == flash_param.quad_enable) {
+        return;
+    }
+    spi_flash_claim();
     /* enable the write access to the flash */
     spi_flash_write_enable();
     /* select the flash: chip select low */
     SPI_FLASH_CS_LOW();
-    /* send "write status register" instruction */
-    spi_flash_send_byte(WRSR);
-
-    spi_flash_send_byte(0x00);
-    spi_flash_send_byte(0x02);
+    switch(flash_param.quad_enable) {
+    case SPI_FLASH_QE_SR1_BIT6:
+        /* send "write status register" instruction with status register 1 only */
+        spi_flash_send_byte(WRSR);
+        spi_flash_send_byte(0x40);
+        break;
+    case SPI_FLASH_QE_SR2_BIT7:
+        spi_flash_send_byte(WRSR2_BIT7);
+        spi_flash_send_byte(0x80);
+        break;
+    case SPI_FLASH_QE_SR2_BIT1_WRSR2:
+        /* send "write status register 2" instruction */
+        spi_flash_send_byte(WRSR2);
+        spi_flash_send_byte(0x02);
+        break;
+    default:
+        /* send "write status register" instruction */
+        spi_flash_send_byte(WRSR);
+
+        spi_flash_send_byte(0x00);
+        spi_flash_send_byte(0x02);
+        break;
+    }
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
     /* wait the end of flash writing */
     spi_flash_wait_for_write_end();
+    spi_flash_release();
 }
 
 /*!
@@ -543,7 +976,8 @@ void qspi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num
 }
 
 /*!
-    \brief      read a block of data from the flash using qspi
+    \brief      read a block of data from the flash using qspi, a program or an erase in
+                progress is suspended for the read
     \param[in]  pbuffer : pointer to the buffer that receives the data read from the flash
     \param[in]  read_addr : flash's internal address to read from
     \param[in]  num_byte_to_read : number of bytes to read from the flash
@@ -552,23 +986,14 @@ void qspi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num
 */
 void qspi_flash_buffer_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read)
 {
-    /* select the flash: chip select low */
-    SPI_FLASH_CS_LOW();
-    /* send "quad fast read from memory " instruction */
-    spi_flash_send_byte(QUADREAD);
+    ErrStatus suspended;
 
-    /* send read_addr high nibble address byte to read from */
-    spi_flash_send_byte((read_addr & 0xFF0000) >> 16);
-    /* send read_addr medium nibble address byte to read from */
-    spi_flash_send_byte((read_addr & 0xFF00) >> 8);
-    /* send read_addr low nibble address byte to read from */
-    spi_flash_send_byte(read_addr & 0xFF);
-    spi_flash_send_byte(0xA5);
+    spi_flash_claim();
+    suspended = spi_flash_read_suspend();
+    qspi_flash_continuous_read_exit();
 
-    /* enable the qspi */
-    spi_quad_enable(SPI0);
-    /* enable the qspi read operation */
-    spi_quad_read_enable(SPI0);
+    /* send the fastest read instruction of the flash, the address and the dummy clocks */
+    qspi_flash_read_command(read_addr);
 
     /* while there is data to be read */
     while(num_byte_to_read--) {
@@ -577,12 +1002,12 @@ void qspi_flash_buffer_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_b
         /* point to the next location where the byte read will be saved */
         pbuffer++;
     }
+    /* disable the qspi before the bus is released to the next transfer */
+    spi_quad_disable(SPI0);
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
-    /* disable the qspi */
-    spi_quad_disable(SPI0);
-    /* wait the end of flash writing */
-    spi_flash_wait_for_write_end();
+    spi_flash_read_resume(suspended);
+    spi_flash_release();
 }
 
 /*!
@@ -595,6 +1020,9 @@ void qspi_flash_buffer_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_b
 */
 void qspi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write)
 {
+    spi_flash_claim();
+    flash_cache_invalidate(write_addr, num_byte_to_write);
+
     /* enable the flash quad mode */
     qspi_flash_quad_enable();
     /* enable the write access to the flash */
@@ -623,10 +1051,505 @@ void qspi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_b
         pbuffer++;
     }
 
+    /* disable the qspi function before the bus is released to the next transfer */
+    spi_quad_disable(SPI0);
     /* select the flash: chip select high */
     SPI_FLASH_CS_HIGH();
-    /* disable the qspi function */
-    spi_quad_disable(SPI0);
     /* wait the end of flash writing */
     spi_flash_wait_for_write_end();
+    spi_flash_release();
+}
+
+/*!
+    \brief      let the quad I/O reads keep the flash in continuous read mode, the next reads
+                skip the instruction byte
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void qspi_flash_continuous_read_enable(void)
+{
+    /* the continuous read mode is entered with the mode bits of the quad I/O read */
+    if((0U == flash_param.io_read_instruction) || (2U != flash_param.io_read_mode_clocks)) {
+        return;
+    }
+    /* the quad I/O read needs the quad enable bit */
+    qspi_flash_quad_enable();
+    crm_enabled = 1U;
+}
+
+/*!
+    \brief      leave the continuous read mode, the quad I/O reads send the instruction again
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void qspi_flash_continuous_read_disable(void)
+{
+    crm_enabled = 0U;
+    qspi_flash_continuous_read_exit();
+}
+
+/*!
+    \brief      read a block of data from the flash with the quad I/O fast read, the address is
+                sent on the four lines and the instruction only when the flash is not in
+                continuous read mode, a program or an erase in progress is suspended for the read
+    \param[in]  pbuffer: pointer to the buffer that receives the data read from the flash
+    \param[in]  read_addr: flash's internal address to read from
+    \param[in]  num_byte_to_read: number of bytes to read from the flash
+    \param[out] none
+    \retval     none
+*/
+void qspi_flash_io_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read)
+{
+    ErrStatus suspended;
+
+    if(0U == flash_param.io_read_instruction) {
+        /* the flash has no quad I/O read */
+        qspi_flash_buffer_read(pbuffer, read_addr, num_byte_to_read);
+        return;
+    }
+    spi_flash_claim();
+    suspended = spi_flash_read_suspend();
+    /* select the flash: chip select low */
+    SPI_FLASH_CS_LOW();
+    if(0U == crm_active) {
+        /* send "quad I/O fast read" instruction */
+        spi_flash_send_byte(flash_param.io_read_instruction);
+    }
+
+    /* send the 24-bit address and the mode bits on the four lines */
+    spi_quad_enable(SPI0);
+    spi_quad_write_enable(SPI0);
+    spi_flash_send_byte((read_addr & 0xFF0000) >> 16);
+    spi_flash_send_byte((read_addr & 0xFF00) >> 8);
+    spi_flash_send_byte(read_addr & 0xFF);
+    qspi_flash_io_mode_send((0U != crm_enabled) ? CRM_ENTER : CRM_EXIT);
+
+    /* while there is data to be read */
+    while(num_byte_to_read--) {
+        /* read a byte from the flash */
+        *pbuffer = spi_flash_send_byte(DUMMY_BYTE);
+        /* point to the next location where the byte read will be saved */
+        pbuffer++;
+    }
+    /* disable the qspi before the bus is released to the next transfer */
+    spi_quad_disable(SPI0);
+    /* select the flash: chip select high */
+    SPI_FLASH_CS_HIGH();
+    crm_active = crm_enabled;
+    spi_flash_read_resume(suspended);
+    spi_flash_release();
+}
+
+/*!
+    \brief      start reading a block of data from the flash with DMA, the function returns
+                while the data is read
+    \param[in]  pbuffer: pointer to the buffer that receives the data read from the flash
+    \param[in]  read_addr: flash's internal address to read from
+    \param[in]  num_byte_to_read: number of bytes to read from the flash
+    \param[in]  callback: function called from the interrupt when the data is read, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if a read is already in progress
+*/
+ErrStatus spi_flash_buffer_read_dma(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read,
+                                    spi_flash_callback_func callback, void *context)
+{
+    if((0U != dma_busy) || (0U == num_byte_to_read)) {
+        return ERROR;
+    }
+    qspi_flash_continuous_read_exit();
+    dma_busy = 1U;
+    dma_quad = 0U;
+    dma_callback = callback;
+    dma_context = context;
+
+    /* select the flash: chip select low */
+    SPI_FLASH_CS_LOW();
+    /* send "read from memory " instruction */
+    spi_flash_send_byte(READ);
+    /* send the 24-bit address to read from */
+    spi_flash_send_byte((read_addr & 0xFF0000) >> 16);
+    spi_flash_send_byte((read_addr & 0xFF00) >> 8);
+    spi_flash_send_byte(read_addr & 0xFF);
+
+    spi_flash_dma_start(pbuffer, num_byte_to_read);
+    return SUCCESS;
+}
+
+/*!
+    \brief      start reading a block of data from the flash using qspi with DMA, the function
+                returns while the data is read
+    \param[in]  pbuffer: pointer to the buffer that receives the data read from the flash
+    \param[in]  read_addr: flash's internal address to read from
+    \param[in]  num_byte_to_read: number of bytes to read from the flash
+    \param[in]  callback: function called from the interrupt when the data is read, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if a read is already in progress
+*/
+ErrStatus qspi_flash_buffer_read_dma(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read,
+                                     spi_flash_callback_func callback, void *context)
+{
+    if((0U != dma_busy) || (0U == num_byte_to_read)) {
+        return ERROR;
+    }
+    qspi_flash_continuous_read_exit();
+    dma_busy = 1U;
+    dma_quad = flash_param.read_quad;
+    dma_callback = callback;
+    dma_context = context;
+
+    /* send the fastest read instruction of the flash, the address and the dummy clocks */
+    qspi_flash_read_command(read_addr);
+
+    spi_flash_dma_start(pbuffer, num_byte_to_read);
+    return SUCCESS;
+}
+
+/*!
+    \brief      check whether an asynchronous read is in progress
+    \param[in]  none
+    \param[out] none
+    \retval     SET while the data is read, RESET otherwise
+*/
+FlagStatus spi_flash_dma_busy(void)
+{
+    return (0U != dma_busy) ? SET : RESET;
+}
+
+/*!
+    \brief      end an asynchronous read, called from the DMA RX channel interrupt
+    \param[in]  context: not used
+    \param[out] none
+    \retval     none
+*/
+static void spi_flash_dma_done(void *context)
+{
+    (void)context;
+
+    if(0U != dma_quad) {
+        /* disable the qspi, releasing the bus starts the next queued transfer */
+        spi_quad_disable(SPI0);
+    }
+    /* select the flash: chip select high */
+    SPI_FLASH_CS_HIGH();
+    dma_busy = 0U;
+    if(NULL != dma_callback) {
+        dma_callback(dma_context);
+    }
+}
+
+/*!
+    \brief      start the DMA channels once the command has been sent
+    \param[in]  pbuffer: pointer to the buffer that receives the data read from the flash
+    \param[in]  num_byte_to_read: number of bytes to read from the flash
+    \param[out] none
+    \retval     none
+*/
+static void spi_flash_dma_start(uint8_t *pbuffer, uint16_t num_byte_to_read)
+{
+#ifdef GD25QXX_SIM
+    /* the simulated flash has no SPI data for the DMA, the read completes at once */
+    while(num_byte_to_read--) {
+        *pbuffer = gd25qxx_sim_transfer(DUMMY_BYTE);
+        pbuffer++;
+    }
+    spi_flash_dma_done(NULL);
+#else
+    /* the bus is locked by the chip select, its DMA channels clock the data in */
+    spi_bus_dma_read(pbuffer, num_byte_to_read, spi_flash_dma_done, NULL);
+#endif /* GD25QXX_SIM */
+}
+
+/*!
+    \brief      return the flash from continuous read mode to instruction mode, called before
+                any other command
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void qspi_flash_continuous_read_exit(void)
+{
+    if(0U == crm_active) {
+        return;
+    }
+    crm_active = 0U;
+
+    /* a quad I/O read with other mode bits than 0x20 ends the continuous read mode */
+    SPI_FLASH_CS_LOW();
+    spi_quad_enable(SPI0);
+    spi_quad_write_enable(SPI0);
+    spi_flash_send_byte(0x00);
+    spi_flash_send_byte(0x00);
+    spi_flash_send_byte(0x00);
+    qspi_flash_io_mode_send(CRM_EXIT);
+    spi_quad_disable(SPI0);
+    SPI_FLASH_CS_HIGH();
+}
+
+/*!
+    \brief      send the read instruction chosen for the flash, the 24-bit address and the dummy
+                clocks, the data lines of a quad read are then switched to input
+    \param[in]  read_addr: flash's internal address to read from
+    \param[out] none
+    \retval     none
+*/
+static void qspi_flash_read_command(uint32_t read_addr)
+{
+    uint8_t dummy;
+
+    /* select the flash: chip select low */
+    SPI_FLASH_CS_LOW();
+    /* send the quad output fast read or the fast read instruction */
+    spi_flash_send_byte(flash_param.read_instruction);
+    /* send the 24-bit address to read from */
+    spi_flash_send_byte((read_addr & 0xFF0000) >> 16);
+    spi_flash_send_byte((read_addr & 0xFF00) >> 8);
+    spi_flash_send_byte(read_addr & 0xFF);
+
+    /* whole dummy bytes on one line, 8 clocks each */
+    for(dummy = flash_param.read_dummy_clocks / 8U; 0U != dummy; dummy--) {
+        spi_flash_send_byte(DUMMY_BYTE);
+    }
+    if(0U != flash_param.read_quad) {
+        /* enable the qspi read operation, the remaining dummy clocks go 2 per byte */
+        spi_quad_enable(SPI0);
+        spi_quad_read_enable(SPI0);
+        for(dummy = (flash_param.read_dummy_clocks % 8U) / 2U; 0U != dummy; dummy--) {
+            spi_flash_send_byte(DUMMY_BYTE);
+        }
+    }
+}
+
+/*!
+    \brief      send the mode bits and the dummy clocks of a quad I/O read, the address has been
+                sent on the four lines
+    \param[in]  mode: mode bits, CRM_ENTER or CRM_EXIT
+    \param[out] none
+    \retval     none
+*/
+static void qspi_flash_io_mode_send(uint8_t mode)
+{
+    uint8_t dummy;
+
+    if(0U != flash_param.io_read_mode_clocks) {
+        spi_flash_send_byte(mode);
+    }
+    /* the lines are released for the dummy clocks, 2 per byte */
+    spi_quad_read_enable(SPI0);
+    for(dummy = flash_param.io_read_dummy_clocks / 2U; 0U != dummy; dummy--) {
+        spi_flash_send_byte(DUMMY_BYTE);
+    }
+}
+
+/*!
+    \brief      read the SFDP basic parameter table and update the parameters it describes
+    \param[in]  param: parameters of the known part or the defaults
+    \param[out] param: parameters with the density, the erases, the reads and the quad enable
+                method of the table, unchanged if the table is missing or not usable
+    \retval     SUCCESS, or ERROR if the flash has no usable SFDP table
+*/
+static ErrStatus spi_flash_sfdp_parse(spi_flash_param_struct *param)
+{
+    static const uint16_t erase_units_ms[4] = {1U, 16U, 128U, 1000U};
+    static const uint32_t chip_units_ms[4] = {16U, 256U, 4000U, 64000U};
+    uint8_t table[SFDP_DWORDS * 4U];
+    spi_flash_param_struct sfdp = *param;
+    spi_flash_erase_struct erase[SPI_FLASH_ERASE_TYPES + 1U], temp;
+    uint32_t length, dword, field, index, count = 0U, kept = 0U;
+
+    /* the header and the first parameter header, which is the JEDEC basic parameter table */
+    spi_flash_sfdp_read(table, 0U, 16U);
+    if((SFDP_SIGNATURE != spi_flash_sfdp_dword(table, 0U)) || (0x01U != table[5]) ||
+            (0x00U != table[8]) || (0x01U != table[10]) || (0xFFU != table[15])) {
+        return ERROR;
+    }
+    /* JESD216 defines 9 words, the later revisions add the times, the page size and the QER */
+    length = table[11];
+    if(length < 9U) {
+        return ERROR;
+    }
+    if(length > SFDP_DWORDS) {
+        length = SFDP_DWORDS;
+    }
+    field = table[12] | ((uint32_t)table[13] << 8) | ((uint32_t)table[14] << 16);
+    memset(table, 0, sizeof(table));
+    spi_flash_sfdp_read(table, field, (uint16_t)(length * 4U));
+
+    /* the driver needs the 4 KB erase and the 3-byte addresses */
+    dword = spi_flash_sfdp_dword(table, 0U);
+    if((0x01U != (dword & 0x03U)) || (0x02U == ((dword >> 17) & 0x03U))) {
+        return ERROR;
+    }
+    field = spi_flash_sfdp_dword(table, 1U);
+    if(0U != (field & 0x80000000U)) {
+        /* 2^N bits, the parts above 16 MB need 4-byte addresses */
+        field &= 0x7FFFFFFFU;
+        if((field < 3U) || (field > 27U)) {
+            return ERROR;
+        }
+        sfdp.capacity = 1UL << (field - 3U);
+    } else {
+        sfdp.capacity = (field >> 3) + 1U;
+    }
+    if(sfdp.capacity > 0x1000000U) {
+        return ERROR;
+    }
+
+    /* the fastest reads: quad output and quad I/O, a quad read byte takes 2 clocks */
+    if(0U != (dword & (1UL << 22))) {
+        field = spi_flash_sfdp_dword(table, 2U);
+        sfdp.read_instruction = (uint8_t)(field >> 24);
+        sfdp.read_dummy_clocks = (uint8_t)(((field >> 16) & 0x1FU) + ((field >> 21) & 0x07U));
+        sfdp.read_quad = 1U;
+    }
+    if((0U == (dword & (1UL << 22))) || (0U != (sfdp.read_dummy_clocks & 0x01U))) {
+        sfdp.read_instruction = FASTREAD;
+        sfdp.read_dummy_clocks = 8U;
+        sfdp.read_quad = 0U;
+    }
+    sfdp.io_read_instruction = 0U;
+    if(0U != (dword & (1UL << 21))) {
+        field = spi_flash_sfdp_dword(table, 2U);
+        sfdp.io_read_dummy_clocks = (uint8_t)(field & 0x1FU);
+        sfdp.io_read_mode_clocks = (uint8_t)((field >> 5) & 0x07U);
+        if(((0U == sfdp.io_read_mode_clocks) || (2U == sfdp.io_read_mode_clocks)) &&
+                (0U == (sfdp.io_read_dummy_clocks & 0x01U))) {
+            sfdp.io_read_instruction = (uint8_t)(field >> 8);
+        }
+    }
+
+    /* the erase types of words 8 and 9 with their typical times of word 10 */
+    for(index = 0U; index < SPI_FLASH_ERASE_TYPES; index++) {
+        field = spi_flash_sfdp_dword(table, 7U + (index >> 1)) >> ((index & 0x01U) * 16U);
+        /* unused (0), smaller than a sector or larger than the flash */
+        if(((field & 0xFFU) < 12U) || ((field & 0xFFU) > 24U)) {
+            continue;
+        }
+        erase[count].size = 1UL << (field & 0xFFU);
+        erase[count].instruction = (uint8_t)(field >> 8);
+        erase[count].time_ms = spi_flash_erase_time(param, erase[count].size);
+        if(length >= 10U) {
+            field = spi_flash_sfdp_dword(table, 9U) >> (4U + 7U * index);
+            erase[count].time_ms = (uint16_t)(((field & 0x1FU) + 1U) * erase_units_ms[(field >> 5) & 0x03U]);
+        }
+        count++;
+    }
+    /* the 4 KB erase of word 1 if the erase types do not list it */
+    for(index = 0U; (index < count) && (SPI_FLASH_SECTOR_SIZE != erase[index].size); index++) {
+    }
+    if(index == count) {
+        erase[count].size = SPI_FLASH_SECTOR_SIZE;
+        erase[count].instruction = (uint8_t)(dword >> 8);
+        erase[count].time_ms = spi_flash_erase_time(param, SPI_FLASH_SECTOR_SIZE);
+        count++;
+    }
+    /* by increasing size */
+    for(index = 1U; index < count; index++) {
+        for(field = index; (0U != field) && (erase[field - 1U].size > erase[field].size); field--) {
+            temp = erase[field];
+            erase[field] = erase[field - 1U];
+            erase[field - 1U] = temp;
+        }
+    }
+    if(count > SPI_FLASH_ERASE_TYPES) {
+        count = SPI_FLASH_ERASE_TYPES;
+    }
+    /* from the 4 KB erase up, a larger erase is kept if it is faster than the smaller one kept */
+    for(index = 0U; SPI_FLASH_SECTOR_SIZE != erase[index].size; index++) {
+    }
+    memset(sfdp.erase, 0, sizeof(sfdp.erase));
+    temp = erase[index];
+    for(index++; index < count; index++) {
+        if((0U == erase[index].time_ms) || (0U == temp.time_ms) ||
+                ((uint32_t)erase[index].time_ms * (temp.size >> 10) < (uint32_t)temp.time_ms * (erase[index].size >> 10))) {
+            sfdp.erase[kept++] = temp;
+            temp = erase[index];
+        }
+    }
+    sfdp.erase[kept++] = temp;
+    /* by decreasing size */
+    for(index = 0U; index < kept / 2U; index++) {
+        temp = sfdp.erase[index];
+        sfdp.erase[index] = sfdp.erase[kept - 1U - index];
+        sfdp.erase[kept - 1U - index] = temp;
+    }
+
+    if(length >= 11U) {
+        /* the page size and the typical chip erase time */
+        field = spi_flash_sfdp_dword(table, 10U);
+        sfdp.page_size = 1UL << ((field >> 4) & 0x0FU);
+        if(sfdp.page_size < SPI_FLASH_PAGE_SIZE) {
+            return ERROR;
+        }
+        sfdp.chip_erase_ms = (((field >> 24) & 0x1FU) + 1U) * chip_units_ms[(field >> 29) & 0x03U];
+    }
+    if(length >= 15U) {
+        /* the quad enable requirement */
+        switch((spi_flash_sfdp_dword(table, 14U) >> 20) & 0x07U) {
+        case 0U:
+            sfdp.quad_enable = SPI_FLASH_QE_NONE;
+            break;
+        case 2U:
+            sfdp.quad_enable = SPI_FLASH_QE_SR1_BIT6;
+            break;
+        case 3U:
+            sfdp.quad_enable = SPI_FLASH_QE_SR2_BIT7;
+            break;
+        case 1U:
+        case 4U:
+        case 5U:
+            /* bit 1 of status register 2, written with both bytes of 0x01 */
+            sfdp.quad_enable = SPI_FLASH_QE_SR2_BIT1;
+            break;
+        case 6U:
+            /* bit 1 of status register 2, written alone with 0x31 */
+            sfdp.quad_enable = SPI_FLASH_QE_SR2_BIT1_WRSR2;
+            break;
+        default:
+            /* reserved value */
+            return ERROR;
+        }
+    }
+    sfdp.source = SPI_FLASH_PARAM_SFDP;
+    *param = sfdp;
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      get a little-endian word of an SFDP table
+    \param[in]  table: bytes read from the SFDP area
+    \param[in]  index: index of the word
+    \param[out] none
+    \retval     word
+*/
+static uint32_t spi_flash_sfdp_dword(const uint8_t *table, uint32_t index)
+{
+    table += index * 4U;
+    return table[0] | ((uint32_t)table[1] << 8) | ((uint32_t)table[2] << 16) | ((uint32_t)table[3] << 24);
+}
+
+/*!
+    \brief      get the typical time of an erase size from the parameters of the known part
+    \param[in]  param: parameters of the known part or the defaults
+    \param[in]  size: bytes erased
+    \param[out] none
+    \retval     typical erase time in ms, 0 if unknown
+*/
+static uint16_t spi_flash_erase_time(const spi_flash_param_struct *param, uint32_t size)
+{
+    uint32_t index;
+
+    if(SPI_FLASH_PARAM_DEFAULT == param->source) {
+        return 0U;
+    }
+    for(index = 0U; index < SPI_FLASH_ERASE_TYPES; index++) {
+        if(size == param->erase[index].size) {
+            return param->erase[index].time_ms;
+        }
+    }
+    return 0U;
 }
@@ -36,19 +36,101 @@ OF SUCH DAMAGE.
 #define GD25QXX_H
 
 #include "gd32e502.h"
+#include "spi_bus.h"
+#ifdef GD25QXX_SIM
+#include "gd25qxx_sim.h"
+#endif /* GD25QXX_SIM */
 
 #define  SPI_FLASH_PAGE_SIZE       0x100
-#define  SPI_FLASH_CS_LOW()        gpio_bit_reset(GPIOA, GPIO_PIN_1)
-#define  SPI_FLASH_CS_HIGH()       gpio_bit_set(GPIOA, GPIO_PIN_1)
+#define  SPI_FLASH_SECTOR_SIZE     0x1000U
+#define  SPI_FLASH_BLOCK32_SIZE    0x8000U
+#define  SPI_FLASH_BLOCK64_SIZE    0x10000U
+#define  SPI_FLASH_ERASE_TYPES     4U
+#define  SPI_FLASH_RESUME_US       100U   /* time an operation runs after a resume before the next suspend */
+/* the driver keeps the read cache of flash_cache.c coherent, the build sets 0 to leave the cache out */
+#ifndef FLASH_CACHE_ENABLE
+#define  FLASH_CACHE_ENABLE        1
+#endif
+#ifdef GD25QXX_SIM
+/* host builds: the simulated flash answers instead of the flash on SPI0 */
+#define  SPI_FLASH_CS_LOW()        gd25qxx_sim_select()
+#define  SPI_FLASH_CS_HIGH()       gd25qxx_sim_deselect()
+#else
+/* the flash shares SPI0 with the other devices of the bus, its chip select waits for the bus */
+#define  SPI_FLASH_CS_LOW()        spi_bus_lock(&spi_flash_device)
+#define  SPI_FLASH_CS_HIGH()       spi_bus_unlock()
+#endif /* GD25QXX_SIM */
+
+/* quad enable requirement enum, the QER field of the SFDP basic parameter table */
+typedef enum {
+    SPI_FLASH_QE_NONE = 0,              /* the part has no quad enable bit */
+    SPI_FLASH_QE_SR2_BIT1,              /* bit 1 of status register 2, written with both bytes of 0x01 */
+    SPI_FLASH_QE_SR1_BIT6,              /* bit 6 of status register 1 */
+    SPI_FLASH_QE_SR2_BIT7,              /* bit 7 of status register 2, written with 0x3E */
+    SPI_FLASH_QE_SR2_BIT1_WRSR2         /* bit 1 of status register 2, written with 0x31 */
+} spi_flash_qe_enum;
+
+/* origin of the flash parameters enum */
+typedef enum {
+    SPI_FLASH_PARAM_DEFAULT = 0,        /* the flash is unknown, the GD25Q16 parameters are used */
+    SPI_FLASH_PARAM_TABLE,              /* the table of the known identifications */
+    SPI_FLASH_PARAM_SFDP                /* the SFDP basic parameter table of the flash */
+} spi_flash_param_enum;
+
+/* erase command structure */
+typedef struct {
+    uint32_t size;                      /* bytes erased by the command, 0 if unused */
+    uint16_t time_ms;                   /* typical erase time, 0 if unknown */
+    uint8_t instruction;                /* erase instruction */
+} spi_flash_erase_struct;
+
+/* flash parameter structure */
+typedef struct {
+    uint32_t id;                        /* JEDEC identification */
+    uint32_t capacity;                  /* bytes */
+    uint32_t page_size;                 /* bytes of a page program, the writes are split at 256 bytes */
+    spi_flash_erase_struct erase[SPI_FLASH_ERASE_TYPES];   /* by decreasing size, the first 4 KB one ends the list */
+    uint32_t chip_erase_ms;             /* typical chip erase time, 0 if unknown */
+    uint8_t read_instruction;           /* quad output fast read, or fast read */
+    uint8_t read_dummy_clocks;          /* clocks between the address and the data */
+    uint8_t read_quad;                  /* the data of the read comes on the four lines */
+    uint8_t io_read_instruction;        /* quad I/O fast read, 0 if not supported */
+    uint8_t io_read_mode_clocks;        /* clocks of the mode bits, 2 for the continuous read mode */
+    uint8_t io_read_dummy_clocks;       /* clocks between the mode bits and the data */
+    spi_flash_qe_enum quad_enable;      /* how to set the quad enable bit */
+    spi_flash_param_enum source;        /* where the parameters come from */
+} spi_flash_param_struct;
+
+/* completion callback of an asynchronous operation, called from the interrupt */
+typedef void (*spi_flash_callback_func)(void *context);
+
+/* the flash on the SPI bus, registered by spi_flash_init() */
+extern spi_bus_device_struct spi_flash_device;
 
 /* initialize SPI GPIO and parameter */
-void spi_flash_init(void);
+ErrStatus spi_flash_init(void);
+/* read the flash parameters from the SFDP table or from the table of known parts */
+ErrStatus spi_flash_param_detect(void);
+/* get the parameters of the flash */
+const spi_flash_param_struct *spi_flash_param_get(void);
+/* read the SFDP table of the flash */
+void spi_flash_sfdp_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read);
 /* erase the specified flash sector */
 void spi_flash_sector_erase(uint32_t sector_addr);
+/* start erasing the specified flash sector without waiting for the end */
+void spi_flash_sector_erase_start(uint32_t sector_addr);
+/* start the largest aligned erase within a range */
+uint32_t spi_flash_range_erase_step(uint32_t addr, uint32_t end);
+/* erase the sectors of a range with the largest aligned erase commands */
+uint32_t spi_flash_range_erase(uint32_t addr, uint32_t length);
 /* erase the entire flash */
 void spi_flash_bulk_erase(void);
+/* start erasing the entire flash without waiting for the end */
+void spi_flash_bulk_erase_start(void);
 /* write more than one byte to the flash */
 void spi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write);
+/* send the data of a page program without waiting for the end of the programming */
+void spi_flash_page_write_start(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write);
 /* write block of data to the flash */
 void spi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write);
 /* read a block of data from the flash */
@@ -67,7 +149,23 @@ uint16_t spi_flash_send_halfword(uint16_t half_word);
 void spi_flash_write_enable(void);
 /* poll the status of the write in progress (wip) flag in the flash's status register */
 void spi_flash_wait_for_write_end(void);
+/* read the write in progress (wip) flag once */
+FlagStatus spi_flash_write_busy(void);
+/* keep the queue poll away from the flash across several commands */
+void spi_flash_claim(void);
+/* end a claim of spi_flash_claim() */
+void spi_flash_release(void);
+/* check whether a command sequence is in progress */
+FlagStatus spi_flash_claimed(void);
 
+/* suspend the erase or the program in progress */
+ErrStatus spi_flash_suspend(void);
+/* resume the suspended erase or program */
+void spi_flash_resume(void);
+/* suspend the program or the erase started without waiting before a read */
+ErrStatus spi_flash_read_suspend(void);
+/* resume the operation suspended by spi_flash_read_suspend() */
+void spi_flash_read_resume(ErrStatus suspended);
 /* enable the flash quad mode */
 void qspi_flash_quad_enable(void);
 /* write block of data to the flash using qspi */
@@ -76,5 +174,20 @@ void qspi_flash_buffer_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num
 void qspi_flash_buffer_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read);
 /* write more than one byte to the flash using qspi */
 void qspi_flash_page_write(uint8_t *pbuffer, uint32_t write_addr, uint16_t num_byte_to_write);
+/* let the quad I/O reads keep the flash in continuous read mode */
+void qspi_flash_continuous_read_enable(void);
+/* leave the continuous read mode */
+void qspi_flash_continuous_read_disable(void);
+/* read a block of data from the flash with the quad I/O fast read */
+void qspi_flash_io_read(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read);
+
+/* start reading a block of data from the flash with DMA */
+ErrStatus spi_flash_buffer_read_dma(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read,
+                                    spi_flash_callback_func callback, void *context);
+/* start reading a block of data from the flash using qspi with DMA */
+ErrStatus qspi_flash_buffer_read_dma(uint8_t *pbuffer, uint32_t read_addr, uint16_t num_byte_to_read,
+                                     spi_flash_callback_func callback, void *context);
+/* check whether an asynchronous read is in progress */
+FlagStatus spi_flash_dma_busy(void);
 
 #endif /* GD25QXX_H */
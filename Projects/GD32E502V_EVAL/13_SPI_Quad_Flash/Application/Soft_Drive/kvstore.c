@@ -0,0 +1,823 @@
+/*!
+    \file    kvstore.c
+    \brief   log-structured key-value store on the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "kvstore.h"
+#include "gd25qxx.h"
+
+/* the store is a log of records appended sector after sector. Each sector starts with a
+   header holding its erase count and, once it is used, a sequence number that orders the
+   sectors. A record is a key and a value protected by a CRC, a newer record of a key
+   replaces the older ones and a record without value deletes the key. The RAM index maps
+   the hash of each key to its last record. The collection copies the records still in use
+   out of a sector and erases it, the copies are written before the erase so a power cut
+   never loses a value. */
+
+#define KV_SECTOR_MAGIC     0x3153564BU         /* "KVS1" */
+#define KV_RECORD_MAGIC     0x5AU
+#define KV_TOMBSTONE        0xFFFFU             /* value length of a deleted key */
+#define KV_FREE             0xFFFFFFFFU         /* sequence of a free sector */
+#define KV_NONE             0xFFFFFFFFU         /* no sector, no index slot */
+#define KV_HEADER_SIZE      16U
+#define KV_RECORD_HEADER    8U
+#define KV_RECORD_MAX       (KV_RECORD_HEADER + KV_KEY_MAX + KV_VALUE_MAX)
+#define KV_ALIGN(size)      (((size) + 3U) & ~3U)
+
+/* sector header in the flash */
+typedef struct {
+    uint32_t magic;                     /* KV_SECTOR_MAGIC */
+    uint32_t erase_count;               /* times the sector has been erased */
+    uint32_t sequence;                  /* order of the sector in the log, KV_FREE while free */
+    uint32_t reserved;
+} kv_sector_header_struct;
+
+/* record header in the flash, followed by the key and the value */
+typedef struct {
+    uint8_t magic;                      /* KV_RECORD_MAGIC */
+    uint8_t key_length;                 /* bytes of the key */
+    uint16_t value_length;              /* bytes of the value, KV_TOMBSTONE for a deleted key */
+    uint32_t crc;                       /* CRC-32 of the lengths, the key and the value */
+} kv_record_header_struct;
+
+/* sector state in RAM */
+typedef struct {
+    uint32_t sequence;                  /* order of the sector in the log, KV_FREE while free */
+    uint32_t erase_count;               /* times the sector has been erased */
+    uint16_t used;                      /* bytes used, header included */
+    uint16_t live;                      /* bytes of the records the index points to */
+} kv_sector_struct;
+
+/* index slot, the key itself stays in the flash */
+typedef struct {
+    uint32_t hash;                      /* hash of the key */
+    uint32_t address;                   /* address of the last record of the key, KV_NONE for a free slot */
+    uint16_t size;                      /* bytes of the record */
+    uint8_t key_length;                 /* bytes of the key */
+    uint8_t tombstone;                  /* the last record deletes the key */
+} kv_index_struct;
+
+static uint32_t kv_base = 0U;
+static uint32_t kv_count = 0U;
+static uint32_t kv_active = KV_NONE;
+static uint32_t kv_sequence = 0U;
+static uint32_t kv_keys = 0U;
+static kv_sector_struct kv_sector[KV_SECTORS_MAX];
+static kv_index_struct kv_index[KV_INDEX_SIZE];
+static uint8_t kv_record[KV_ALIGN(KV_RECORD_MAX)];
+static kv_stats_struct kv_stats;
+
+static uint32_t kv_crc32(uint32_t crc, const uint8_t *data, uint32_t length);
+static uint32_t kv_hash(const char *key, uint32_t length);
+static uint32_t kv_sector_addr(uint32_t sector);
+static void kv_sector_format(uint32_t sector, uint32_t erase_count);
+static ErrStatus kv_sector_open(uint32_t reserve);
+static uint32_t kv_free_count(void);
+static ErrStatus kv_record_load(uint32_t address, uint32_t limit, kv_record_header_struct *header);
+static uint32_t kv_index_find(const char *key, uint32_t length, uint32_t hash);
+static ErrStatus kv_index_update(uint32_t address, const kv_record_header_struct *header, uint32_t hash);
+static void kv_index_remove(uint32_t slot);
+static void kv_sector_replay(uint32_t sector);
+static ErrStatus kv_append(uint32_t size, uint32_t reserve, uint32_t *address);
+static ErrStatus kv_write(const char *key, const void *value, uint32_t length, uint16_t value_length);
+static uint32_t kv_victim_select(FlagStatus force);
+static ErrStatus kv_collect(uint32_t victim);
+static FlagStatus kv_blank_check(uint32_t address, uint32_t length);
+static uint32_t kv_record_size(const kv_record_header_struct *header);
+
+/*!
+    \brief      mount the store, the sectors which are not part of a store are erased
+    \param[in]  base_addr: address of the first sector of the store, sector aligned
+    \param[in]  sector_count: number of sectors of the store, 3 to KV_SECTORS_MAX
+    \param[out] none
+    \retval     SUCCESS or ERROR if the parameters or the content are not usable
+*/
+ErrStatus kv_init(uint32_t base_addr, uint32_t sector_count)
+{
+    kv_sector_header_struct header;
+    uint32_t sector;
+    uint32_t offset;
+    uint32_t next;
+    uint32_t erase_max = 0U;
+    uint8_t record;
+
+    if((0U != (base_addr % KV_SECTOR_SIZE)) || (sector_count < 3U) || (sector_count > KV_SECTORS_MAX)) {
+        return ERROR;
+    }
+    kv_base = base_addr;
+    kv_count = sector_count;
+    kv_active = KV_NONE;
+    kv_sequence = 0U;
+    kv_keys = 0U;
+    memset(&kv_stats, 0, sizeof(kv_stats));
+    for(offset = 0U; offset < KV_INDEX_SIZE; offset++) {
+        kv_index[offset].address = KV_NONE;
+    }
+
+    /* read the sector headers, a sector without header is erased later */
+    for(sector = 0U; sector < kv_count; sector++) {
+        spi_flash_buffer_read((uint8_t *)&header, kv_sector_addr(sector), sizeof(header));
+        kv_sector[sector].used = KV_HEADER_SIZE;
+        kv_sector[sector].live = 0U;
+        if(KV_SECTOR_MAGIC == header.magic) {
+            kv_sector[sector].sequence = header.sequence;
+            kv_sector[sector].erase_count = header.erase_count;
+            if(header.erase_count > erase_max) {
+                erase_max = header.erase_count;
+            }
+            if(KV_FREE != header.sequence) {
+                /* a sector opened without record may hold a sequence torn by a power cut, it is erased later */
+                spi_flash_buffer_read(&record, kv_sector_addr(sector) + KV_HEADER_SIZE, 1U);
+                if(0xFFU == record) {
+                    kv_sector[sector].sequence = KV_NONE;
+                } else if(header.sequence >= kv_sequence) {
+                    kv_sequence = header.sequence + 1U;
+                }
+            }
+        } else {
+            kv_sector[sector].sequence = KV_NONE;
+            kv_sector[sector].erase_count = KV_NONE;
+        }
+    }
+    for(sector = 0U; sector < kv_count; sector++) {
+        if(KV_NONE == kv_sector[sector].erase_count) {
+            /* the erase count of a sector without header is not known, the highest one is taken */
+            if(SET != kv_blank_check(kv_sector_addr(sector), KV_SECTOR_SIZE)) {
+                spi_flash_sector_erase(kv_sector_addr(sector));
+                kv_stats.erases++;
+            }
+            kv_sector_format(sector, erase_max);
+        } else if(KV_NONE == kv_sector[sector].sequence) {
+            spi_flash_sector_erase(kv_sector_addr(sector));
+            kv_stats.erases++;
+            kv_sector_format(sector, kv_sector[sector].erase_count + 1U);
+        }
+    }
+
+    /* replay the sectors from the oldest to the newest */
+    next = 0U;
+    while(1) {
+        sector = KV_NONE;
+        for(offset = 0U; offset < kv_count; offset++) {
+            if((KV_FREE != kv_sector[offset].sequence) && (kv_sector[offset].sequence >= next)
+                    && ((KV_NONE == sector) || (kv_sector[offset].sequence < kv_sector[sector].sequence))) {
+                sector = offset;
+            }
+        }
+        if(KV_NONE == sector) {
+            break;
+        }
+        kv_sector_replay(sector);
+        kv_active = sector;
+        next = kv_sector[sector].sequence + 1U;
+    }
+
+    if(KV_NONE != kv_active) {
+        /* a record torn by a power cut leaves programmed bytes after the last valid record */
+        offset = kv_sector[kv_active].used;
+        if(SET != kv_blank_check(kv_sector_addr(kv_active) + offset, KV_SECTOR_SIZE - offset)) {
+            kv_sector[kv_active].used = KV_SECTOR_SIZE;
+        }
+        return SUCCESS;
+    }
+    return kv_sector_open(0U);
+}
+
+/*!
+    \brief      write the value of a key
+    \param[in]  key: zero terminated key, 1 to KV_KEY_MAX bytes
+    \param[in]  value: the value
+    \param[in]  length: bytes of the value, up to KV_VALUE_MAX
+    \param[out] none
+    \retval     SUCCESS or ERROR if the parameters are wrong or the store is full
+*/
+ErrStatus kv_put(const char *key, const void *value, uint32_t length)
+{
+    uint32_t key_length;
+
+    if((NULL == key) || (length > KV_VALUE_MAX) || ((NULL == value) && (0U != length))) {
+        return ERROR;
+    }
+    /* a new key must fit in the index before its record is written */
+    key_length = (uint32_t)strlen(key);
+    if((kv_keys >= KV_KEYS_MAX) && (KV_NONE == kv_index_find(key, key_length, kv_hash(key, key_length)))) {
+        return ERROR;
+    }
+    if(SUCCESS != kv_write(key, value, length, (uint16_t)length)) {
+        return ERROR;
+    }
+    kv_stats.puts++;
+    kv_stats.user_bytes += key_length + length;
+    return SUCCESS;
+}
+
+/*!
+    \brief      read the value of a key
+    \param[in]  key: zero terminated key
+    \param[in]  size: bytes of the value buffer
+    \param[out] value: the value, truncated to size bytes
+    \param[out] length: bytes of the value stored, or NULL
+    \retval     SUCCESS or ERROR if the key is not found
+*/
+ErrStatus kv_get(const char *key, void *value, uint32_t size, uint32_t *length)
+{
+    uint32_t key_length = (uint32_t)strlen(key);
+    uint32_t slot;
+    uint32_t stored;
+
+    slot = kv_index_find(key, key_length, kv_hash(key, key_length));
+    if((KV_NONE == slot) || (0U != kv_index[slot].tombstone)) {
+        return ERROR;
+    }
+    /* the record size is aligned, the header gives the exact length */
+    spi_flash_buffer_read(kv_record, kv_index[slot].address, KV_RECORD_HEADER);
+    stored = ((kv_record_header_struct *)kv_record)->value_length;
+    if(NULL != length) {
+        *length = stored;
+    }
+    if(size > stored) {
+        size = stored;
+    }
+    if(0U != size) {
+        spi_flash_buffer_read((uint8_t *)value, kv_index[slot].address + KV_RECORD_HEADER + key_length, (uint16_t)size);
+    }
+    kv_stats.gets++;
+    return SUCCESS;
+}
+
+/*!
+    \brief      delete a key
+    \param[in]  key: zero terminated key
+    \param[out] none
+    \retval     SUCCESS or ERROR if the key is not found or the store is full
+*/
+ErrStatus kv_delete(const char *key)
+{
+    uint32_t key_length = (uint32_t)strlen(key);
+    uint32_t slot;
+
+    slot = kv_index_find(key, key_length, kv_hash(key, key_length));
+    if((KV_NONE == slot) || (0U != kv_index[slot].tombstone)) {
+        return ERROR;
+    }
+    if(SUCCESS != kv_write(key, NULL, 0U, KV_TOMBSTONE)) {
+        return ERROR;
+    }
+    kv_stats.deletes++;
+    return SUCCESS;
+}
+
+/*!
+    \brief      collect a sector when the free sectors run low or the wear is uneven, call from
+                the idle loop so that kv_put() rarely has to collect
+    \param[in]  none
+    \param[out] none
+    \retval     SET if a sector was collected, RESET if there was nothing to do
+*/
+FlagStatus kv_gc_step(void)
+{
+    uint32_t victim;
+
+    victim = kv_victim_select((kv_free_count() < KV_GC_FREE_SECTORS) ? SET : RESET);
+    if((KV_NONE == victim) || (SUCCESS != kv_collect(victim))) {
+        return RESET;
+    }
+    return SET;
+}
+
+/*!
+    \brief      get the statistics of the store, flash_bytes / user_bytes is the write amplification
+    \param[in]  none
+    \param[out] stats: the statistics
+    \retval     none
+*/
+void kv_stats_get(kv_stats_struct *stats)
+{
+    uint32_t sector;
+
+    kv_stats.erase_min = KV_NONE;
+    kv_stats.erase_max = 0U;
+    for(sector = 0U; sector < kv_count; sector++) {
+        if(kv_sector[sector].erase_count < kv_stats.erase_min) {
+            kv_stats.erase_min = kv_sector[sector].erase_count;
+        }
+        if(kv_sector[sector].erase_count > kv_stats.erase_max) {
+            kv_stats.erase_max = kv_sector[sector].erase_count;
+        }
+    }
+    kv_stats.free_sectors = kv_free_count();
+    kv_stats.keys = kv_keys;
+    *stats = kv_stats;
+}
+
+/*!
+    \brief      update a CRC-32 (reflected, polynomial 0xEDB88320) with a buffer
+    \param[in]  crc: CRC of the previous data, 0 to start
+    \param[in]  data: pointer to the data
+    \param[in]  length: bytes of the data
+    \param[out] none
+    \retval     the updated CRC
+*/
+static uint32_t kv_crc32(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    static const uint32_t table[16] = {
+        0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+        0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+    };
+
+    crc = ~crc;
+    while(0U != length--) {
+        crc = (crc >> 4) ^ table[(crc ^ *data) & 0x0FU];
+        crc = (crc >> 4) ^ table[(crc ^ ((uint32_t)*data >> 4)) & 0x0FU];
+        data++;
+    }
+    return ~crc;
+}
+
+/*!
+    \brief      hash a key (FNV-1a)
+    \param[in]  key: pointer to the key
+    \param[in]  length: bytes of the key
+    \param[out] none
+    \retval     the hash
+*/
+static uint32_t kv_hash(const char *key, uint32_t length)
+{
+    uint32_t hash = 0x811C9DC5U;
+
+    while(0U != length--) {
+        hash = (hash ^ (uint8_t)*key++) * 0x01000193U;
+    }
+    return hash;
+}
+
+/*!
+    \brief      get the flash address of a sector
+    \param[in]  sector: index of the sector in the store
+    \param[out] none
+    \retval     the address
+*/
+static uint32_t kv_sector_addr(uint32_t sector)
+{
+    return kv_base + (sector * KV_SECTOR_SIZE);
+}
+
+/*!
+    \brief      write the header of an erased sector, the sector becomes free
+    \param[in]  sector: index of the sector
+    \param[in]  erase_count: erase count of the sector
+    \param[out] none
+    \retval     none
+*/
+static void kv_sector_format(uint32_t sector, uint32_t erase_count)
+{
+    kv_sector_header_struct header;
+
+    /* the sequence stays erased, it is programmed when the sector is used. The magic is
+       programmed last, a header torn by a power cut is erased again by kv_init() */
+    header.magic = 0xFFFFFFFFU;
+    header.erase_count = erase_count;
+    header.sequence = KV_FREE;
+    header.reserved = 0xFFFFFFFFU;
+    spi_flash_page_write((uint8_t *)&header, kv_sector_addr(sector), sizeof(header));
+    header.magic = KV_SECTOR_MAGIC;
+    spi_flash_page_write((uint8_t *)&header.magic, kv_sector_addr(sector), sizeof(header.magic));
+    kv_stats.flash_bytes += sizeof(header);
+    kv_sector[sector].sequence = KV_FREE;
+    kv_sector[sector].erase_count = erase_count;
+    kv_sector[sector].used = KV_HEADER_SIZE;
+    kv_sector[sector].live = 0U;
+}
+
+/*!
+    \brief      make the least erased free sector the active sector
+    \param[in]  reserve: free sectors which must stay free after this one is taken
+    \param[out] none
+    \retval     SUCCESS or ERROR if no free sector can be taken
+*/
+static ErrStatus kv_sector_open(uint32_t reserve)
+{
+    uint32_t sector;
+    uint32_t found = KV_NONE;
+
+    if(kv_free_count() <= reserve) {
+        return ERROR;
+    }
+    for(sector = 0U; sector < kv_count; sector++) {
+        if((KV_FREE == kv_sector[sector].sequence)
+                && ((KV_NONE == found) || (kv_sector[sector].erase_count < kv_sector[found].erase_count))) {
+            found = sector;
+        }
+    }
+    /* only the erased bits of the sequence are programmed */
+    spi_flash_page_write((uint8_t *)&kv_sequence, kv_sector_addr(found) + 8U, sizeof(kv_sequence));
+    kv_stats.flash_bytes += sizeof(kv_sequence);
+    kv_sector[found].sequence = kv_sequence++;
+    kv_active = found;
+    return SUCCESS;
+}
+
+/*!
+    \brief      count the free sectors
+    \param[in]  none
+    \param[out] none
+    \retval     number of free sectors
+*/
+static uint32_t kv_free_count(void)
+{
+    uint32_t sector;
+    uint32_t count = 0U;
+
+    for(sector = 0U; sector < kv_count; sector++) {
+        if(KV_FREE == kv_sector[sector].sequence) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*!
+    \brief      read a record into kv_record and check it
+    \param[in]  address: address of the record
+    \param[in]  limit: bytes left in the sector from the address
+    \param[out] header: the record header
+    \retval     SUCCESS or ERROR if the record is damaged
+*/
+static ErrStatus kv_record_load(uint32_t address, uint32_t limit, kv_record_header_struct *header)
+{
+    uint32_t size;
+
+    spi_flash_buffer_read((uint8_t *)header, address, KV_RECORD_HEADER);
+    if((KV_RECORD_MAGIC != header->magic) || (0U == header->key_length) || (header->key_length > KV_KEY_MAX)
+            || ((KV_TOMBSTONE != header->value_length) && (header->value_length > KV_VALUE_MAX))) {
+        return ERROR;
+    }
+    size = KV_RECORD_HEADER + header->key_length + ((KV_TOMBSTONE == header->value_length) ? 0U : header->value_length);
+    if(kv_record_size(header) > limit) {
+        return ERROR;
+    }
+    spi_flash_buffer_read(kv_record, address, (uint16_t)kv_record_size(header));
+    if(header->crc != kv_crc32(kv_crc32(0U, kv_record, 4U), &kv_record[KV_RECORD_HEADER], size - KV_RECORD_HEADER)) {
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      find the index slot of a key
+    \param[in]  key: pointer to the key
+    \param[in]  length: bytes of the key
+    \param[in]  hash: hash of the key
+    \param[out] none
+    \retval     the slot, KV_NONE if the key is not in the index
+*/
+static uint32_t kv_index_find(const char *key, uint32_t length, uint32_t hash)
+{
+    uint8_t stored[KV_KEY_MAX];
+    uint32_t slot = hash & (KV_INDEX_SIZE - 1U);
+
+    if((0U == length) || (length > KV_KEY_MAX)) {
+        return KV_NONE;
+    }
+    /* linear probing, the key is read back from the flash only when the hash matches */
+    while(KV_NONE != kv_index[slot].address) {
+        if((hash == kv_index[slot].hash) && (length == kv_index[slot].key_length)) {
+            spi_flash_buffer_read(stored, kv_index[slot].address + KV_RECORD_HEADER, (uint16_t)length);
+            if(0 == memcmp(stored, key, length)) {
+                return slot;
+            }
+        }
+        slot = (slot + 1U) & (KV_INDEX_SIZE - 1U);
+    }
+    return KV_NONE;
+}
+
+/*!
+    \brief      point the index to a new record of a key, the record is in kv_record
+    \param[in]  address: address of the record
+    \param[in]  header: the record header
+    \param[in]  hash: hash of the key
+    \param[out] none
+    \retval     SUCCESS or ERROR if the index is full
+*/
+static ErrStatus kv_index_update(uint32_t address, const kv_record_header_struct *header, uint32_t hash)
+{
+    uint32_t slot;
+    uint32_t size;
+
+    size = kv_record_size(header);
+    slot = kv_index_find((const char *)&kv_record[KV_RECORD_HEADER], header->key_length, hash);
+    if(KV_NONE != slot) {
+        /* the previous record of the key is no longer in use */
+        kv_sector[(kv_index[slot].address - kv_base) / KV_SECTOR_SIZE].live -= kv_index[slot].size;
+    } else {
+        if(kv_keys >= KV_KEYS_MAX) {
+            return ERROR;
+        }
+        slot = hash & (KV_INDEX_SIZE - 1U);
+        while(KV_NONE != kv_index[slot].address) {
+            slot = (slot + 1U) & (KV_INDEX_SIZE - 1U);
+        }
+        kv_keys++;
+    }
+    kv_index[slot].hash = hash;
+    kv_index[slot].address = address;
+    kv_index[slot].size = (uint16_t)size;
+    kv_index[slot].key_length = header->key_length;
+    kv_index[slot].tombstone = (KV_TOMBSTONE == header->value_length) ? 1U : 0U;
+    kv_sector[(address - kv_base) / KV_SECTOR_SIZE].live += (uint16_t)size;
+    return SUCCESS;
+}
+
+/*!
+    \brief      remove a slot from the index, the following slots are moved back to keep the probing
+    \param[in]  slot: the slot
+    \param[out] none
+    \retval     none
+*/
+static void kv_index_remove(uint32_t slot)
+{
+    uint32_t next = slot;
+    uint32_t home;
+
+    kv_index[slot].address = KV_NONE;
+    kv_keys--;
+    while(1) {
+        next = (next + 1U) & (KV_INDEX_SIZE - 1U);
+        if(KV_NONE == kv_index[next].address) {
+            return;
+        }
+        /* move the entry back unless its home slot lies after the hole */
+        home = kv_index[next].hash & (KV_INDEX_SIZE - 1U);
+        if(((next - home) & (KV_INDEX_SIZE - 1U)) >= ((next - slot) & (KV_INDEX_SIZE - 1U))) {
+            kv_index[slot] = kv_index[next];
+            kv_index[next].address = KV_NONE;
+            slot = next;
+        }
+    }
+}
+
+/*!
+    \brief      add the records of a sector to the index
+    \param[in]  sector: index of the sector
+    \param[out] none
+    \retval     none
+*/
+static void kv_sector_replay(uint32_t sector)
+{
+    kv_record_header_struct header;
+    uint32_t offset = KV_HEADER_SIZE;
+    uint32_t address;
+    uint32_t hash;
+
+    while((offset + KV_RECORD_HEADER) <= KV_SECTOR_SIZE) {
+        address = kv_sector_addr(sector) + offset;
+        spi_flash_buffer_read((uint8_t *)&header, address, KV_RECORD_HEADER);
+        if(0xFFU == header.magic) {
+            break;
+        }
+        /* a damaged record ends the sector, nothing is appended after it */
+        if(SUCCESS != kv_record_load(address, KV_SECTOR_SIZE - offset, &header)) {
+            offset = KV_SECTOR_SIZE;
+            break;
+        }
+        hash = kv_hash((const char *)&kv_record[KV_RECORD_HEADER], header.key_length);
+        if(SUCCESS != kv_index_update(address, &header, hash)) {
+            offset = KV_SECTOR_SIZE;
+            break;
+        }
+        offset += kv_record_size(&header);
+    }
+    kv_sector[sector].used = (uint16_t)offset;
+}
+
+/*!
+    \brief      find room for a record in the active sector, a new sector is opened when it is full
+    \param[in]  size: bytes of the record
+    \param[in]  reserve: free sectors which must stay free
+    \param[out] address: address of the record
+    \retval     SUCCESS or ERROR if no sector can be opened
+*/
+static ErrStatus kv_append(uint32_t size, uint32_t reserve, uint32_t *address)
+{
+    if((kv_sector[kv_active].used + size) > KV_SECTOR_SIZE) {
+        if(SUCCESS != kv_sector_open(reserve)) {
+            return ERROR;
+        }
+    }
+    *address = kv_sector_addr(kv_active) + kv_sector[kv_active].used;
+    kv_sector[kv_active].used += (uint16_t)size;
+    return SUCCESS;
+}
+
+/*!
+    \brief      append a record of a key, collecting sectors when the store is full
+    \param[in]  key: zero terminated key
+    \param[in]  value: the value
+    \param[in]  length: bytes of the value
+    \param[in]  value_length: length written in the record, KV_TOMBSTONE to delete the key
+    \param[out] none
+    \retval     SUCCESS or ERROR
+*/
+static ErrStatus kv_write(const char *key, const void *value, uint32_t length, uint16_t value_length)
+{
+    kv_record_header_struct *header = (kv_record_header_struct *)kv_record;
+    uint32_t key_length;
+    uint32_t size;
+    uint32_t address;
+    uint32_t victim;
+
+    if((NULL == key) || (KV_NONE == kv_active)) {
+        return ERROR;
+    }
+    key_length = (uint32_t)strlen(key);
+    if((0U == key_length) || (key_length > KV_KEY_MAX)) {
+        return ERROR;
+    }
+    size = KV_RECORD_HEADER + key_length + length;
+
+    /* one free sector is kept for the collection */
+    while(SUCCESS != kv_append(KV_ALIGN(size), 1U, &address)) {
+        victim = kv_victim_select(SET);
+        if((KV_NONE == victim) || (SUCCESS != kv_collect(victim))) {
+            return ERROR;
+        }
+    }
+
+    memset(kv_record, 0xFF, sizeof(kv_record));
+    header->magic = KV_RECORD_MAGIC;
+    header->key_length = (uint8_t)key_length;
+    header->value_length = value_length;
+    memcpy(&kv_record[KV_RECORD_HEADER], key, key_length);
+    if(0U != length) {
+        memcpy(&kv_record[KV_RECORD_HEADER + key_length], value, length);
+    }
+    header->crc = kv_crc32(kv_crc32(0U, kv_record, 4U), &kv_record[KV_RECORD_HEADER], size - KV_RECORD_HEADER);
+    spi_flash_buffer_write(kv_record, address, (uint16_t)KV_ALIGN(size));
+    kv_stats.flash_bytes += KV_ALIGN(size);
+    return kv_index_update(address, header, kv_hash(key, key_length));
+}
+
+/*!
+    \brief      choose the sector to collect
+    \param[in]  force: SET to collect the sector with the most unused bytes, RESET to collect
+                only a cold sector when the wear is uneven
+    \param[out] none
+    \retval     the sector, KV_NONE if no sector is worth collecting
+*/
+static uint32_t kv_victim_select(FlagStatus force)
+{
+    uint32_t sector;
+    uint32_t victim = KV_NONE;
+    uint32_t coldest = KV_NONE;
+    uint32_t dead;
+    uint32_t best = 0U;
+    uint32_t erase_max = 0U;
+
+    for(sector = 0U; sector < kv_count; sector++) {
+        if(kv_sector[sector].erase_count > erase_max) {
+            erase_max = kv_sector[sector].erase_count;
+        }
+        if((KV_FREE == kv_sector[sector].sequence) || (sector == kv_active)) {
+            continue;
+        }
+        dead = (uint32_t)kv_sector[sector].used - KV_HEADER_SIZE - kv_sector[sector].live;
+        /* the unused bytes first, then the least erased sector */
+        if((dead > best) || ((dead == best) && (0U != dead) && (kv_sector[sector].erase_count < kv_sector[victim].erase_count))) {
+            best = dead;
+            victim = sector;
+        }
+        if((KV_NONE == coldest) || (kv_sector[sector].erase_count < kv_sector[coldest].erase_count)) {
+            coldest = sector;
+        }
+    }
+    /* data which never changes keeps its sectors from wearing, it is moved to a worn sector */
+    if((KV_NONE != coldest) && ((erase_max - kv_sector[coldest].erase_count) > KV_WEAR_LIMIT)) {
+        return coldest;
+    }
+    return (SET == force) ? victim : KV_NONE;
+}
+
+/*!
+    \brief      copy the records in use out of a sector and erase it
+    \param[in]  victim: index of the sector
+    \param[out] none
+    \retval     SUCCESS or ERROR if the records do not fit in the other sectors
+*/
+static ErrStatus kv_collect(uint32_t victim)
+{
+    kv_record_header_struct header;
+    uint32_t offset = KV_HEADER_SIZE;
+    uint32_t address;
+    uint32_t target;
+    uint32_t slot;
+    uint32_t sector;
+    uint8_t oldest = 1U;
+
+    for(sector = 0U; sector < kv_count; sector++) {
+        if((KV_FREE != kv_sector[sector].sequence) && (kv_sector[sector].sequence < kv_sector[victim].sequence)) {
+            oldest = 0U;
+        }
+    }
+    while(offset < kv_sector[victim].used) {
+        address = kv_sector_addr(victim) + offset;
+        if(SUCCESS != kv_record_load(address, KV_SECTOR_SIZE - offset, &header)) {
+            break;
+        }
+        slot = kv_index_find((const char *)&kv_record[KV_RECORD_HEADER], header.key_length,
+                             kv_hash((const char *)&kv_record[KV_RECORD_HEADER], header.key_length));
+        offset += kv_record_size(&header);
+        if((KV_NONE == slot) || (address != kv_index[slot].address)) {
+            continue;
+        }
+        if((0U != kv_index[slot].tombstone) && (0U != oldest)) {
+            /* no older record of the key is left, the deletion itself can go */
+            kv_sector[victim].live -= kv_index[slot].size;
+            kv_index_remove(slot);
+            continue;
+        }
+        /* the collection may use the last free sector */
+        if(SUCCESS != kv_append(kv_index[slot].size, 0U, &target)) {
+            return ERROR;
+        }
+        spi_flash_buffer_write(kv_record, target, kv_index[slot].size);
+        kv_stats.flash_bytes += kv_index[slot].size;
+        kv_sector[victim].live -= kv_index[slot].size;
+        kv_sector[(target - kv_base) / KV_SECTOR_SIZE].live += kv_index[slot].size;
+        kv_index[slot].address = target;
+    }
+
+    spi_flash_sector_erase(kv_sector_addr(victim));
+    kv_stats.erases++;
+    kv_stats.collections++;
+    kv_sector_format(victim, kv_sector[victim].erase_count + 1U);
+    return SUCCESS;
+}
+
+/*!
+    \brief      check that a flash area is erased
+    \param[in]  address: address of the area
+    \param[in]  length: bytes of the area
+    \param[out] none
+    \retval     SET if all the bytes are 0xFF, RESET otherwise
+*/
+static FlagStatus kv_blank_check(uint32_t address, uint32_t length)
+{
+    uint32_t chunk;
+    uint32_t i;
+
+    while(0U != length) {
+        chunk = (length < sizeof(kv_record)) ? length : sizeof(kv_record);
+        spi_flash_buffer_read(kv_record, address, (uint16_t)chunk);
+        for(i = 0U; i < chunk; i++) {
+            if(0xFFU != kv_record[i]) {
+                return RESET;
+            }
+        }
+        address += chunk;
+        length -= chunk;
+    }
+    return SET;
+}
+
+/*!
+    \brief      get the bytes a record takes in the flash
+    \param[in]  header: the record header
+    \param[out] none
+    \retval     bytes of the record, padding included
+*/
+static uint32_t kv_record_size(const kv_record_header_struct *header)
+{
+    return KV_ALIGN(KV_RECORD_HEADER + header->key_length
+                    + ((KV_TOMBSTONE == header->value_length) ? 0U : header->value_length));
+}
@@ -0,0 +1,78 @@
+/*!
+    \file    kvstore.h
+    \brief   the header file of the log-structured key-value store on the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef KVSTORE_H
+#define KVSTORE_H
+
+#include "gd32e502.h"
+
+#define KV_SECTOR_SIZE                0x1000U             /* erase unit of the GD25Q16 */
+#define KV_SECTORS_MAX                32U                 /* sectors a store can use */
+#define KV_KEY_MAX                    16U                 /* bytes of a key */
+#define KV_VALUE_MAX                  256U                /* bytes of a value */
+#define KV_INDEX_SIZE                 128U                /* slots of the RAM index, a power of two */
+#define KV_KEYS_MAX                   96U                 /* keys of the store, deleted keys included */
+#define KV_GC_FREE_SECTORS            2U                  /* kv_gc_step() collects below this number of free sectors */
+#define KV_WEAR_LIMIT                 64U                 /* erase count difference that moves cold data */
+
+/* key-value store statistics structure */
+typedef struct {
+    uint32_t puts;                      /* values written */
+    uint32_t gets;                      /* values read */
+    uint32_t deletes;                   /* keys deleted */
+    uint32_t user_bytes;                /* bytes of the keys and values written by the application */
+    uint32_t flash_bytes;               /* bytes programmed in the flash, records copied by the collection included */
+    uint32_t collections;               /* sectors collected */
+    uint32_t erases;                    /* sectors erased */
+    uint32_t erase_min;                 /* lowest erase count of the sectors */
+    uint32_t erase_max;                 /* highest erase count of the sectors */
+    uint32_t free_sectors;              /* sectors erased and not used */
+    uint32_t keys;                      /* keys in the index */
+} kv_stats_struct;
+
+/* function declarations */
+/* mount the store, the sectors which are not part of a store are erased */
+ErrStatus kv_init(uint32_t base_addr, uint32_t sector_count);
+/* write the value of a key */
+ErrStatus kv_put(const char *key, const void *value, uint32_t length);
+/* read the value of a key */
+ErrStatus kv_get(const char *key, void *value, uint32_t size, uint32_t *length);
+/* delete a key */
+ErrStatus kv_delete(const char *key);
+/* collect a sector when the free sectors run low or the wear is uneven, call from the idle loop */
+FlagStatus kv_gc_step(void);
+/* get the statistics of the store */
+void kv_stats_get(kv_stats_struct *stats);
+
+#endif /* KVSTORE_H */
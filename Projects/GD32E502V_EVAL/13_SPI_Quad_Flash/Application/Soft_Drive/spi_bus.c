@@ -0,0 +1,456 @@
+/*!
+    \file    spi_bus.c
+    \brief   SPI0 bus shared by several devices: transaction queue with priorities, DMA and chip select handling
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "spi_bus.h"
+#include <string.h>
+
+#define SPI_BUS_PHASE_COMMAND    0U       /* the command of the active transfer is sent */
+#define SPI_BUS_PHASE_DATA       1U       /* the data of the active transfer is sent */
+
+/* queued transfers by decreasing priority, the transfer on the bus and its phase */
+static spi_bus_transfer_struct *bus_head = NULL;
+static spi_bus_transfer_struct *bus_active = NULL;
+static uint8_t bus_phase = SPI_BUS_PHASE_COMMAND;
+/* device holding the bus with spi_bus_lock(), device waiting in spi_bus_lock() */
+static spi_bus_device_struct *bus_owner = NULL;
+static spi_bus_device_struct *__IO bus_waiting = NULL;
+static uint32_t bus_lock_start = 0U;
+/* device whose clock and mode are set in SPI0 */
+static spi_bus_device_struct *bus_device = NULL;
+/* DMA read of a locked access */
+static spi_bus_callback_func bus_dma_callback = NULL;
+static void *bus_dma_context = NULL;
+/* byte sent when there is no data, byte receiving the data dropped */
+static uint8_t bus_fill = 0xFFU;
+static uint8_t bus_drop;
+
+static void spi_bus_next(void);
+static void spi_bus_device_select(spi_bus_device_struct *device);
+static void spi_bus_dma_start(const uint8_t *ptx, uint8_t *prx, uint16_t length);
+static void spi_bus_wait_account(spi_bus_device_struct *device, uint32_t wait);
+
+/*!
+    \brief      configure SPI0 and the DMA channels of the bus
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_init(void)
+{
+    spi_parameter_struct spi_init_struct;
+    dma_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_GPIOA);
+    rcu_periph_clock_enable(RCU_GPIOE);
+    rcu_periph_clock_enable(RCU_SPI0);
+    rcu_periph_clock_enable(RCU_DMA0);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    /* SPI_CLK(PE14), SPI_MISO_IO1(PE13) and SPI_MOSI_IO0(PA2) GPIO pin configuration */
+    gpio_af_set(GPIOA, GPIO_AF_4, GPIO_PIN_2);
+    gpio_mode_set(GPIOA, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_2);
+    gpio_output_options_set(GPIOA, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_2);
+
+    gpio_af_set(GPIOE, GPIO_AF_4, GPIO_PIN_13 | GPIO_PIN_14);
+    gpio_mode_set(GPIOE, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_13 | GPIO_PIN_14);
+    gpio_output_options_set(GPIOE, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 | GPIO_PIN_14);
+
+    /* SPI parameter configuration, each device sets its clock and its mode */
+    spi_init_struct.trans_mode           = SPI_TRANSMODE_FULLDUPLEX;
+    spi_init_struct.device_mode          = SPI_MASTER;
+    spi_init_struct.frame_size           = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.clock_polarity_phase = SPI_CK_PL_LOW_PH_1EDGE;
+    spi_init_struct.nss                  = SPI_NSS_SOFT;
+    spi_init_struct.prescale             = SPI_PSC_32;
+    spi_init_struct.endian               = SPI_ENDIAN_MSB;
+    spi_init(SPI0, &spi_init_struct);
+    spi_enable(SPI0);
+
+    /* SPI0 RX to the buffer, the address, the increment and the number are set by each transfer */
+    dma_deinit(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL);
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.request      = DMA_REQUEST_SPI0_RX;
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = 0U;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number       = 0U;
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI0);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, &dma_init_struct);
+    dma_circulation_disable(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL);
+    dma_memory_to_memory_disable(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL);
+    dmamux_synchronization_disable(DMAMUX_MULTIPLEXER_CH2);
+    dma_interrupt_enable(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, DMA_INT_FTF);
+
+    /* the buffer to SPI0 TX, the RX channel has the higher priority so that no byte is lost */
+    dma_deinit(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL);
+    dma_init_struct.request      = DMA_REQUEST_SPI0_TX;
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+    dma_init(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL, &dma_init_struct);
+    dma_circulation_disable(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL);
+    dma_memory_to_memory_disable(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL);
+    dmamux_synchronization_disable(DMAMUX_MULTIPLEXER_CH3);
+
+    /* the cycle counter times the waits and the transfers */
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    bus_head = NULL;
+    bus_active = NULL;
+    bus_owner = NULL;
+    bus_waiting = NULL;
+    bus_device = NULL;
+}
+
+/*!
+    \brief      configure the chip select and the settings of a device
+    \param[in]  device: device structure, it must stay valid while the device is used
+    \param[in]  cs_port: GPIO port of the chip select, GPIOx(x = A,B,C,D,E,F)
+    \param[in]  cs_pin: GPIO pin of the chip select, GPIO_PIN_x(x = 0..15)
+    \param[in]  prescale: clock of the device, SPI_PSC_x(x = 2,4,8,16,32,64,128,256)
+    \param[in]  clock_polarity_phase: mode of the device, SPI_CK_PL_x_PH_x
+    \param[in]  priority: the transfers of higher priority go first
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_device_init(spi_bus_device_struct *device, uint32_t cs_port, uint32_t cs_pin,
+                         uint32_t prescale, uint32_t clock_polarity_phase, uint8_t priority)
+{
+    device->cs_port = cs_port;
+    device->cs_pin = cs_pin;
+    device->prescale = prescale;
+    device->clock_polarity_phase = clock_polarity_phase;
+    device->priority = priority;
+    spi_bus_stats_clear(device);
+
+    /* chip select invalid */
+    gpio_bit_set(cs_port, cs_pin);
+    gpio_mode_set(cs_port, GPIO_MODE_OUTPUT, GPIO_PUPD_NONE, cs_pin);
+    gpio_output_options_set(cs_port, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, cs_pin);
+}
+
+/*!
+    \brief      queue a transfer after those of the same or a higher priority, it runs with DMA
+                when the bus is free and its callback is called from the interrupt
+    \param[in]  transfer: transfer structure, it must stay valid until done is set
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the transfer is empty
+*/
+ErrStatus spi_bus_submit(spi_bus_transfer_struct *transfer)
+{
+    spi_bus_transfer_struct **link = &bus_head;
+    uint32_t primask;
+
+    if((NULL == transfer->device) || (0U == (transfer->command_length + transfer->length))) {
+        return ERROR;
+    }
+    transfer->done = 0U;
+    transfer->next = NULL;
+    transfer->queued = DWT->CYCCNT;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    while((NULL != *link) && ((*link)->device->priority >= transfer->device->priority)) {
+        link = &(*link)->next;
+    }
+    transfer->next = *link;
+    *link = transfer;
+    spi_bus_next();
+    __set_PRIMASK(primask);
+
+    return SUCCESS;
+}
+
+/*!
+    \brief      wait for the bus and select a device for direct accesses: the transfer on the
+                bus and the queued transfers of a higher priority go first, those of the same
+                or a lower priority wait for spi_bus_unlock(). An interrupt checks spi_bus_busy()
+                first, it would wait forever for the access it preempted.
+    \param[in]  device: device to select
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_lock(spi_bus_device_struct *device)
+{
+    uint32_t request = DWT->CYCCNT;
+    uint32_t primask;
+
+    for(;;) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if((NULL == bus_active) && (NULL == bus_owner) &&
+                ((NULL == bus_head) || (bus_head->device->priority <= device->priority))) {
+            break;
+        }
+        /* the transfer in progress does not start the queued ones of a lower priority */
+        if((NULL == bus_waiting) || (bus_waiting->priority < device->priority)) {
+            bus_waiting = device;
+        }
+        __set_PRIMASK(primask);
+    }
+    bus_owner = device;
+    if(device == bus_waiting) {
+        bus_waiting = NULL;
+    }
+    __set_PRIMASK(primask);
+
+    spi_bus_device_select(device);
+    bus_lock_start = DWT->CYCCNT;
+    spi_bus_wait_account(device, bus_lock_start - request);
+}
+
+/*!
+    \brief      deselect the device of spi_bus_lock() and release the bus, the next queued
+                transfer starts
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_unlock(void)
+{
+    spi_bus_device_struct *device = bus_owner;
+    uint32_t primask;
+
+    if(NULL == device) {
+        return;
+    }
+    /* chip select high */
+    gpio_bit_set(device->cs_port, device->cs_pin);
+    device->stats.transfers++;
+    device->stats.busy_cycles += DWT->CYCCNT - bus_lock_start;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    bus_owner = NULL;
+    spi_bus_next();
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      read with DMA while the bus is locked, 0xFF is sent for each byte and the
+                callback is called from the interrupt at the end
+    \param[in]  prx: buffer receiving the data
+    \param[in]  length: bytes to read
+    \param[in]  callback: function called from the interrupt when the data is read, or NULL
+    \param[in]  context: parameter of the callback
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the bus is not locked or the length is 0
+*/
+ErrStatus spi_bus_dma_read(uint8_t *prx, uint16_t length, spi_bus_callback_func callback, void *context)
+{
+    if((NULL == bus_owner) || (0U == length)) {
+        return ERROR;
+    }
+    bus_dma_callback = callback;
+    bus_dma_context = context;
+    spi_bus_dma_start(NULL, prx, length);
+    return SUCCESS;
+}
+
+/*!
+    \brief      check whether a transfer or a locked access uses the bus
+    \param[in]  none
+    \param[out] none
+    \retval     SET if a transfer is in progress or queued or if a device locked the bus, RESET otherwise
+*/
+FlagStatus spi_bus_busy(void)
+{
+    return ((NULL != bus_active) || (NULL != bus_owner) || (NULL != bus_head)) ? SET : RESET;
+}
+
+/*!
+    \brief      end a DMA phase, called from the DMA RX channel interrupt: the data of a transfer
+                follows its command, a finished transfer releases the bus for the next one
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_dma_complete(void)
+{
+    spi_bus_transfer_struct *transfer = bus_active;
+    spi_bus_device_struct *device;
+
+    spi_dma_disable(SPI0, SPI_DMA_TRANSMIT);
+    spi_dma_disable(SPI0, SPI_DMA_RECEIVE);
+    dma_channel_disable(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL);
+    dma_channel_disable(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL);
+
+    if(NULL == transfer) {
+        /* the read of a locked access */
+        if(NULL != bus_dma_callback) {
+            bus_dma_callback(bus_dma_context);
+        }
+        return;
+    }
+    if((SPI_BUS_PHASE_COMMAND == bus_phase) && (0U != transfer->length)) {
+        bus_phase = SPI_BUS_PHASE_DATA;
+        spi_bus_dma_start(transfer->tx, transfer->rx, transfer->length);
+        return;
+    }
+
+    /* chip select high */
+    device = transfer->device;
+    gpio_bit_set(device->cs_port, device->cs_pin);
+    device->stats.transfers++;
+    device->stats.bytes += transfer->command_length + transfer->length;
+    device->stats.busy_cycles += DWT->CYCCNT - transfer->started;
+
+    bus_active = NULL;
+    transfer->done = 1U;
+    if(NULL != transfer->callback) {
+        transfer->callback(transfer->context);
+    }
+    spi_bus_next();
+}
+
+/*!
+    \brief      clear the statistics of a device
+    \param[in]  device: device structure
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_stats_clear(spi_bus_device_struct *device)
+{
+    memset(&device->stats, 0, sizeof(device->stats));
+}
+
+/*!
+    \brief      start the first queued transfer if the bus is free, called with the interrupts
+                disabled or from the DMA interrupt
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_next(void)
+{
+    spi_bus_transfer_struct *transfer = bus_head;
+
+    if((NULL != bus_active) || (NULL != bus_owner) || (NULL == transfer)) {
+        return;
+    }
+    /* a waiting lock of a higher or the same priority goes first */
+    if((NULL != bus_waiting) && (transfer->device->priority <= bus_waiting->priority)) {
+        return;
+    }
+    bus_head = transfer->next;
+    bus_active = transfer;
+
+    spi_bus_device_select(transfer->device);
+    transfer->started = DWT->CYCCNT;
+    spi_bus_wait_account(transfer->device, transfer->started - transfer->queued);
+    if(0U != transfer->command_length) {
+        bus_phase = SPI_BUS_PHASE_COMMAND;
+        spi_bus_dma_start(transfer->command, NULL, transfer->command_length);
+    } else {
+        bus_phase = SPI_BUS_PHASE_DATA;
+        spi_bus_dma_start(transfer->tx, transfer->rx, transfer->length);
+    }
+}
+
+/*!
+    \brief      set the clock and the mode of a device in SPI0 and set its chip select low
+    \param[in]  device: device structure
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_device_select(spi_bus_device_struct *device)
+{
+    if(device != bus_device) {
+        /* the prescaler and the mode are changed while SPI0 is disabled */
+        spi_disable(SPI0);
+        SPI_CTL0(SPI0) = (SPI_CTL0(SPI0) & ~(SPI_CTL0_PSC | SPI_CTL0_CKPL | SPI_CTL0_CKPH)) |
+                         device->prescale | device->clock_polarity_phase;
+        spi_enable(SPI0);
+        bus_device = device;
+    }
+    /* every transfer starts in single wire mode, whatever the previous owner left */
+    SPI_QCTL(SPI0) &= ~(SPI_QCTL_QMOD | SPI_QCTL_QRD);
+    /* chip select low */
+    gpio_bit_reset(device->cs_port, device->cs_pin);
+}
+
+/*!
+    \brief      start the DMA channels for one phase of a transfer
+    \param[in]  ptx: data sent, NULL to send 0xFF
+    \param[in]  prx: buffer receiving the data, NULL to drop it
+    \param[in]  length: bytes of the phase
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_dma_start(const uint8_t *ptx, uint8_t *prx, uint16_t length)
+{
+    if(NULL != prx) {
+        dma_memory_address_config(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, (uint32_t)prx);
+        dma_memory_increase_enable(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL);
+    } else {
+        dma_memory_address_config(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, (uint32_t)&bus_drop);
+        dma_memory_increase_disable(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL);
+    }
+    if(NULL != ptx) {
+        dma_memory_address_config(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL, (uint32_t)ptx);
+        dma_memory_increase_enable(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL);
+    } else {
+        dma_memory_address_config(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL, (uint32_t)&bus_fill);
+        dma_memory_increase_disable(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL);
+    }
+    dma_transfer_number_config(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, length);
+    dma_transfer_number_config(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL, length);
+    dma_flag_clear(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL, DMA_FLAG_G);
+    dma_flag_clear(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL, DMA_FLAG_G);
+
+    /* the receiver is ready before the first byte is sent */
+    dma_channel_enable(SPI_BUS_DMA, SPI_BUS_DMA_RX_CHANNEL);
+    spi_dma_enable(SPI0, SPI_DMA_RECEIVE);
+    dma_channel_enable(SPI_BUS_DMA, SPI_BUS_DMA_TX_CHANNEL);
+    spi_dma_enable(SPI0, SPI_DMA_TRANSMIT);
+}
+
+/*!
+    \brief      add a wait to the statistics of a device
+    \param[in]  device: device structure
+    \param[in]  wait: CPU cycles from the request to the start
+    \param[out] none
+    \retval     none
+*/
+static void spi_bus_wait_account(spi_bus_device_struct *device, uint32_t wait)
+{
+    device->stats.wait_cycles += wait;
+    if(wait > device->stats.max_wait_cycles) {
+        device->stats.max_wait_cycles = wait;
+    }
+}
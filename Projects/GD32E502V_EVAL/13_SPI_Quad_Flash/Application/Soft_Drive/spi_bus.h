@@ -0,0 +1,105 @@
+/*!
+    \file    spi_bus.h
+    \brief   the header file of the SPI0 bus shared by several devices
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+#include "gd32e502.h"
+
+/* DMA channels of the bus, SPI0 RX and SPI0 TX */
+#define SPI_BUS_DMA                   DMA0
+#define SPI_BUS_DMA_RX_CHANNEL        DMA_CH2
+#define SPI_BUS_DMA_TX_CHANNEL        DMA_CH3
+#define SPI_BUS_DMA_RX_IRQn           DMA0_Channel2_IRQn
+
+/* completion callback of a transfer, called from the interrupt */
+typedef void (*spi_bus_callback_func)(void *context);
+
+/* device statistics structure */
+typedef struct {
+    uint32_t transfers;                 /* transfers and locked accesses completed */
+    uint32_t bytes;                     /* bytes of the transfers, the locked accesses are not counted */
+    uint32_t busy_cycles;               /* CPU cycles the device held the bus */
+    uint32_t wait_cycles;               /* CPU cycles from the requests to the start, summed */
+    uint32_t max_wait_cycles;           /* longest wait */
+} spi_bus_stats_struct;
+
+/* device structure, one per chip select */
+typedef struct {
+    uint32_t cs_port;                   /* GPIO port of the chip select */
+    uint32_t cs_pin;                    /* GPIO pin of the chip select */
+    uint32_t prescale;                  /* SPI_PSC_x, clock of the device */
+    uint32_t clock_polarity_phase;      /* SPI_CK_PL_x_PH_x, mode of the device */
+    uint8_t priority;                   /* the transfers of higher priority go first */
+    spi_bus_stats_struct stats;         /* statistics */
+} spi_bus_device_struct;
+
+/* transfer structure: an optional command, then the data, with the chip select low */
+typedef struct spi_bus_transfer {
+    spi_bus_device_struct *device;      /* device addressed */
+    const uint8_t *command;             /* bytes sent first, the bytes received are dropped */
+    uint16_t command_length;            /* bytes of the command, 0 if none */
+    const uint8_t *tx;                  /* data sent, NULL to send 0xFF */
+    uint8_t *rx;                        /* data received, NULL to drop it */
+    uint16_t length;                    /* bytes of the data */
+    spi_bus_callback_func callback;     /* called when the transfer is done, or NULL */
+    void *context;                      /* parameter of the callback */
+    struct spi_bus_transfer *next;      /* next transfer of the queue */
+    uint32_t queued;                    /* cycle counter when the transfer was submitted */
+    uint32_t started;                   /* cycle counter when the transfer started */
+    __IO uint8_t done;                  /* set when the transfer is done */
+} spi_bus_transfer_struct;
+
+/* function declarations */
+/* configure SPI0 and the DMA channels of the bus */
+void spi_bus_init(void);
+/* configure the chip select and the settings of a device */
+void spi_bus_device_init(spi_bus_device_struct *device, uint32_t cs_port, uint32_t cs_pin,
+                         uint32_t prescale, uint32_t clock_polarity_phase, uint8_t priority);
+/* queue a transfer, it runs with DMA when the bus is free */
+ErrStatus spi_bus_submit(spi_bus_transfer_struct *transfer);
+/* wait for the bus and select a device for direct accesses */
+void spi_bus_lock(spi_bus_device_struct *device);
+/* deselect the device of spi_bus_lock() and release the bus */
+void spi_bus_unlock(void);
+/* read with DMA while the bus is locked */
+ErrStatus spi_bus_dma_read(uint8_t *prx, uint16_t length, spi_bus_callback_func callback, void *context);
+/* check whether a transfer or a locked access uses the bus */
+FlagStatus spi_bus_busy(void);
+/* end a DMA phase, called from the DMA RX channel interrupt */
+void spi_bus_dma_complete(void);
+/* clear the statistics of a device */
+void spi_bus_stats_clear(spi_bus_device_struct *device);
+
+#endif /* SPI_BUS_H */
@@ -0,0 +1,359 @@
+/*!
+    \file    spi_slave.c
+    \brief   SPI1 slave receiver: DMA ring, frames ended by NSS through EXTI, zero-copy frame handoff
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "spi_slave.h"
+#include <string.h>
+
+/* pending frame structure */
+typedef struct {
+    uint32_t start;                     /* bytes received before the frame */
+    uint32_t length;                    /* bytes of the frame */
+} spi_slave_entry_struct;
+
+/* ring written by the DMA channel in circular mode */
+static uint8_t slave_ring[SPI_SLAVE_RING_SIZE];
+/* laps of the DMA channel, bytes received before the frame in progress */
+static __IO uint32_t ring_laps = 0U;
+static uint32_t frame_start = 0U;
+
+/* frames waiting for the application: frame_head is written by the NSS interrupt only and
+   frame_tail by the application only, so no lock is needed */
+static spi_slave_entry_struct slave_frames[SPI_SLAVE_FRAMES];
+static __IO uint32_t frame_head = 0U;
+static __IO uint32_t frame_tail = 0U;
+
+static spi_slave_stats_struct slave_stats;
+
+static uint32_t spi_slave_position(void);
+static void spi_slave_ring_overrun(void);
+
+/*!
+    \brief      configure SPI1 as a receive-only slave and start receiving into the ring, the
+                data of a frame is received by the DMA and NSS going high ends the frame
+    \param[in]  clock_polarity_phase: mode of the host, SPI_CK_PL_x_PH_x
+    \param[out] none
+    \retval     none
+*/
+void spi_slave_init(uint32_t clock_polarity_phase)
+{
+    spi_parameter_struct spi_init_struct;
+    dma_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_GPIOC);
+    rcu_periph_clock_enable(RCU_GPIOD);
+    rcu_periph_clock_enable(RCU_SYSCFG);
+    rcu_periph_clock_enable(RCU_SPI1);
+    rcu_periph_clock_enable(RCU_DMA0);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    /* SPI1_SCK(PC6), SPI1_MOSI(PD14) and SPI1_NSS(PD13) GPIO pin configuration, NSS is pulled
+       high so that the slave is not selected without host */
+    gpio_af_set(GPIOC, GPIO_AF_4, GPIO_PIN_6);
+    gpio_mode_set(GPIOC, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_6);
+    gpio_output_options_set(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_6);
+
+    gpio_af_set(GPIOD, GPIO_AF_4, GPIO_PIN_13 | GPIO_PIN_14);
+    gpio_mode_set(GPIOD, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_14);
+    gpio_mode_set(GPIOD, GPIO_MODE_AF, GPIO_PUPD_PULLUP, GPIO_PIN_13);
+    gpio_output_options_set(GPIOD, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 | GPIO_PIN_14);
+
+    /* SPI parameter configuration, the host gives the clock */
+    spi_i2s_deinit(SPI_SLAVE_SPI);
+    spi_init_struct.trans_mode           = SPI_TRANSMODE_RECEIVEONLY;
+    spi_init_struct.device_mode          = SPI_SLAVE;
+    spi_init_struct.frame_size           = SPI_FRAMESIZE_8BIT;
+    spi_init_struct.clock_polarity_phase = clock_polarity_phase;
+    spi_init_struct.nss                  = SPI_NSS_HARD;
+    spi_init_struct.prescale             = SPI_PSC_2;
+    spi_init_struct.endian               = SPI_ENDIAN_MSB;
+    spi_init(SPI_SLAVE_SPI, &spi_init_struct);
+
+    /* the DMA channel walks the ring in circular mode and is never stopped */
+    dma_deinit(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL);
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.request      = DMA_REQUEST_SPI1_RX;
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)slave_ring;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+    dma_init_struct.number       = SPI_SLAVE_RING_SIZE;
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI_SLAVE_SPI);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL, &dma_init_struct);
+    dma_circulation_enable(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL);
+    dma_memory_to_memory_disable(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL);
+    dmamux_synchronization_disable(SPI_SLAVE_DMA_MUX_CHANNEL);
+    dma_interrupt_enable(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL, DMA_INT_FTF);
+
+    ring_laps = 0U;
+    frame_start = 0U;
+    frame_head = 0U;
+    frame_tail = 0U;
+    spi_slave_stats_clear();
+
+    dma_channel_enable(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL);
+    spi_dma_enable(SPI_SLAVE_SPI, SPI_DMA_RECEIVE);
+    spi_i2s_interrupt_enable(SPI_SLAVE_SPI, SPI_I2S_INT_ERR);
+
+    /* connect the EXTI line to NSS, the rising edge ends a frame */
+    syscfg_exti_line_config(EXTI_SOURCE_GPIOD, EXTI_SOURCE_PIN13);
+    exti_init(SPI_SLAVE_NSS_EXTI_LINE, EXTI_INTERRUPT, EXTI_TRIG_RISING);
+    exti_interrupt_flag_clear(SPI_SLAVE_NSS_EXTI_LINE);
+
+    spi_enable(SPI_SLAVE_SPI);
+}
+
+/*!
+    \brief      get the oldest frame received, its data stays in the ring until
+                spi_slave_frame_release() and the frames overwritten meanwhile are dropped
+    \param[in]  none
+    \param[out] frame: the frame, in one part or in two if it wraps at the end of the ring
+    \retval     SUCCESS, or ERROR if no frame is waiting
+*/
+ErrStatus spi_slave_frame_get(spi_slave_frame_struct *frame)
+{
+    spi_slave_entry_struct *entry;
+    uint32_t position, offset;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    position = spi_slave_position();
+    __set_PRIMASK(primask);
+
+    while(frame_tail != frame_head) {
+        entry = &slave_frames[frame_tail % SPI_SLAVE_FRAMES];
+        if((position - entry->start) <= SPI_SLAVE_RING_SIZE) {
+            /* the offset in the ring follows from the running count, the size is a power of 2 */
+            offset = entry->start % SPI_SLAVE_RING_SIZE;
+            frame->data = &slave_ring[offset];
+            frame->start = entry->start;
+            if((offset + entry->length) > SPI_SLAVE_RING_SIZE) {
+                frame->length = SPI_SLAVE_RING_SIZE - offset;
+                frame->wrap_data = slave_ring;
+                frame->wrap_length = entry->length - frame->length;
+            } else {
+                frame->length = entry->length;
+                frame->wrap_data = NULL;
+                frame->wrap_length = 0U;
+            }
+            return SUCCESS;
+        }
+        /* the DMA went a whole ring past the start of the frame */
+        spi_slave_ring_overrun();
+        frame_tail++;
+    }
+    return ERROR;
+}
+
+/*!
+    \brief      release the frame returned by spi_slave_frame_get(), its bytes of the ring
+                can be received again
+    \param[in]  frame: the frame
+    \param[out] none
+    \retval     SUCCESS, or ERROR if the frame is not the oldest one or if the DMA overwrote it
+                while it was used, the result of its processing is then to be dropped
+*/
+ErrStatus spi_slave_frame_release(spi_slave_frame_struct *frame)
+{
+    uint32_t position;
+    uint32_t primask;
+
+    if((frame_tail == frame_head) || (frame->start != slave_frames[frame_tail % SPI_SLAVE_FRAMES].start)) {
+        return ERROR;
+    }
+    primask = __get_PRIMASK();
+    __disable_irq();
+    position = spi_slave_position();
+    __set_PRIMASK(primask);
+
+    frame_tail++;
+    if((position - frame->start) > SPI_SLAVE_RING_SIZE) {
+        spi_slave_ring_overrun();
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      get the number of frames waiting
+    \param[in]  none
+    \param[out] none
+    \retval     frames received and not released, the overwritten ones included
+*/
+uint32_t spi_slave_frame_count(void)
+{
+    return frame_head - frame_tail;
+}
+
+/*!
+    \brief      get the statistics of the receiver
+    \param[in]  none
+    \param[out] stats: statistics
+    \retval     none
+*/
+void spi_slave_stats_get(spi_slave_stats_struct *stats)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = slave_stats;
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      clear the statistics of the receiver
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_slave_stats_clear(void)
+{
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    memset(&slave_stats, 0, sizeof(slave_stats));
+    __set_PRIMASK(primask);
+}
+
+/*!
+    \brief      end a frame, called from the EXTI interrupt of the NSS line: the bytes received
+                since the previous rising edge make the frame
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_slave_nss_irq(void)
+{
+    spi_slave_entry_struct *entry;
+    uint32_t end, length, timeout = 100U;
+
+    /* the DMA reads the last byte of the frame from SPI1 before the position is taken */
+    while((SET == spi_i2s_flag_get(SPI_SLAVE_SPI, SPI_FLAG_RBNE)) && (0U != timeout)) {
+        timeout--;
+    }
+    end = spi_slave_position();
+    length = end - frame_start;
+    if(0U == length) {
+        /* a select without clocks */
+        return;
+    }
+    slave_stats.frames++;
+    slave_stats.bytes += length;
+    if(length > slave_stats.max_frame) {
+        slave_stats.max_frame = length;
+    }
+
+    if(length > SPI_SLAVE_RING_SIZE) {
+        /* the start of the frame is already overwritten */
+        slave_stats.ring_overruns++;
+    } else if((frame_head - frame_tail) >= SPI_SLAVE_FRAMES) {
+        slave_stats.queue_overruns++;
+    } else {
+        entry = &slave_frames[frame_head % SPI_SLAVE_FRAMES];
+        entry->start = frame_start;
+        entry->length = length;
+        frame_head++;
+    }
+    frame_start = end;
+}
+
+/*!
+    \brief      count the laps of the ring, called from the DMA channel interrupt once its full
+                transfer finish flag is cleared
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_slave_dma_irq(void)
+{
+    ring_laps++;
+}
+
+/*!
+    \brief      count the overruns, called from the SPI1 interrupt when the receive overrun
+                error flag is set
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void spi_slave_error_irq(void)
+{
+    /* reading the data then the status clears the flag, the byte read is lost anyway */
+    spi_i2s_data_receive(SPI_SLAVE_SPI);
+    (void)SPI_STAT(SPI_SLAVE_SPI);
+    slave_stats.spi_overruns++;
+}
+
+/*!
+    \brief      get the bytes received since the start, called from the interrupts of the
+                receiver or with the interrupts disabled
+    \param[in]  none
+    \param[out] none
+    \retval     running count of the bytes written by the DMA in the ring
+*/
+static uint32_t spi_slave_position(void)
+{
+    uint32_t count, laps;
+
+    count = SPI_SLAVE_RING_SIZE - dma_transfer_number_get(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL);
+    laps = ring_laps;
+    /* the DMA restarted at the beginning of the ring and its interrupt is pending */
+    if((SET == dma_interrupt_flag_get(SPI_SLAVE_DMA, SPI_SLAVE_DMA_CHANNEL, DMA_INT_FLAG_FTF)) &&
+            (count < (SPI_SLAVE_RING_SIZE / 2U))) {
+        laps++;
+    }
+    return laps * SPI_SLAVE_RING_SIZE + count;
+}
+
+/*!
+    \brief      count a frame overwritten in the ring, from the application
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void spi_slave_ring_overrun(void)
+{
+    uint32_t primask;
+
+    /* the NSS interrupt updates the same counter */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    slave_stats.ring_overruns++;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,94 @@
+/*!
+    \file    spi_slave.h
+    \brief   the header file of the SPI1 slave receiver with a DMA ring and frames ended by NSS
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef SPI_SLAVE_H
+#define SPI_SLAVE_H
+
+#include "gd32e502.h"
+
+/* SPI1 receives the host in slave mode: SCK(PC6), MOSI(PD14) and NSS(PD13), no MISO */
+#define SPI_SLAVE_SPI                 SPI1
+/* DMA channel of the ring, the lowest channel wins the requests of the same priority */
+#define SPI_SLAVE_DMA                 DMA0
+#define SPI_SLAVE_DMA_CHANNEL         DMA_CH0
+#define SPI_SLAVE_DMA_MUX_CHANNEL     DMAMUX_MULTIPLEXER_CH0
+#define SPI_SLAVE_DMA_IRQn            DMA0_Channel0_IRQn
+/* the rising edge of NSS ends a frame */
+#define SPI_SLAVE_NSS_EXTI_LINE       EXTI_13
+#define SPI_SLAVE_NSS_IRQn            EXTI10_15_IRQn
+#define SPI_SLAVE_IRQn                SPI1_IRQn
+
+#define SPI_SLAVE_RING_SIZE           4096U               /* bytes of the DMA ring, a power of 2 */
+#define SPI_SLAVE_FRAMES              16U                 /* frames waiting for the application, a power of 2 */
+
+/* received frame structure, the data stays in the ring until the frame is released */
+typedef struct {
+    uint8_t *data;                      /* first part of the frame in the ring */
+    uint32_t length;                    /* bytes of the first part */
+    uint8_t *wrap_data;                 /* part wrapped to the start of the ring, NULL if none */
+    uint32_t wrap_length;               /* bytes of the wrapped part */
+    uint32_t start;                     /* bytes received before the frame, a running count */
+} spi_slave_frame_struct;
+
+/* receiver statistics structure */
+typedef struct {
+    uint32_t frames;                    /* frames ended by NSS */
+    uint32_t bytes;                     /* bytes of the frames */
+    uint32_t max_frame;                 /* longest frame */
+    uint32_t spi_overruns;              /* bytes lost because the DMA did not read SPI1 in time */
+    uint32_t ring_overruns;             /* frames overwritten in the ring before their release, or longer than the ring */
+    uint32_t queue_overruns;            /* frames dropped because SPI_SLAVE_FRAMES frames were waiting */
+} spi_slave_stats_struct;
+
+/* function declarations */
+/* configure SPI1 as a receive-only slave and start receiving into the ring */
+void spi_slave_init(uint32_t clock_polarity_phase);
+/* get the oldest frame received, its data stays in the ring */
+ErrStatus spi_slave_frame_get(spi_slave_frame_struct *frame);
+/* release the frame returned by spi_slave_frame_get() */
+ErrStatus spi_slave_frame_release(spi_slave_frame_struct *frame);
+/* get the number of frames waiting */
+uint32_t spi_slave_frame_count(void);
+/* get the statistics of the receiver */
+void spi_slave_stats_get(spi_slave_stats_struct *stats);
+/* clear the statistics of the receiver */
+void spi_slave_stats_clear(void);
+/* end a frame, called from the EXTI interrupt of the NSS line */
+void spi_slave_nss_irq(void);
+/* count the laps of the ring, called from the DMA channel interrupt */
+void spi_slave_dma_irq(void);
+/* count the overruns, called from the SPI1 interrupt */
+void spi_slave_error_irq(void);
+
+#endif /* SPI_SLAVE_H */
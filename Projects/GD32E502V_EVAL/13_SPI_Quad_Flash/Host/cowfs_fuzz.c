@@ -0,0 +1,412 @@
+/*!
+    \file    cowfs_fuzz.c
+    \brief   power cut fuzzer of the copy-on-write file system on the simulated flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include "cowfs.h"
+#include "flash_cache.h"
+#include "gd25qxx.h"
+#include "host_spi.h"
+
+#define FS_ADDRESS              0x100000U
+#define FS_BLOCKS               32U
+#define FUZZ_FILES              3U
+#define FUZZ_FILE_SIZE          (3U * COWFS_BLOCK_SIZE)
+#define FUZZ_PCLK_HZ            1000000U            /* slow bus, a busy flash needs few polls */
+
+/* step of the scenario: a file written and closed, or removed */
+typedef struct {
+    const char *name;                   /* name of the file */
+    uint8_t mode;                       /* open mode, 0 to remove the file */
+    uint32_t position;                  /* position of the write */
+    uint32_t length;                    /* bytes written */
+} fuzz_step_struct;
+
+/* expected content of the files */
+typedef struct {
+    uint8_t exists[FUZZ_FILES];
+    uint32_t size[FUZZ_FILES];
+    uint8_t data[FUZZ_FILES][FUZZ_FILE_SIZE];
+} fuzz_state_struct;
+
+static void fuzz_power_fail(void);
+
+static const char *const fuzz_names[FUZZ_FILES] = {"a", "b", "c"};
+/* each path of a commit is cut: the creation of a file, the data and index blocks, the metadata
+   revisions, the erase of the second metadata block (step 6, revision 9) and the removal */
+static const fuzz_step_struct fuzz_steps[] = {
+    {"a", COWFS_MODE_WRITE, 0U, 300U},                          /* created, one data block */
+    {"b", COWFS_MODE_WRITE, 0U, 6000U},                         /* created, two data blocks */
+    {"a", COWFS_MODE_READ | COWFS_MODE_WRITE, 100U, 50U},       /* overwritten in place */
+    {"b", COWFS_MODE_WRITE | COWFS_MODE_TRUNCATE, 0U, 10U},     /* truncated */
+    {"a", 0U, 0U, 0U},                                          /* removed */
+    {"b", COWFS_MODE_WRITE, 10U, 20U},                          /* appended */
+    {"c", COWFS_MODE_WRITE, 0U, 4097U},                         /* created, crossing a block */
+    {"c", COWFS_MODE_WRITE, 4000U, 200U}                        /* overwritten across two blocks */
+};
+#define FUZZ_STEPS              (sizeof(fuzz_steps) / sizeof(fuzz_steps[0]))
+
+static const gd25qxx_sim_port_struct fuzz_port = {
+    FUZZ_PCLK_HZ, host_spi_prescaler, host_spi_quad, fuzz_power_fail
+};
+
+static jmp_buf fuzz_jump;
+static volatile uint32_t fuzz_step = 0U;
+/* state after each step, and after the creation which starts the step */
+static fuzz_state_struct fuzz_after[FUZZ_STEPS + 1U];
+static fuzz_state_struct fuzz_created[FUZZ_STEPS];
+static fuzz_state_struct fuzz_found;
+static uint8_t fuzz_buffer[FUZZ_FILE_SIZE];
+static cowfs_file_struct fuzz_file;
+
+static void power_on(void);
+static uint8_t pattern(uint32_t step, uint32_t offset);
+static uint32_t name_index(const char *name);
+static void model_build(void);
+static ErrStatus step_run(uint32_t step);
+static ErrStatus steps_run(uint32_t first);
+static ErrStatus state_read(fuzz_state_struct *state);
+static uint32_t state_equal(const fuzz_state_struct *a, const fuzz_state_struct *b);
+static uint32_t blocks_check(const fuzz_state_struct *state);
+static uint32_t cut_check(uint32_t cells, uint32_t *step);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+int main(void)
+{
+    gd25qxx_sim_stats_struct stats;
+    uint32_t cells, start, cut, step = 0U, failed = 0U;
+    uint32_t cuts[FUZZ_STEPS];
+
+    model_build();
+    gd25qxx_sim_init(&fuzz_port);
+    power_on();
+
+    /* the run without cut gives the number of bytes programmed and erased by the scenario */
+    cowfs_format(FS_ADDRESS, FS_BLOCKS);
+    gd25qxx_sim_stats_get(&stats);
+    start = stats.cells;
+    if((ERROR == steps_run(0U)) || (ERROR == state_read(&fuzz_found)) ||
+            (0U == state_equal(&fuzz_found, &fuzz_after[FUZZ_STEPS]))) {
+        printf("the scenario fails without power cut\n");
+        return 1;
+    }
+    gd25qxx_sim_stats_get(&stats);
+    cells = stats.cells - start;
+
+    /* cut the power after each byte programmed or erased */
+    memset(cuts, 0, sizeof(cuts));
+    for(cut = 1U; cut <= cells; cut++) {
+        if(0U != cut_check(cut, &step)) {
+            failed++;
+            if(failed >= 10U) {
+                break;
+            }
+        }
+        cuts[step]++;
+    }
+
+    printf("%u bytes programmed or erased by the scenario, a power cut after each one\n", cells);
+    for(cut = 0U; cut < FUZZ_STEPS; cut++) {
+        printf("step %u, %s %s: %u cuts\n", cut, (0U != fuzz_steps[cut].mode) ? "write" : "remove",
+               fuzz_steps[cut].name, cuts[cut]);
+    }
+    printf("%u failed\n", failed);
+    return (int)failed;
+}
+
+/*!
+    \brief      power cut callback of the simulated flash, back to the fuzzer
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void fuzz_power_fail(void)
+{
+    longjmp(fuzz_jump, 1);
+}
+
+/*!
+    \brief      power the flash and SPI0 again and initialize the driver as a reset does
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void power_on(void)
+{
+    gd25qxx_sim_power_on();
+    host_spi_reset();
+    spi_flash_init();
+    flash_cache_invalidate_all();
+}
+
+/*!
+    \brief      get a byte written by a step
+    \param[in]  step: the step
+    \param[in]  offset: offset of the byte in the file
+    \param[out] none
+    \retval     the byte
+*/
+static uint8_t pattern(uint32_t step, uint32_t offset)
+{
+    return (uint8_t)((step * 59U) + (offset * 7U) + (offset >> 8) + 1U);
+}
+
+/*!
+    \brief      get the index of a file name
+    \param[in]  name: the name
+    \param[out] none
+    \retval     index in fuzz_names
+*/
+static uint32_t name_index(const char *name)
+{
+    uint32_t index;
+
+    for(index = 0U; (index < (FUZZ_FILES - 1U)) && (0 != strcmp(name, fuzz_names[index])); index++) {
+    }
+    return index;
+}
+
+/*!
+    \brief      compute the expected state after each step, and after the creation of a file
+                which is committed before its data
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_build(void)
+{
+    const fuzz_step_struct *step;
+    fuzz_state_struct *state;
+    uint32_t index, file, offset;
+
+    memset(&fuzz_after[0], 0, sizeof(fuzz_after[0]));
+    for(index = 0U; index < FUZZ_STEPS; index++) {
+        step = &fuzz_steps[index];
+        file = name_index(step->name);
+        fuzz_created[index] = fuzz_after[index];
+        state = &fuzz_created[index];
+        if((0U != step->mode) && (0U == state->exists[file])) {
+            state->exists[file] = 1U;
+            state->size[file] = 0U;
+        }
+        fuzz_after[index + 1U] = *state;
+        state = &fuzz_after[index + 1U];
+        if(0U == step->mode) {
+            state->exists[file] = 0U;
+            state->size[file] = 0U;
+            continue;
+        }
+        if(0U != (step->mode & COWFS_MODE_TRUNCATE)) {
+            state->size[file] = 0U;
+        }
+        for(offset = step->position; offset < (step->position + step->length); offset++) {
+            state->data[file][offset] = pattern(index, offset);
+        }
+        if(state->size[file] < offset) {
+            state->size[file] = offset;
+        }
+    }
+}
+
+/*!
+    \brief      run a step of the scenario on the file system
+    \param[in]  step: the step
+    \param[out] none
+    \retval     SUCCESS or ERROR if a call failed
+*/
+static ErrStatus step_run(uint32_t step)
+{
+    const fuzz_step_struct *s = &fuzz_steps[step];
+    uint32_t offset;
+
+    fuzz_step = step;
+    if(0U == s->mode) {
+        return cowfs_remove(s->name);
+    }
+    for(offset = 0U; offset < s->length; offset++) {
+        fuzz_buffer[offset] = pattern(step, s->position + offset);
+    }
+    if((ERROR == cowfs_open(&fuzz_file, s->name, s->mode)) || (ERROR == cowfs_seek(&fuzz_file, s->position)) ||
+            (s->length != cowfs_write(&fuzz_file, fuzz_buffer, s->length))) {
+        return ERROR;
+    }
+    return cowfs_close(&fuzz_file);
+}
+
+/*!
+    \brief      run the steps of the scenario from one of them to the end
+    \param[in]  first: the first step to run
+    \param[out] none
+    \retval     SUCCESS or ERROR if a call failed
+*/
+static ErrStatus steps_run(uint32_t first)
+{
+    uint32_t step;
+
+    for(step = first; step < FUZZ_STEPS; step++) {
+        if(ERROR == step_run(step)) {
+            printf("step %u fails\n", step);
+            return ERROR;
+        }
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      read the files of the file system
+    \param[in]  none
+    \param[out] state: the files found
+    \retval     SUCCESS or ERROR if a file is larger than expected or cannot be read
+*/
+static ErrStatus state_read(fuzz_state_struct *state)
+{
+    uint32_t file;
+
+    memset(state, 0, sizeof(*state));
+    for(file = 0U; file < FUZZ_FILES; file++) {
+        if(ERROR == cowfs_open(&fuzz_file, fuzz_names[file], COWFS_MODE_READ)) {
+            continue;
+        }
+        if(fuzz_file.size > FUZZ_FILE_SIZE) {
+            return ERROR;
+        }
+        state->exists[file] = 1U;
+        state->size[file] = fuzz_file.size;
+        if(fuzz_file.size != cowfs_read(&fuzz_file, state->data[file], fuzz_file.size)) {
+            return ERROR;
+        }
+        cowfs_close(&fuzz_file);
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      compare two states of the files
+    \param[in]  a: a state
+    \param[in]  b: the other state
+    \param[out] none
+    \retval     1 if the files are the same, 0 otherwise
+*/
+static uint32_t state_equal(const fuzz_state_struct *a, const fuzz_state_struct *b)
+{
+    uint32_t file;
+
+    for(file = 0U; file < FUZZ_FILES; file++) {
+        if((a->exists[file] != b->exists[file]) || (a->size[file] != b->size[file]) ||
+                (0 != memcmp(a->data[file], b->data[file], a->size[file]))) {
+            return 0U;
+        }
+    }
+    return 1U;
+}
+
+/*!
+    \brief      check that the blocks which are not free are exactly the blocks of the files
+    \param[in]  state: the files of the file system
+    \param[out] none
+    \retval     1 if a block is lost or shared, 0 otherwise
+*/
+static uint32_t blocks_check(const fuzz_state_struct *state)
+{
+    cowfs_stats_struct stats;
+    uint32_t file, used = 0U;
+
+    for(file = 0U; file < FUZZ_FILES; file++) {
+        if(0U != state->size[file]) {
+            /* the data blocks and the index block */
+            used += ((state->size[file] + COWFS_BLOCK_SIZE - 1U) / COWFS_BLOCK_SIZE) + 1U;
+        }
+    }
+    cowfs_stats_get(&stats);
+    return (stats.free_blocks != (FS_BLOCKS - 2U - used)) ? 1U : 0U;
+}
+
+/*!
+    \brief      run the scenario with a power cut, remount and check that each file is in its
+                last committed state, then that the scenario completes from there
+    \param[in]  cells: bytes programmed or erased before the cut
+    \param[out] step: the step the cut interrupted
+    \retval     1 if the check failed, 0 otherwise
+*/
+static uint32_t cut_check(uint32_t cells, uint32_t *step)
+{
+    uint32_t cut_step, next;
+
+    power_on();
+    cowfs_format(FS_ADDRESS, FS_BLOCKS);
+    gd25qxx_sim_power_cut_set(cells);
+    if(0 == setjmp(fuzz_jump)) {
+        steps_run(0U);
+        gd25qxx_sim_power_cut_set(GD25QXX_SIM_NO_CUT);
+        printf("cut %u: the scenario completes\n", cells);
+        return 1U;
+    }
+
+    /* the commit in progress is complete or not done at all, a new file can be committed empty */
+    cut_step = fuzz_step;
+    *step = cut_step;
+    power_on();
+    if((ERROR == cowfs_mount(FS_ADDRESS, FS_BLOCKS)) || (ERROR == state_read(&fuzz_found))) {
+        printf("cut %u in step %u: the file system cannot be mounted or read\n", cells, cut_step);
+        return 1U;
+    }
+    if(0U != state_equal(&fuzz_found, &fuzz_after[cut_step + 1U])) {
+        next = cut_step + 1U;
+    } else if((0U != state_equal(&fuzz_found, &fuzz_after[cut_step])) ||
+              (0U != state_equal(&fuzz_found, &fuzz_created[cut_step]))) {
+        next = cut_step;
+    } else {
+        printf("cut %u in step %u: the files are not in a committed state\n", cells, cut_step);
+        return 1U;
+    }
+    if(0U != blocks_check(&fuzz_found)) {
+        printf("cut %u in step %u: the free blocks do not match the files\n", cells, cut_step);
+        return 1U;
+    }
+
+    /* the file system is still writable */
+    if((ERROR == steps_run(next)) || (ERROR == state_read(&fuzz_found)) ||
+            (0U == state_equal(&fuzz_found, &fuzz_after[FUZZ_STEPS])) || (0U != blocks_check(&fuzz_found))) {
+        printf("cut %u in step %u: the scenario does not complete after the cut\n", cells, cut_step);
+        return 1U;
+    }
+    return 0U;
+}
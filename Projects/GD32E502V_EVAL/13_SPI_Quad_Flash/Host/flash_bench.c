@@ -0,0 +1,326 @@
+/*!
+    \file    flash_bench.c
+    \brief   benchmark of the flash driver in the virtual time of the simulated GD25Q16
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "gd25qxx.h"
+#include "flash_cache.h"
+#include "host_spi.h"
+
+#define SFLASH_ID               0xC84015U
+#define BENCH_ADDRESS           0x010000U
+#define BENCH_BUFFER_SIZE       4096U
+#define SMALL_READ_SIZE         16U
+#define SMALL_READS             1000U
+#define ARRAY_SIZE              0x200000U           /* the whole GD25Q16 */
+#define ARRAY_STEP              0x1F000U            /* sectors spread over the whole array */
+#define SUSPEND_ERASE_ADDRESS   0x020000U           /* block erased while ARRAY_STEP is read */
+#define SUSPEND_LATENCY_US      200U                /* time a read during the erase adds, tSUS and the commands */
+#define CACHE_ADDRESS           0x030000U           /* sector read through the cache during its erase */
+#define CACHE_READ_SIZE         32U
+
+static uint8_t bench_buffer[BENCH_BUFFER_SIZE];
+static uint8_t read_buffer[BENCH_BUFFER_SIZE];
+
+static void pattern_fill(uint8_t *buffer, uint32_t seed);
+static uint32_t pattern_check(const uint8_t *buffer, uint32_t seed);
+static uint32_t array_check(void);
+static uint32_t method_read(uint32_t method, uint8_t *buffer, uint32_t read_addr);
+static uint32_t suspend_check(void);
+static uint32_t cache_check(void);
+static uint32_t flash_benchmark(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+int main(void)
+{
+    uint32_t failed = 0U;
+    uint32_t flash_id;
+
+    gd25qxx_sim_init(&host_spi_flash_port);
+    if(ERROR == spi_flash_init()) {
+        printf("flash parameters not detected\n");
+        return 1;
+    }
+    flash_id = spi_flash_read_id();
+    if(SFLASH_ID != flash_id) {
+        printf("flash identification 0x%06X, 0x%06X expected\n", flash_id, SFLASH_ID);
+        return 1;
+    }
+    qspi_flash_quad_enable();
+
+    failed += array_check();
+    failed += suspend_check();
+    failed += cache_check();
+    failed += flash_benchmark();
+    return (int)failed;
+}
+
+/*!
+    \brief      fill a buffer with a pattern depending on a seed
+    \param[in]  seed: seed of the pattern
+    \param[out] buffer: BENCH_BUFFER_SIZE bytes
+    \retval     none
+*/
+static void pattern_fill(uint8_t *buffer, uint32_t seed)
+{
+    uint32_t index;
+
+    for(index = 0U; index < BENCH_BUFFER_SIZE; index++) {
+        buffer[index] = (uint8_t)((index * 7U) + (index >> 8) + seed);
+    }
+}
+
+/*!
+    \brief      count the bytes of a buffer differing from the pattern of a seed
+    \param[in]  buffer: BENCH_BUFFER_SIZE bytes
+    \param[in]  seed: seed of the pattern
+    \param[out] none
+    \retval     number of bytes differing
+*/
+static uint32_t pattern_check(const uint8_t *buffer, uint32_t seed)
+{
+    uint32_t index, errors = 0U;
+
+    for(index = 0U; index < BENCH_BUFFER_SIZE; index++) {
+        if(buffer[index] != (uint8_t)((index * 7U) + (index >> 8) + seed)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+/*!
+    \brief      program sectors spread over the whole array, then read them all back: each one
+                keeps its own data
+    \param[in]  none
+    \param[out] none
+    \retval     1 if a sector lost its data, 0 otherwise
+*/
+static uint32_t array_check(void)
+{
+    uint32_t addr, errors = 0U, sectors = 0U;
+
+    for(addr = 0U; addr < ARRAY_SIZE; addr += ARRAY_STEP) {
+        spi_flash_sector_erase(addr);
+        pattern_fill(bench_buffer, addr >> 12);
+        qspi_flash_buffer_write(bench_buffer, addr, BENCH_BUFFER_SIZE);
+        sectors++;
+    }
+    for(addr = 0U; addr < ARRAY_SIZE; addr += ARRAY_STEP) {
+        qspi_flash_buffer_read(read_buffer, addr, BENCH_BUFFER_SIZE);
+        errors += pattern_check(read_buffer, addr >> 12);
+    }
+    printf("array: %u sectors over 2 MB programmed and read back, %u errors\n", sectors, errors);
+    return (0U != errors) ? 1U : 0U;
+}
+
+/*!
+    \brief      read a flash area with the single, the quad output or the quad I/O read
+    \param[in]  method: 0, 1 or 2
+    \param[in]  read_addr: flash's internal address to read from
+    \param[out] buffer: BENCH_BUFFER_SIZE bytes
+    \retval     virtual time of the read in us
+*/
+static uint32_t method_read(uint32_t method, uint8_t *buffer, uint32_t read_addr)
+{
+    uint32_t start = gd25qxx_sim_time_us();
+
+    if(0U == method) {
+        spi_flash_buffer_read(buffer, read_addr, BENCH_BUFFER_SIZE);
+    } else if(1U == method) {
+        qspi_flash_buffer_read(buffer, read_addr, BENCH_BUFFER_SIZE);
+    } else {
+        qspi_flash_io_read(buffer, read_addr, BENCH_BUFFER_SIZE);
+    }
+    return gd25qxx_sim_time_us() - start;
+}
+
+/*!
+    \brief      read a programmed sector with each read while a block erase is in progress: the
+                reads suspend the erase, so they return the data without waiting for its end,
+                and the erase completes after them
+    \param[in]  none
+    \param[out] none
+    \retval     1 if a read failed or waited, 0 otherwise
+*/
+static uint32_t suspend_check(void)
+{
+    uint32_t idle_us[3], read_us[3], errors = 0U, slow = 0U;
+    uint32_t index;
+
+    for(index = 0U; index < 3U; index++) {
+        idle_us[index] = method_read(index, read_buffer, ARRAY_STEP);
+    }
+    spi_flash_range_erase_step(SUSPEND_ERASE_ADDRESS, SUSPEND_ERASE_ADDRESS + SPI_FLASH_BLOCK64_SIZE);
+    for(index = 0U; index < 3U; index++) {
+        read_us[index] = method_read(index, read_buffer, ARRAY_STEP);
+        errors += pattern_check(read_buffer, ARRAY_STEP >> 12);
+        if(read_us[index] > (idle_us[index] + SUSPEND_LATENCY_US)) {
+            slow++;
+        }
+    }
+    /* the erase was resumed after each read */
+    if(RESET == spi_flash_write_busy()) {
+        errors++;
+    }
+    spi_flash_wait_for_write_end();
+    spi_flash_buffer_read(read_buffer, SUSPEND_ERASE_ADDRESS + SPI_FLASH_BLOCK64_SIZE - BENCH_BUFFER_SIZE,
+                          BENCH_BUFFER_SIZE);
+    for(index = 0U; index < BENCH_BUFFER_SIZE; index++) {
+        if(0xFFU != read_buffer[index]) {
+            errors++;
+        }
+    }
+    printf("read 4 KB during a block erase, us over an idle read: %u single, %u quad output, %u quad I/O, %u errors\n",
+           read_us[0] - idle_us[0], read_us[1] - idle_us[1], read_us[2] - idle_us[2], errors);
+    return ((0U != errors) || (0U != slow)) ? 1U : 0U;
+}
+
+/*!
+    \brief      read a sector through the cache before, during and after its erase: the lines
+                read while the erase is suspended are dropped when it ends
+    \param[in]  none
+    \param[out] none
+    \retval     1 if the cache returned stale data, 0 otherwise
+*/
+static uint32_t cache_check(void)
+{
+    uint32_t index, before = 0U, after = 0U;
+
+    spi_flash_sector_erase(CACHE_ADDRESS);
+    pattern_fill(bench_buffer, 0x5AU);
+    spi_flash_buffer_write(bench_buffer, CACHE_ADDRESS, BENCH_BUFFER_SIZE);
+    flash_cache_read(read_buffer, CACHE_ADDRESS, CACHE_READ_SIZE);
+    before = (0U != memcmp(read_buffer, bench_buffer, CACHE_READ_SIZE)) ? 1U : 0U;
+
+    /* the read during the erase sees the sector as the suspended erase left it */
+    spi_flash_sector_erase_start(CACHE_ADDRESS);
+    flash_cache_read(read_buffer, CACHE_ADDRESS, CACHE_READ_SIZE);
+    spi_flash_wait_for_write_end();
+
+    flash_cache_read(read_buffer, CACHE_ADDRESS, CACHE_READ_SIZE);
+    for(index = 0U; index < CACHE_READ_SIZE; index++) {
+        if(0xFFU != read_buffer[index]) {
+            after++;
+        }
+    }
+    printf("cache: sector read before, during and after its erase, %u stale bytes\n", before + after);
+    return (0U != (before + after)) ? 1U : 0U;
+}
+
+/*!
+    \brief      measure the erase, program and read paths of the driver in the virtual time of
+                the simulated flash, the time of the host does not count
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+static uint32_t flash_benchmark(void)
+{
+    gd25qxx_sim_stats_struct stats;
+    uint32_t start, offset, errors = 0U, failed = 0U;
+    uint32_t erase_us, write_us, qwrite_us, read_us, qread_us, io_read_us, small_us, sector_us, range_us;
+
+    pattern_fill(bench_buffer, 0U);
+
+    /* program a sector with the single and the quad page program */
+    start = gd25qxx_sim_time_us();
+    spi_flash_sector_erase(BENCH_ADDRESS);
+    erase_us = gd25qxx_sim_time_us() - start;
+    start = gd25qxx_sim_time_us();
+    spi_flash_buffer_write(bench_buffer, BENCH_ADDRESS, BENCH_BUFFER_SIZE);
+    write_us = gd25qxx_sim_time_us() - start;
+    spi_flash_sector_erase(BENCH_ADDRESS + BENCH_BUFFER_SIZE);
+    start = gd25qxx_sim_time_us();
+    qspi_flash_buffer_write(bench_buffer, BENCH_ADDRESS + BENCH_BUFFER_SIZE, BENCH_BUFFER_SIZE);
+    qwrite_us = gd25qxx_sim_time_us() - start;
+
+    /* read it back with each read */
+    start = gd25qxx_sim_time_us();
+    spi_flash_buffer_read(read_buffer, BENCH_ADDRESS, BENCH_BUFFER_SIZE);
+    read_us = gd25qxx_sim_time_us() - start;
+    errors += pattern_check(read_buffer, 0U);
+    start = gd25qxx_sim_time_us();
+    qspi_flash_buffer_read(read_buffer, BENCH_ADDRESS + BENCH_BUFFER_SIZE, BENCH_BUFFER_SIZE);
+    qread_us = gd25qxx_sim_time_us() - start;
+    errors += pattern_check(read_buffer, 0U);
+    qspi_flash_continuous_read_enable();
+    start = gd25qxx_sim_time_us();
+    qspi_flash_io_read(read_buffer, BENCH_ADDRESS + BENCH_BUFFER_SIZE, BENCH_BUFFER_SIZE);
+    io_read_us = gd25qxx_sim_time_us() - start;
+    errors += pattern_check(read_buffer, 0U);
+    start = gd25qxx_sim_time_us();
+    for(offset = 0U; offset < SMALL_READS; offset++) {
+        qspi_flash_io_read(read_buffer, BENCH_ADDRESS + ((offset * 97U) % BENCH_BUFFER_SIZE), SMALL_READ_SIZE);
+    }
+    small_us = gd25qxx_sim_time_us() - start;
+    qspi_flash_continuous_read_disable();
+
+    /* a 64 KB block with sector erases and with the range erase */
+    start = gd25qxx_sim_time_us();
+    for(offset = 0U; offset < SPI_FLASH_BLOCK64_SIZE; offset += SPI_FLASH_SECTOR_SIZE) {
+        spi_flash_sector_erase(BENCH_ADDRESS + offset);
+    }
+    sector_us = gd25qxx_sim_time_us() - start;
+    start = gd25qxx_sim_time_us();
+    spi_flash_range_erase(BENCH_ADDRESS, SPI_FLASH_BLOCK64_SIZE);
+    range_us = gd25qxx_sim_time_us() - start;
+
+    gd25qxx_sim_stats_get(&stats);
+    printf("simulated GD25Q16, virtual time: sector erase %u us\n", erase_us);
+    printf("program 4 KB: %u us single, %u us quad\n", write_us, qwrite_us);
+    printf("read 4 KB: %u us single, %u us quad output, %u us quad I/O, %u errors\n",
+           read_us, qread_us, io_read_us, errors);
+    printf("read %u bytes with quad I/O continuous read: %u ns per read\n",
+           SMALL_READ_SIZE, (small_us * 1000U) / SMALL_READS);
+    printf("erase 64 KB: %u us with sector erases, %u us with the range erase\n", sector_us, range_us);
+    printf("%u commands, %u bytes, %u programs, %u erases, %u ignored\n",
+           stats.commands, stats.bytes, stats.programs, stats.erases, stats.ignored);
+
+    /* the data survives each path and the faster paths are faster */
+    if(0U != errors) {
+        failed++;
+    }
+    if((qread_us >= read_us) || (io_read_us >= read_us) || (range_us >= sector_us)) {
+        printf("the quad reads or the range erase are not faster\n");
+        failed++;
+    }
+    return failed;
+}
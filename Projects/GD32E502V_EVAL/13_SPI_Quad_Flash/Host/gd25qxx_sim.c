@@ -0,0 +1,565 @@
+/*!
+    \file    gd25qxx_sim.c
+    \brief   simulated GD25Q16 SPI flash with a timing model, for the host builds
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "gd25qxx_sim.h"
+#include <string.h>
+
+#define SIM_ID               0xC84015U
+#define SIM_SIZE             0x200000U
+#define SIM_PAGE_SIZE        256U
+#define SIM_SECTOR_SIZE      0x1000U
+#define SIM_BLOCK32_SIZE     0x8000U
+#define SIM_BLOCK64_SIZE     0x10000U
+
+/* command set of the GD25Q16 */
+#define SIM_WRSR             0x01U
+#define SIM_WRITE            0x02U
+#define SIM_READ             0x03U
+#define SIM_WRDI             0x04U
+#define SIM_RDSR             0x05U
+#define SIM_WREN             0x06U
+#define SIM_FASTREAD         0x0BU
+#define SIM_SE               0x20U
+#define SIM_WRSR2            0x31U
+#define SIM_QUADWRITE        0x32U
+#define SIM_RDSR2            0x35U
+#define SIM_BE32             0x52U
+#define SIM_RDSFDP           0x5AU
+#define SIM_CE               0x60U
+#define SIM_QUADREAD         0x6BU
+#define SIM_PES              0x75U
+#define SIM_PER              0x7AU
+#define SIM_RDID             0x9FU
+#define SIM_BE               0xC7U
+#define SIM_BE64             0xD8U
+#define SIM_QUADIOREAD       0xEBU
+#define SIM_IGNORED          0x00U    /* the command is not executed */
+
+#define SIM_SR1_WIP          0x01U
+#define SIM_SR1_WEL          0x02U
+#define SIM_SR2_QE           0x02U
+#define SIM_SR2_SUS          0x80U
+
+/* typical times of the GD25Q16 datasheet */
+#define SIM_TPP_US           600U         /* page program */
+#define SIM_TW_US            2000U        /* write status register */
+#define SIM_TSE_US           50000U       /* 4 KB sector erase */
+#define SIM_TBE32_US         150000U      /* 32 KB block erase */
+#define SIM_TBE64_US         250000U      /* 64 KB block erase */
+#define SIM_TCE_US           8000000U     /* chip erase */
+#define SIM_TSUS_US          20U          /* program/erase suspend latency */
+
+/* SFDP area of the GD25Q16: the header, the JEDEC parameter header and the basic table at 0x30 */
+static const uint8_t sim_sfdp[0x54] = {
+    0x53, 0x46, 0x44, 0x50, 0x00, 0x01, 0x00, 0xFF, 0x00, 0x00, 0x01, 0x09, 0x30, 0x00, 0x00, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xE5, 0x20, 0xF9, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x44, 0xEB, 0x08, 0x6B, 0x08, 0x3B, 0x42, 0xBB,
+    0xEE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0x0C, 0x20, 0x0F, 0x52,
+    0x10, 0xD8, 0x00, 0xFF
+};
+
+/* the whole array of the flash */
+static uint8_t sim_array[SIM_SIZE];
+/* data latched by a page program */
+static uint8_t sim_page[SIM_PAGE_SIZE];
+
+/* virtual time, end of the program or erase in progress and time left to a suspended one */
+static uint64_t sim_time_ns = 0U;
+static uint64_t sim_busy_end_ns = 0U;
+static uint64_t sim_remaining_ns = 0U;
+static uint32_t sim_clock_ns = 320U;
+/* the bus driving the flash */
+static const gd25qxx_sim_port_struct *sim_port = NULL;
+/* bytes of the array which can still change before the power is cut */
+static uint32_t sim_cut = GD25QXX_SIM_NO_CUT;
+static uint8_t sim_suspendable = 0U;
+/* area of the program or the erase which can be suspended */
+static uint32_t sim_op_addr = 0U;
+static uint32_t sim_op_size = 0U;
+
+static uint8_t sim_sr1 = 0U;
+static uint8_t sim_sr2 = 0U;
+static uint8_t sim_new_sr1 = 0U;
+static uint8_t sim_new_sr2 = 0U;
+
+/* command in progress */
+static uint8_t sim_selected = 0U;
+static uint8_t sim_crm = 0U;
+static uint8_t sim_instruction = SIM_IGNORED;
+static uint32_t sim_pos = 0U;
+static uint32_t sim_addr = 0U;
+static uint32_t sim_dummy = 0U;
+
+static gd25qxx_sim_stats_struct sim_stats;
+
+static uint8_t sim_command_start(uint8_t instruction);
+static void sim_operation_start(uint32_t time_us, uint8_t suspendable);
+static uint8_t sim_read(uint32_t addr);
+static void sim_program(uint32_t addr, uint8_t data);
+static void sim_erase(uint32_t addr, uint32_t size);
+static void sim_cells_use(uint32_t count);
+
+/*!
+    \brief      reset the simulated flash to an erased GD25Q16 driven by a port
+    \param[in]  port: gives the clock and the mode of the SPI bus, kept by the simulated flash
+    \param[out] none
+    \retval     none
+*/
+void gd25qxx_sim_init(const gd25qxx_sim_port_struct *port)
+{
+    sim_port = port;
+    memset(sim_array, 0xFF, sizeof(sim_array));
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    sim_time_ns = 0U;
+    sim_sr1 = 0U;
+    sim_sr2 = 0U;
+    gd25qxx_sim_power_on();
+}
+
+/*!
+    \brief      power the simulated flash again after a cut: the command and the operation in
+                progress, the write enable and the suspend are lost, the array and the
+                non-volatile bits of the status registers are kept
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gd25qxx_sim_power_on(void)
+{
+    sim_busy_end_ns = sim_time_ns;
+    sim_remaining_ns = 0U;
+    sim_suspendable = 0U;
+    sim_sr1 &= ~(SIM_SR1_WIP | SIM_SR1_WEL);
+    sim_sr2 &= ~SIM_SR2_SUS;
+    sim_selected = 0U;
+    sim_crm = 0U;
+    sim_cut = GD25QXX_SIM_NO_CUT;
+}
+
+/*!
+    \brief      cut the power after a number of bytes of the array are programmed or erased: the
+                operation stops after its last byte allowed and the power_fail function of the
+                port is called
+    \param[in]  cells: bytes programmed or erased before the cut, 1 or more, or
+                GD25QXX_SIM_NO_CUT
+    \param[out] none
+    \retval     none
+*/
+void gd25qxx_sim_power_cut_set(uint32_t cells)
+{
+    sim_cut = cells;
+}
+
+/*!
+    \brief      select the simulated flash: chip select low
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gd25qxx_sim_select(void)
+{
+    uint32_t spi_hz;
+
+    /* the bus clock at the prescaler of the port */
+    spi_hz = sim_port->pclk_hz / sim_port->prescaler();
+    sim_clock_ns = (1000000000U + (spi_hz / 2U)) / spi_hz;
+
+    sim_selected = 1U;
+    sim_pos = 0U;
+    sim_addr = 0U;
+    sim_dummy = 0U;
+    sim_instruction = SIM_IGNORED;
+    if(0U != sim_crm) {
+        /* continuous read mode: the command starts with the address */
+        sim_instruction = SIM_QUADIOREAD;
+        sim_pos = 1U;
+    }
+}
+
+/*!
+    \brief      deselect the simulated flash: chip select high, a program or an erase starts
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void gd25qxx_sim_deselect(void)
+{
+    uint32_t index, sent, count;
+
+    if(0U == sim_selected) {
+        return;
+    }
+    sim_selected = 0U;
+    switch(sim_instruction) {
+    case SIM_WRITE:
+    case SIM_QUADWRITE:
+        if(sim_pos > 4U) {
+            /* the bytes latched are programmed in the order they were sent */
+            sent = sim_pos - 4U;
+            count = (sent < SIM_PAGE_SIZE) ? sent : SIM_PAGE_SIZE;
+            for(index = sim_addr + sent - count; index < (sim_addr + sent); index++) {
+                sim_program((sim_addr & ~(SIM_PAGE_SIZE - 1U)) + (index % SIM_PAGE_SIZE),
+                            sim_page[index % SIM_PAGE_SIZE]);
+            }
+            sim_stats.programs++;
+            sim_op_addr = sim_addr & ~(SIM_PAGE_SIZE - 1U);
+            sim_op_size = SIM_PAGE_SIZE;
+            sim_operation_start(SIM_TPP_US, 1U);
+        }
+        break;
+    case SIM_SE:
+    case SIM_BE32:
+    case SIM_BE64:
+        if(4U == sim_pos) {
+            if(SIM_SE == sim_instruction) {
+                sim_op_size = SIM_SECTOR_SIZE;
+                sim_operation_start(SIM_TSE_US, 1U);
+            } else if(SIM_BE32 == sim_instruction) {
+                sim_op_size = SIM_BLOCK32_SIZE;
+                sim_operation_start(SIM_TBE32_US, 1U);
+            } else {
+                sim_op_size = SIM_BLOCK64_SIZE;
+                sim_operation_start(SIM_TBE64_US, 1U);
+            }
+            sim_op_addr = sim_addr & (SIM_SIZE - 1U) & ~(sim_op_size - 1U);
+            sim_erase(sim_op_addr, sim_op_size);
+            sim_stats.erases++;
+        }
+        break;
+    case SIM_BE:
+    case SIM_CE:
+        if(1U == sim_pos) {
+            sim_erase(0U, SIM_SIZE);
+            sim_stats.erases++;
+            sim_operation_start(SIM_TCE_US, 0U);
+        }
+        break;
+    case SIM_WRSR:
+    case SIM_WRSR2:
+        if(sim_pos > 1U) {
+            if(SIM_WRSR == sim_instruction) {
+                sim_sr1 = sim_new_sr1 & ~(SIM_SR1_WIP | SIM_SR1_WEL);
+            }
+            if((SIM_WRSR2 == sim_instruction) || (sim_pos > 2U)) {
+                sim_sr2 = (sim_sr2 & SIM_SR2_SUS) | (sim_new_sr2 & ~SIM_SR2_SUS);
+            }
+            sim_operation_start(SIM_TW_US, 0U);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+    \brief      exchange a byte with the simulated flash, the virtual time advances by the clocks
+                of the byte: 8, or 2 in quad mode
+    \param[in]  byte: byte sent to the flash
+    \param[out] none
+    \retval     byte returned by the flash, 0xFF when it drives nothing
+*/
+uint8_t gd25qxx_sim_transfer(uint8_t byte)
+{
+    uint32_t clocks = (0U != sim_port->quad()) ? 2U : 8U;
+    uint32_t dummy_clocks = 8U;
+    uint8_t data = 0xFFU;
+
+    sim_time_ns += clocks * sim_clock_ns;
+    sim_stats.bytes++;
+    if(0U == sim_selected) {
+        return data;
+    }
+    if(0U == sim_pos) {
+        sim_instruction = sim_command_start(byte);
+        sim_pos = 1U;
+        return data;
+    }
+
+    switch(sim_instruction) {
+    case SIM_RDID:
+        if(sim_pos <= 3U) {
+            data = (uint8_t)(SIM_ID >> (8U * (3U - sim_pos)));
+        }
+        break;
+    case SIM_RDSR:
+        data = sim_sr1 | ((sim_time_ns < sim_busy_end_ns) ? SIM_SR1_WIP : 0U);
+        break;
+    case SIM_RDSR2:
+        data = sim_sr2;
+        break;
+    case SIM_WRSR:
+    case SIM_WRSR2:
+        if((1U == sim_pos) && (SIM_WRSR == sim_instruction)) {
+            sim_new_sr1 = byte;
+        } else if(sim_pos <= 2U) {
+            sim_new_sr2 = byte;
+        }
+        break;
+    case SIM_READ:
+    case SIM_FASTREAD:
+    case SIM_QUADREAD:
+    case SIM_QUADIOREAD:
+    case SIM_RDSFDP:
+        if(SIM_READ == sim_instruction) {
+            dummy_clocks = 0U;
+        } else if(SIM_QUADIOREAD == sim_instruction) {
+            dummy_clocks = 4U;
+        }
+        if(sim_pos <= 3U) {
+            sim_addr = (sim_addr << 8) | byte;
+        } else if((SIM_QUADIOREAD == sim_instruction) && (4U == sim_pos)) {
+            /* the mode bits 0x20 keep the continuous read mode */
+            sim_crm = (0x20U == (byte & 0x30U)) ? 1U : 0U;
+        } else if(sim_dummy < dummy_clocks) {
+            sim_dummy += clocks;
+        } else if(SIM_RDSFDP == sim_instruction) {
+            data = (sim_addr < sizeof(sim_sfdp)) ? sim_sfdp[sim_addr] : 0xFFU;
+            sim_addr++;
+        } else {
+            data = sim_read(sim_addr);
+            sim_addr++;
+        }
+        break;
+    case SIM_WRITE:
+    case SIM_QUADWRITE:
+        if(sim_pos <= 3U) {
+            sim_addr = (sim_addr << 8) | byte;
+        } else {
+            /* the address wraps within the page, the last bytes sent are kept */
+            sim_page[(sim_addr + sim_pos - 4U) % SIM_PAGE_SIZE] = byte;
+        }
+        break;
+    case SIM_SE:
+    case SIM_BE32:
+    case SIM_BE64:
+        if(sim_pos <= 3U) {
+            sim_addr = (sim_addr << 8) | byte;
+        }
+        break;
+    default:
+        break;
+    }
+    sim_pos++;
+    return data;
+}
+
+/*!
+    \brief      get the virtual time
+    \param[in]  none
+    \param[out] none
+    \retval     virtual time in us since gd25qxx_sim_init()
+*/
+uint32_t gd25qxx_sim_time_us(void)
+{
+    return (uint32_t)(sim_time_ns / 1000U);
+}
+
+/*!
+    \brief      advance the virtual time, for the work of the application between two accesses
+    \param[in]  time_us: time to add in us
+    \param[out] none
+    \retval     none
+*/
+void gd25qxx_sim_time_advance(uint32_t time_us)
+{
+    sim_time_ns += (uint64_t)time_us * 1000U;
+}
+
+/*!
+    \brief      get the statistics of the simulated flash
+    \param[in]  none
+    \param[out] stats: counters since gd25qxx_sim_init()
+    \retval     none
+*/
+void gd25qxx_sim_stats_get(gd25qxx_sim_stats_struct *stats)
+{
+    *stats = sim_stats;
+}
+
+/*!
+    \brief      check an instruction against the state of the flash, like the GD25Q16 does
+    \param[in]  instruction: first byte of the command
+    \param[out] none
+    \retval     instruction to execute, SIM_IGNORED if the flash ignores it
+*/
+static uint8_t sim_command_start(uint8_t instruction)
+{
+    uint8_t busy = (sim_time_ns < sim_busy_end_ns) ? 1U : 0U;
+    uint8_t suspended = (0U != (sim_sr2 & SIM_SR2_SUS)) ? 1U : 0U;
+
+    sim_stats.commands++;
+    /* only the status can be read and the operation suspended while it runs */
+    if((0U != busy) && (SIM_RDSR != instruction) && (SIM_RDSR2 != instruction) && (SIM_PES != instruction)) {
+        sim_stats.ignored++;
+        return SIM_IGNORED;
+    }
+
+    switch(instruction) {
+    case SIM_WREN:
+        sim_sr1 |= SIM_SR1_WEL;
+        break;
+    case SIM_WRDI:
+        sim_sr1 &= ~SIM_SR1_WEL;
+        break;
+    case SIM_PES:
+        if((0U == busy) || (0U == sim_suspendable)) {
+            sim_stats.ignored++;
+            return SIM_IGNORED;
+        }
+        /* the operation stops within tSUS */
+        sim_remaining_ns = sim_busy_end_ns - sim_time_ns;
+        sim_busy_end_ns = sim_time_ns + (SIM_TSUS_US * 1000U);
+        sim_suspendable = 0U;
+        sim_sr2 |= SIM_SR2_SUS;
+        break;
+    case SIM_PER:
+        if(0U != suspended) {
+            sim_sr2 &= ~SIM_SR2_SUS;
+            sim_busy_end_ns = sim_time_ns + sim_remaining_ns;
+            sim_suspendable = 1U;
+        }
+        break;
+    case SIM_QUADREAD:
+    case SIM_QUADIOREAD:
+        if(0U == (sim_sr2 & SIM_SR2_QE)) {
+            sim_stats.ignored++;
+            return SIM_IGNORED;
+        }
+        break;
+    case SIM_WRITE:
+    case SIM_QUADWRITE:
+    case SIM_SE:
+    case SIM_BE32:
+    case SIM_BE64:
+    case SIM_BE:
+    case SIM_CE:
+    case SIM_WRSR:
+    case SIM_WRSR2:
+        /* the changes need the write enable, the quad program the quad enable */
+        if((0U == (sim_sr1 & SIM_SR1_WEL)) || (0U != suspended) ||
+                ((SIM_QUADWRITE == instruction) && (0U == (sim_sr2 & SIM_SR2_QE)))) {
+            sim_stats.ignored++;
+            return SIM_IGNORED;
+        }
+        memset(sim_page, 0xFF, sizeof(sim_page));
+        break;
+    default:
+        break;
+    }
+    return instruction;
+}
+
+/*!
+    \brief      start a program, an erase or a status register write, WIP is set for its time
+    \param[in]  time_us: typical time of the operation
+    \param[in]  suspendable: 1 if the operation can be suspended
+    \param[out] none
+    \retval     none
+*/
+static void sim_operation_start(uint32_t time_us, uint8_t suspendable)
+{
+    sim_busy_end_ns = sim_time_ns + ((uint64_t)time_us * 1000U);
+    sim_suspendable = suspendable;
+    sim_sr1 &= ~SIM_SR1_WEL;
+}
+
+/*!
+    \brief      read a byte of the simulated array
+    \param[in]  addr: flash's internal address
+    \param[out] none
+    \retval     byte
+*/
+static uint8_t sim_read(uint32_t addr)
+{
+    addr &= SIM_SIZE - 1U;
+    /* the cells of a suspended operation are between two states, they read as 0x00 here */
+    if((0U != (sim_sr2 & SIM_SR2_SUS)) && (addr >= sim_op_addr) && (addr < (sim_op_addr + sim_op_size))) {
+        return 0x00U;
+    }
+    return sim_array[addr];
+}
+
+/*!
+    \brief      program a byte of the simulated array, the bits only go from 1 to 0
+    \param[in]  addr: flash's internal address
+    \param[in]  data: byte programmed
+    \param[out] none
+    \retval     none
+*/
+static void sim_program(uint32_t addr, uint8_t data)
+{
+    sim_array[addr & (SIM_SIZE - 1U)] &= data;
+    sim_cells_use(1U);
+}
+
+/*!
+    \brief      erase an aligned area of the simulated array from its start, a power cut leaves
+                the end of the area as it was
+    \param[in]  addr: address within the area
+    \param[in]  size: bytes of the area, a power of 2
+    \param[out] none
+    \retval     none
+*/
+static void sim_erase(uint32_t addr, uint32_t size)
+{
+    addr &= (SIM_SIZE - 1U) & ~(size - 1U);
+    if(size > sim_cut) {
+        size = sim_cut;
+    }
+    memset(&sim_array[addr], 0xFF, size);
+    sim_cells_use(size);
+}
+
+/*!
+    \brief      count the bytes of the array changed, the power is cut when the count set by
+                gd25qxx_sim_power_cut_set() is reached
+    \param[in]  count: bytes programmed or erased
+    \param[out] none
+    \retval     none
+*/
+static void sim_cells_use(uint32_t count)
+{
+    sim_stats.cells += count;
+    if(GD25QXX_SIM_NO_CUT == sim_cut) {
+        return;
+    }
+    sim_cut -= count;
+    if(0U == sim_cut) {
+        sim_cut = GD25QXX_SIM_NO_CUT;
+        if(NULL != sim_port->power_fail) {
+            sim_port->power_fail();
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/*!
+    \file    gd25qxx_sim.h
+    \brief   the header file of the simulated GD25Q16 SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef GD25QXX_SIM_H
+#define GD25QXX_SIM_H
+
+#include <stdint.h>
+
+/* port of the simulated flash: the state of the SPI bus driving it */
+typedef struct {
+    uint32_t pclk_hz;                   /* clock of the SPI peripheral before the prescaler */
+    uint32_t (*prescaler)(void);        /* division factor of the SPI prescaler, 2 to 256 */
+    uint8_t (*quad)(void);              /* 1 while the bytes are shifted on four lines */
+    void (*power_fail)(void);           /* called when the power is cut, does not return, or NULL */
+} gd25qxx_sim_port_struct;
+
+#define GD25QXX_SIM_NO_CUT        0xFFFFFFFFU   /* the power is never cut */
+
+/* simulated flash statistics structure */
+typedef struct {
+    uint32_t commands;                  /* commands received */
+    uint32_t bytes;                     /* bytes transferred on the bus */
+    uint32_t programs;                  /* page programs */
+    uint32_t erases;                    /* sector, block and chip erases */
+    uint32_t cells;                     /* bytes of the array programmed or erased */
+    uint32_t ignored;                   /* commands ignored: flash busy, no write enable or no quad enable */
+} gd25qxx_sim_stats_struct;
+
+/* function declarations */
+/* reset the simulated flash to an erased GD25Q16 driven by a port */
+void gd25qxx_sim_init(const gd25qxx_sim_port_struct *port);
+/* power the simulated flash again after a cut, the array and the non-volatile bits are kept */
+void gd25qxx_sim_power_on(void);
+/* cut the power after a number of bytes of the array are programmed or erased */
+void gd25qxx_sim_power_cut_set(uint32_t cells);
+/* select the simulated flash: chip select low */
+void gd25qxx_sim_select(void);
+/* deselect the simulated flash: chip select high, a program or an erase starts */
+void gd25qxx_sim_deselect(void);
+/* exchange a byte with the simulated flash */
+uint8_t gd25qxx_sim_transfer(uint8_t byte);
+/* get the virtual time */
+uint32_t gd25qxx_sim_time_us(void);
+/* advance the virtual time, for the work of the application between two accesses */
+void gd25qxx_sim_time_advance(uint32_t time_us);
+/* get the statistics of the simulated flash */
+void gd25qxx_sim_stats_get(gd25qxx_sim_stats_struct *stats);
+
+#endif /* GD25QXX_SIM_H */
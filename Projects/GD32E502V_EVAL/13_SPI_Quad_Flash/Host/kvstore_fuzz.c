@@ -0,0 +1,575 @@
+/*!
+    \file    kvstore_fuzz.c
+    \brief   key-value store on the simulated flash with power cuts
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <string.h>
+#include "flash_cache.h"
+#include "gd25qxx.h"
+#include "host_spi.h"
+#include "kvstore.h"
+
+#define KV_ADDRESS              0x1E0000U
+#define KV_SECTORS              3U                  /* the fewest sectors, the collection runs often */
+#define KV_SECTORS_LARGE        6U                  /* sectors of the store of the deletion check */
+#define KV_SECTOR_MAGIC         0x3153564BU         /* "KVS1", first word of a sector of the store */
+#define HEADER_LIMIT            1000U               /* erase counts and sequences stay below it */
+#define FUZZ_KEYS               8U
+#define FUZZ_OPS                128U
+#define FUZZ_PCLK_HZ            1000000U            /* slow bus, a busy flash needs few polls */
+
+/* operation of the scenario */
+#define OP_PUT                  0U
+#define OP_DELETE               1U
+#define OP_GC                   2U
+
+/* operation of the scenario */
+typedef struct {
+    uint8_t action;                     /* OP_PUT, OP_DELETE or OP_GC */
+    uint8_t key;                        /* index of the key */
+    uint16_t length;                    /* bytes of the value written */
+} fuzz_op_struct;
+
+/* expected values of the keys */
+typedef struct {
+    uint8_t exists[FUZZ_KEYS];
+    uint16_t length[FUZZ_KEYS];
+    uint8_t value[FUZZ_KEYS][KV_VALUE_MAX];
+} fuzz_state_struct;
+
+static void fuzz_power_fail(void);
+
+static const gd25qxx_sim_port_struct fuzz_port = {
+    FUZZ_PCLK_HZ, host_spi_prescaler, host_spi_quad, fuzz_power_fail
+};
+
+static jmp_buf fuzz_jump;
+static volatile uint32_t fuzz_op = 0U;
+static fuzz_op_struct fuzz_ops[FUZZ_OPS];
+/* state after each operation */
+static fuzz_state_struct fuzz_after[FUZZ_OPS + 1U];
+static fuzz_state_struct fuzz_found;
+/* operations which erase a sector in the run without cut */
+static uint8_t fuzz_collects[FUZZ_OPS];
+static uint8_t fuzz_buffer[KV_VALUE_MAX];
+static char fuzz_key[KV_KEY_MAX + 1U];
+
+static void power_on(void);
+static void store_erase(uint32_t count);
+static const char *key_name(uint32_t key);
+static uint8_t pattern(uint32_t op, uint32_t offset);
+static void model_build(void);
+static ErrStatus op_run(uint32_t op);
+static ErrStatus ops_run(uint32_t first);
+static void state_read(fuzz_state_struct *state);
+static uint32_t state_equal(const fuzz_state_struct *a, const fuzz_state_struct *b);
+static uint32_t headers_check(void);
+static uint32_t cut_check(uint32_t cells, uint32_t *op);
+static uint32_t tombstone_check(void);
+static uint32_t index_full_check(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+int main(void)
+{
+    gd25qxx_sim_stats_struct stats;
+    kv_stats_struct kv_stats;
+    uint32_t cells, start, erases, cut, op = 0U, failed = 0U;
+    uint32_t cuts[3] = {0U, 0U, 0U};
+    uint32_t collect_cuts = 0U;
+
+    model_build();
+    gd25qxx_sim_init(&fuzz_port);
+    power_on();
+    qspi_flash_quad_enable();
+
+    failed += tombstone_check();
+    failed += index_full_check();
+
+    /* the run without cut gives the number of bytes programmed and erased by the scenario and
+       the operations which collect a sector */
+    store_erase(KV_SECTORS);
+    if(SUCCESS != kv_init(KV_ADDRESS, KV_SECTORS)) {
+        printf("the store cannot be mounted\n");
+        return 1;
+    }
+    gd25qxx_sim_stats_get(&stats);
+    start = stats.cells;
+    for(op = 0U; op < FUZZ_OPS; op++) {
+        erases = stats.erases;
+        if(ERROR == op_run(op)) {
+            printf("the scenario fails without power cut at operation %u\n", op);
+            return 1;
+        }
+        gd25qxx_sim_stats_get(&stats);
+        fuzz_collects[op] = (stats.erases != erases) ? 1U : 0U;
+    }
+    state_read(&fuzz_found);
+    if(0U == state_equal(&fuzz_found, &fuzz_after[FUZZ_OPS])) {
+        printf("the scenario fails without power cut\n");
+        return 1;
+    }
+    cells = stats.cells - start;
+    kv_stats_get(&kv_stats);
+    printf("%u collections, %u keys left in the index\n", kv_stats.collections, kv_stats.keys);
+
+    /* cut the power after each byte programmed or erased */
+    for(cut = 1U; cut <= cells; cut++) {
+        if(0U != cut_check(cut, &op)) {
+            failed++;
+            if(failed >= 10U) {
+                break;
+            }
+        }
+        cuts[fuzz_ops[op].action]++;
+        collect_cuts += fuzz_collects[op];
+    }
+
+    printf("%u bytes programmed or erased by the scenario, a power cut after each one\n", cells);
+    printf("%u cuts in kv_put(), %u in kv_delete(), %u in kv_gc_step(), %u of them in an operation which collects\n",
+           cuts[OP_PUT], cuts[OP_DELETE], cuts[OP_GC], collect_cuts);
+    printf("%u failed\n", failed);
+    return (int)failed;
+}
+
+/*!
+    \brief      power cut callback of the simulated flash, back to the fuzzer
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void fuzz_power_fail(void)
+{
+    longjmp(fuzz_jump, 1);
+}
+
+/*!
+    \brief      power the flash and SPI0 again and initialize the driver as a reset does
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void power_on(void)
+{
+    gd25qxx_sim_power_on();
+    host_spi_reset();
+    spi_flash_init();
+    flash_cache_invalidate_all();
+}
+
+/*!
+    \brief      erase the sectors of the store, the next kv_init() formats them
+    \param[in]  count: number of sectors of the store
+    \param[out] none
+    \retval     none
+*/
+static void store_erase(uint32_t count)
+{
+    uint32_t sector;
+
+    for(sector = 0U; sector < count; sector++) {
+        spi_flash_sector_erase(KV_ADDRESS + (sector * KV_SECTOR_SIZE));
+    }
+}
+
+/*!
+    \brief      get the name of a key
+    \param[in]  key: index of the key
+    \param[out] none
+    \retval     the name, valid until the next call
+*/
+static const char *key_name(uint32_t key)
+{
+    sprintf(fuzz_key, "key%02u", key);
+    return fuzz_key;
+}
+
+/*!
+    \brief      get a byte of the value written by an operation
+    \param[in]  op: the operation
+    \param[in]  offset: offset of the byte in the value
+    \param[out] none
+    \retval     the byte
+*/
+static uint8_t pattern(uint32_t op, uint32_t offset)
+{
+    return (uint8_t)((op * 59U) + (offset * 7U) + 1U);
+}
+
+/*!
+    \brief      build the scenario and the expected values after each operation
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void model_build(void)
+{
+    fuzz_op_struct *op;
+    fuzz_state_struct *state;
+    uint32_t index, offset;
+
+    memset(&fuzz_after[0], 0, sizeof(fuzz_after[0]));
+    for(index = 0U; index < FUZZ_OPS; index++) {
+        op = &fuzz_ops[index];
+        /* the last key is deleted for good a quarter into the scenario, the collections drop
+           its deletion later */
+        if(index < (FUZZ_OPS / 4U)) {
+            op->key = (uint8_t)((index * 3U) % FUZZ_KEYS);
+        } else if((FUZZ_OPS / 4U) == index) {
+            op->key = FUZZ_KEYS - 1U;
+        } else {
+            op->key = (uint8_t)((index * 3U) % (FUZZ_KEYS - 1U));
+        }
+        op->length = (uint16_t)((index * 37U) % 201U);
+        fuzz_after[index + 1U] = fuzz_after[index];
+        state = &fuzz_after[index + 1U];
+        /* keys are deleted and written again, the idle collection runs between the writes */
+        if(63U == (index % 64U)) {
+            op->action = OP_GC;
+        } else if((((FUZZ_OPS / 4U) == index) || (6U == (index % 7U))) && (0U != state->exists[op->key])) {
+            op->action = OP_DELETE;
+            state->exists[op->key] = 0U;
+        } else {
+            op->action = OP_PUT;
+            state->exists[op->key] = 1U;
+            state->length[op->key] = op->length;
+            for(offset = 0U; offset < op->length; offset++) {
+                state->value[op->key][offset] = pattern(index, offset);
+            }
+        }
+    }
+}
+
+/*!
+    \brief      run an operation of the scenario on the store
+    \param[in]  op: the operation
+    \param[out] none
+    \retval     SUCCESS or ERROR if the call failed
+*/
+static ErrStatus op_run(uint32_t op)
+{
+    const fuzz_op_struct *o = &fuzz_ops[op];
+    uint32_t offset;
+
+    fuzz_op = op;
+    switch(o->action) {
+    case OP_PUT:
+        for(offset = 0U; offset < o->length; offset++) {
+            fuzz_buffer[offset] = pattern(op, offset);
+        }
+        return kv_put(key_name(o->key), fuzz_buffer, o->length);
+    case OP_DELETE:
+        return kv_delete(key_name(o->key));
+    default:
+        kv_gc_step();
+        return SUCCESS;
+    }
+}
+
+/*!
+    \brief      run the operations of the scenario from one of them to the end
+    \param[in]  first: the first operation to run
+    \param[out] none
+    \retval     SUCCESS or ERROR if a call failed
+*/
+static ErrStatus ops_run(uint32_t first)
+{
+    uint32_t op;
+
+    for(op = first; op < FUZZ_OPS; op++) {
+        if(ERROR == op_run(op)) {
+            printf("operation %u fails\n", op);
+            return ERROR;
+        }
+    }
+    return SUCCESS;
+}
+
+/*!
+    \brief      read the values of the keys
+    \param[in]  none
+    \param[out] state: the values found
+    \retval     none
+*/
+static void state_read(fuzz_state_struct *state)
+{
+    uint32_t key, length;
+
+    memset(state, 0, sizeof(*state));
+    for(key = 0U; key < FUZZ_KEYS; key++) {
+        if(SUCCESS == kv_get(key_name(key), state->value[key], KV_VALUE_MAX, &length)) {
+            state->exists[key] = 1U;
+            state->length[key] = (uint16_t)length;
+        }
+    }
+}
+
+/*!
+    \brief      compare two states of the keys
+    \param[in]  a: a state
+    \param[in]  b: the other state
+    \param[out] none
+    \retval     1 if the values are the same, 0 otherwise
+*/
+static uint32_t state_equal(const fuzz_state_struct *a, const fuzz_state_struct *b)
+{
+    uint32_t key;
+
+    for(key = 0U; key < FUZZ_KEYS; key++) {
+        if((a->exists[key] != b->exists[key]) || ((0U != a->exists[key]) && ((a->length[key] != b->length[key])
+                || (0 != memcmp(a->value[key], b->value[key], a->length[key]))))) {
+            return 0U;
+        }
+    }
+    return 1U;
+}
+
+/*!
+    \brief      check the sector headers in the flash, a header torn by a power cut must not
+                leave a huge erase count or sequence behind
+    \param[in]  none
+    \param[out] none
+    \retval     1 if a header is missing or out of range, 0 otherwise
+*/
+static uint32_t headers_check(void)
+{
+    uint32_t header[4];
+    uint32_t sector;
+
+    for(sector = 0U; sector < KV_SECTORS; sector++) {
+        spi_flash_buffer_read((uint8_t *)header, KV_ADDRESS + (sector * KV_SECTOR_SIZE), sizeof(header));
+        if((KV_SECTOR_MAGIC != header[0]) || (header[1] >= HEADER_LIMIT)
+                || ((0xFFFFFFFFU != header[2]) && (header[2] >= HEADER_LIMIT))) {
+            return 1U;
+        }
+    }
+    return 0U;
+}
+
+/*!
+    \brief      run the scenario with a power cut, remount and check that each key holds its
+                last committed value, then that the scenario completes from there
+    \param[in]  cells: bytes programmed or erased before the cut
+    \param[out] op: the operation the cut interrupted
+    \retval     1 if the check failed, 0 otherwise
+*/
+static uint32_t cut_check(uint32_t cells, uint32_t *op)
+{
+    uint32_t cut_op, next;
+
+    power_on();
+    store_erase(KV_SECTORS);
+    kv_init(KV_ADDRESS, KV_SECTORS);
+    gd25qxx_sim_power_cut_set(cells);
+    if(0 == setjmp(fuzz_jump)) {
+        ops_run(0U);
+        gd25qxx_sim_power_cut_set(GD25QXX_SIM_NO_CUT);
+        printf("cut %u: the scenario completes\n", cells);
+        return 1U;
+    }
+
+    /* the record in progress is written or not at all, a collection loses nothing */
+    cut_op = fuzz_op;
+    *op = cut_op;
+    power_on();
+    if(SUCCESS != kv_init(KV_ADDRESS, KV_SECTORS)) {
+        printf("cut %u in operation %u: the store cannot be mounted\n", cells, cut_op);
+        return 1U;
+    }
+    state_read(&fuzz_found);
+    if(0U != state_equal(&fuzz_found, &fuzz_after[cut_op + 1U])) {
+        next = cut_op + 1U;
+    } else if(0U != state_equal(&fuzz_found, &fuzz_after[cut_op])) {
+        next = cut_op;
+    } else {
+        printf("cut %u in operation %u: the keys do not hold committed values\n", cells, cut_op);
+        return 1U;
+    }
+    if(0U != headers_check()) {
+        printf("cut %u in operation %u: a sector header is damaged\n", cells, cut_op);
+        return 1U;
+    }
+
+    /* the store is still writable, and mounts again with the same values */
+    if(ERROR == ops_run(next)) {
+        printf("cut %u in operation %u: the scenario does not complete after the cut\n", cells, cut_op);
+        return 1U;
+    }
+    kv_init(KV_ADDRESS, KV_SECTORS);
+    state_read(&fuzz_found);
+    if((0U == state_equal(&fuzz_found, &fuzz_after[FUZZ_OPS])) || (0U != headers_check())) {
+        printf("cut %u in operation %u: wrong values at the end of the scenario\n", cells, cut_op);
+        return 1U;
+    }
+    return 0U;
+}
+
+/*!
+    \brief      check that a deleted key stays deleted across the collections and the remounts,
+                and that the collection of the oldest sector drops its deletion from the index
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+static uint32_t tombstone_check(void)
+{
+    kv_stats_struct stats;
+    uint32_t key, update, length, failed = 0U;
+
+    store_erase(KV_SECTORS);
+    kv_init(KV_ADDRESS, KV_SECTORS);
+    memset(fuzz_buffer, 0x55, sizeof(fuzz_buffer));
+    kv_put("gone", fuzz_buffer, 100U);
+    kv_put("kept", fuzz_buffer, 100U);
+    if((SUCCESS != kv_delete("gone")) || (SUCCESS == kv_get("gone", fuzz_buffer, KV_VALUE_MAX, &length))
+            || (ERROR != kv_delete("gone"))) {
+        printf("tombstone: the key is not deleted\n");
+        failed++;
+    }
+    kv_init(KV_ADDRESS, KV_SECTORS);
+    kv_stats_get(&stats);
+    if((SUCCESS == kv_get("gone", fuzz_buffer, KV_VALUE_MAX, &length)) || (2U != stats.keys)) {
+        printf("tombstone: the deletion is lost by a remount\n");
+        failed++;
+    }
+
+    /* the updates of an other key collect the sectors until the deletion is dropped */
+    for(update = 0U; (update < 200U) && (2U == stats.keys); update++) {
+        kv_put("kept", fuzz_buffer, 200U);
+        kv_stats_get(&stats);
+    }
+    if((1U != stats.keys) || (SUCCESS == kv_get("gone", fuzz_buffer, KV_VALUE_MAX, &length))) {
+        printf("tombstone: the deletion is not dropped by the collection\n");
+        failed++;
+    }
+    kv_init(KV_ADDRESS, KV_SECTORS);
+    kv_stats_get(&stats);
+    if((1U != stats.keys) || (SUCCESS == kv_get("gone", fuzz_buffer, KV_VALUE_MAX, &length))
+            || (SUCCESS != kv_get("kept", fuzz_buffer, KV_VALUE_MAX, &length)) || (200U != length)) {
+        printf("tombstone: the deleted key comes back after a remount\n");
+        failed++;
+    }
+    printf("tombstone: dropped after %u updates\n", update);
+
+    /* the value fills the first sector with keys which never change and the deletion goes to
+       the second one, the sectors of the updates are collected while the value is still there */
+    store_erase(KV_SECTORS_LARGE);
+    kv_init(KV_ADDRESS, KV_SECTORS_LARGE);
+    kv_put("gone", fuzz_buffer, 100U);
+    for(key = 0U; key < 15U; key++) {
+        kv_put(key_name(key), fuzz_buffer, 248U);
+    }
+    kv_delete("gone");
+    for(update = 0U; update < 100U; update++) {
+        kv_put("kept", fuzz_buffer, 200U);
+    }
+    kv_stats_get(&stats);
+    kv_init(KV_ADDRESS, KV_SECTORS_LARGE);
+    if((0U == stats.collections) || (SUCCESS == kv_get("gone", fuzz_buffer, KV_VALUE_MAX, &length))
+            || (SUCCESS != kv_get(key_name(14U), fuzz_buffer, KV_VALUE_MAX, &length)) || (248U != length)) {
+        printf("tombstone: the deleted key comes back after the collection of its deletion\n");
+        failed++;
+    }
+    return failed;
+}
+
+/*!
+    \brief      check that the index refuses a key more than KV_KEYS_MAX, that the stored keys
+                can still be written and that a deleted key makes room once it is collected
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+static uint32_t index_full_check(void)
+{
+    kv_stats_struct stats;
+    uint32_t key, update, length, failed = 0U;
+
+    store_erase(KV_SECTORS);
+    kv_init(KV_ADDRESS, KV_SECTORS);
+    for(key = 0U; key < KV_KEYS_MAX; key++) {
+        fuzz_buffer[0] = (uint8_t)key;
+        if(SUCCESS != kv_put(key_name(key), fuzz_buffer, 4U)) {
+            printf("index full: key %u is refused\n", key);
+            failed++;
+        }
+    }
+    if((SUCCESS == kv_put("extra", fuzz_buffer, 4U)) || (SUCCESS == kv_get("extra", fuzz_buffer, KV_VALUE_MAX, &length))) {
+        printf("index full: a key more than KV_KEYS_MAX is written\n");
+        failed++;
+    }
+    fuzz_buffer[0] = 0xA5U;
+    if(SUCCESS != kv_put(key_name(7U), fuzz_buffer, 4U)) {
+        printf("index full: a stored key cannot be written\n");
+        failed++;
+    }
+
+    /* the deleted key keeps its slot until its deletion is collected */
+    kv_delete(key_name(3U));
+    if(SUCCESS == kv_put("extra", fuzz_buffer, 4U)) {
+        printf("index full: a deleted key frees its slot before the collection\n");
+        failed++;
+    }
+    kv_stats_get(&stats);
+    for(update = 0U; (update < 500U) && (KV_KEYS_MAX == stats.keys); update++) {
+        kv_put(key_name(update % 3U), fuzz_buffer, 200U);
+        kv_stats_get(&stats);
+    }
+    if(SUCCESS != kv_put("extra", fuzz_buffer, 4U)) {
+        printf("index full: the collected deletion does not free its slot\n");
+        failed++;
+    }
+
+    /* the index is rebuilt full by a remount */
+    kv_init(KV_ADDRESS, KV_SECTORS);
+    kv_stats_get(&stats);
+    if((KV_KEYS_MAX != stats.keys) || (SUCCESS == kv_get(key_name(3U), fuzz_buffer, KV_VALUE_MAX, &length))
+            || (SUCCESS != kv_get("extra", fuzz_buffer, KV_VALUE_MAX, &length))) {
+        printf("index full: the index is not rebuilt by a remount\n");
+        failed++;
+    }
+    for(key = 8U; key < KV_KEYS_MAX; key++) {
+        if((3U != key) && ((SUCCESS != kv_get(key_name(key), fuzz_buffer, KV_VALUE_MAX, &length))
+                           || ((uint8_t)key != fuzz_buffer[0]))) {
+            printf("index full: key %u is lost\n", key);
+            failed++;
+        }
+    }
+    printf("index full: the slot of a deleted key is free after %u updates\n", update);
+    return failed;
+}
@@ -0,0 +1,129 @@
+/*!
+    \file    gd32e502.h
+    \brief   host version of the device header used by the flash simulator harness
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32E502_H
+#define GD32E502_H
+
+/* only the part of the device header and of the peripheral library used by the flash driver
+   is declared, SPI0 and the CRC unit are modelled by host_spi.c */
+
+#include <stdint.h>
+
+#define __IO                volatile
+#define __I                 volatile const
+#define BIT(x)              ((uint32_t)((uint32_t)0x01U << (x)))
+#define BITS(start, end)    ((0xFFFFFFFFUL << (start)) & (0xFFFFFFFFUL >> (31U - (uint32_t)(end))))
+
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} EventStatus, ControlStatus;
+typedef enum {RESET = 0, SET = !RESET} FlagStatus;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrStatus;
+
+typedef enum {
+    DMA0_Channel2_IRQn = 20,
+    HOST_IRQ_NUM = 64
+} IRQn_Type;
+
+/* RCU */
+typedef enum {
+    RCU_CRC = 0,
+    RCU_GPIOA,
+    RCU_GPIOB,
+    RCU_GPIOE
+} rcu_periph_enum;
+
+void rcu_periph_clock_enable(rcu_periph_enum periph);
+
+/* GPIO */
+#define GPIOA               0x48000000U
+#define GPIOB               0x48000400U
+#define GPIOE               0x48001000U
+#define GPIO_PIN_1          BIT(1)
+#define GPIO_PIN_10         BIT(10)
+#define GPIO_PIN_15         BIT(15)
+#define GPIO_AF_4           4U
+#define GPIO_MODE_AF        2U
+#define GPIO_PUPD_NONE      0U
+#define GPIO_OTYPE_PP       0U
+#define GPIO_OSPEED_50MHZ   3U
+
+void gpio_af_set(uint32_t gpio_periph, uint32_t alt_func_num, uint32_t pin);
+void gpio_mode_set(uint32_t gpio_periph, uint32_t mode, uint32_t pull_up_down, uint32_t pin);
+void gpio_output_options_set(uint32_t gpio_periph, uint8_t otype, uint32_t speed, uint32_t pin);
+
+/* SPI */
+#define SPI0                0x40013000U
+#define CTL0_PSC(regval)    (BITS(3, 5) & ((uint32_t)(regval) << 3))
+#define SPI_PSC_2           CTL0_PSC(0)
+#define SPI_PSC_4           CTL0_PSC(1)
+#define SPI_PSC_8           CTL0_PSC(2)
+#define SPI_PSC_16          CTL0_PSC(3)
+#define SPI_PSC_32          CTL0_PSC(4)
+#define SPI_PSC_64          CTL0_PSC(5)
+#define SPI_PSC_128         CTL0_PSC(6)
+#define SPI_PSC_256         CTL0_PSC(7)
+#define SPI_CK_PL_LOW_PH_1EDGE          0x00000000U
+#define SPI_FLAG_RBNE       BIT(0)
+#define SPI_FLAG_TBE        BIT(1)
+
+void spi_i2s_data_transmit(uint32_t spi_periph, uint16_t data);
+uint16_t spi_i2s_data_receive(uint32_t spi_periph);
+FlagStatus spi_i2s_flag_get(uint32_t spi_periph, uint32_t flag);
+void spi_quad_enable(uint32_t spi_periph);
+void spi_quad_disable(uint32_t spi_periph);
+void spi_quad_write_enable(uint32_t spi_periph);
+void spi_quad_read_enable(uint32_t spi_periph);
+void spi_quad_io23_output_enable(uint32_t spi_periph);
+
+/* CRC */
+#define INPUT_FORMAT_WORD   0U
+
+void crc_deinit(void);
+void crc_data_register_reset(void);
+uint32_t crc_block_data_calculate(void *array, uint32_t size, uint8_t data_format);
+
+/* DMA */
+#define DMA0                0x40020000U
+
+typedef enum {
+    DMA_CH0 = 0U,
+    DMA_CH1,
+    DMA_CH2,
+    DMA_CH3,
+    DMA_CH4,
+    DMA_CH5,
+    DMA_CH6
+} dma_channel_enum;
+
+#endif /* GD32E502_H */
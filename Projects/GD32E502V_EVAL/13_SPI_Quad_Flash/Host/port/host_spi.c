@@ -0,0 +1,306 @@
+/*!
+    \file    host_spi.c
+    \brief   SPI0 and CRC unit models for the simulated flash harnesses, stubs of the other peripherals
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <stddef.h>
+#include "host_spi.h"
+#include "spi_bus.h"
+
+/* SPI0 state seen by the simulated flash: SPI_PSC_x of the device and the quad mode */
+static uint32_t spi_prescale = SPI_PSC_32;
+static uint8_t spi_quad = 0U;
+/* CRC unit data register */
+static uint32_t crc_data = 0xFFFFFFFFU;
+
+const gd25qxx_sim_port_struct host_spi_flash_port = {
+    HOST_SPI_PCLK_HZ, host_spi_prescaler, host_spi_quad, NULL
+};
+
+/*!
+    \brief      reset SPI0 as a power on does
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void host_spi_reset(void)
+{
+    spi_prescale = SPI_PSC_2;
+    spi_quad = 0U;
+}
+
+/*!
+    \brief      get the prescaler of SPI0, for the ports of the simulated flash
+    \param[in]  none
+    \param[out] none
+    \retval     division factor of the prescaler, 2 to 256
+*/
+uint32_t host_spi_prescaler(void)
+{
+    return 2U << ((spi_prescale & BITS(3, 5)) >> 3);
+}
+
+/*!
+    \brief      get the mode of SPI0, for the ports of the simulated flash
+    \param[in]  none
+    \param[out] none
+    \retval     1 in quad mode, 0 otherwise
+*/
+uint8_t host_spi_quad(void)
+{
+    return spi_quad;
+}
+
+/*!
+    \brief      enable the clock of a peripheral, nothing to do on the host
+    \param[in]  periph: the peripheral
+    \param[out] none
+    \retval     none
+*/
+void rcu_periph_clock_enable(rcu_periph_enum periph)
+{
+    (void)periph;
+}
+
+/*!
+    \brief      set the alternate function of pins, nothing to do on the host
+    \param[in]  gpio_periph: GPIO port
+    \param[in]  alt_func_num: alternate function
+    \param[in]  pin: pins
+    \param[out] none
+    \retval     none
+*/
+void gpio_af_set(uint32_t gpio_periph, uint32_t alt_func_num, uint32_t pin)
+{
+    (void)gpio_periph;
+    (void)alt_func_num;
+    (void)pin;
+}
+
+/*!
+    \brief      set the mode of pins, nothing to do on the host
+    \param[in]  gpio_periph: GPIO port
+    \param[in]  mode: pin mode
+    \param[in]  pull_up_down: pull-up or pull-down
+    \param[in]  pin: pins
+    \param[out] none
+    \retval     none
+*/
+void gpio_mode_set(uint32_t gpio_periph, uint32_t mode, uint32_t pull_up_down, uint32_t pin)
+{
+    (void)gpio_periph;
+    (void)mode;
+    (void)pull_up_down;
+    (void)pin;
+}
+
+/*!
+    \brief      set the output options of pins, nothing to do on the host
+    \param[in]  gpio_periph: GPIO port
+    \param[in]  otype: output type
+    \param[in]  speed: output speed
+    \param[in]  pin: pins
+    \param[out] none
+    \retval     none
+*/
+void gpio_output_options_set(uint32_t gpio_periph, uint8_t otype, uint32_t speed, uint32_t pin)
+{
+    (void)gpio_periph;
+    (void)otype;
+    (void)speed;
+    (void)pin;
+}
+
+/*!
+    \brief      register a device of the bus, the flash is the only device: its prescaler is the
+                one of SPI0
+    \param[in]  device: the device
+    \param[in]  cs_port: GPIO port of the chip select
+    \param[in]  cs_pin: GPIO pin of the chip select
+    \param[in]  prescale: SPI_PSC_x, clock of the device
+    \param[in]  clock_polarity_phase: SPI_CK_PL_x_PH_x, mode of the device
+    \param[in]  priority: priority of the device
+    \param[out] none
+    \retval     none
+*/
+void spi_bus_device_init(spi_bus_device_struct *device, uint32_t cs_port, uint32_t cs_pin,
+                         uint32_t prescale, uint32_t clock_polarity_phase, uint8_t priority)
+{
+    device->cs_port = cs_port;
+    device->cs_pin = cs_pin;
+    device->prescale = prescale;
+    device->clock_polarity_phase = clock_polarity_phase;
+    device->priority = priority;
+    spi_prescale = prescale;
+}
+
+/*!
+    \brief      write the SPI data register, the simulated flash is not reached through it
+    \param[in]  spi_periph: SPIx
+    \param[in]  data: data sent
+    \param[out] none
+    \retval     none
+*/
+void spi_i2s_data_transmit(uint32_t spi_periph, uint16_t data)
+{
+    (void)spi_periph;
+    (void)data;
+}
+
+/*!
+    \brief      read the SPI data register, nothing drives the lines
+    \param[in]  spi_periph: SPIx
+    \param[out] none
+    \retval     0xFFFF
+*/
+uint16_t spi_i2s_data_receive(uint32_t spi_periph)
+{
+    (void)spi_periph;
+    return 0xFFFFU;
+}
+
+/*!
+    \brief      get a SPI flag, the transfers complete at once
+    \param[in]  spi_periph: SPIx
+    \param[in]  flag: SPI_FLAG_TBE or SPI_FLAG_RBNE
+    \param[out] none
+    \retval     SET
+*/
+FlagStatus spi_i2s_flag_get(uint32_t spi_periph, uint32_t flag)
+{
+    (void)spi_periph;
+    (void)flag;
+    return SET;
+}
+
+/*!
+    \brief      enable the quad mode: the bytes are shifted on four lines
+    \param[in]  spi_periph: SPIx
+    \param[out] none
+    \retval     none
+*/
+void spi_quad_enable(uint32_t spi_periph)
+{
+    (void)spi_periph;
+    spi_quad = 1U;
+}
+
+/*!
+    \brief      disable the quad mode
+    \param[in]  spi_periph: SPIx
+    \param[out] none
+    \retval     none
+*/
+void spi_quad_disable(uint32_t spi_periph)
+{
+    (void)spi_periph;
+    spi_quad = 0U;
+}
+
+/*!
+    \brief      set the quad mode to write, the direction does not change the timing
+    \param[in]  spi_periph: SPIx
+    \param[out] none
+    \retval     none
+*/
+void spi_quad_write_enable(uint32_t spi_periph)
+{
+    (void)spi_periph;
+}
+
+/*!
+    \brief      set the quad mode to read, the direction does not change the timing
+    \param[in]  spi_periph: SPIx
+    \param[out] none
+    \retval     none
+*/
+void spi_quad_read_enable(uint32_t spi_periph)
+{
+    (void)spi_periph;
+}
+
+/*!
+    \brief      enable the output of SPI_IO2 and SPI_IO3, nothing to do on the host
+    \param[in]  spi_periph: SPIx
+    \param[out] none
+    \retval     none
+*/
+void spi_quad_io23_output_enable(uint32_t spi_periph)
+{
+    (void)spi_periph;
+}
+
+/*!
+    \brief      reset the CRC unit, its data register starts from 0xFFFFFFFF
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void crc_deinit(void)
+{
+    crc_data = 0xFFFFFFFFU;
+}
+
+/*!
+    \brief      load the data register of the CRC unit with the initial value
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void crc_data_register_reset(void)
+{
+    crc_data = 0xFFFFFFFFU;
+}
+
+/*!
+    \brief      add words to the CRC, polynomial 0x04C11DB7 MSB first as the CRC unit
+    \param[in]  array: pointer to the data
+    \param[in]  size: number of data items
+    \param[in]  data_format: INPUT_FORMAT_WORD, only words are modelled
+    \param[out] none
+    \retval     the CRC value
+*/
+uint32_t crc_block_data_calculate(void *array, uint32_t size, uint8_t data_format)
+{
+    const uint32_t *data = (const uint32_t *)array;
+    uint32_t index, bit;
+
+    (void)data_format;
+    for(index = 0U; index < size; index++) {
+        crc_data ^= data[index];
+        for(bit = 0U; bit < 32U; bit++) {
+            crc_data = (0U != (crc_data & 0x80000000U)) ? ((crc_data << 1) ^ 0x04C11DB7U) : (crc_data << 1);
+        }
+    }
+    return crc_data;
+}
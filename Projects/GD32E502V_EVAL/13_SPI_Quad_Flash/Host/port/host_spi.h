@@ -0,0 +1,55 @@
+/*!
+    \file    host_spi.h
+    \brief   the header file of the SPI0 model driving the simulated flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "gd32e502.h"
+#include "gd25qxx_sim.h"
+
+#define HOST_SPI_PCLK_HZ    100000000U          /* APB2 clock of SPI0, the system clock */
+
+/* port of the simulated flash: the clock and the mode of the SPI0 model */
+extern const gd25qxx_sim_port_struct host_spi_flash_port;
+
+/* function declarations */
+/* reset SPI0 as a power on does */
+void host_spi_reset(void);
+/* get the prescaler of SPI0, for the ports of the simulated flash */
+uint32_t host_spi_prescaler(void);
+/* get the mode of SPI0, for the ports of the simulated flash */
+uint8_t host_spi_quad(void);
+
+#endif /* HOST_SPI_H */
@@ -58,7 +58,9 @@ void PendSV_Handler(void);
 void FPU_IRQHandler(void);
 /* this function handles SRAM ECC error interrupt */
 void SRAMC_ECCSE_IRQHandler(void);
-/* this function handles SPI1 exception */
-void SPI1_IRQHandler(void);
+/* this function handles DMA0 channel0 exception */
+void DMA0_Channel0_IRQHandler(void);
+/* this function handles DMA0 channel1 exception */
+void DMA0_Channel1_IRQHandler(void);
 
 #endif /* GD32E502_IT_H */
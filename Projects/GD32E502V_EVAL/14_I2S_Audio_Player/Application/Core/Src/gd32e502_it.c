@@ -34,6 +34,7 @@ OF SUCH DAMAGE.
 
 #include "gd32e502_it.h"
 #include "i2s_codec.h"
+#include "audio_record.h"
 
 #define SRAM_ECC_ERROR_HANDLE(s)    do{}while(1)
 #define FLASH_ECC_ERROR_HANDLE(s)   do{}while(1)
@@ -178,14 +179,37 @@ void SRAMC_ECCSE_IRQHandler(void)
 }
 
 /*!
-    \brief      this function handles SPI1 exception
+    \brief      this function handles DMA0 channel0 exception
     \param[in]  none
     \param[out] none
     \retval     none
 */
-void SPI1_IRQHandler(void)
+void DMA0_Channel0_IRQHandler(void)
 {
-    if(SET == spi_i2s_interrupt_flag_get(SPI1, SPI_I2S_INT_TBE)) {
-        i2s_audio_data_send();
+    if(SET == dma_interrupt_flag_get(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_HTF)) {
+        dma_interrupt_flag_clear(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_HTF);
+        i2s_audio_half_transfer_callback();
+    }
+    if(SET == dma_interrupt_flag_get(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_FTF)) {
+        dma_interrupt_flag_clear(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_FTF);
+        i2s_audio_full_transfer_callback();
+    }
+}
+
+/*!
+    \brief      this function handles DMA0 channel1 exception
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void DMA0_Channel1_IRQHandler(void)
+{
+    if(SET == dma_interrupt_flag_get(RECORD_DMA, RECORD_DMA_CHANNEL, DMA_INT_FLAG_HTF)) {
+        dma_interrupt_flag_clear(RECORD_DMA, RECORD_DMA_CHANNEL, DMA_INT_FLAG_HTF);
+        record_half_transfer_callback();
+    }
+    if(SET == dma_interrupt_flag_get(RECORD_DMA, RECORD_DMA_CHANNEL, DMA_INT_FLAG_FTF)) {
+        dma_interrupt_flag_clear(RECORD_DMA, RECORD_DMA_CHANNEL, DMA_INT_FLAG_FTF);
+        record_full_transfer_callback();
     }
 }
@@ -36,6 +36,43 @@ OF SUCH DAMAGE.
 #include <stdio.h>
 #include "gd32e502v_eval.h"
 #include "i2s_codec.h"
+#include "flash_audio.h"
+#include "playlist.h"
+#include "audio_record.h"
+
+/* uncomment to play the wave file stored in the GD25Q16 SPI flash instead of wave_data.h,
+   the file can be written once with flash_audio_store() */
+/* #define AUDIO_FROM_SPI_FLASH */
+#define AUDIO_FLASH_ADDRESS      0x000000
+/* uncomment to play wave_data.h twice in a row through the gapless playlist */
+/* #define AUDIO_PLAYLIST */
+/* uncomment to record 4 s of 16 kHz mono audio from the I2S1 data line into the SPI flash
+   and play it back, the worst case FIFO occupancy is in the recorder statistics */
+/* #define AUDIO_RECORD */
+#define AUDIO_RECORD_ADDRESS     0x100000
+#define AUDIO_RECORD_SIZE        (RECORD_HEADER_SIZE + 4U * 16000U * 2U)
+/* uncomment to measure the cost of each pipeline stage and the CRC of the first blocks of
+   the output, two builds playing the same file must give the same CRC */
+/* #define AUDIO_PROFILE */
+#define AUDIO_PROFILE_BLOCKS     1000U
+
+#if defined(AUDIO_FROM_SPI_FLASH) || defined(AUDIO_RECORD)
+wave_file_struct flash_wave;
+audio_source_struct flash_source;
+#elif defined(AUDIO_PLAYLIST)
+wave_reader_struct playlist_reader;
+#endif /* AUDIO_FROM_SPI_FLASH || AUDIO_RECORD */
+#ifdef AUDIO_RECORD
+record_stats_struct record_stats;
+#endif /* AUDIO_RECORD */
+#ifdef AUDIO_PROFILE
+/* read with the debugger once profile_checksum.blocks reaches AUDIO_PROFILE_BLOCKS */
+audio_checksum_struct profile_checksum;
+float profile_cycles[AUDIO_STAGE_NUM];
+float profile_ns[AUDIO_STAGE_NUM];
+
+static void profile_report(void);
+#endif /* AUDIO_PROFILE */
 
 /*!
     \brief      main function
@@ -48,9 +85,84 @@ int main(void)
 {
     nvic_priority_group_set(NVIC_PRIGROUP_PRE1_SUB3);
     /* configure NVIC */
-    nvic_irq_enable(SPI1_IRQn, 0, 1);
+    nvic_irq_enable(AUDIO_DMA_IRQn, 0, 1);
+    /* play the file at the exact I2S sample rate instead of the closest one */
+    i2s_audio_resampler_enable();
+#ifdef AUDIO_PROFILE
+    i2s_audio_checksum_start(AUDIO_PROFILE_BLOCKS);
+#endif /* AUDIO_PROFILE */
+#ifdef AUDIO_RECORD
+    /* record until the area is full, the flash erases the sectors while the samples are captured */
+    nvic_irq_enable(RECORD_DMA_IRQn, 0, 0);
+    if(SUCCESS == record_start(AUDIO_RECORD_ADDRESS, AUDIO_RECORD_SIZE, I2S_AUDIOSAMPLE_16K)) {
+        while(RECORD_STATE_RECORD == record_state_get()) {
+            record_process();
+        }
+        record_stop();
+        record_stats_get(&record_stats);
+    }
+    if(VALID_WAVE_FILE == flash_audio_open(AUDIO_RECORD_ADDRESS, &flash_wave)) {
+        flash_audio_source_get(&flash_source);
+        i2s_audio_play_source(&flash_wave, &flash_source);
+    }
+#elif defined(AUDIO_FROM_SPI_FLASH)
+    /* play the audio file stored in the SPI flash */
+    if(VALID_WAVE_FILE == flash_audio_open(AUDIO_FLASH_ADDRESS, &flash_wave)) {
+        flash_audio_source_get(&flash_source);
+        i2s_audio_play_source(&flash_wave, &flash_source);
+    }
+#elif defined(AUDIO_PLAYLIST)
+    /* queue the audio file twice, the second one follows without a gap */
+    codec_wave_reader_get(&playlist_reader);
+    playlist_init();
+    playlist_add(&playlist_reader);
+    playlist_add(&playlist_reader);
+    playlist_play();
+#else
     /* play audio file */
     i2s_audio_play();
+#endif /* AUDIO_FROM_SPI_FLASH */
     while(1) {
+#if defined(AUDIO_FROM_SPI_FLASH) || defined(AUDIO_RECORD)
+        /* keep the prefetch ring ahead of the player */
+        flash_audio_prefetch();
+#elif defined(AUDIO_PLAYLIST)
+        /* parse the next header and handle the end of the list */
+        playlist_process();
+#endif /* AUDIO_FROM_SPI_FLASH */
+        /* refill the blocks played by the DMA */
+        i2s_audio_process();
+#ifdef AUDIO_PROFILE
+        profile_report();
+#endif /* AUDIO_PROFILE */
+    }
+}
+#ifdef AUDIO_PROFILE
+
+/*!
+    \brief      compute the cost of each pipeline stage per frame once the CRC is complete
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void profile_report(void)
+{
+    audio_stage_stats_struct stats;
+    uint32_t stage;
+
+    if(profile_checksum.blocks >= AUDIO_PROFILE_BLOCKS) {
+        return;
+    }
+    i2s_audio_checksum_get(&profile_checksum);
+    if(profile_checksum.blocks < AUDIO_PROFILE_BLOCKS) {
+        return;
+    }
+    for(stage = 0U; stage < AUDIO_STAGE_NUM; stage++) {
+        i2s_audio_stage_stats_get((audio_stage_enum)stage, &stats);
+        if(0U != stats.frames) {
+            profile_cycles[stage] = (float)stats.cycles / (float)stats.frames;
+            profile_ns[stage] = profile_cycles[stage] * 1000000000.0f / (float)SystemCoreClock;
+        }
     }
 }
+#endif /* AUDIO_PROFILE */
@@ -0,0 +1,215 @@
+/*!
+    \file    adpcm.c
+    \brief   IMA-ADPCM decoder
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include "adpcm.h"
+
+#define ADPCM_INDEX_MAX               88
+
+/* step index adjustment for each 4-bit code */
+static const int8_t index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/* quantizer step size for each step index */
+static const int16_t step_table[ADPCM_INDEX_MAX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static void adpcm_channel_decode(adpcm_decoder_struct *decoder, uint32_t channel, int16_t *output, uint32_t frames);
+
+/*!
+    \brief      compute the number of frames stored in one block
+    \param[in]  blockalign: size of one block in bytes
+    \param[in]  channels: number of channels
+    \param[out] none
+    \retval     number of frames, 0 if the block is not the headers followed by whole groups of
+                4 bytes per channel
+*/
+uint16_t adpcm_samples_per_block(uint16_t blockalign, uint16_t channels)
+{
+    if((0U == channels) || (blockalign < (4U * channels))
+            || (0U != ((blockalign - 4U * channels) % (4U * channels)))) {
+        return 0U;
+    }
+    return (uint16_t)(((uint32_t)(blockalign - 4U * channels) * 2U) / channels + 1U);
+}
+
+/*!
+    \brief      initialize the decoder, no block is loaded
+    \param[in]  decoder: pointer to the decoder
+    \param[in]  channels: number of channels, 1 or 2
+    \param[in]  blockalign: size of one block in bytes
+    \param[out] none
+    \retval     none
+*/
+void adpcm_decoder_init(adpcm_decoder_struct *decoder, uint16_t channels, uint16_t blockalign)
+{
+    decoder->channels = channels;
+    decoder->blockalign = blockalign;
+    decoder->samplesperblock = adpcm_samples_per_block(blockalign, channels);
+    /* the first call to adpcm_decode() asks for a block */
+    decoder->frame = decoder->samplesperblock;
+}
+
+/*!
+    \brief      start decoding the block copied into decoder->block
+    \param[in]  decoder: pointer to the decoder
+    \param[out] none
+    \retval     none
+*/
+void adpcm_block_start(adpcm_decoder_struct *decoder)
+{
+    uint32_t channel;
+    const uint8_t *header;
+
+    for(channel = 0U; channel < decoder->channels; channel++) {
+        header = &decoder->block[4U * channel];
+        decoder->predictor[channel] = (int16_t)((uint16_t)header[0] | ((uint16_t)header[1] << 8));
+        decoder->index[channel] = (header[2] > ADPCM_INDEX_MAX) ? ADPCM_INDEX_MAX : header[2];
+    }
+    decoder->frame = 0U;
+}
+
+/*!
+    \brief      decode the next frames of the current block into interleaved 16-bit samples
+    \param[in]  decoder: pointer to the decoder
+    \param[in]  frames: number of frames wanted
+    \param[out] output: pointer to the interleaved samples
+    \retval     number of frames decoded, less than frames when the block ends
+*/
+uint32_t adpcm_decode(adpcm_decoder_struct *decoder, int16_t *output, uint32_t frames)
+{
+    uint32_t channel;
+
+    if(frames > (uint32_t)(decoder->samplesperblock - decoder->frame)) {
+        frames = decoder->samplesperblock - decoder->frame;
+    }
+    if(0U != frames) {
+        /* each channel is decoded in one pass over its own codes */
+        for(channel = 0U; channel < decoder->channels; channel++) {
+            adpcm_channel_decode(decoder, channel, &output[channel], frames);
+        }
+        decoder->frame += frames;
+    }
+    return frames;
+}
+
+/*!
+    \brief      decode the next frames of one channel
+    \param[in]  decoder: pointer to the decoder
+    \param[in]  channel: channel to decode
+    \param[in]  frames: number of frames to decode, the block holds them
+    \param[out] output: pointer to the first sample of the channel, the samples are interleaved
+    \retval     none
+*/
+static void adpcm_channel_decode(adpcm_decoder_struct *decoder, uint32_t channel, int16_t *output, uint32_t frames)
+{
+    uint32_t stride = decoder->channels;
+    uint32_t sample = decoder->frame;
+    int32_t predictor = decoder->predictor[channel];
+    int32_t index = decoder->index[channel];
+    const uint8_t *code;
+    uint32_t nibble;
+    int32_t step;
+    int32_t diff;
+
+    /* frame 0 is the predictor stored in the header */
+    if(0U == sample) {
+        *output = (int16_t)predictor;
+        output += stride;
+        frames--;
+        sample = 1U;
+    }
+    /* codes of the channel: skip the headers, whole groups and the bytes before the sample */
+    sample--;
+    code = &decoder->block[4U * stride + (sample >> 3) * 4U * stride + 4U * channel + ((sample & 7U) >> 1)];
+
+    while(frames--) {
+        if(0U == (sample & 1U)) {
+            nibble = *code & 0x0FU;
+        } else {
+            nibble = *code >> 4;
+            code++;
+            /* jump over the groups of the other channels */
+            if(7U == (sample & 7U)) {
+                code += 4U * (stride - 1U);
+            }
+        }
+        sample++;
+
+        step = step_table[index];
+        diff = step >> 3;
+        if(nibble & 4U) {
+            diff += step;
+        }
+        if(nibble & 2U) {
+            diff += step >> 1;
+        }
+        if(nibble & 1U) {
+            diff += step >> 2;
+        }
+        if(nibble & 8U) {
+            predictor -= diff;
+            if(predictor < -32768) {
+                predictor = -32768;
+            }
+        } else {
+            predictor += diff;
+            if(predictor > 32767) {
+                predictor = 32767;
+            }
+        }
+        index += index_table[nibble];
+        if(index < 0) {
+            index = 0;
+        } else if(index > ADPCM_INDEX_MAX) {
+            index = ADPCM_INDEX_MAX;
+        }
+
+        *output = (int16_t)predictor;
+        output += stride;
+    }
+
+    decoder->predictor[channel] = predictor;
+    decoder->index[channel] = index;
+}
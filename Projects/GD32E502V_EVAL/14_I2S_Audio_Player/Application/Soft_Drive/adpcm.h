@@ -0,0 +1,78 @@
+/*!
+    \file    adpcm.h
+    \brief   the header file of the IMA-ADPCM decoder
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef ADPCM_H
+#define ADPCM_H
+
+/* IMA-ADPCM block layout (WAVE format tag 0x11):
+
+  Each block starts with one 4 bytes header per channel:
+
+  little      0           2 bytes     <predictor>         first sample of the block
+  -           2           1 byte      <step index>        0 to 88
+  -           3           1 byte      <reserved>
+
+  Then the 4-bit codes come in groups of 4 bytes (8 samples) per channel, the channels
+  alternating group by group, low nibble first:
+
+  samples per block = (block align - 4 * channels) * 2 / channels + 1
+*/
+
+#include <stdint.h>
+
+#define ADPCM_BLOCK_ALIGN_MAX         1024U               /* largest supported block align in bytes */
+#define ADPCM_CHANNELS_MAX            2U                  /* largest supported number of channels */
+
+/* IMA-ADPCM decoder structure */
+typedef struct {
+    int32_t predictor[ADPCM_CHANNELS_MAX];              /* last decoded sample of each channel */
+    int32_t index[ADPCM_CHANNELS_MAX];                  /* step index of each channel */
+    uint16_t channels;                                  /* number of channels */
+    uint16_t blockalign;                                /* size of one block in bytes */
+    uint16_t samplesperblock;                           /* frames decoded from one block */
+    uint16_t frame;                                     /* next frame to decode in the block */
+    uint8_t block[ADPCM_BLOCK_ALIGN_MAX];               /* block being decoded */
+} adpcm_decoder_struct;
+
+/* function declarations */
+/* compute the number of frames stored in one block */
+uint16_t adpcm_samples_per_block(uint16_t blockalign, uint16_t channels);
+/* initialize the decoder, no block is loaded */
+void adpcm_decoder_init(adpcm_decoder_struct *decoder, uint16_t channels, uint16_t blockalign);
+/* start decoding the block copied into decoder->block */
+void adpcm_block_start(adpcm_decoder_struct *decoder);
+/* decode the next frames of the current block into interleaved 16-bit samples */
+uint32_t adpcm_decode(adpcm_decoder_struct *decoder, int16_t *output, uint32_t frames);
+
+#endif /* ADPCM_H */
@@ -0,0 +1,237 @@
+/*!
+    \file    audio_dsp.h
+    \brief   Cortex-M33 DSP instructions used by the audio pipeline
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef AUDIO_DSP_H
+#define AUDIO_DSP_H
+
+/* the audio pipeline uses the packed 16-bit instructions of the Cortex-M33 DSP extension,
+   a plain C version of each instruction is used when the extension is not available so
+   that the pipeline modules can also be built and checked on a host computer */
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "gd32e502.h"
+#endif /* __ARM_FEATURE_DSP */
+
+/*!
+    \brief      load two consecutive Q15 samples as one packed word
+    \param[in]  data: pointer to the first sample, no alignment is required
+    \param[out] none
+    \retval     first sample in the low half word, second sample in the high half word
+*/
+static inline uint32_t dsp_read_q15x2(const int16_t *data)
+{
+    uint32_t value;
+
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/*!
+    \brief      dual signed 16-bit multiply with 32-bit accumulate (SMLAD)
+    \param[in]  x: two packed Q15 values
+    \param[in]  y: two packed Q15 values
+    \param[in]  acc: accumulator
+    \param[out] none
+    \retval     acc + x.low * y.low + x.high * y.high
+*/
+static inline int32_t dsp_smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return (int32_t)__SMLAD(x, y, (uint32_t)acc);
+#else
+    return (int32_t)((uint32_t)acc
+                     + (uint32_t)((int32_t)(int16_t)x * (int16_t)y)
+                     + (uint32_t)((int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16)));
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      dual signed 16-bit multiply and add (SMUAD)
+    \param[in]  x: two packed Q15 values
+    \param[in]  y: two packed Q15 values
+    \param[out] none
+    \retval     x.low * y.low + x.high * y.high
+*/
+static inline int32_t dsp_smuad(uint32_t x, uint32_t y)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return (int32_t)__SMUAD(x, y);
+#else
+    return (int32_t)((uint32_t)((int32_t)(int16_t)x * (int16_t)y)
+                     + (uint32_t)((int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16)));
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      signed multiply of the low half words (SMULBB)
+    \param[in]  x: two packed 16-bit values
+    \param[in]  y: two packed 16-bit values
+    \param[out] none
+    \retval     x.low * y.low
+*/
+static inline int32_t dsp_smulbb(uint32_t x, uint32_t y)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __smulbb((int32_t)x, (int32_t)y);
+#else
+    return (int32_t)(int16_t)x * (int16_t)y;
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      signed multiply of the high half word of x by the low half word of y (SMULTB)
+    \param[in]  x: two packed 16-bit values
+    \param[in]  y: two packed 16-bit values
+    \param[out] none
+    \retval     x.high * y.low
+*/
+static inline int32_t dsp_smultb(uint32_t x, uint32_t y)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __smultb((int32_t)x, (int32_t)y);
+#else
+    return (int32_t)(int16_t)(x >> 16) * (int16_t)y;
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      dual signed 16-bit multiply with 64-bit accumulate (SMLALD)
+    \param[in]  x: two packed Q15 values
+    \param[in]  y: two packed Q15 values
+    \param[in]  acc: accumulator
+    \param[out] none
+    \retval     acc + x.low * y.low + x.high * y.high
+*/
+static inline int64_t dsp_smlald(uint32_t x, uint32_t y, int64_t acc)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return (int64_t)__SMLALD(x, y, (uint64_t)acc);
+#else
+    return acc + ((int32_t)(int16_t)x * (int16_t)y) + ((int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16));
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      saturate a value to the signed 16-bit range (SSAT)
+    \param[in]  value: value to saturate
+    \param[out] none
+    \retval     the saturated value
+*/
+static inline int16_t dsp_ssat16(int32_t value)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return (int16_t)__SSAT(value, 16);
+#else
+    if(value > 32767) {
+        value = 32767;
+    } else if(value < -32768) {
+        value = -32768;
+    }
+    return (int16_t)value;
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      pack two 16-bit values in one word (PKHBT)
+    \param[in]  low: value placed in the low half word
+    \param[in]  high: value placed in the high half word
+    \param[out] none
+    \retval     the packed values
+*/
+static inline uint32_t dsp_pack(int16_t low, int16_t high)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __PKHBT((uint32_t)(uint16_t)low, (uint32_t)(uint16_t)high, 16);
+#else
+    return (uint32_t)(uint16_t)low | ((uint32_t)(uint16_t)high << 16);
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      pack the low half words of two words (PKHBT)
+    \param[in]  x: word giving the low half word
+    \param[in]  y: word giving the high half word
+    \param[out] none
+    \retval     low half of x in the low half word, low half of y in the high half word
+*/
+static inline uint32_t dsp_pack_bottom(uint32_t x, uint32_t y)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __PKHBT(x, y, 16);
+#else
+    return (x & 0x0000FFFFU) | (y << 16);
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      pack the high half words of two words (PKHTB)
+    \param[in]  x: word giving the low half word
+    \param[in]  y: word giving the high half word
+    \param[out] none
+    \retval     high half of x in the low half word, high half of y in the high half word
+*/
+static inline uint32_t dsp_pack_top(uint32_t x, uint32_t y)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __PKHTB(y, x, 16);
+#else
+    return (x >> 16) | (y & 0xFFFF0000U);
+#endif /* __ARM_FEATURE_DSP */
+}
+
+/*!
+    \brief      dual signed 16-bit saturating addition (QADD16)
+    \param[in]  x: two packed 16-bit values
+    \param[in]  y: two packed 16-bit values
+    \param[out] none
+    \retval     the two saturated sums, packed
+*/
+static inline uint32_t dsp_qadd16(uint32_t x, uint32_t y)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    return __QADD16(x, y);
+#else
+    int32_t low = (int32_t)(int16_t)x + (int16_t)y;
+    int32_t high = (int32_t)(int16_t)(x >> 16) + (int16_t)(y >> 16);
+
+    low = (low > 32767) ? 32767 : ((low < -32768) ? -32768 : low);
+    high = (high > 32767) ? 32767 : ((high < -32768) ? -32768 : high);
+    return (uint32_t)(uint16_t)low | ((uint32_t)(uint16_t)high << 16);
+#endif /* __ARM_FEATURE_DSP */
+}
+
+#endif /* AUDIO_DSP_H */
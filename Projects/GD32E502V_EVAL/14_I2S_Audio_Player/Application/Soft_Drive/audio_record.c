@@ -0,0 +1,437 @@
+/*!
+    \file    audio_record.c
+    \brief   I2S recorder writing to the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "audio_record.h"
+#include "gd25qxx.h"
+
+/* read the DWT cycle counter */
+#define RECORD_CYCLES()     (DWT->CYCCNT)
+
+/* flash side of the recorder */
+typedef enum {
+    RECORD_FLASH_IDLE = 0,              /* the flash is ready for a page program */
+    RECORD_FLASH_ERASE                  /* a sector erase is in progress */
+} record_flash_enum;
+
+/* ping-pong buffer of the I2S frames, the DMA fills one block while the other one is read */
+static uint16_t record_buffer[RECORD_BUFFER_SIZE];
+static __IO uint8_t block_pending[2] = {0U, 0U};
+static uint8_t block_next = 0U;
+/* mono samples waiting to be written to the flash */
+static uint8_t record_fifo[RECORD_FIFO_SIZE];
+static uint32_t fifo_head = 0U;
+static uint32_t fifo_tail = 0U;
+static uint8_t record_page[SPI_FLASH_PAGE_SIZE];
+static __IO record_state_enum record_state = RECORD_STATE_STOP;
+static record_flash_enum flash_state = RECORD_FLASH_IDLE;
+/* recording area, next address to program and end of the erased sectors */
+static uint32_t record_address = 0U;
+static uint32_t record_end = 0U;
+static uint32_t write_address = 0U;
+static uint32_t erased_end = 0U;
+static uint32_t erase_start = 0U;
+/* sample rate produced by the I2S prescaler */
+static uint32_t record_rate = 0U;
+static __IO record_stats_struct record_stats;
+
+static void record_i2s_config(uint32_t samplerate);
+static void record_dma_config(void);
+static void record_block_read(const uint16_t *block);
+static FlagStatus record_flash_step(void);
+static void record_header_write(uint32_t datasize);
+static void record_block_release(uint8_t block);
+
+/*!
+    \brief      start recording 16-bit mono samples into the SPI flash
+    \param[in]  address: start of the recording area, sector aligned
+    \param[in]  size: size of the recording area in bytes, header included
+    \param[in]  samplerate: requested sample rate in Hz, the header gives the rate of the I2S prescaler
+    \param[out] none
+    \retval     SUCCESS or ERROR if the area is not usable
+*/
+ErrStatus record_start(uint32_t address, uint32_t size, uint32_t samplerate)
+{
+    if((0U != (address % RECORD_SECTOR_SIZE)) || (size <= RECORD_HEADER_SIZE)) {
+        return ERROR;
+    }
+    /* I2S1 is shared with the player */
+    i2s_audio_stop();
+    record_stop();
+    /* the statistics cover this recording only */
+    record_stats_clear();
+    spi_flash_init();
+
+    record_address = address;
+    record_end = address + size;
+    /* the header is programmed at the end into the first bytes, they stay erased meanwhile */
+    write_address = address + RECORD_HEADER_SIZE;
+    erased_end = address;
+    flash_state = RECORD_FLASH_IDLE;
+    fifo_head = 0U;
+    fifo_tail = 0U;
+    block_pending[0] = 0U;
+    block_pending[1] = 0U;
+    block_next = 0U;
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    record_state = RECORD_STATE_RECORD;
+
+    record_dma_config();
+    record_i2s_config(samplerate);
+    dma_channel_enable(RECORD_DMA, RECORD_DMA_CHANNEL);
+    spi_dma_enable(SPI1, SPI_DMA_RECEIVE);
+    i2s_enable(SPI1);
+    return SUCCESS;
+}
+
+/*!
+    \brief      move the captured samples to the flash, call from the main loop
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void record_process(void)
+{
+    uint32_t fill;
+
+    if(RECORD_STATE_STOP == record_state) {
+        return;
+    }
+    /* empty the DMA blocks first, they are the only buffer the hardware fills */
+    while(0U != block_pending[block_next]) {
+        record_block_read(&record_buffer[block_next * (RECORD_BUFFER_SIZE / 2U)]);
+        block_pending[block_next] = 0U;
+        block_next ^= 1U;
+    }
+    fill = fifo_head - fifo_tail;
+    if(fill > record_stats.fifo_max) {
+        record_stats.fifo_max = fill;
+        record_stats.fifo_max_us = (uint32_t)(((uint64_t)fill * 1000000U) / (record_rate * 2U));
+    }
+    if(RECORD_STATE_RECORD == record_state) {
+        record_flash_step();
+    }
+}
+
+/*!
+    \brief      stop recording, write the rest of the samples and the wave header
+    \param[in]  none
+    \param[out] none
+    \retval     size of the wave file in bytes, 0 if nothing was recorded
+*/
+uint32_t record_stop(void)
+{
+    uint32_t datasize;
+
+    if(RECORD_STATE_STOP == record_state) {
+        return 0U;
+    }
+    spi_dma_disable(SPI1, SPI_DMA_RECEIVE);
+    dma_channel_disable(RECORD_DMA, RECORD_DMA_CHANNEL);
+    i2s_disable(SPI1);
+    /* take the last full blocks, then write the FIFO out, partial page included */
+    record_process();
+    record_state = RECORD_STATE_STOP;
+    while((fifo_head != fifo_tail) && (write_address < record_end)) {
+        record_flash_step();
+    }
+    spi_flash_wait_for_write_end();
+
+    datasize = write_address - record_address - RECORD_HEADER_SIZE;
+    record_header_write(datasize);
+    return datasize + RECORD_HEADER_SIZE;
+}
+
+/*!
+    \brief      get the recorder state
+    \param[in]  none
+    \param[out] none
+    \retval     record_state_enum
+*/
+record_state_enum record_state_get(void)
+{
+    return record_state;
+}
+
+/*!
+    \brief      get the recorder statistics
+    \param[in]  none
+    \param[out] stats: the recorder statistics
+    \retval     none
+*/
+void record_stats_get(record_stats_struct *stats)
+{
+    stats->fifo_max = record_stats.fifo_max;
+    stats->fifo_max_us = record_stats.fifo_max_us;
+    stats->overrun = record_stats.overrun;
+    stats->dma_overrun = record_stats.dma_overrun;
+    stats->erases = record_stats.erases;
+    stats->erase_max_us = record_stats.erase_max_us;
+    stats->pages = record_stats.pages;
+}
+
+/*!
+    \brief      clear the recorder statistics
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void record_stats_clear(void)
+{
+    record_stats.fifo_max = 0U;
+    record_stats.fifo_max_us = 0U;
+    record_stats.overrun = 0U;
+    record_stats.dma_overrun = 0U;
+    record_stats.erases = 0U;
+    record_stats.erase_max_us = 0U;
+    record_stats.pages = 0U;
+}
+
+/*!
+    \brief      DMA half transfer callback, the first block has been filled
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void record_half_transfer_callback(void)
+{
+    record_block_release(0U);
+}
+
+/*!
+    \brief      DMA full transfer callback, the second block has been filled
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void record_full_transfer_callback(void)
+{
+    record_block_release(1U);
+}
+
+/*!
+    \brief      configure I2S1 as a master receiver
+    \param[in]  samplerate: requested sample rate in Hz
+    \param[out] none
+    \retval     none
+*/
+static void record_i2s_config(uint32_t samplerate)
+{
+    uint32_t divider;
+
+    rcu_periph_clock_enable(RCU_GPIOD);
+    rcu_periph_clock_enable(RCU_GPIOC);
+    rcu_periph_clock_enable(RCU_SPI1);
+
+    /* I2S1 GPIO configuration: MCK/PC7, SCK/PC6, SD/PD14, WS/PD13 */
+    gpio_af_set(GPIOD, GPIO_AF_4, GPIO_PIN_13 | GPIO_PIN_14);
+    gpio_mode_set(GPIOD, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_13 | GPIO_PIN_14);
+    gpio_output_options_set(GPIOD, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 | GPIO_PIN_14);
+
+    gpio_af_set(GPIOC, GPIO_AF_4, GPIO_PIN_6 | GPIO_PIN_7);
+    gpio_mode_set(GPIOC, GPIO_MODE_AF, GPIO_PUPD_NONE, GPIO_PIN_6 | GPIO_PIN_7);
+    gpio_output_options_set(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_6 | GPIO_PIN_7);
+
+    i2s_psc_config(SPI1, samplerate, I2S_FRAMEFORMAT_DT16B_CH16B, I2S_MCLKOUTPUT);
+    i2s_init(SPI1, I2S_MODE_MASTERRX, I2S_STANDARD, I2S_CKPL_HIGH);
+
+    /* read back the prescaler, I2S1 is clocked by CK_SYS */
+    divider = 2U * (SPI_I2SPSC(SPI1) & SPI_I2SPSC_DIV) + ((0U != (SPI_I2SPSC(SPI1) & SPI_I2SPSC_OF)) ? 1U : 0U);
+    divider *= (0U != (SPI_I2SPSC(SPI1) & SPI_I2SPSC_MCKOEN)) ? 256U : 32U;
+    record_rate = (rcu_clock_freq_get(CK_SYS) + (divider / 2U)) / divider;
+}
+
+/*!
+    \brief      configure the DMA channel reading I2S1
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void record_dma_config(void)
+{
+    dma_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_DMA0);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    dma_deinit(RECORD_DMA, RECORD_DMA_CHANNEL);
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.request      = DMA_REQUEST_SPI1_RX;
+    dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+    dma_init_struct.memory_addr  = (uint32_t)record_buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = RECORD_BUFFER_SIZE;
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI1);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(RECORD_DMA, RECORD_DMA_CHANNEL, &dma_init_struct);
+
+    dma_circulation_enable(RECORD_DMA, RECORD_DMA_CHANNEL);
+    dma_memory_to_memory_disable(RECORD_DMA, RECORD_DMA_CHANNEL);
+    dmamux_synchronization_disable(RECORD_DMA_MUX_CHANNEL);
+
+    dma_interrupt_flag_clear(RECORD_DMA, RECORD_DMA_CHANNEL, DMA_INT_FLAG_G);
+    dma_interrupt_enable(RECORD_DMA, RECORD_DMA_CHANNEL, DMA_INT_HTF | DMA_INT_FTF);
+}
+
+/*!
+    \brief      copy the left channel of a block into the FIFO
+    \param[in]  block: pointer to the block of stereo frames
+    \param[out] none
+    \retval     none
+*/
+static void record_block_read(const uint16_t *block)
+{
+    uint32_t index;
+    uint32_t position;
+
+    for(index = 0U; index < RECORD_BLOCK_FRAMES; index++) {
+        if((fifo_head - fifo_tail) > (RECORD_FIFO_SIZE - 2U)) {
+            record_stats.overrun += RECORD_BLOCK_FRAMES - index;
+            break;
+        }
+        /* the FIFO size is a power of two and a sample never straddles its end */
+        position = fifo_head & (RECORD_FIFO_SIZE - 1U);
+        record_fifo[position] = (uint8_t)block[2U * index];
+        record_fifo[position + 1U] = (uint8_t)(block[2U * index] >> 8);
+        fifo_head += 2U;
+    }
+}
+
+/*!
+    \brief      advance the flash side by one operation: wait for an erase, erase a sector or program a page
+    \param[in]  none
+    \param[out] none
+    \retval     SET if an operation was done or is in progress, RESET if the FIFO lacks data for a page
+*/
+static FlagStatus record_flash_step(void)
+{
+    uint32_t chunk;
+    uint32_t elapsed;
+    uint32_t position;
+    uint32_t index;
+
+    if(RECORD_FLASH_ERASE == flash_state) {
+        /* the erase runs inside the flash, the samples keep going to the FIFO meanwhile */
+        if(SET == spi_flash_write_busy()) {
+            return SET;
+        }
+        elapsed = (RECORD_CYCLES() - erase_start) / (SystemCoreClock / 1000000U);
+        if(elapsed > record_stats.erase_max_us) {
+            record_stats.erase_max_us = elapsed;
+        }
+        flash_state = RECORD_FLASH_IDLE;
+    }
+
+    if(write_address >= record_end) {
+        if(RECORD_STATE_RECORD == record_state) {
+            record_state = RECORD_STATE_FULL;
+        }
+        return RESET;
+    }
+    if(write_address >= erased_end) {
+        spi_flash_sector_erase_start(erased_end);
+        erased_end += RECORD_SECTOR_SIZE;
+        erase_start = RECORD_CYCLES();
+        record_stats.erases++;
+        flash_state = RECORD_FLASH_ERASE;
+        return SET;
+    }
+
+    /* a page program stops at the page end, and at the end of the recording area */
+    chunk = SPI_FLASH_PAGE_SIZE - (write_address % SPI_FLASH_PAGE_SIZE);
+    if(chunk > (record_end - write_address)) {
+        chunk = record_end - write_address;
+    }
+    if((fifo_head - fifo_tail) < chunk) {
+        /* record_stop() writes the last partial page */
+        if(RECORD_STATE_STOP != record_state) {
+            return RESET;
+        }
+        chunk = fifo_head - fifo_tail;
+        if(0U == chunk) {
+            return RESET;
+        }
+    }
+    for(index = 0U; index < chunk; index++) {
+        position = (fifo_tail + index) & (RECORD_FIFO_SIZE - 1U);
+        record_page[index] = record_fifo[position];
+    }
+    spi_flash_page_write(record_page, write_address, (uint16_t)chunk);
+    fifo_tail += chunk;
+    write_address += chunk;
+    record_stats.pages++;
+    return SET;
+}
+
+/*!
+    \brief      program the wave header in front of the recorded samples
+    \param[in]  datasize: size of the recorded samples in bytes
+    \param[out] none
+    \retval     none
+*/
+static void record_header_write(uint32_t datasize)
+{
+    uint8_t header[RECORD_HEADER_SIZE];
+    uint32_t fields[] = {
+        0x46464952U, datasize + 36U, 0x45564157U, 0x20746D66U, 16U,
+        /* pcm, mono, sample rate, byte rate, block align 2, 16 bits per sample */
+        0x00010001U, record_rate, record_rate * 2U, 0x00100002U,
+        0x61746164U, datasize
+    };
+    uint32_t index;
+
+    for(index = 0U; index < RECORD_HEADER_SIZE; index++) {
+        header[index] = (uint8_t)(fields[index / 4U] >> (8U * (index % 4U)));
+    }
+    spi_flash_page_write(header, record_address, RECORD_HEADER_SIZE);
+}
+
+/*!
+    \brief      mark a block as filled and check that the DMA moved onto a block already read
+    \param[in]  block: index of the block filled by the DMA
+    \param[out] none
+    \retval     none
+*/
+static void record_block_release(uint8_t block)
+{
+    /* the DMA has started the other block, it must have been read */
+    if(0U != block_pending[block ^ 1U]) {
+        record_stats.dma_overrun++;
+    }
+    block_pending[block] = 1U;
+}
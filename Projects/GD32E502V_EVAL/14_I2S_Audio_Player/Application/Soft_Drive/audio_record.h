@@ -0,0 +1,89 @@
+/*!
+    \file    audio_record.h
+    \brief   the header file of the I2S recorder writing to the SPI flash
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef AUDIO_RECORD_H
+#define AUDIO_RECORD_H
+
+#include "gd32e502.h"
+#include "i2s_codec.h"
+
+/* record DMA configuration parameters */
+#define RECORD_DMA                    DMA0                /* DMA used to read SPI1/I2S1 */
+#define RECORD_DMA_CHANNEL            DMA_CH1             /* DMA channel used to read SPI1/I2S1 */
+#define RECORD_DMA_IRQn               DMA0_Channel1_IRQn  /* DMA channel interrupt */
+#define RECORD_DMA_MUX_CHANNEL        DMAMUX_MULTIPLEXER_CH1
+#define RECORD_BLOCK_FRAMES           128U                /* stereo frames in one half of the ping-pong buffer */
+#define RECORD_BUFFER_SIZE            (RECORD_BLOCK_FRAMES * 4U)      /* half words in the ping-pong buffer */
+/* the FIFO holds the samples while the flash erases a sector, 16 KB is 512 ms at 16 kHz */
+#define RECORD_FIFO_SIZE              16384U              /* bytes, power of two */
+#define RECORD_HEADER_SIZE            44U                 /* wave header written at the start of the recording */
+#define RECORD_SECTOR_SIZE            0x1000U             /* GD25Q16 sector size */
+
+/* recorder state enum */
+typedef enum {
+    RECORD_STATE_STOP = 0,              /* nothing is recorded */
+    RECORD_STATE_RECORD,                /* the samples are captured and written to the flash */
+    RECORD_STATE_FULL                   /* the recording area is full, record_stop() writes the header */
+} record_state_enum;
+
+/* recorder statistics structure */
+typedef struct {
+    uint32_t fifo_max;                  /* largest number of bytes waiting in the FIFO */
+    uint32_t fifo_max_us;               /* fifo_max expressed in microseconds of audio */
+    uint32_t overrun;                   /* samples lost because the FIFO was full */
+    uint32_t dma_overrun;               /* blocks overwritten by the DMA before being read */
+    uint32_t erases;                    /* sectors erased */
+    uint32_t erase_max_us;              /* longest sector erase */
+    uint32_t pages;                     /* pages programmed */
+} record_stats_struct;
+
+/* function declarations */
+/* start recording 16-bit mono samples into the SPI flash */
+ErrStatus record_start(uint32_t address, uint32_t size, uint32_t samplerate);
+/* move the captured samples to the flash, call from the main loop */
+void record_process(void);
+/* stop recording, write the rest of the samples and the wave header */
+uint32_t record_stop(void);
+/* get the recorder state */
+record_state_enum record_state_get(void);
+/* get the recorder statistics */
+void record_stats_get(record_stats_struct *stats);
+/* clear the recorder statistics */
+void record_stats_clear(void);
+/* DMA half transfer callback */
+void record_half_transfer_callback(void);
+/* DMA full transfer callback */
+void record_full_transfer_callback(void);
+
+#endif /* AUDIO_RECORD_H */
@@ -0,0 +1,240 @@
+/*!
+    \file    equalizer.c
+    \brief   biquad equalizer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <string.h>
+#include "equalizer.h"
+#include "audio_dsp.h"
+
+#define EQ_PI                         3.14159265f
+
+static void eq_band_compute(eq_band_struct *band, uint32_t samplerate);
+
+/*!
+    \brief      initialize the equalizer, all the bands are bypassed
+    \param[in]  eq: pointer to the equalizer
+    \param[in]  samplerate: sample rate of the frames in Hz
+    \param[out] none
+    \retval     none
+*/
+void eq_init(eq_struct *eq, uint32_t samplerate)
+{
+    memset(eq, 0, sizeof(eq_struct));
+    eq->samplerate = samplerate;
+}
+
+/*!
+    \brief      recompute the coefficients of the bands for a new sample rate
+    \param[in]  eq: pointer to the equalizer
+    \param[in]  samplerate: sample rate of the frames in Hz
+    \param[out] none
+    \retval     none
+*/
+void eq_samplerate_set(eq_struct *eq, uint32_t samplerate)
+{
+    uint8_t band;
+
+    if(samplerate != eq->samplerate) {
+        eq->samplerate = samplerate;
+        for(band = 0U; band < EQ_BANDS; band++) {
+            eq_band_compute(&eq->band[band], samplerate);
+        }
+    }
+}
+
+/*!
+    \brief      configure a band of the equalizer
+    \param[in]  eq: pointer to the equalizer
+    \param[in]  band: index of the band
+    \param[in]  type: type of the band
+      \arg        EQ_BAND_OFF: the band is bypassed
+      \arg        EQ_BAND_LOWSHELF: gain below the frequency
+      \arg        EQ_BAND_PEAKING: gain around the frequency
+      \arg        EQ_BAND_HIGHSHELF: gain above the frequency
+    \param[in]  frequency: centre or corner frequency in Hz, below half the sample rate
+    \param[in]  gain: gain in dB
+    \param[in]  q: quality factor, 0.707 for a shelf without overshoot
+    \param[out] none
+    \retval     none
+*/
+void eq_band_config(eq_struct *eq, uint8_t band, eq_band_enum type, float frequency, float gain, float q)
+{
+    if(band < EQ_BANDS) {
+        eq->band[band].type = type;
+        eq->band[band].frequency = frequency;
+        eq->band[band].gain = gain;
+        eq->band[band].q = q;
+        eq_band_compute(&eq->band[band], eq->samplerate);
+    }
+}
+
+/*!
+    \brief      filter interleaved stereo frames in place
+    \param[in]  eq: pointer to the equalizer
+    \param[in]  frames: pointer to the interleaved 16-bit frames
+    \param[in]  count: number of stereo frames
+    \param[out] frames: the filtered frames
+    \retval     none
+*/
+void eq_process(eq_struct *eq, int16_t *frames, uint32_t count)
+{
+    eq_band_struct *band;
+    int16_t *sample;
+    int16_t *end;
+    uint32_t channel;
+    uint32_t shift;
+    uint32_t error;
+    int32_t x1;
+    int32_t x2;
+    int32_t y1;
+    int32_t y2;
+    int64_t acc;
+    int16_t in;
+    int16_t out;
+
+    for(band = &eq->band[0]; band < &eq->band[EQ_BANDS]; band++) {
+        if(EQ_BAND_OFF == band->type) {
+            continue;
+        }
+        /* one channel of one band over the whole block keeps its coefficients and state in registers */
+        shift = 31U - band->shift;
+        for(channel = 0U; channel < 2U; channel++) {
+            x1 = band->x[channel][0];
+            x2 = band->x[channel][1];
+            y1 = band->y[channel][0];
+            y2 = band->y[channel][1];
+            error = band->error[channel];
+            end = &frames[2U * count];
+            for(sample = &frames[channel]; sample < end; sample += 2) {
+                in = *sample;
+                /* y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2], one SMLAL each */
+                acc = (int64_t)error + (int64_t)band->b[0] * in;
+                acc += (int64_t)band->b[1] * x1;
+                acc += (int64_t)band->b[2] * x2;
+                acc += (int64_t)band->a[0] * y1;
+                acc += (int64_t)band->a[1] * y2;
+                out = dsp_ssat16((int32_t)(acc >> shift));
+                /* the part lost by the shift is added to the next sample (first order error
+                   feedback), it keeps the rounding noise of low frequency poles small */
+                acc -= (int64_t)out << shift;
+                /* when the output saturated the difference is not a rounding error */
+                error = ((acc >= 0) && (acc < ((int64_t)1 << shift))) ? (uint32_t)acc : 0U;
+                x2 = x1;
+                x1 = in;
+                y2 = y1;
+                y1 = out;
+                *sample = out;
+            }
+            band->x[channel][0] = x1;
+            band->x[channel][1] = x2;
+            band->y[channel][0] = y1;
+            band->y[channel][1] = y2;
+            band->error[channel] = error;
+        }
+    }
+}
+
+/*!
+    \brief      compute the fixed point coefficients of a band (audio EQ cookbook)
+    \param[in]  band: pointer to the band
+    \param[in]  samplerate: sample rate of the frames in Hz
+    \param[out] none
+    \retval     none
+*/
+static void eq_band_compute(eq_band_struct *band, uint32_t samplerate)
+{
+    float coef[5];
+    float a = powf(10.0f, band->gain / 40.0f);
+    float w0 = 2.0f * EQ_PI * band->frequency / (float)samplerate;
+    float cosw0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * band->q);
+    float root = 2.0f * sqrtf(a) * alpha;
+    float a0 = 1.0f;
+    float largest = 0.0f;
+    float scale;
+    uint32_t index;
+
+    /* the coefficients are computed once the sample rate is known */
+    if(0U == samplerate) {
+        return;
+    }
+    switch(band->type) {
+    case EQ_BAND_LOWSHELF:
+        a0 = (a + 1.0f) + (a - 1.0f) * cosw0 + root;
+        coef[0] = a * ((a + 1.0f) - (a - 1.0f) * cosw0 + root);
+        coef[1] = 2.0f * a * ((a - 1.0f) - (a + 1.0f) * cosw0);
+        coef[2] = a * ((a + 1.0f) - (a - 1.0f) * cosw0 - root);
+        coef[3] = 2.0f * ((a - 1.0f) + (a + 1.0f) * cosw0);
+        coef[4] = -((a + 1.0f) + (a - 1.0f) * cosw0 - root);
+        break;
+    case EQ_BAND_PEAKING:
+        a0 = 1.0f + alpha / a;
+        coef[0] = 1.0f + alpha * a;
+        coef[1] = -2.0f * cosw0;
+        coef[2] = 1.0f - alpha * a;
+        coef[3] = 2.0f * cosw0;
+        coef[4] = -(1.0f - alpha / a);
+        break;
+    case EQ_BAND_HIGHSHELF:
+        a0 = (a + 1.0f) - (a - 1.0f) * cosw0 + root;
+        coef[0] = a * ((a + 1.0f) + (a - 1.0f) * cosw0 + root);
+        coef[1] = -2.0f * a * ((a - 1.0f) + (a + 1.0f) * cosw0);
+        coef[2] = a * ((a + 1.0f) + (a - 1.0f) * cosw0 - root);
+        coef[3] = -2.0f * ((a - 1.0f) - (a + 1.0f) * cosw0);
+        coef[4] = -((a + 1.0f) - (a - 1.0f) * cosw0 - root);
+        break;
+    default:
+        band->type = EQ_BAND_OFF;
+        return;
+    }
+
+    /* normalize by a0, then pick the Q format that holds the largest coefficient */
+    for(index = 0U; index < 5U; index++) {
+        coef[index] /= a0;
+        if(fabsf(coef[index]) > largest) {
+            largest = fabsf(coef[index]);
+        }
+    }
+    band->shift = 0U;
+    while(((largest * (float)(1UL << (31U - band->shift))) >= 2147483648.0f) && (band->shift < 4U)) {
+        band->shift++;
+    }
+    /* 31-bit coefficients, the poles of a low shelf sit within 1e-4 of z = 1 */
+    scale = (float)(1UL << (31U - band->shift));
+    for(index = 0U; index < 3U; index++) {
+        band->b[index] = (int32_t)lrintf(coef[index] * scale);
+    }
+    band->a[0] = (int32_t)lrintf(coef[3] * scale);
+    band->a[1] = (int32_t)lrintf(coef[4] * scale);
+}
@@ -0,0 +1,80 @@
+/*!
+    \file    equalizer.h
+    \brief   the header file of the biquad equalizer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef EQUALIZER_H
+#define EQUALIZER_H
+
+#include <stdint.h>
+
+#define EQ_BANDS                      4U                  /* biquad sections of the equalizer */
+
+/* equalizer band type enum */
+typedef enum {
+    EQ_BAND_OFF = 0,                    /* the band is bypassed */
+    EQ_BAND_LOWSHELF,                   /* gain below the frequency */
+    EQ_BAND_PEAKING,                    /* gain around the frequency */
+    EQ_BAND_HIGHSHELF                   /* gain above the frequency */
+} eq_band_enum;
+
+/* equalizer band structure, one Direct Form I biquad */
+typedef struct {
+    int32_t b[3];                                       /* b0, b1 and b2 in Q(31 - shift) */
+    int32_t a[2];                                       /* -a1 and -a2 in Q(31 - shift) */
+    uint32_t shift;                                     /* coefficients larger than 1.0 are scaled down by 2^shift */
+    int32_t x[2][2];                                    /* x[n-1] and x[n-2] of each channel */
+    int32_t y[2][2];                                    /* y[n-1] and y[n-2] of each channel */
+    uint32_t error[2];                                  /* rounding error of y[n-1] of each channel */
+    eq_band_enum type;                                  /* type of the band */
+    float frequency;                                    /* centre or corner frequency in Hz */
+    float gain;                                         /* gain in dB */
+    float q;                                            /* quality factor */
+} eq_band_struct;
+
+/* equalizer structure */
+typedef struct {
+    eq_band_struct band[EQ_BANDS];                      /* cascaded bands */
+    uint32_t samplerate;                                /* sample rate the coefficients are computed for */
+} eq_struct;
+
+/* function declarations */
+/* initialize the equalizer, all the bands are bypassed */
+void eq_init(eq_struct *eq, uint32_t samplerate);
+/* recompute the coefficients of the bands for a new sample rate */
+void eq_samplerate_set(eq_struct *eq, uint32_t samplerate);
+/* configure a band of the equalizer */
+void eq_band_config(eq_struct *eq, uint8_t band, eq_band_enum type, float frequency, float gain, float q);
+/* filter interleaved stereo frames in place */
+void eq_process(eq_struct *eq, int16_t *frames, uint32_t count);
+
+#endif /* EQUALIZER_H */
@@ -0,0 +1,248 @@
+/*!
+    \file    flash_audio.c
+    \brief   SPI flash audio source with a prefetch ring
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "flash_audio.h"
+#include "gd25qxx.h"
+
+#define FLASH_AUDIO_RING_MASK         (FLASH_AUDIO_RING_SIZE - 1U)
+#define FLASH_AUDIO_STORE_CHUNK       0x1000U             /* bytes written by one qspi_flash_buffer_write() */
+
+/* prefetch ring, the prefetch writes at ring_head and the player reads at ring_tail */
+static uint8_t ring[FLASH_AUDIO_RING_SIZE];
+static __IO uint32_t ring_head = 0U;
+static __IO uint32_t ring_tail = 0U;
+/* location of the audio data in the SPI flash */
+static uint32_t data_address = 0U;
+static uint32_t data_size = 0U;
+static uint32_t byte_rate = 0U;
+/* bytes of a frame, or of a compressed block, and bytes of it already given to the player */
+static uint32_t block_align = 1U;
+static uint32_t block_phase = 0U;
+/* offset of the next byte to prefetch in the audio data */
+static uint32_t data_position = 0U;
+static flash_audio_stats_struct flash_stats;
+
+static uint32_t flash_wave_read(void *context, uint32_t offset, uint8_t *buffer, uint32_t length);
+static uint32_t flash_audio_read(void *context, uint8_t *buffer, uint32_t length);
+
+/*!
+    \brief      parse the wave file stored in the SPI flash and prime the prefetch ring
+    \param[in]  address: address of the wave file in the SPI flash
+    \param[out] wave: format of the wave file
+    \retval     errorcode_enum
+*/
+errorcode_enum flash_audio_open(uint32_t address, wave_file_struct *wave)
+{
+    wave_reader_struct reader;
+    errorcode_enum errorcode = UNVALID_RIFF_ID;
+
+    spi_flash_init();
+    qspi_flash_quad_enable();
+
+    /* only the chunk headers are read, the audio data stays in the flash */
+    reader.read = flash_wave_read;
+    reader.context = (void *)address;
+    reader.size = 0U;
+    errorcode = wave_parse(&reader, wave);
+    if(VALID_WAVE_FILE != errorcode) {
+        return errorcode;
+    }
+
+    data_address = address + wave->dataoffset;
+    data_size = wave->datasize;
+    byte_rate = wave->byterate;
+    block_align = (0U != wave->blockalign) ? wave->blockalign : 1U;
+    block_phase = 0U;
+    data_position = 0U;
+    ring_head = 0U;
+    ring_tail = 0U;
+    flash_audio_stats_clear();
+
+    /* fill the whole ring before the player starts */
+    while((0U != data_size) && ((FLASH_AUDIO_RING_SIZE - (ring_head - ring_tail)) >= FLASH_AUDIO_CHUNK_SIZE)) {
+        flash_audio_prefetch();
+    }
+    return errorcode;
+}
+
+/*!
+    \brief      get the audio source reading the prefetch ring
+    \param[in]  none
+    \param[out] source: the audio source
+    \retval     none
+*/
+void flash_audio_source_get(audio_source_struct *source)
+{
+    source->read = flash_audio_read;
+    source->context = NULL;
+}
+
+/*!
+    \brief      read the next chunk of audio data from the SPI flash if the ring has room
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_audio_prefetch(void)
+{
+    uint32_t head = ring_head;
+    uint32_t length = FLASH_AUDIO_CHUNK_SIZE;
+
+    if((0U == data_size) || ((FLASH_AUDIO_RING_SIZE - (head - ring_tail)) < FLASH_AUDIO_CHUNK_SIZE)) {
+        return;
+    }
+    /* one read never crosses the end of the ring nor the end of the audio data */
+    if(length > (FLASH_AUDIO_RING_SIZE - (head & FLASH_AUDIO_RING_MASK))) {
+        length = FLASH_AUDIO_RING_SIZE - (head & FLASH_AUDIO_RING_MASK);
+    }
+    if(length > (data_size - data_position)) {
+        length = data_size - data_position;
+    }
+
+    qspi_flash_buffer_read(&ring[head & FLASH_AUDIO_RING_MASK], data_address + data_position, (uint16_t)length);
+    flash_stats.reads++;
+
+    /* loop the audio file forever */
+    data_position += length;
+    if(data_position >= data_size) {
+        data_position = 0U;
+    }
+    ring_head = head + length;
+}
+
+/*!
+    \brief      get the SPI flash audio source statistics
+    \param[in]  none
+    \param[out] stats: the SPI flash audio source statistics
+    \retval     none
+*/
+void flash_audio_stats_get(flash_audio_stats_struct *stats)
+{
+    *stats = flash_stats;
+    stats->fill = ring_head - ring_tail;
+    stats->lead_us = 0U;
+    if(0U != byte_rate) {
+        stats->lead_us = (uint32_t)(((uint64_t)flash_stats.min_fill * 1000000U) / byte_rate);
+    }
+}
+
+/*!
+    \brief      clear the SPI flash audio source statistics
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void flash_audio_stats_clear(void)
+{
+    memset(&flash_stats, 0, sizeof(flash_stats));
+    flash_stats.min_fill = FLASH_AUDIO_RING_SIZE;
+}
+
+/*!
+    \brief      erase the sectors needed and store a wave file in the SPI flash
+    \param[in]  address: sector aligned address of the wave file in the SPI flash
+    \param[in]  data: pointer to the wave file
+    \param[in]  size: size of the wave file in bytes
+    \param[out] none
+    \retval     none
+*/
+void flash_audio_store(uint32_t address, const uint8_t *data, uint32_t size)
+{
+    uint32_t offset = 0U;
+    uint32_t length = 0U;
+
+    spi_flash_init();
+    for(offset = 0U; offset < size; offset += FLASH_AUDIO_SECTOR_SIZE) {
+        spi_flash_sector_erase(address + offset);
+    }
+    for(offset = 0U; offset < size; offset += length) {
+        length = size - offset;
+        if(length > FLASH_AUDIO_STORE_CHUNK) {
+            length = FLASH_AUDIO_STORE_CHUNK;
+        }
+        qspi_flash_buffer_write((uint8_t *)&data[offset], address + offset, (uint16_t)length);
+    }
+}
+
+/*!
+    \brief      read callback used to parse the wave header in the SPI flash
+    \param[in]  context: address of the wave file in the SPI flash
+    \param[in]  offset: offset of the first byte to read
+    \param[in]  length: number of bytes to read
+    \param[out] buffer: pointer to the buffer receiving the data
+    \retval     number of bytes read
+*/
+static uint32_t flash_wave_read(void *context, uint32_t offset, uint8_t *buffer, uint32_t length)
+{
+    qspi_flash_buffer_read(buffer, (uint32_t)context + offset, (uint16_t)length);
+    return length;
+}
+
+/*!
+    \brief      read callback of the audio source, copy the prefetched data to the player
+    \param[in]  context: not used
+    \param[in]  length: number of bytes to read
+    \param[out] buffer: pointer to the buffer receiving the data
+    \retval     number of bytes read
+*/
+static uint32_t flash_audio_read(void *context, uint8_t *buffer, uint32_t length)
+{
+    uint32_t tail = ring_tail;
+    uint32_t available = ring_head - tail;
+    uint32_t chunk = 0U;
+    uint32_t cut = 0U;
+
+    (void)context;
+    if(length > available) {
+        /* stop on a frame boundary, the partial frame stays in the ring for the next read */
+        cut = (block_phase + available) % block_align;
+        length = (available > cut) ? (available - cut) : 0U;
+        flash_stats.underrun++;
+    }
+    /* copy up to the end of the ring, then from its start */
+    chunk = FLASH_AUDIO_RING_SIZE - (tail & FLASH_AUDIO_RING_MASK);
+    if(chunk > length) {
+        chunk = length;
+    }
+    memcpy(buffer, &ring[tail & FLASH_AUDIO_RING_MASK], chunk);
+    memcpy(&buffer[chunk], ring, length - chunk);
+    ring_tail = tail + length;
+    block_phase = (block_phase + length) % block_align;
+
+    if((available - length) < flash_stats.min_fill) {
+        flash_stats.min_fill = available - length;
+    }
+    return length;
+}
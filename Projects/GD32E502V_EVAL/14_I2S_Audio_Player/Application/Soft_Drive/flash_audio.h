@@ -0,0 +1,69 @@
+/*!
+    \file    flash_audio.h
+    \brief   the header file of the SPI flash audio source
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef FLASH_AUDIO_H
+#define FLASH_AUDIO_H
+
+#include "gd32e502.h"
+#include "i2s_codec.h"
+
+/* prefetch ring configuration */
+#define FLASH_AUDIO_RING_SIZE         4096U               /* SRAM ring size in bytes, power of two */
+#define FLASH_AUDIO_CHUNK_SIZE        512U                /* bytes read from the flash by one prefetch */
+#define FLASH_AUDIO_SECTOR_SIZE       0x1000U             /* GD25Q16 sector size */
+
+/* SPI flash audio source statistics structure */
+typedef struct {
+    uint32_t fill;                      /* bytes prefetched ahead of the player */
+    uint32_t min_fill;                  /* minimum bytes ahead of the player seen by a read */
+    uint32_t lead_us;                   /* min_fill expressed in microseconds of audio */
+    uint32_t underrun;                  /* reads that found less data than requested */
+    uint32_t reads;                     /* flash read commands issued by the prefetch */
+} flash_audio_stats_struct;
+
+/* function declarations */
+/* parse the wave file stored in the SPI flash and prime the prefetch ring */
+errorcode_enum flash_audio_open(uint32_t address, wave_file_struct *wave);
+/* get the audio source reading the prefetch ring */
+void flash_audio_source_get(audio_source_struct *source);
+/* read the next chunk of audio data from the SPI flash if the ring has room, call from the main loop */
+void flash_audio_prefetch(void);
+/* get the SPI flash audio source statistics */
+void flash_audio_stats_get(flash_audio_stats_struct *stats);
+/* clear the SPI flash audio source statistics */
+void flash_audio_stats_clear(void);
+/* erase the sectors needed and store a wave file in the SPI flash */
+void flash_audio_store(uint32_t address, const uint8_t *data, uint32_t size);
+
+#endif /* FLASH_AUDIO_H */
@@ -33,116 +33,166 @@ OF SUCH DAMAGE.
 */
 
 #include <stdio.h>
+#include <string.h>
 #include "wave_data.h"
 #include "i2s_codec.h"
+#include "adpcm.h"
+#include "resampler.h"
+#include "mixer.h"
+#include "equalizer.h"
+#include "volume.h"
+#include "pcm_convert.h"
+
+/* read the DWT cycle counter */
+#define AUDIO_CYCLES()      (DWT->CYCCNT)
+/* the resampler filters are designed for steps within 1.0 +/- 1/8 */
+#define AUDIO_RESAMPLE_STEP_MIN     (((uint64_t)7U << 32) / 8U)
+#define AUDIO_RESAMPLE_STEP_MAX     (((uint64_t)9U << 32) / 8U)
+/* size of the buffer the 8, 24 and 32-bit samples are read into before the conversion,
+   it holds a multiple of four samples of any format */
+#define AUDIO_RAW_SIZE              384U
 
 wave_file_struct wave_struct;
-uint16_t i2saudiofreq = 0;
-__IO uint8_t headertab_index = 0;
+uint32_t i2saudiofreq = 0;
 uint32_t datastartaddr = 0;
 __IO uint32_t audiodataindex = 0;
 
+/* ping-pong buffer, the DMA plays one block while the other one is refilled, it is word
+   aligned for the 32-bit samples */
+static uint32_t audio_buffer[AUDIO_BUFFER_SIZE / 2U];
+/* bytes of an output sample (2 or 4), frames in one block and I2S frame format */
+static uint32_t audio_sample_bytes = 2U;
+static uint32_t audio_block_frames = AUDIO_BLOCK_FRAMES;
+static uint32_t audio_frameformat = I2S_FRAMEFORMAT_DT16B_CH16B;
+static uint8_t hires_enable = 0U;
+/* samples to convert and number of bytes already read */
+static uint32_t audio_raw[AUDIO_RAW_SIZE / 4U];
+static uint32_t audio_raw_count = 0U;
+/* set by the DMA callbacks when a block has been played, cleared by the refill */
+static __IO uint8_t block_pending[2] = {0U, 0U};
+/* next block to be refilled */
+static uint8_t block_next = 0U;
+static __IO audio_state_enum audio_state = AUDIO_STATE_STOP;
+static __IO audio_stats_struct audio_stats;
+/* source of the audio data being played */
+static audio_source_struct audio_source;
+/* cost of the pipeline stages */
+static audio_stage_stats_struct stage_stats[AUDIO_STAGE_NUM];
+/* decoder of IMA-ADPCM files and number of bytes of its block already read */
+static adpcm_decoder_struct adpcm_decoder;
+static uint32_t adpcm_block_count = 0U;
+/* converter of the file sample rate to the exact I2S sample rate */
+static resampler_struct audio_resampler;
+static uint8_t resampler_enable = 0U;
+static uint8_t resampler_active = 0U;
+static uint32_t resampler_pull_cycles = 0U;
+/* sample rate produced by the I2S prescaler in Hz */
+static uint32_t audio_output_rate = 0U;
+/* voices mixed over the music */
+static mixer_struct audio_mixer;
+/* notes rendered from wavetables over the music */
+static synth_struct audio_synth;
+/* levels of the output */
+static meter_struct audio_meter;
+/* CRC of the blocks played from the source and number of blocks still to add */
+static audio_checksum_struct audio_checksum;
+static uint32_t checksum_remaining = 0U;
+/* tone of the music and volume of the whole output */
+static eq_struct audio_eq;
+static volume_struct audio_volume = {(int32_t)(VOLUME_UNITY << 15), 0, VOLUME_UNITY, 0U};
+
+static void audio_cycle_counter_enable(void);
+static uint32_t audio_i2s_divider(uint32_t samplerate);
+static void audio_format_setup(void);
+static void audio_resampler_setup(void);
+static void audio_resampler_pull(void *context, int16_t *frames, uint32_t count);
+static void audio_stage_account(audio_stage_enum stage, uint32_t start, uint32_t frames);
+static uint32_t audio_adpcm_fill(int16_t *output, uint32_t frames);
+static uint32_t audio_pcm_convert(uint8_t *output, uint32_t samples);
+static uint32_t audio_memory_read(void *context, uint8_t *buffer, uint32_t length);
+static void audio_frames_read(uint16_t *block, uint32_t frames);
+static void audio_block_fill(uint16_t *block, uint32_t frames);
+static void audio_block_release(uint8_t block);
+static void audio_checksum_add(const uint16_t *block, uint32_t frames);
+
 /*!
-    \brief      read uint data according to endianness
-    \param[in]  nbrofbytes: number of read bytes
-    \param[in]  bytesformat: littleendian or bigendian
+    \brief      wave audio file parsing function
+    \param[in]  none
     \param[out] none
-    \retval     the uint data
+    \retval     errorcode_enum
 */
-uint32_t read_unit(uint8_t nbrofbytes, endianness_enum bytesformat)
+errorcode_enum codec_wave_parsing(void)
 {
-    uint32_t index = 0;
-    uint32_t temp = 0;
-    if(littleendian == bytesformat) {
-        for(index = 0; index < nbrofbytes; index++) {
-            temp |= AUDIOFILEADDRESS[headertab_index++] << (index * 8);
-        }
-    } else {
-        for(index = nbrofbytes; index != 0; index--) {
-            temp |= AUDIOFILEADDRESS[headertab_index++] << ((index - 1) * 8);
-        }
+    wave_reader_struct reader;
+    errorcode_enum errorcode = UNVALID_RIFF_ID;
+
+    codec_wave_reader_get(&reader);
+    errorcode = wave_parse(&reader, &wave_struct);
+    if(VALID_WAVE_FILE != errorcode) {
+        return errorcode;
+    }
+    errorcode = codec_wave_check(&wave_struct);
+    if(VALID_WAVE_FILE != errorcode) {
+        return errorcode;
     }
-    return temp;
+    /* set the data pointer at the beginning of the effective audio data */
+    datastartaddr = wave_struct.dataoffset;
+
+    return(VALID_WAVE_FILE);
 }
 
 /*!
-    \brief      wave audio file parsing function
+    \brief      get a reader of the audio file stored in the internal flash
     \param[in]  none
+    \param[out] reader: reader of wavetestdata
+    \retval     none
+*/
+void codec_wave_reader_get(wave_reader_struct *reader)
+{
+    /* the audio file is in the internal flash, it is read in place */
+    reader->read = wave_memory_read;
+    reader->context = (void *)AUDIOFILEADDRESS;
+    reader->size = COUNTOF(wavetestdata);
+}
+
+/*!
+    \brief      check that the player supports the format of a wave file
+    \param[in]  wave: format of the wave file
     \param[out] none
     \retval     errorcode_enum
 */
-errorcode_enum codec_wave_parsing(void)
+errorcode_enum codec_wave_check(const wave_file_struct *wave)
 {
-    uint32_t temp = 0;
-    uint32_t extraformatbytes = 0;
-    /* initialize the headertab index variable */
-    headertab_index = 0;
-    /* read chunkid, must be 'riff' */
-    if(CHUNKID != read_unit(4, bigendian)) {
-        return(UNVALID_RIFF_ID);
-    }
-    /* read the file length */
-    wave_struct.riffchunksize = read_unit(4, littleendian);
-    /* read the file format, must be 'wave' */
-    if(FILEFORMAT != read_unit(4, bigendian)) {
-        return(UNVALID_WAVE_FORMAT);
-    }
-    /* read the format chunk, must be 'fmt' */
-    if(FORMATID != read_unit(4, bigendian)) {
-        return(UNVALID_FORMATCHUNK_ID);
-    }
-    /* read the size of the 'fmt' data, must be 0x10 */
-    if(FORMATCHUNKSIZE != read_unit(4, littleendian)) {
-        extraformatbytes = 1;
-    }
-    /* read the audio format, must be 0x01 (pcm) */
-    wave_struct.formattag = read_unit(2, littleendian);
-    if(WAVE_FORMAT_PCM != wave_struct.formattag) {
+    /* the audio format must be 0x01 (pcm) or 0x11 (ima-adpcm) */
+    if((WAVE_FORMAT_PCM != wave->formattag) && (WAVE_FORMAT_IMA_ADPCM != wave->formattag)) {
         return(UNSUPPORETD_FORMATTAG);
     }
-    /* read the number of channels: 0x02->stereo 0x01->mono */
-    wave_struct.numchannels = read_unit(2, littleendian);
-    /* read the sample rate */
-    wave_struct.samplerate = read_unit(4, littleendian);
-    /* update the i2s_audiofreq value according to the .wav file sample rate */
-    if((wave_struct.samplerate < 8000) || (wave_struct.samplerate > 192000)) {
-        return(UNSUPPORETD_SAMPLE_RATE);
-    } else {
-        i2saudiofreq = wave_struct.samplerate;
+    /* the number of channels: 0x02->stereo 0x01->mono */
+    if((CHANNEL_MONO != wave->numchannels) && (CHANNEL_STEREO != wave->numchannels)) {
+        return(UNSUPPORETD_NUMBER_OF_CHANNEL);
     }
-    /* read the byte rate */
-    wave_struct.byterate = read_unit(4, littleendian);
-    /* read the block alignment */
-    wave_struct.blockalign = read_unit(2, littleendian);
-    /* read the number of bits per sample */
-    wave_struct.bitspersample = read_unit(2, littleendian);
-    if(BITS_PER_SAMPLE_16 != wave_struct.bitspersample) {
-        return(UNSUPPORETD_BITS_PER_SAMPLE);
+    /* the I2S clock must be able to follow the .wav file sample rate */
+    if((wave->samplerate < 8000) || (wave->samplerate > 192000)) {
+        return(UNSUPPORETD_SAMPLE_RATE);
     }
-    /* if there are extra format bytes, these bytes will be defined in "fact chunk" */
-    if(1 == extraformatbytes) {
-        /* read th extra format bytes, must be 0x00 */
-        if(0x00 != read_unit(2, littleendian)) {
+    if(WAVE_FORMAT_IMA_ADPCM == wave->formattag) {
+        if(BITS_PER_SAMPLE_4 != wave->bitspersample) {
+            return(UNSUPPORETD_BITS_PER_SAMPLE);
+        }
+        /* the block must fit in the decoder, hold the headers and whole groups of codes and
+           match the samples per block if given */
+        if((wave->blockalign > ADPCM_BLOCK_ALIGN_MAX)
+                || (0U == adpcm_samples_per_block(wave->blockalign, wave->numchannels))) {
             return(UNSUPPORETD_EXTRAFORMATBYTES);
         }
-        /* read the fact chunk, must be 'fact' */
-        if(FACTID != read_unit(4, bigendian)) {
-            return(UNVALID_FACTCHUNK_ID);
+        if((0U != wave->samplesperblock)
+                && (wave->samplesperblock != adpcm_samples_per_block(wave->blockalign, wave->numchannels))) {
+            return(UNSUPPORETD_EXTRAFORMATBYTES);
         }
-        /* read fact chunk data size */
-        temp = read_unit(4, littleendian);
-        /* set the index to start reading just after the header end */
-        headertab_index += temp;
-    }
-    /* read the data chunk, must be 'data' */
-    if(DATAID != read_unit(4, bigendian)) {
-        return(UNVALID_DATACHUNK_ID);
+    } else if((BITS_PER_SAMPLE_8 != wave->bitspersample) && (BITS_PER_SAMPLE_16 != wave->bitspersample)
+              && (BITS_PER_SAMPLE_24 != wave->bitspersample) && (BITS_PER_SAMPLE_32 != wave->bitspersample)) {
+        return(UNSUPPORETD_BITS_PER_SAMPLE);
     }
-    /* read the number of sample data */
-    wave_struct.datasize = read_unit(4, littleendian);
-    /* set the data pointer at the beginning of the effective audio data */
-    datastartaddr += headertab_index;
-
     return(VALID_WAVE_FILE);
 }
 
@@ -170,24 +220,49 @@ void i2s_config()
     gpio_output_options_set(GPIOC, GPIO_OTYPE_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_6 | GPIO_PIN_7);
 
     /* I2S1 peripheral configuration */
-    i2s_psc_config(SPI1, i2saudiofreq, I2S_FRAMEFORMAT_DT16B_CH16B, I2S_MCLKOUTPUT);
+    i2s_psc_config(SPI1, i2saudiofreq, audio_frameformat, I2S_MCLKOUTPUT);
     i2s_init(SPI1, I2S_MODE_MASTERTX, I2S_STANDARD, I2S_CKPL_HIGH);
     /* enable the I2S1 peripheral */
     i2s_enable(SPI1);
 }
 
 /*!
-    \brief      send audio data
+    \brief      I2S DMA configuration function
     \param[in]  none
     \param[out] none
     \retval     none
 */
-void i2s_audio_data_send(void)
+void i2s_dma_config(void)
 {
-    /* send the data read from the memory */
-    spi_i2s_data_transmit(SPI1, read_half_word(audiodataindex + datastartaddr));
-    /* increment the index */
-    audiodataindex += (uint32_t)wave_struct.numchannels ;
+    dma_parameter_struct dma_init_struct;
+
+    rcu_periph_clock_enable(RCU_DMA0);
+    rcu_periph_clock_enable(RCU_DMAMUX);
+
+    /* the DMA channel walks the whole ping-pong buffer in circular mode */
+    dma_deinit(AUDIO_DMA, AUDIO_DMA_CHANNEL);
+    dma_struct_para_init(&dma_init_struct);
+    dma_init_struct.request      = DMA_REQUEST_SPI1_TX;
+    dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+    dma_init_struct.memory_addr  = (uint32_t)audio_buffer;
+    dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+    dma_init_struct.memory_width = DMA_MEMORY_WIDTH_16BIT;
+    dma_init_struct.number       = AUDIO_BUFFER_SIZE;
+    dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI1);
+    dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+    dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_16BIT;
+    dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+    dma_init(AUDIO_DMA, AUDIO_DMA_CHANNEL, &dma_init_struct);
+
+    /* configure DMA mode */
+    dma_circulation_enable(AUDIO_DMA, AUDIO_DMA_CHANNEL);
+    dma_memory_to_memory_disable(AUDIO_DMA, AUDIO_DMA_CHANNEL);
+    /* disable the DMAMUX multiplexer channel synchronization mode */
+    dmamux_synchronization_disable(AUDIO_DMA_MUX_CHANNEL);
+
+    /* one interrupt per played block */
+    dma_interrupt_flag_clear(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_G);
+    dma_interrupt_enable(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_HTF | DMA_INT_FTF);
 }
 
 /*!
@@ -199,44 +274,805 @@ void i2s_audio_data_send(void)
 errorcode_enum i2s_audio_play(void)
 {
     errorcode_enum errorcode = UNVALID_RIFF_ID;
+    audio_source_struct source;
+
     /* read the audio file to extract the audio frequency */
     errorcode = codec_wave_parsing();
     if(VALID_WAVE_FILE == errorcode) {
+        audiodataindex = 0U;
+        source.read = audio_memory_read;
+        source.context = NULL;
+        errorcode = i2s_audio_play_source(&wave_struct, &source);
+    }
+    return errorcode;
+}
+
+/*!
+    \brief      start playing the audio data delivered by a source
+    \param[in]  wave: format of the audio data
+    \param[in]  source: source delivering the audio data
+    \param[out] none
+    \retval     errorcode_enum
+*/
+errorcode_enum i2s_audio_play_source(const wave_file_struct *wave, const audio_source_struct *source)
+{
+    errorcode_enum errorcode = UNVALID_RIFF_ID;
+
+    /* restart from a clean state if the audio is already playing */
+    i2s_audio_stop();
+    errorcode = codec_wave_check(wave);
+    if(VALID_WAVE_FILE == errorcode) {
+        if(wave != &wave_struct) {
+            wave_struct = *wave;
+        }
+        i2saudiofreq = wave_struct.samplerate;
+        audio_source = *source;
+        audio_format_setup();
+        audio_resampler_setup();
+        eq_samplerate_set(&audio_eq, audio_output_rate);
+        synth_samplerate_set(&audio_synth, audio_output_rate);
+        adpcm_decoder_init(&adpcm_decoder, wave_struct.numchannels, wave_struct.blockalign);
+        adpcm_block_count = 0U;
+        audio_cycle_counter_enable();
+        block_pending[0] = 0U;
+        block_pending[1] = 0U;
+        block_next = 0U;
+        audio_state = AUDIO_STATE_PLAY;
+        /* prime both blocks before the first DMA request */
+        audio_block_fill((uint16_t *)audio_buffer, audio_block_frames);
+        audio_block_fill((uint16_t *)audio_buffer + AUDIO_BLOCK_SIZE, audio_block_frames);
+
+        i2s_dma_config();
         i2s_config();
-        /* enable the I2S1 TBE interrupt */
-        spi_i2s_interrupt_enable(SPI1, SPI_I2S_INT_TBE);
+        dma_channel_enable(AUDIO_DMA, AUDIO_DMA_CHANNEL);
+        /* enable the I2S1 DMA request */
+        spi_dma_enable(SPI1, SPI_DMA_TRANSMIT);
     }
     return errorcode;
 }
 
 /*!
-    \brief      read half word
-    \param[in]  offset : audio data index
+    \brief      pause audio play, the I2S keeps running and plays silence
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_pause(void)
+{
+    if(AUDIO_STATE_PLAY == audio_state) {
+        audio_state = AUDIO_STATE_PAUSE;
+    }
+}
+
+/*!
+    \brief      resume audio play from the paused position
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_resume(void)
+{
+    if(AUDIO_STATE_PAUSE == audio_state) {
+        audio_state = AUDIO_STATE_PLAY;
+    }
+}
+
+/*!
+    \brief      stop audio play, the voices of the mixer and of the synthesizer keep their state
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_stop(void)
+{
+    if(AUDIO_STATE_STOP != audio_state) {
+        audio_state = AUDIO_STATE_STOP;
+        spi_dma_disable(SPI1, SPI_DMA_TRANSMIT);
+        dma_channel_disable(AUDIO_DMA, AUDIO_DMA_CHANNEL);
+        i2s_disable(SPI1);
+    }
+}
+
+/*!
+    \brief      stop audio play and all the voices of the mixer and of the synthesizer
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_reset(void)
+{
+    i2s_audio_stop();
+    mixer_init(&audio_mixer);
+    synth_init(&audio_synth, audio_output_rate);
+}
+
+/*!
+    \brief      get the audio playback state
+    \param[in]  none
+    \param[out] none
+    \retval     audio_state_enum
+*/
+audio_state_enum i2s_audio_state_get(void)
+{
+    return audio_state;
+}
+
+/*!
+    \brief      convert the next files to the sample rate the I2S prescaler produces exactly
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_resampler_enable(void)
+{
+    resampler_enable = 1U;
+}
+
+/*!
+    \brief      play the next files at the closest sample rate of the I2S prescaler
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_resampler_disable(void)
+{
+    resampler_enable = 0U;
+}
+
+/*!
+    \brief      play the next 24 and 32-bit files with 24 and 32-bit I2S frames, the resampler,
+                the equalizer and the voices are bypassed for them
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_hires_enable(void)
+{
+    hires_enable = 1U;
+}
+
+/*!
+    \brief      play the next 24 and 32-bit files with 16-bit I2S frames
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_hires_disable(void)
+{
+    hires_enable = 0U;
+}
+
+/*!
+    \brief      get the sample rate produced by the I2S prescaler
+    \param[in]  none
+    \param[out] none
+    \retval     sample rate in Hz
+*/
+uint32_t i2s_audio_output_rate_get(void)
+{
+    return audio_output_rate;
+}
+
+/*!
+    \brief      start a clip on a free voice, the voices are mixed over the music or the pause
+    \param[in]  data: mono 16-bit samples of the clip, at the I2S sample rate
+    \param[in]  frames: number of samples of the clip
+    \param[in]  gain: Q15 gain of the voice on both channels, MIXER_GAIN_UNITY for 1.0
+    \param[in]  loop: 1 to restart the clip at its end, 0 to stop the voice
+    \param[out] none
+    \retval     index of the voice, MIXER_VOICE_NONE if all the voices are playing
+*/
+uint8_t i2s_audio_voice_start(const int16_t *data, uint32_t frames, int16_t gain, uint8_t loop)
+{
+    /* the voices are changed from the main loop, as the refill, so they need no lock */
+    return mixer_voice_start(&audio_mixer, data, frames, gain, loop);
+}
+
+/*!
+    \brief      stop a voice
+    \param[in]  voice: index of the voice
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_voice_stop(uint8_t voice)
+{
+    mixer_voice_stop(&audio_mixer, voice);
+}
+
+/*!
+    \brief      set the gain of a voice on each channel
+    \param[in]  voice: index of the voice
+    \param[in]  gain_left: Q15 gain on the left channel
+    \param[in]  gain_right: Q15 gain on the right channel
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_voice_gain_set(uint8_t voice, int16_t gain_left, int16_t gain_right)
+{
+    mixer_voice_gain_set(&audio_mixer, voice, gain_left, gain_right);
+}
+
+/*!
+    \brief      check whether a voice is playing
+    \param[in]  voice: index of the voice
+    \param[out] none
+    \retval     1 if the voice is playing, 0 otherwise
+*/
+uint8_t i2s_audio_voice_active(uint8_t voice)
+{
+    return mixer_voice_active(&audio_mixer, voice);
+}
+
+/*!
+    \brief      start a synthesizer note, the notes are rendered over the music or the pause
+    \param[in]  table: one cycle of SYNTH_TABLE_SIZE samples followed by the first sample again
+    \param[in]  frequency: frequency of the note in Hz
+    \param[in]  gain: Q15 gain of the note, SYNTH_GAIN_UNITY for 1.0
+    \param[in]  envelope: ADSR envelope of the note
+    \param[out] none
+    \retval     index of the note, SYNTH_VOICE_NONE if all the notes are held
+*/
+uint8_t i2s_audio_note_on(const int16_t *table, float frequency, int16_t gain, const synth_envelope_struct *envelope)
+{
+    return synth_note_on(&audio_synth, table, frequency, gain, envelope);
+}
+
+/*!
+    \brief      release a synthesizer note
+    \param[in]  note: index of the note
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_note_off(uint8_t note)
+{
+    synth_note_off(&audio_synth, note);
+}
+
+/*!
+    \brief      check whether a synthesizer note is playing, its release included
+    \param[in]  note: index of the note
+    \param[out] none
+    \retval     1 if the note is playing, 0 otherwise
+*/
+uint8_t i2s_audio_note_active(uint8_t note)
+{
+    return synth_voice_active(&audio_synth, note);
+}
+
+/*!
+    \brief      get the levels of the output, it never waits for the refill
+    \param[in]  none
+    \param[out] levels: peak and RMS levels of the last block, peak hold and clip counts
+    \retval     none
+*/
+void i2s_audio_meter_get(meter_snapshot_struct *levels)
+{
+    meter_snapshot_get(&audio_meter, levels);
+}
+
+/*!
+    \brief      clear the peak hold and the clip counts of the output
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_meter_clear(void)
+{
+    meter_init(&audio_meter);
+}
+
+/*!
+    \brief      configure a band of the equalizer applied to the music
+    \param[in]  band: index of the band, 0 to EQ_BANDS - 1
+    \param[in]  type: type of the band
+      \arg        EQ_BAND_OFF: the band is bypassed
+      \arg        EQ_BAND_LOWSHELF: gain below the frequency
+      \arg        EQ_BAND_PEAKING: gain around the frequency
+      \arg        EQ_BAND_HIGHSHELF: gain above the frequency
+    \param[in]  frequency: centre or corner frequency in Hz
+    \param[in]  gain: gain in dB
+    \param[in]  q: quality factor
     \param[out] none
-    \retval     audio data
+    \retval     none
+*/
+void i2s_audio_eq_config(uint8_t band, eq_band_enum type, float frequency, float gain, float q)
+{
+    eq_band_config(&audio_eq, band, type, frequency, gain, q);
+}
+
+/*!
+    \brief      ramp the volume of the output to a new gain
+    \param[in]  gain: gain in Q15, VOLUME_UNITY for 1.0
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_volume_set(uint32_t gain)
+{
+    volume_set(&audio_volume, gain);
+}
+
+/*!
+    \brief      refill the blocks released by the DMA, call from the main loop
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_process(void)
+{
+    /* refill in the order the DMA released the blocks */
+    while((AUDIO_STATE_STOP != audio_state) && (0U != block_pending[block_next])) {
+        audio_block_fill((uint16_t *)audio_buffer + (block_next * AUDIO_BLOCK_SIZE), audio_block_frames);
+        block_pending[block_next] = 0U;
+        block_next ^= 1U;
+    }
+}
+
+/*!
+    \brief      DMA half transfer callback, the first block has been played
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_half_transfer_callback(void)
+{
+    audio_block_release(0U);
+}
+
+/*!
+    \brief      DMA full transfer callback, the second block has been played
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_full_transfer_callback(void)
+{
+    audio_block_release(1U);
+}
+
+/*!
+    \brief      get the audio playback statistics
+    \param[in]  none
+    \param[out] stats: the audio playback statistics
+    \retval     none
+*/
+void i2s_audio_stats_get(audio_stats_struct *stats)
+{
+    stats->blocks = audio_stats.blocks;
+    stats->underrun = audio_stats.underrun;
+    stats->max_pending = audio_stats.max_pending;
+    stats->source_underrun = audio_stats.source_underrun;
+}
+
+/*!
+    \brief      clear the audio playback statistics
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_stats_clear(void)
+{
+    audio_stats.blocks = 0U;
+    audio_stats.underrun = 0U;
+    audio_stats.max_pending = 0U;
+    audio_stats.source_underrun = 0U;
+    memset(stage_stats, 0, sizeof(stage_stats));
+}
+
+/*!
+    \brief      compute the CRC of the next blocks played from the source, to compare the
+                output of two builds playing the same file
+    \param[in]  blocks: number of blocks to add to the CRC
+    \param[out] none
+    \retval     none
+*/
+void i2s_audio_checksum_start(uint32_t blocks)
+{
+    rcu_periph_clock_enable(RCU_CRC);
+    audio_checksum.crc = 0xFFFFFFFFU;
+    audio_checksum.blocks = 0U;
+    checksum_remaining = blocks;
+}
+
+/*!
+    \brief      get the CRC of the output
+    \param[in]  none
+    \param[out] checksum: CRC and number of blocks it covers
+    \retval     none
+*/
+void i2s_audio_checksum_get(audio_checksum_struct *checksum)
+{
+    *checksum = audio_checksum;
+}
+
+/*!
+    \brief      get the cost of an audio pipeline stage
+    \param[in]  stage: the pipeline stage
+      \arg        AUDIO_STAGE_SOURCE: read the audio data from the source
+      \arg        AUDIO_STAGE_DECODE: decode compressed audio data
+      \arg        AUDIO_STAGE_CONVERT: convert 8, 24 and 32-bit samples
+      \arg        AUDIO_STAGE_RESAMPLE: convert the sample rate, frames are output frames
+      \arg        AUDIO_STAGE_MIX: mix the voices, frames are summed over the voices
+      \arg        AUDIO_STAGE_SYNTH: render the synthesizer notes, frames are summed over the notes
+      \arg        AUDIO_STAGE_EQ: filter the music with the equalizer
+      \arg        AUDIO_STAGE_VOLUME: apply the volume to the output
+      \arg        AUDIO_STAGE_METER: measure the levels of the output
+    \param[out] stats: cycles spent in the stage and frames processed
+    \retval     none
+*/
+void i2s_audio_stage_stats_get(audio_stage_enum stage, audio_stage_stats_struct *stats)
+{
+    if(stage < AUDIO_STAGE_NUM) {
+        *stats = stage_stats[stage];
+    }
+}
+
+/*!
+    \brief      mark a block as played and check that the DMA moved onto a refilled block
+    \param[in]  block: index of the block released by the DMA
+    \param[out] none
+    \retval     none
+*/
+static void audio_block_release(uint8_t block)
+{
+    uint32_t pending;
+
+    audio_stats.blocks++;
+    /* the DMA has started the other block, it must not be waiting for a refill */
+    if(0U != block_pending[block ^ 1U]) {
+        audio_stats.underrun++;
+    }
+    block_pending[block] = 1U;
+
+    pending = (uint32_t)block_pending[0] + block_pending[1];
+    if(pending > audio_stats.max_pending) {
+        audio_stats.max_pending = pending;
+    }
+}
+
+/*!
+    \brief      add a block played from the source to the CRC of the output
+    \param[in]  block: pointer to the refilled block
+    \param[in]  frames: number of stereo frames in the block
+    \param[out] none
+    \retval     none
+*/
+static void audio_checksum_add(const uint16_t *block, uint32_t frames)
+{
+    if((AUDIO_STATE_PLAY != audio_state) || (0U == checksum_remaining)) {
+        return;
+    }
+    /* the CRC unit restarts from the value of the previous block, it can be used in between */
+    crc_init_data_register_write(audio_checksum.crc);
+    crc_data_register_reset();
+    audio_checksum.crc = crc_block_data_calculate((void *)block, frames * audio_sample_bytes / 2U, INPUT_FORMAT_WORD);
+    audio_checksum.blocks++;
+    checksum_remaining--;
+}
+
+/*!
+    \brief      enable the DWT cycle counter used to measure the pipeline stages
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void audio_cycle_counter_enable(void)
+{
+    DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*!
+    \brief      add the cycles elapsed since start to a pipeline stage
+    \param[in]  stage: the pipeline stage
+    \param[in]  start: cycle counter value when the stage started
+    \param[in]  frames: frames processed by the stage
+    \param[out] none
+    \retval     none
 */
-uint16_t read_half_word(uint32_t offset)
+static void audio_stage_account(audio_stage_enum stage, uint32_t start, uint32_t frames)
 {
-    static  uint32_t monovar = 0, tmpvar = 0;
-    if((AUDIOFILEADDRESS + offset) >= AUDIOFILEADDRESSEND) {
-        audiodataindex = 0;
+    stage_stats[stage].cycles += (uint32_t)(AUDIO_CYCLES() - start);
+    stage_stats[stage].frames += frames;
+}
+
+/*!
+    \brief      decode IMA-ADPCM frames, the source is read one whole block at a time
+    \param[in]  frames: number of frames to decode
+    \param[out] output: pointer to the interleaved 16-bit samples
+    \retval     number of frames decoded, less than frames if the source ran dry
+*/
+static uint32_t audio_adpcm_fill(int16_t *output, uint32_t frames)
+{
+    uint32_t done = 0U;
+    uint32_t count = 0U;
+    uint32_t start = 0U;
+
+    while(done < frames) {
+        if(adpcm_decoder.frame >= adpcm_decoder.samplesperblock) {
+            /* a block cut by a source underrun is completed on the next refill */
+            start = AUDIO_CYCLES();
+            adpcm_block_count += audio_source.read(audio_source.context, &adpcm_decoder.block[adpcm_block_count],
+                                                   adpcm_decoder.blockalign - adpcm_block_count);
+            audio_stage_account(AUDIO_STAGE_SOURCE, start, 0U);
+            if(adpcm_block_count < adpcm_decoder.blockalign) {
+                break;
+            }
+            adpcm_block_count = 0U;
+            adpcm_block_start(&adpcm_decoder);
+        }
+        start = AUDIO_CYCLES();
+        count = adpcm_decode(&adpcm_decoder, &output[done * adpcm_decoder.channels], frames - done);
+        audio_stage_account(AUDIO_STAGE_DECODE, start, count);
+        done += count;
     }
-    /* test if the left channel is to be sent */
-    if(0 == monovar) {
-        tmpvar = (*(__IO uint16_t *)(AUDIOFILEADDRESS + offset));
-        /* increment the mono variable only if the file is in mono format */
-        if(CHANNEL_MONO == wave_struct.numchannels)
-            /* increment the monovar variable */
-        {
-            monovar++;
+    return done;
+}
+
+/*!
+    \brief      read callback of the audio file located in the internal flash
+    \param[in]  context: not used
+    \param[in]  length: number of bytes to read
+    \param[out] buffer: pointer to the buffer receiving the data
+    \retval     number of bytes read
+*/
+static uint32_t audio_memory_read(void *context, uint8_t *buffer, uint32_t length)
+{
+    const uint8_t *data = (const uint8_t *)AUDIOFILEADDRESS + datastartaddr;
+    uint32_t count = 0U;
+    uint32_t chunk = 0U;
+
+    (void)context;
+    while(count < length) {
+        /* loop the audio file forever */
+        if(audiodataindex >= wave_struct.datasize) {
+            audiodataindex = 0U;
+        }
+        chunk = wave_struct.datasize - audiodataindex;
+        if(chunk > (length - count)) {
+            chunk = length - count;
         }
-        /* return the read value */
-        return tmpvar;
-        /* right channel to be sent in mono format */
+        memcpy(&buffer[count], &data[audiodataindex], chunk);
+        audiodataindex += chunk;
+        count += chunk;
+    }
+    return count;
+}
+
+/*!
+    \brief      compute the divider of the I2S clock giving a sample rate, as i2s_psc_config() does
+    \param[in]  samplerate: requested sample rate in Hz
+    \param[out] none
+    \retval     I2S clock cycles per frame
+*/
+static uint32_t audio_i2s_divider(uint32_t samplerate)
+{
+    uint32_t i2sclock = rcu_clock_freq_get(CK_SYS);
+    uint32_t cycles = 32U;
+    uint32_t clks = 0U;
+
+    /* the MCK runs at 256 times the sample rate, otherwise the bit clock gives 32 or 64
+       cycles per frame of two 16 or 32-bit channels */
+    if(I2S_MCKOUT_ENABLE == I2S_MCLKOUTPUT) {
+        cycles = 256U;
+    } else if(I2S_FRAMEFORMAT_DT16B_CH16B != audio_frameformat) {
+        cycles = 64U;
+    }
+    clks = ((((i2sclock / cycles) * 10U) / samplerate) + 5U) / 10U;
+    if((clks < 4U) || (clks > 511U)) {
+        clks = 4U;
+    }
+    return clks * cycles;
+}
+
+/*!
+    \brief      choose the output sample size and the I2S frame format of the file
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void audio_format_setup(void)
+{
+    audio_sample_bytes = 2U;
+    audio_frameformat = I2S_FRAMEFORMAT_DT16B_CH16B;
+    if((0U != hires_enable) && (WAVE_FORMAT_PCM == wave_struct.formattag)) {
+        if(BITS_PER_SAMPLE_24 == wave_struct.bitspersample) {
+            audio_sample_bytes = 4U;
+            audio_frameformat = I2S_FRAMEFORMAT_DT24B_CH32B;
+        } else if(BITS_PER_SAMPLE_32 == wave_struct.bitspersample) {
+            audio_sample_bytes = 4U;
+            audio_frameformat = I2S_FRAMEFORMAT_DT32B_CH32B;
+        }
+    }
+    /* a block keeps its size in bytes, it holds half the frames with 32-bit samples */
+    audio_block_frames = (AUDIO_BLOCK_FRAMES * 2U) / audio_sample_bytes;
+    audio_raw_count = 0U;
+}
+
+/*!
+    \brief      compute the I2S sample rate of the file and set up the resampler
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void audio_resampler_setup(void)
+{
+    /* I2S1 is clocked by CK_SYS, the PLL2 clock source of RCU_CFG1 is not used */
+    uint32_t i2sclock = rcu_clock_freq_get(CK_SYS);
+    uint32_t divider = audio_i2s_divider(wave_struct.samplerate);
+    uint64_t step = resampler_step_calc(wave_struct.samplerate, i2sclock, divider);
+
+    audio_output_rate = (i2sclock + (divider / 2U)) / divider;
+    resampler_active = 0U;
+    /* a rate out of the range of the filters keeps playing at the approximate rate */
+    if((0U != resampler_enable) && (2U == audio_sample_bytes) && (((uint64_t)1U << 32) != step)
+            && (step >= AUDIO_RESAMPLE_STEP_MIN) && (step <= AUDIO_RESAMPLE_STEP_MAX)) {
+        resampler_init(&audio_resampler, step, audio_resampler_pull, NULL);
+        resampler_active = 1U;
+    }
+}
+
+/*!
+    \brief      pull callback of the resampler, the frames are read from the audio source
+    \param[in]  context: not used
+    \param[in]  count: number of stereo frames to read
+    \param[out] frames: pointer to the interleaved 16-bit samples
+    \retval     none
+*/
+static void audio_resampler_pull(void *context, int16_t *frames, uint32_t count)
+{
+    uint32_t start = AUDIO_CYCLES();
+
+    (void)context;
+    audio_frames_read((uint16_t *)frames, count);
+    /* the source and decode stages account for themselves */
+    resampler_pull_cycles += (uint32_t)(AUDIO_CYCLES() - start);
+}
+
+/*!
+    \brief      fill a block with stereo frames at the I2S sample rate
+    \param[in]  block: pointer to the block to fill
+    \param[in]  frames: number of stereo frames to fill
+    \param[out] none
+    \retval     none
+*/
+static void audio_block_fill(uint16_t *block, uint32_t frames)
+{
+    uint32_t start;
+    uint32_t mixed;
+
+    if(AUDIO_STATE_PLAY != audio_state) {
+        /* keep the I2S clocks running with silence */
+        memset(block, 0, frames * 2U * audio_sample_bytes);
+    } else if(0U != resampler_active) {
+        resampler_pull_cycles = 0U;
+        start = AUDIO_CYCLES();
+        resampler_process(&audio_resampler, (int16_t *)block, frames);
+        stage_stats[AUDIO_STAGE_RESAMPLE].cycles += (uint32_t)(AUDIO_CYCLES() - start) - resampler_pull_cycles;
+        stage_stats[AUDIO_STAGE_RESAMPLE].frames += frames;
     } else {
-        /* reset the monovar variable */
-        monovar = 0;
-        /* return the previous read data in mono format */
-        return tmpvar;
+        audio_frames_read(block, frames);
+    }
+
+    if(4U == audio_sample_bytes) {
+        /* the 32-bit samples only go through the volume */
+        start = AUDIO_CYCLES();
+        volume_process32(&audio_volume, (int32_t *)block, frames);
+        pcm_i2s32_order((int32_t *)block, frames * 2U);
+        audio_stage_account(AUDIO_STAGE_VOLUME, start, frames);
+        audio_checksum_add(block, frames);
+        return;
+    }
+
+    if(AUDIO_STATE_PLAY == audio_state) {
+        start = AUDIO_CYCLES();
+        eq_process(&audio_eq, (int16_t *)block, frames);
+        audio_stage_account(AUDIO_STAGE_EQ, start, frames);
+    }
+
+    start = AUDIO_CYCLES();
+    mixed = mixer_process(&audio_mixer, (int16_t *)block, frames);
+    audio_stage_account(AUDIO_STAGE_MIX, start, mixed);
+
+    start = AUDIO_CYCLES();
+    mixed = synth_process(&audio_synth, (int16_t *)block, frames);
+    audio_stage_account(AUDIO_STAGE_SYNTH, start, mixed);
+
+    start = AUDIO_CYCLES();
+    volume_process(&audio_volume, (int16_t *)block, frames);
+    audio_stage_account(AUDIO_STAGE_VOLUME, start, frames);
+
+    start = AUDIO_CYCLES();
+    meter_process(&audio_meter, (const int16_t *)block, frames);
+    audio_stage_account(AUDIO_STAGE_METER, start, frames);
+    audio_checksum_add(block, frames);
+}
+
+/*!
+    \brief      read stereo frames from the audio source at the file sample rate
+    \param[in]  block: pointer to the buffer receiving the frames
+    \param[in]  frames: number of stereo frames to read
+    \param[out] none
+    \retval     none
+*/
+static void audio_frames_read(uint16_t *block, uint32_t frames)
+{
+    uint32_t length = frames * (uint32_t)wave_struct.numchannels * audio_sample_bytes;
+    uint8_t *raw;
+    uint32_t count;
+    uint32_t start;
+
+    /* the samples are placed at the end of the block so that the mono samples can be
+       duplicated in place from the start of the block */
+    raw = (uint8_t *)block + (frames * 2U * audio_sample_bytes) - length;
+    if(WAVE_FORMAT_IMA_ADPCM == wave_struct.formattag) {
+        count = audio_adpcm_fill((int16_t *)raw, frames) * (uint32_t)wave_struct.numchannels * 2U;
+    } else if(wave_struct.bitspersample == (audio_sample_bytes * 8U)) {
+        start = AUDIO_CYCLES();
+        count = audio_source.read(audio_source.context, raw, length);
+        audio_stage_account(AUDIO_STAGE_SOURCE, start, frames);
+    } else {
+        count = audio_pcm_convert(raw, frames * (uint32_t)wave_struct.numchannels);
+    }
+    if(count < length) {
+        /* the source could not keep up, play silence for the missing part */
+        memset(&raw[count], 0, length - count);
+        audio_stats.source_underrun++;
+    }
+
+    if(CHANNEL_MONO == wave_struct.numchannels) {
+        /* the mono sample is sent on both channels */
+        if(2U == audio_sample_bytes) {
+            pcm_mono_to_stereo16((int16_t *)block, frames);
+        } else {
+            pcm_mono_to_stereo32((int32_t *)block, frames);
+        }
+    }
+}
+
+/*!
+    \brief      read 8, 24 or 32-bit samples and convert them to the output sample size
+    \param[in]  samples: number of samples to produce
+    \param[out] output: pointer to the converted samples
+    \retval     number of bytes produced, less than samples output samples if the source ran dry
+*/
+static uint32_t audio_pcm_convert(uint8_t *output, uint32_t samples)
+{
+    uint32_t width = wave_struct.bitspersample / 8U;
+    uint8_t *raw = (uint8_t *)audio_raw;
+    uint32_t done = 0U;
+    uint32_t chunk = 0U;
+    uint32_t count = 0U;
+    uint32_t start = 0U;
+
+    while(done < samples) {
+        chunk = samples - done;
+        if(chunk > (AUDIO_RAW_SIZE / width)) {
+            chunk = AUDIO_RAW_SIZE / width;
+        }
+        /* a sample cut by the source is completed by the next read */
+        start = AUDIO_CYCLES();
+        audio_raw_count += audio_source.read(audio_source.context, &raw[audio_raw_count], (chunk * width) - audio_raw_count);
+        count = audio_raw_count / width;
+        audio_stage_account(AUDIO_STAGE_SOURCE, start, count / wave_struct.numchannels);
+
+        start = AUDIO_CYCLES();
+        if(BITS_PER_SAMPLE_8 == wave_struct.bitspersample) {
+            pcm_u8_to_s16(raw, (int16_t *)&output[done * 2U], count);
+        } else if(4U == audio_sample_bytes) {
+            pcm_s24_to_s32(raw, (int32_t *)&output[done * 4U], count);
+        } else if(BITS_PER_SAMPLE_24 == wave_struct.bitspersample) {
+            pcm_s24_to_s16(raw, (int16_t *)&output[done * 2U], count);
+        } else {
+            pcm_s32_to_s16(raw, (int16_t *)&output[done * 2U], count);
+        }
+        audio_stage_account(AUDIO_STAGE_CONVERT, start, count / wave_struct.numchannels);
+
+        audio_raw_count -= count * width;
+        memmove(raw, &raw[count * width], audio_raw_count);
+        done += count;
+        if(count < chunk) {
+            break;
+        }
     }
+    return done * audio_sample_bytes;
 }
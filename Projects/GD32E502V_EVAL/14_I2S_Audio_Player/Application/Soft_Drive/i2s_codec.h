@@ -35,33 +35,13 @@ OF SUCH DAMAGE.
 #ifndef I2S_CODEC_H
 #define I2S_CODEC_H
 
-/* .WAV file format :
-
-  Endian      Offset      Length      Contents
-  big         0           4 bytes     'RIFF'              0x52494646
-  little      4           4 bytes     <file length - 8>
-  big         8           4 bytes     'WAVE'              0x57415645
-
-  Next, the fmt chunk describes the sample format:
-
-  big         12          4 bytes     'fmt '              0x666D7420
-  little      16          4 bytes     0x00000010          length of the fmt data (16 bytes)
-  little      20          2 bytes     0x0001              format tag: 1 = PCM
-  little      22          2 bytes     <channels>          channels: 1 = mono, 2 = stereo
-  little      24          4 bytes     <sample rate>       samples per second: e.g., 22050
-  little      28          4 bytes     <bytes/second>      sample rate * block align
-  little      32          2 bytes     <block align>       channels * bits/sample / 8
-  little      34          2 bytes     <bits/sample>       8 or 16
-
-  Finally, the data chunk contains the sample data:
-
-  big         36          4 bytes     'data'              0x64617461
-  little      40          4 bytes     <length of the data block>
-  little      44          *           <sample data>
-
-*/
-
 #include "gd32e502.h"
+#include "wave_parser.h"
+#include "mixer.h"
+#include "equalizer.h"
+#include "volume.h"
+#include "synth.h"
+#include "meter.h"
 
 /* extern audio file */
 extern const char wavetestdata[];
@@ -69,71 +49,144 @@ extern const char wavetestdata[];
 #define COUNTOF(a)          (sizeof(a) / sizeof(*(a)))
 
 /* constants definitions */
-/* audio parsing constants */
-#define CHUNKID             0x52494646  /* correspond to the letters 'RIFF' */
-#define FILEFORMAT          0x57415645  /* correspond to the letters 'WAVE' */
-#define FORMATID            0x666D7420  /* correspond to the letters 'fmt ' */
-#define DATAID              0x64617461  /* correspond to the letters 'data' */
-#define FACTID              0x66616374  /* correspond to the letters 'fact' */
-#define WAVE_FORMAT_PCM     0x01        /* pcm format */
-#define FORMATCHUNKSIZE     0x10        /* format chunk size */
-#define CHANNEL_MONO        0x01        /* mono channel */
-#define CHANNEL_STEREO      0x02        /* stereo channel */
-#define BITS_PER_SAMPLE_8   8           /* 8 bits per sample */
-#define BITS_PER_SAMPLE_16  16          /* 16 bits per sample */
 /* audio start address and end address constants */
 #define AUDIOFILEADDRESS       (uint32_t)wavetestdata                                /* audio start address */
 #define AUDIOFILEADDRESSEND    (uint32_t)(wavetestdata + (COUNTOF(wavetestdata)))    /* audio end address */
 /* I2S configuration parameters */
 #define I2S_STANDARD                  I2S_STD_MSB         /* I2S MSB standard */
 #define I2S_MCLKOUTPUT                I2S_MCKOUT_ENABLE   /* mck output enable */
+/* audio DMA configuration parameters */
+#define AUDIO_DMA                     DMA0                /* DMA used to feed SPI1/I2S1 */
+#define AUDIO_DMA_CHANNEL             DMA_CH0             /* DMA channel used to feed SPI1/I2S1 */
+#define AUDIO_DMA_IRQn                DMA0_Channel0_IRQn  /* DMA channel interrupt */
+#define AUDIO_DMA_MUX_CHANNEL         DMAMUX_MULTIPLEXER_CH0
+#define AUDIO_BLOCK_FRAMES            256U                /* 16-bit stereo frames in one half of the ping-pong buffer */
+#define AUDIO_BLOCK_SIZE              (AUDIO_BLOCK_FRAMES * 2U)       /* half words in one block */
+#define AUDIO_BUFFER_SIZE             (AUDIO_BLOCK_SIZE * 2U)         /* half words in the ping-pong buffer */
+
+/* audio playback state enum */
+typedef enum {
+    AUDIO_STATE_STOP = 0,               /* I2S and DMA stopped */
+    AUDIO_STATE_PLAY,                   /* blocks are refilled from the audio file */
+    AUDIO_STATE_PAUSE                   /* blocks are refilled with silence, file position is kept */
+} audio_state_enum;
 
-/* audio file information structure */
+/* audio playback statistics structure */
 typedef struct {
-    uint32_t riffchunksize;             /* riff chunk size */
-    uint16_t formattag;                 /* format tag */
-    uint16_t numchannels;               /* number of channel */
-    uint32_t samplerate;                /* audio sample rate */
-    uint32_t byterate;                  /* byte rate */
-    uint16_t blockalign;                /* block align */
-    uint16_t bitspersample;             /* bits per sample */
-    uint32_t datasize;                  /* audio data size */
-} wave_file_struct;
-
-/* error identification enum */
-typedef enum {
-    VALID_WAVE_FILE = 0,                /* valid wave file */
-    UNVALID_RIFF_ID,                    /* unvalid riff id */
-    UNVALID_WAVE_FORMAT,                /* unvalid wave format */
-    UNVALID_FORMATCHUNK_ID,             /* unvalid format chunk id */
-    UNSUPPORETD_FORMATTAG,              /* unsupporetd format tag */
-    UNSUPPORETD_NUMBER_OF_CHANNEL,      /* unsupporetd number of channel */
-    UNSUPPORETD_SAMPLE_RATE,            /* unsupporetd sample rate */
-    UNSUPPORETD_BITS_PER_SAMPLE,        /* unsupporetd bits per sample */
-    UNVALID_DATACHUNK_ID,               /* unvalid data chunk id */
-    UNSUPPORETD_EXTRAFORMATBYTES,       /* unsupporetd extra format bytes */
-    UNVALID_FACTCHUNK_ID                /* unvalid fact chunk id */
-} errorcode_enum;
-
-/* endianness enum */
+    uint32_t blocks;                    /* number of blocks consumed by the DMA */
+    uint32_t underrun;                  /* number of blocks replayed because they were not refilled in time */
+    uint32_t max_pending;               /* maximum number of blocks waiting for a refill */
+    uint32_t source_underrun;           /* number of refills the source could not complete */
+} audio_stats_struct;
+
+/* audio output checksum structure */
+typedef struct {
+    uint32_t crc;                       /* CRC-32 (polynomial 0x04C11DB7, MSB first, words) of the blocks */
+    uint32_t blocks;                    /* number of blocks in the CRC */
+} audio_checksum_struct;
+
+/* audio pipeline stage enum */
 typedef enum {
-    littleendian,                       /* little endian */
-    bigendian                           /* big endian */
-} endianness_enum;
+    AUDIO_STAGE_SOURCE = 0,             /* read the audio data from the source */
+    AUDIO_STAGE_DECODE,                 /* decode compressed audio data */
+    AUDIO_STAGE_CONVERT,                /* convert 8, 24 and 32-bit samples */
+    AUDIO_STAGE_RESAMPLE,               /* convert the sample rate, frames are output frames */
+    AUDIO_STAGE_MIX,                    /* mix the voices, frames are summed over the voices */
+    AUDIO_STAGE_SYNTH,                  /* render the synthesizer notes, frames are summed over the notes */
+    AUDIO_STAGE_EQ,                     /* filter the music with the equalizer */
+    AUDIO_STAGE_VOLUME,                 /* apply the volume to the output */
+    AUDIO_STAGE_METER,                  /* measure the levels of the output */
+    AUDIO_STAGE_NUM                     /* number of stages */
+} audio_stage_enum;
+
+/* audio pipeline stage cost structure */
+typedef struct {
+    uint64_t cycles;                    /* CPU cycles spent in the stage */
+    uint32_t frames;                    /* frames produced by the stage, cycles / frames gives the cost per frame */
+} audio_stage_stats_struct;
+
+/* sequential read callback of the audio data, return the number of bytes copied */
+typedef uint32_t (*audio_read_func)(void *context, uint8_t *buffer, uint32_t length);
+
+/* audio source structure */
+typedef struct {
+    audio_read_func read;               /* read callback, a short read is played as silence */
+    void *context;                      /* context passed to the read callback */
+} audio_source_struct;
 
 /* function declarations */
 
-/* read uint data according to endianness */
-uint32_t read_unit(uint8_t nbrofbytes, endianness_enum bytesformat);
 /* wave audio file parsing function */
 errorcode_enum codec_wave_parsing(void);
+/* get a reader of the audio file stored in the internal flash */
+void codec_wave_reader_get(wave_reader_struct *reader);
+/* check that the player supports the format of a wave file */
+errorcode_enum codec_wave_check(const wave_file_struct *wave);
 /* I2S configuration function */
 void i2s_config(void);
-/* send audio data */
-void i2s_audio_data_send(void);
+/* I2S DMA configuration function */
+void i2s_dma_config(void);
 /* start audio paly */
 errorcode_enum i2s_audio_play(void);
-/* read half word */
-uint16_t read_half_word(uint32_t offset);
+/* start playing the audio data delivered by a source */
+errorcode_enum i2s_audio_play_source(const wave_file_struct *wave, const audio_source_struct *source);
+/* pause audio play */
+void i2s_audio_pause(void);
+/* resume audio play */
+void i2s_audio_resume(void);
+/* stop audio play */
+void i2s_audio_stop(void);
+/* stop audio play and all the voices */
+void i2s_audio_reset(void);
+/* get the audio playback state */
+audio_state_enum i2s_audio_state_get(void);
+/* convert the next files to the sample rate the I2S prescaler produces exactly */
+void i2s_audio_resampler_enable(void);
+/* play the next files at the closest sample rate of the I2S prescaler */
+void i2s_audio_resampler_disable(void);
+/* play the next 24 and 32-bit files with 24 and 32-bit I2S frames */
+void i2s_audio_hires_enable(void);
+/* play the next 24 and 32-bit files with 16-bit I2S frames */
+void i2s_audio_hires_disable(void);
+/* get the sample rate produced by the I2S prescaler */
+uint32_t i2s_audio_output_rate_get(void);
+/* start a clip on a free voice */
+uint8_t i2s_audio_voice_start(const int16_t *data, uint32_t frames, int16_t gain, uint8_t loop);
+/* stop a voice */
+void i2s_audio_voice_stop(uint8_t voice);
+/* set the gain of a voice on each channel */
+void i2s_audio_voice_gain_set(uint8_t voice, int16_t gain_left, int16_t gain_right);
+/* check whether a voice is playing */
+uint8_t i2s_audio_voice_active(uint8_t voice);
+/* start a synthesizer note */
+uint8_t i2s_audio_note_on(const int16_t *table, float frequency, int16_t gain, const synth_envelope_struct *envelope);
+/* release a synthesizer note */
+void i2s_audio_note_off(uint8_t note);
+/* check whether a synthesizer note is playing */
+uint8_t i2s_audio_note_active(uint8_t note);
+/* get the levels of the output */
+void i2s_audio_meter_get(meter_snapshot_struct *levels);
+/* clear the peak hold and the clip counts of the output */
+void i2s_audio_meter_clear(void);
+/* configure a band of the equalizer applied to the music */
+void i2s_audio_eq_config(uint8_t band, eq_band_enum type, float frequency, float gain, float q);
+/* ramp the volume of the output to a new gain */
+void i2s_audio_volume_set(uint32_t gain);
+/* refill the blocks released by the DMA, call from the main loop */
+void i2s_audio_process(void);
+/* DMA half transfer callback */
+void i2s_audio_half_transfer_callback(void);
+/* DMA full transfer callback */
+void i2s_audio_full_transfer_callback(void);
+/* get the audio playback statistics */
+void i2s_audio_stats_get(audio_stats_struct *stats);
+/* clear the audio playback statistics */
+void i2s_audio_stats_clear(void);
+/* compute the CRC of the next blocks played from the source */
+void i2s_audio_checksum_start(uint32_t blocks);
+/* get the CRC of the output */
+void i2s_audio_checksum_get(audio_checksum_struct *checksum);
+/* get the cost of an audio pipeline stage */
+void i2s_audio_stage_stats_get(audio_stage_enum stage, audio_stage_stats_struct *stats);
 
 #endif /* I2S_CODEC_H */
@@ -0,0 +1,164 @@
+/*!
+    \file    meter.c
+    \brief   audio level meter measuring the peak, RMS and clipping of each block
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include <math.h>
+#include "meter.h"
+#include "audio_dsp.h"
+
+/* orders the accesses to the snapshots around the published index */
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define METER_BARRIER()     __DMB()
+#else
+#define METER_BARRIER()     __sync_synchronize()
+#endif /* __ARM_FEATURE_DSP */
+
+static void meter_channel_peak(int32_t sample, int32_t *peak, uint32_t *clips);
+
+/*!
+    \brief      initialize the level meter
+    \param[in]  meter: pointer to the level meter
+    \param[out] none
+    \retval     none
+*/
+void meter_init(meter_struct *meter)
+{
+    uint32_t next = meter->published ^ 1U;
+
+    memset(&meter->snapshot[next], 0, sizeof(meter_snapshot_struct));
+    METER_BARRIER();
+    meter->published = next;
+}
+
+/*!
+    \brief      measure a block of interleaved stereo frames and publish the levels
+    \param[in]  meter: pointer to the level meter
+    \param[in]  frames: pointer to the interleaved 16-bit frames
+    \param[in]  count: number of stereo frames
+    \param[out] none
+    \retval     none
+*/
+void meter_process(meter_struct *meter, const int16_t *frames, uint32_t count)
+{
+    int64_t energy_left = 0;
+    int64_t energy_right = 0;
+    const meter_snapshot_struct *last;
+    meter_snapshot_struct *next;
+    int32_t peak_left = 0;
+    int32_t peak_right = 0;
+    uint32_t clips_left = 0U;
+    uint32_t clips_right = 0U;
+    uint32_t first;
+    uint32_t second;
+    uint32_t pair;
+    uint32_t index;
+
+    if(0U == count) {
+        return;
+    }
+    /* two frames per loop, the samples of each channel are packed together and squared by SMLALD */
+    for(index = 0U; (index + 2U) <= count; index += 2U) {
+        first = dsp_read_q15x2(&frames[2U * index]);
+        second = dsp_read_q15x2(&frames[2U * index + 2U]);
+        pair = dsp_pack_bottom(first, second);
+        energy_left = dsp_smlald(pair, pair, energy_left);
+        pair = dsp_pack_top(first, second);
+        energy_right = dsp_smlald(pair, pair, energy_right);
+        meter_channel_peak(frames[2U * index], &peak_left, &clips_left);
+        meter_channel_peak(frames[2U * index + 1U], &peak_right, &clips_right);
+        meter_channel_peak(frames[2U * index + 2U], &peak_left, &clips_left);
+        meter_channel_peak(frames[2U * index + 3U], &peak_right, &clips_right);
+    }
+    if(index < count) {
+        energy_left += (int32_t)frames[2U * index] * frames[2U * index];
+        energy_right += (int32_t)frames[2U * index + 1U] * frames[2U * index + 1U];
+        meter_channel_peak(frames[2U * index], &peak_left, &clips_left);
+        meter_channel_peak(frames[2U * index + 1U], &peak_right, &clips_right);
+    }
+
+    /* the levels are written into the other snapshot, then published by flipping the index,
+       a reader always copies a complete snapshot and never waits */
+    last = &meter->snapshot[meter->published];
+    next = &meter->snapshot[meter->published ^ 1U];
+    next->blocks = last->blocks + 1U;
+    next->peak[0] = (uint16_t)peak_left;
+    next->peak[1] = (uint16_t)peak_right;
+    next->rms[0] = (uint16_t)sqrtf((float)energy_left / (float)count);
+    next->rms[1] = (uint16_t)sqrtf((float)energy_right / (float)count);
+    next->peak_hold[0] = (next->peak[0] > last->peak_hold[0]) ? next->peak[0] : last->peak_hold[0];
+    next->peak_hold[1] = (next->peak[1] > last->peak_hold[1]) ? next->peak[1] : last->peak_hold[1];
+    next->clips[0] = last->clips[0] + clips_left;
+    next->clips[1] = last->clips[1] + clips_right;
+    METER_BARRIER();
+    meter->published ^= 1U;
+}
+
+/*!
+    \brief      get a consistent copy of the levels without waiting, from the main loop or from
+                an interrupt: meter_process() runs in the main loop, it never interrupts a reader,
+                so the published snapshot cannot be rewritten during the copy
+    \param[in]  meter: pointer to the level meter
+    \param[out] snapshot: the levels of the last block
+    \retval     none
+*/
+void meter_snapshot_get(const meter_struct *meter, meter_snapshot_struct *snapshot)
+{
+    uint32_t published = meter->published;
+
+    METER_BARRIER();
+    memcpy(snapshot, &meter->snapshot[published], sizeof(meter_snapshot_struct));
+}
+
+/*!
+    \brief      update the peak and the clip count of a channel with a sample
+    \param[in]  sample: the sample
+    \param[in]  peak: pointer to the largest absolute sample
+    \param[in]  clips: pointer to the number of samples at full scale
+    \param[out] peak: updated largest absolute sample
+    \param[out] clips: updated number of samples at full scale
+    \retval     none
+*/
+static void meter_channel_peak(int32_t sample, int32_t *peak, uint32_t *clips)
+{
+    if(sample < 0) {
+        sample = -sample;
+    }
+    if(sample > *peak) {
+        *peak = sample;
+    }
+    /* a saturated sample is 32767 or -32768 */
+    if(sample >= 32767) {
+        (*clips)++;
+    }
+}
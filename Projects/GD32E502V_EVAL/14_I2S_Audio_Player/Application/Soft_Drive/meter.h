@@ -0,0 +1,65 @@
+/*!
+    \file    meter.h
+    \brief   the header file of the audio level meter
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef METER_H
+#define METER_H
+
+#include <stdint.h>
+
+#define METER_CHANNELS                2U                  /* left and right */
+
+/* level meter snapshot structure */
+typedef struct {
+    uint32_t blocks;                    /* blocks measured */
+    uint16_t peak[METER_CHANNELS];      /* largest absolute sample of the last block */
+    uint16_t rms[METER_CHANNELS];       /* RMS level of the last block */
+    uint16_t peak_hold[METER_CHANNELS]; /* largest absolute sample since meter_init() */
+    uint32_t clips[METER_CHANNELS];     /* samples at full scale since meter_init() */
+} meter_snapshot_struct;
+
+/* level meter structure, the levels are written into the snapshot that is not published */
+typedef struct {
+    meter_snapshot_struct snapshot[2];  /* published levels and levels being written */
+    volatile uint32_t published;        /* index of the snapshot of the last block */
+} meter_struct;
+
+/* function declarations */
+/* initialize the level meter */
+void meter_init(meter_struct *meter);
+/* measure a block of interleaved stereo frames and publish the levels */
+void meter_process(meter_struct *meter, const int16_t *frames, uint32_t count);
+/* get a consistent copy of the levels */
+void meter_snapshot_get(const meter_struct *meter, meter_snapshot_struct *snapshot);
+
+#endif /* METER_H */
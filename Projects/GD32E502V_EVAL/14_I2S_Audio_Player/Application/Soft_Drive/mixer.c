@@ -0,0 +1,213 @@
+/*!
+    \file    mixer.c
+    \brief   multi-voice audio mixer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "mixer.h"
+#include "audio_dsp.h"
+
+/*!
+    \brief      initialize the mixer, all the voices are stopped
+    \param[in]  mixer: pointer to the mixer
+    \param[out] none
+    \retval     none
+*/
+void mixer_init(mixer_struct *mixer)
+{
+    memset(mixer, 0, sizeof(mixer_struct));
+}
+
+/*!
+    \brief      start a clip on a free voice
+    \param[in]  mixer: pointer to the mixer
+    \param[in]  data: mono 16-bit samples of the clip, at the output sample rate
+    \param[in]  frames: number of samples of the clip
+    \param[in]  gain: Q15 gain of the voice on both channels
+    \param[in]  loop: 1 to restart the clip at its end, 0 to stop the voice
+    \param[out] none
+    \retval     index of the voice, MIXER_VOICE_NONE if all the voices are playing
+*/
+uint8_t mixer_voice_start(mixer_struct *mixer, const int16_t *data, uint32_t frames, int16_t gain, uint8_t loop)
+{
+    uint8_t voice;
+
+    if((NULL == data) || (0U == frames)) {
+        return MIXER_VOICE_NONE;
+    }
+    for(voice = 0U; voice < MIXER_VOICES; voice++) {
+        if(0U == mixer->voice[voice].active) {
+            mixer->voice[voice].data = data;
+            mixer->voice[voice].frames = frames;
+            mixer->voice[voice].position = 0U;
+            mixer->voice[voice].gain_left = gain;
+            mixer->voice[voice].gain_right = gain;
+            mixer->voice[voice].loop = loop;
+            mixer->voice[voice].active = 1U;
+            return voice;
+        }
+    }
+    return MIXER_VOICE_NONE;
+}
+
+/*!
+    \brief      stop a voice
+    \param[in]  mixer: pointer to the mixer
+    \param[in]  voice: index of the voice
+    \param[out] none
+    \retval     none
+*/
+void mixer_voice_stop(mixer_struct *mixer, uint8_t voice)
+{
+    if(voice < MIXER_VOICES) {
+        mixer->voice[voice].active = 0U;
+    }
+}
+
+/*!
+    \brief      set the gain of a voice on each channel
+    \param[in]  mixer: pointer to the mixer
+    \param[in]  voice: index of the voice
+    \param[in]  gain_left: Q15 gain on the left channel
+    \param[in]  gain_right: Q15 gain on the right channel
+    \param[out] none
+    \retval     none
+*/
+void mixer_voice_gain_set(mixer_struct *mixer, uint8_t voice, int16_t gain_left, int16_t gain_right)
+{
+    if(voice < MIXER_VOICES) {
+        mixer->voice[voice].gain_left = gain_left;
+        mixer->voice[voice].gain_right = gain_right;
+    }
+}
+
+/*!
+    \brief      check whether a voice is playing
+    \param[in]  mixer: pointer to the mixer
+    \param[in]  voice: index of the voice
+    \param[out] none
+    \retval     1 if the voice is playing, 0 otherwise
+*/
+uint8_t mixer_voice_active(const mixer_struct *mixer, uint8_t voice)
+{
+    if(voice < MIXER_VOICES) {
+        return mixer->voice[voice].active;
+    }
+    return 0U;
+}
+
+/*!
+    \brief      add the playing voices to interleaved stereo frames
+    \param[in]  mixer: pointer to the mixer
+    \param[in]  output: pointer to the interleaved 16-bit frames the voices are added to
+    \param[in]  frames: number of stereo frames
+    \param[out] output: the frames with the voices added
+    \retval     number of voice frames mixed, the sum over the voices of the frames each played
+*/
+uint32_t mixer_process(mixer_struct *mixer, int16_t *output, uint32_t frames)
+{
+    const int16_t *source[MIXER_VOICES + 1U];
+    uint32_t gain_left[(MIXER_VOICES + 1U) / 2U];
+    uint32_t gain_right[(MIXER_VOICES + 1U) / 2U];
+    mixer_voice_struct *active[MIXER_VOICES];
+    uint32_t voices;
+    uint32_t pairs;
+    uint32_t count;
+    uint32_t index;
+    uint32_t pair;
+    uint32_t packed;
+    uint32_t mixed = 0U;
+    int64_t acc_left;
+    int64_t acc_right;
+
+    while(0U != frames) {
+        /* the block is cut where a clip ends so that every source is contiguous */
+        voices = 0U;
+        count = frames;
+        for(index = 0U; index < MIXER_VOICES; index++) {
+            if(0U != mixer->voice[index].active) {
+                active[voices++] = &mixer->voice[index];
+                if((mixer->voice[index].frames - mixer->voice[index].position) < count) {
+                    count = mixer->voice[index].frames - mixer->voice[index].position;
+                }
+            }
+        }
+        if(0U == voices) {
+            break;
+        }
+
+        /* the voices are mixed by pairs, one SMLALD applies the gains of two voices, the
+           64-bit sum cannot wrap even with all the voices at full scale */
+        pairs = (voices + 1U) / 2U;
+        for(index = 0U; index < voices; index++) {
+            source[index] = &active[index]->data[active[index]->position];
+        }
+        /* an odd voice is paired with the first voice at a gain of 0 */
+        source[voices] = source[0];
+        for(pair = 0U; pair < pairs; pair++) {
+            if((2U * pair + 1U) < voices) {
+                gain_left[pair] = dsp_pack(active[2U * pair]->gain_left, active[2U * pair + 1U]->gain_left);
+                gain_right[pair] = dsp_pack(active[2U * pair]->gain_right, active[2U * pair + 1U]->gain_right);
+            } else {
+                gain_left[pair] = dsp_pack(active[2U * pair]->gain_left, 0);
+                gain_right[pair] = dsp_pack(active[2U * pair]->gain_right, 0);
+            }
+        }
+
+        for(index = 0U; index < count; index++) {
+            acc_left = 1 << 14;
+            acc_right = 1 << 14;
+            for(pair = 0U; pair < pairs; pair++) {
+                packed = dsp_pack(source[2U * pair][index], source[2U * pair + 1U][index]);
+                acc_left = dsp_smlald(packed, gain_left[pair], acc_left);
+                acc_right = dsp_smlald(packed, gain_right[pair], acc_right);
+            }
+            /* the voices are added to the stream with a saturation on each channel, the sum
+               of 8 voices in Q15 fits in 32 bits */
+            packed = dsp_pack(dsp_ssat16((int32_t)(acc_left >> 15)), dsp_ssat16((int32_t)(acc_right >> 15)));
+            packed = dsp_qadd16(dsp_read_q15x2(output), packed);
+            memcpy(output, &packed, sizeof(packed));
+            output += 2U;
+        }
+
+        for(index = 0U; index < voices; index++) {
+            active[index]->position += count;
+            if(active[index]->position >= active[index]->frames) {
+                active[index]->position = 0U;
+                active[index]->active = active[index]->loop;
+            }
+        }
+        mixed += count * voices;
+        frames -= count;
+    }
+    return mixed;
+}
@@ -0,0 +1,74 @@
+/*!
+    \file    mixer.h
+    \brief   the header file of the multi-voice audio mixer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+
+#define MIXER_VOICES                  8U                  /* voices played at the same time */
+#define MIXER_VOICE_NONE              0xFFU               /* returned when no voice is free */
+#define MIXER_GAIN_UNITY              32767               /* Q15 gain of 1.0 */
+
+/* mixer voice structure, a voice plays a mono 16-bit clip at the output sample rate */
+typedef struct {
+    const int16_t *data;                                /* samples of the clip */
+    uint32_t frames;                                    /* number of samples of the clip */
+    uint32_t position;                                  /* next sample to mix */
+    int16_t gain_left;                                  /* Q15 gain on the left channel */
+    int16_t gain_right;                                 /* Q15 gain on the right channel */
+    uint8_t loop;                                       /* restart the clip at its end */
+    uint8_t active;                                     /* the voice is playing */
+} mixer_voice_struct;
+
+/* mixer structure */
+typedef struct {
+    mixer_voice_struct voice[MIXER_VOICES];             /* voices of the mixer */
+} mixer_struct;
+
+/* function declarations */
+/* initialize the mixer, all the voices are stopped */
+void mixer_init(mixer_struct *mixer);
+/* start a clip on a free voice */
+uint8_t mixer_voice_start(mixer_struct *mixer, const int16_t *data, uint32_t frames, int16_t gain, uint8_t loop);
+/* stop a voice */
+void mixer_voice_stop(mixer_struct *mixer, uint8_t voice);
+/* set the gain of a voice on each channel */
+void mixer_voice_gain_set(mixer_struct *mixer, uint8_t voice, int16_t gain_left, int16_t gain_right);
+/* check whether a voice is playing */
+uint8_t mixer_voice_active(const mixer_struct *mixer, uint8_t voice);
+/* add the playing voices to interleaved stereo frames */
+uint32_t mixer_process(mixer_struct *mixer, int16_t *output, uint32_t frames);
+
+#endif /* MIXER_H */
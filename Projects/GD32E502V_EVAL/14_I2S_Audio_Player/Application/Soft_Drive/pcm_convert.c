@@ -0,0 +1,234 @@
+/*!
+    \file    pcm_convert.c
+    \brief   PCM sample format converters
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "pcm_convert.h"
+
+static uint32_t pcm_read_word(const void *address);
+static void pcm_write_word(void *address, uint32_t value);
+
+/*!
+    \brief      convert 8-bit unsigned samples to 16-bit signed samples
+    \param[in]  input: pointer to the 8-bit samples
+    \param[in]  count: number of samples
+    \param[out] output: pointer to the 16-bit samples, it may overlap the end of the input
+    \retval     none
+*/
+void pcm_u8_to_s16(const uint8_t *input, int16_t *output, uint32_t count)
+{
+    uint32_t word;
+
+    for(; count >= 4U; count -= 4U) {
+        /* flip the sign bits, then move each byte to the high byte of a half word */
+        word = pcm_read_word(input) ^ 0x80808080U;
+        pcm_write_word(&output[0], ((word << 8) & 0x0000FF00U) | ((word << 16) & 0xFF000000U));
+        pcm_write_word(&output[2], ((word >> 8) & 0x0000FF00U) | (word & 0xFF000000U));
+        input += 4U;
+        output += 4U;
+    }
+    while(0U != count--) {
+        *output++ = (int16_t)(((uint16_t)*input++ ^ 0x80U) << 8);
+    }
+}
+
+/*!
+    \brief      convert packed 24-bit samples to 16-bit samples, the low byte is dropped
+    \param[in]  input: pointer to the 24-bit samples
+    \param[in]  count: number of samples
+    \param[out] output: pointer to the 16-bit samples, it may overlap the start of the input
+    \retval     none
+*/
+void pcm_s24_to_s16(const uint8_t *input, int16_t *output, uint32_t count)
+{
+    uint32_t word0;
+    uint32_t word1;
+    uint32_t word2;
+
+    for(; count >= 4U; count -= 4U) {
+        /* three words hold four samples */
+        word0 = pcm_read_word(&input[0]);
+        word1 = pcm_read_word(&input[4]);
+        word2 = pcm_read_word(&input[8]);
+        pcm_write_word(&output[0], ((word0 >> 8) & 0x0000FFFFU) | (word1 << 16));
+        pcm_write_word(&output[2], (word1 >> 24) | ((word2 << 8) & 0x0000FF00U) | (word2 & 0xFFFF0000U));
+        input += 12U;
+        output += 4U;
+    }
+    while(0U != count--) {
+        *output++ = (int16_t)((uint16_t)input[1] | ((uint16_t)input[2] << 8));
+        input += 3U;
+    }
+}
+
+/*!
+    \brief      convert 32-bit samples to 16-bit samples, the low half word is dropped
+    \param[in]  input: pointer to the 32-bit samples
+    \param[in]  count: number of samples
+    \param[out] output: pointer to the 16-bit samples, it may overlap the start of the input
+    \retval     none
+*/
+void pcm_s32_to_s16(const uint8_t *input, int16_t *output, uint32_t count)
+{
+    uint32_t word0;
+    uint32_t word1;
+
+    for(; count >= 2U; count -= 2U) {
+        word0 = pcm_read_word(&input[0]);
+        word1 = pcm_read_word(&input[4]);
+        pcm_write_word(output, (word0 >> 16) | (word1 & 0xFFFF0000U));
+        input += 8U;
+        output += 2U;
+    }
+    if(0U != count) {
+        *output = (int16_t)(pcm_read_word(input) >> 16);
+    }
+}
+
+/*!
+    \brief      convert packed 24-bit samples to 32-bit samples
+    \param[in]  input: pointer to the 24-bit samples
+    \param[in]  count: number of samples
+    \param[out] output: pointer to the 32-bit samples, it may overlap the end of the input
+    \retval     none
+*/
+void pcm_s24_to_s32(const uint8_t *input, int32_t *output, uint32_t count)
+{
+    uint32_t word0;
+    uint32_t word1;
+    uint32_t word2;
+
+    for(; count >= 4U; count -= 4U) {
+        word0 = pcm_read_word(&input[0]);
+        word1 = pcm_read_word(&input[4]);
+        word2 = pcm_read_word(&input[8]);
+        pcm_write_word(&output[0], word0 << 8);
+        pcm_write_word(&output[1], ((word0 >> 16) & 0x0000FF00U) | (word1 << 16));
+        pcm_write_word(&output[2], ((word1 >> 8) & 0x00FFFF00U) | (word2 << 24));
+        pcm_write_word(&output[3], word2 & 0xFFFFFF00U);
+        input += 12U;
+        output += 4U;
+    }
+    while(0U != count--) {
+        *output++ = (int32_t)(((uint32_t)input[0] << 8) | ((uint32_t)input[1] << 16) | ((uint32_t)input[2] << 24));
+        input += 3U;
+    }
+}
+
+/*!
+    \brief      duplicate 16-bit mono samples on both channels in place
+    \param[in]  frames: pointer to the frames, the mono samples are in frames[count] to frames[2 * count - 1]
+    \param[in]  count: number of samples
+    \param[out] frames: the interleaved stereo frames
+    \retval     none
+*/
+void pcm_mono_to_stereo16(int16_t *frames, uint32_t count)
+{
+    const int16_t *input = &frames[count];
+    uint32_t word;
+
+    /* the output never overtakes the input, both move forward */
+    for(; count >= 2U; count -= 2U) {
+        word = pcm_read_word(input);
+        pcm_write_word(&frames[0], (word & 0x0000FFFFU) | (word << 16));
+        pcm_write_word(&frames[2], (word & 0xFFFF0000U) | (word >> 16));
+        input += 2U;
+        frames += 4U;
+    }
+    if(0U != count) {
+        frames[0] = *input;
+        frames[1] = *input;
+    }
+}
+
+/*!
+    \brief      duplicate 32-bit mono samples on both channels in place
+    \param[in]  frames: pointer to the frames, the mono samples are in frames[count] to frames[2 * count - 1]
+    \param[in]  count: number of samples
+    \param[out] frames: the interleaved stereo frames
+    \retval     none
+*/
+void pcm_mono_to_stereo32(int32_t *frames, uint32_t count)
+{
+    const int32_t *input = &frames[count];
+    int32_t sample;
+
+    while(0U != count--) {
+        sample = *input++;
+        *frames++ = sample;
+        *frames++ = sample;
+    }
+}
+
+/*!
+    \brief      swap the half words of 32-bit samples, the I2S sends the high half word first
+    \param[in]  samples: pointer to the 32-bit samples
+    \param[in]  count: number of samples
+    \param[out] samples: the samples in the order of the 16-bit DMA transfers
+    \retval     none
+*/
+void pcm_i2s32_order(int32_t *samples, uint32_t count)
+{
+    uint32_t word;
+
+    while(0U != count--) {
+        word = (uint32_t)*samples;
+        *samples++ = (int32_t)((word << 16) | (word >> 16));
+    }
+}
+
+/*!
+    \brief      load a word from any address
+    \param[in]  address: address of the word
+    \param[out] none
+    \retval     the word
+*/
+static uint32_t pcm_read_word(const void *address)
+{
+    uint32_t value;
+
+    memcpy(&value, address, sizeof(value));
+    return value;
+}
+
+/*!
+    \brief      store a word at any address
+    \param[in]  address: address of the word
+    \param[in]  value: the word
+    \param[out] none
+    \retval     none
+*/
+static void pcm_write_word(void *address, uint32_t value)
+{
+    memcpy(address, &value, sizeof(value));
+}
@@ -0,0 +1,59 @@
+/*!
+    \file    pcm_convert.h
+    \brief   the header file of the PCM sample format converters
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef PCM_CONVERT_H
+#define PCM_CONVERT_H
+
+/* the converters work on whole blocks, four samples per loop with word loads and stores,
+   the 32-bit samples are left aligned (a 24-bit sample is in bits 31 to 8) */
+
+#include <stdint.h>
+
+/* function declarations */
+/* convert 8-bit unsigned samples to 16-bit signed samples */
+void pcm_u8_to_s16(const uint8_t *input, int16_t *output, uint32_t count);
+/* convert packed 24-bit samples to 16-bit samples */
+void pcm_s24_to_s16(const uint8_t *input, int16_t *output, uint32_t count);
+/* convert 32-bit samples to 16-bit samples */
+void pcm_s32_to_s16(const uint8_t *input, int16_t *output, uint32_t count);
+/* convert packed 24-bit samples to 32-bit samples */
+void pcm_s24_to_s32(const uint8_t *input, int32_t *output, uint32_t count);
+/* duplicate 16-bit mono samples on both channels in place */
+void pcm_mono_to_stereo16(int16_t *frames, uint32_t count);
+/* duplicate 32-bit mono samples on both channels in place */
+void pcm_mono_to_stereo32(int32_t *frames, uint32_t count);
+/* swap the half words of 32-bit samples, the I2S sends the high half word first */
+void pcm_i2s32_order(int32_t *samples, uint32_t count);
+
+#endif /* PCM_CONVERT_H */
@@ -0,0 +1,307 @@
+/*!
+    \file    playlist.c
+    \brief   gapless playlist
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "playlist.h"
+
+/* queued clip structure */
+typedef struct {
+    wave_reader_struct reader;                          /* reader of the wave file */
+    wave_file_struct wave;                              /* format of the clip once parsed */
+    uint8_t parsed;                                     /* the header has been parsed and is supported */
+} playlist_clip_struct;
+
+/* the playing clip is clips[0], the next one clips[1] */
+static playlist_clip_struct clips[PLAYLIST_SIZE];
+static uint32_t clip_count = 0U;
+/* bytes of the data chunk of clips[0] already read */
+static uint32_t clip_position = 0U;
+static playlist_state_enum playlist_state = PLAYLIST_STATE_STOP;
+/* blocks played by the DMA when the last data was read */
+static uint32_t drain_blocks = 0U;
+
+static errorcode_enum playlist_clip_parse(uint32_t index);
+static uint8_t playlist_next_ready(void);
+static void playlist_remove(uint32_t index);
+static void playlist_silence(uint8_t *buffer, uint32_t length);
+static uint32_t playlist_read(void *context, uint8_t *buffer, uint32_t length);
+
+/*!
+    \brief      empty the playlist
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void playlist_init(void)
+{
+    if(PLAYLIST_STATE_STOP != playlist_state) {
+        i2s_audio_stop();
+        playlist_state = PLAYLIST_STATE_STOP;
+    }
+    clip_count = 0U;
+    clip_position = 0U;
+}
+
+/*!
+    \brief      queue a wave file read through a reader, its header is parsed later
+    \param[in]  reader: reader of the wave file, it is copied
+    \param[out] none
+    \retval     SUCCESS or ERROR if the playlist is full
+*/
+ErrStatus playlist_add(const wave_reader_struct *reader)
+{
+    if(clip_count >= PLAYLIST_SIZE) {
+        return ERROR;
+    }
+    clips[clip_count].reader = *reader;
+    clips[clip_count].parsed = 0U;
+    clip_count++;
+    return SUCCESS;
+}
+
+/*!
+    \brief      start playing the first clip of the playlist
+    \param[in]  none
+    \param[out] none
+    \retval     errorcode_enum
+*/
+errorcode_enum playlist_play(void)
+{
+    errorcode_enum errorcode = UNVALID_RIFF_ID;
+    audio_source_struct source;
+
+    /* the clips that cannot be played are dropped */
+    while(0U != clip_count) {
+        errorcode = playlist_clip_parse(0U);
+        if(VALID_WAVE_FILE == errorcode) {
+            break;
+        }
+        playlist_remove(0U);
+    }
+    if(VALID_WAVE_FILE == errorcode) {
+        clip_position = 0U;
+        playlist_state = PLAYLIST_STATE_PLAY;
+        source.read = playlist_read;
+        source.context = NULL;
+        errorcode = i2s_audio_play_source(&clips[0].wave, &source);
+        if(VALID_WAVE_FILE != errorcode) {
+            playlist_state = PLAYLIST_STATE_STOP;
+        }
+    }
+    return errorcode;
+}
+
+/*!
+    \brief      parse the header of the next clip and handle the end of the list, call from the main loop
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void playlist_process(void)
+{
+    audio_stats_struct stats;
+
+    /* the next header is ready long before the player reaches the end of the current clip */
+    if((PLAYLIST_STATE_PLAY == playlist_state) && (clip_count > 1U) && (0U == clips[1].parsed)) {
+        if(VALID_WAVE_FILE != playlist_clip_parse(1U)) {
+            playlist_remove(1U);
+        }
+    }
+
+    if(PLAYLIST_STATE_DRAIN == playlist_state) {
+        /* the block holding the last data is played once the DMA released two more blocks,
+           one more block covers the frames still held by the resampler */
+        i2s_audio_stats_get(&stats);
+        if((stats.blocks - drain_blocks) >= 3U) {
+            playlist_remove(0U);
+            if(0U != clip_count) {
+                /* the next clip has another format, the I2S is configured again */
+                playlist_play();
+            } else {
+                i2s_audio_stop();
+                playlist_state = PLAYLIST_STATE_STOP;
+            }
+        }
+    }
+}
+
+/*!
+    \brief      get the playlist state
+    \param[in]  none
+    \param[out] none
+    \retval     playlist_state_enum
+*/
+playlist_state_enum playlist_state_get(void)
+{
+    return playlist_state;
+}
+
+/*!
+    \brief      get the number of clips queued, the playing one included
+    \param[in]  none
+    \param[out] none
+    \retval     number of clips
+*/
+uint32_t playlist_count_get(void)
+{
+    return clip_count;
+}
+
+/*!
+    \brief      parse the header of a queued clip and check that the player supports it
+    \param[in]  index: index of the clip in the playlist
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum playlist_clip_parse(uint32_t index)
+{
+    errorcode_enum errorcode = VALID_WAVE_FILE;
+
+    if(0U == clips[index].parsed) {
+        errorcode = wave_parse(&clips[index].reader, &clips[index].wave);
+        if(VALID_WAVE_FILE == errorcode) {
+            errorcode = codec_wave_check(&clips[index].wave);
+        }
+        if(VALID_WAVE_FILE == errorcode) {
+            clips[index].parsed = 1U;
+        }
+    }
+    return errorcode;
+}
+
+/*!
+    \brief      check that the next clip can follow the current one without configuring the I2S again
+    \param[in]  none
+    \param[out] none
+    \retval     1 if the next clip can be read right after the current one, 0 otherwise
+*/
+static uint8_t playlist_next_ready(void)
+{
+    const wave_file_struct *current = &clips[0].wave;
+    const wave_file_struct *next = &clips[1].wave;
+
+    /* the header is normally parsed by playlist_process(), this catches a slow main loop */
+    while((clip_count > 1U) && (VALID_WAVE_FILE != playlist_clip_parse(1U))) {
+        playlist_remove(1U);
+    }
+    if(clip_count < 2U) {
+        return 0U;
+    }
+    if((current->formattag != next->formattag) || (current->numchannels != next->numchannels)
+            || (current->samplerate != next->samplerate) || (current->bitspersample != next->bitspersample)
+            || (current->blockalign != next->blockalign)) {
+        return 0U;
+    }
+    /* the decoder reads whole blocks, the current clip must end on a block boundary */
+    if((WAVE_FORMAT_IMA_ADPCM == current->formattag) && (0U != (current->datasize % current->blockalign))) {
+        return 0U;
+    }
+    return 1U;
+}
+
+/*!
+    \brief      remove a clip from the playlist
+    \param[in]  index: index of the clip in the playlist
+    \param[out] none
+    \retval     none
+*/
+static void playlist_remove(uint32_t index)
+{
+    if(index < clip_count) {
+        clip_count--;
+        memmove(&clips[index], &clips[index + 1U], (clip_count - index) * sizeof(playlist_clip_struct));
+    }
+}
+
+/*!
+    \brief      fill a buffer with the silence of the format being played
+    \param[in]  length: number of bytes
+    \param[out] buffer: pointer to the buffer
+    \retval     none
+*/
+static void playlist_silence(uint8_t *buffer, uint32_t length)
+{
+    /* 8-bit samples are unsigned, the other formats are signed (an IMA-ADPCM block of zeros
+       decodes to zeros) */
+    memset(buffer, (BITS_PER_SAMPLE_8 == clips[0].wave.bitspersample) ? 0x80 : 0x00, length);
+}
+
+/*!
+    \brief      read callback of the playlist, the data chunks of the clips follow each other
+    \param[in]  context: not used
+    \param[in]  length: number of bytes to read
+    \param[out] buffer: pointer to the buffer receiving the data
+    \retval     number of bytes read
+*/
+static uint32_t playlist_read(void *context, uint8_t *buffer, uint32_t length)
+{
+    playlist_clip_struct *clip = &clips[0];
+    audio_stats_struct stats;
+    uint32_t count = 0U;
+    uint32_t chunk = 0U;
+    uint32_t done = 0U;
+
+    (void)context;
+    while(count < length) {
+        if(PLAYLIST_STATE_PLAY != playlist_state) {
+            /* the end of the list, or a format change, is reached: play silence meanwhile */
+            playlist_silence(&buffer[count], length - count);
+            count = length;
+            break;
+        }
+        if(clip_position >= clip->wave.datasize) {
+            if(0U != playlist_next_ready()) {
+                /* the next clip goes on in the same block, the I2S keeps running */
+                playlist_remove(0U);
+                clip_position = 0U;
+            } else {
+                i2s_audio_stats_get(&stats);
+                drain_blocks = stats.blocks;
+                playlist_state = PLAYLIST_STATE_DRAIN;
+            }
+            continue;
+        }
+        chunk = clip->wave.datasize - clip_position;
+        if(chunk > (length - count)) {
+            chunk = length - count;
+        }
+        done = clip->reader.read(clip->reader.context, clip->wave.dataoffset + clip_position, &buffer[count], chunk);
+        clip_position += done;
+        count += done;
+        if(done < chunk) {
+            break;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,64 @@
+/*!
+    \file    playlist.h
+    \brief   the header file of the gapless playlist
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef PLAYLIST_H
+#define PLAYLIST_H
+
+#include "gd32e502.h"
+#include "i2s_codec.h"
+
+#define PLAYLIST_SIZE                 8U                  /* clips queued at most, the playing one included */
+
+/* playlist state enum */
+typedef enum {
+    PLAYLIST_STATE_STOP = 0,            /* nothing is played */
+    PLAYLIST_STATE_PLAY,                /* the clips are read by the player */
+    PLAYLIST_STATE_DRAIN                /* the last data is played, the player then stops or restarts */
+} playlist_state_enum;
+
+/* function declarations */
+/* empty the playlist */
+void playlist_init(void);
+/* queue a wave file read through a reader, its header is parsed later */
+ErrStatus playlist_add(const wave_reader_struct *reader);
+/* start playing the first clip of the playlist */
+errorcode_enum playlist_play(void);
+/* parse the header of the next clip and handle the end of the list, call from the main loop */
+void playlist_process(void);
+/* get the playlist state */
+playlist_state_enum playlist_state_get(void);
+/* get the number of clips queued, the playing one included */
+uint32_t playlist_count_get(void);
+
+#endif /* PLAYLIST_H */
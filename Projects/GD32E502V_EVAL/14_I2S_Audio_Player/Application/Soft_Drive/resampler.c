@@ -0,0 +1,415 @@
+/*!
+    \file    resampler.c
+    \brief   polyphase sample rate converter
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "resampler.h"
+#include "audio_dsp.h"
+
+#define RESAMPLER_PHASES              (1U << RESAMPLER_PHASE_BITS)
+
+/* Kaiser windowed sinc (beta 5.0, cutoff 0.45 of the input rate), phase p holds the taps
+   of the output frame located p / 128 input frame after the eighth tap, each phase is
+   normalized to a gain of 1.0 in Q15 */
+static const int16_t resampler_coef[RESAMPLER_PHASES][RESAMPLER_TAPS] = {
+    {   137,   -381,    796,  -1370,   2032,  -2659,   3110,  29466,
+       3110,  -2659,   2032,  -1370,    796,   -381,    137,    -28},
+    {   138,   -381,    791,  -1354,   1990,  -2564,   2873,  29466,
+       3348,  -2753,   2073,  -1386,    799,   -380,    136,    -28},
+    {   139,   -381,    787,  -1337,   1948,  -2469,   2640,  29455,
+       3589,  -2846,   2113,  -1401,    803,   -379,    134,    -27},
+    {   140,   -381,    782,  -1320,   1905,  -2374,   2408,  29443,
+       3832,  -2939,   2153,  -1415,    806,   -378,    133,    -27},
+    {   141,   -381,    777,  -1302,   1861,  -2279,   2180,  29425,
+       4078,  -3032,   2192,  -1429,    808,   -377,    132,    -26},
+    {   141,   -381,    771,  -1284,   1817,  -2184,   1954,  29405,
+       4325,  -3123,   2230,  -1442,    810,   -376,    130,    -25},
+    {   142,   -380,    765,  -1265,   1772,  -2088,   1730,  29378,
+       4575,  -3215,   2268,  -1455,    812,   -374,    128,    -25},
+    {   143,   -379,    759,  -1246,   1727,  -1992,   1510,  29343,
+       4827,  -3305,   2304,  -1467,    813,   -372,    127,    -24},
+    {   143,   -378,    753,  -1226,   1681,  -1897,   1292,  29306,
+       5081,  -3395,   2340,  -1478,    814,   -370,    125,    -23},
+    {   143,   -377,    746,  -1206,   1635,  -1801,   1077,  29264,
+       5337,  -3484,   2375,  -1489,    815,   -368,    123,    -22},
+    {   144,   -376,    739,  -1185,   1588,  -1705,    864,  29217,
+       5595,  -3572,   2409,  -1499,    815,   -365,    121,    -22},
+    {   144,   -374,    731,  -1164,   1541,  -1609,    655,  29165,
+       5854,  -3660,   2442,  -1508,    815,   -362,    119,    -21},
+    {   144,   -372,    723,  -1143,   1494,  -1514,    448,  29110,
+       6116,  -3746,   2474,  -1517,    814,   -359,    116,    -20},
+    {   144,   -370,    715,  -1121,   1446,  -1419,    245,  29048,
+       6379,  -3831,   2505,  -1525,    813,   -356,    114,    -19},
+    {   144,   -368,    707,  -1099,   1398,  -1323,     44,  28984,
+       6643,  -3916,   2535,  -1532,    811,   -353,    111,    -18},
+    {   144,   -366,    698,  -1076,   1350,  -1229,   -153,  28911,
+       6910,  -3999,   2564,  -1538,    809,   -349,    109,    -17},
+    {   143,   -364,    689,  -1053,   1302,  -1134,   -348,  28836,
+       7178,  -4081,   2592,  -1544,    807,   -345,    106,    -16},
+    {   143,   -361,    680,  -1030,   1253,  -1040,   -539,  28756,
+       7447,  -4162,   2619,  -1549,    804,   -341,    103,    -15},
+    {   143,   -358,    671,  -1007,   1204,   -946,   -727,  28669,
+       7718,  -4242,   2645,  -1553,    801,   -337,    101,    -14},
+    {   142,   -355,    661,   -983,   1155,   -853,   -913,  28582,
+       7990,  -4320,   2669,  -1557,    797,   -332,     98,    -13},
+    {   142,   -352,    651,   -959,   1105,   -760,  -1094,  28486,
+       8263,  -4397,   2693,  -1560,    793,   -327,     95,    -11},
+    {   141,   -349,    641,   -934,   1056,   -668,  -1273,  28389,
+       8537,  -4472,   2715,  -1562,    788,   -322,     91,    -10},
+    {   140,   -346,    630,   -910,   1006,   -576,  -1449,  28288,
+       8813,  -4547,   2737,  -1563,    783,   -317,     88,     -9},
+    {   140,   -342,    620,   -885,    957,   -485,  -1621,  28176,
+       9090,  -4619,   2757,  -1563,    777,   -311,     85,     -8},
+    {   139,   -338,    609,   -860,    907,   -394,  -1790,  28065,
+       9367,  -4690,   2776,  -1563,    771,   -306,     81,     -6},
+    {   138,   -335,    598,   -834,    857,   -304,  -1955,  27948,
+       9646,  -4760,   2793,  -1562,    765,   -300,     78,     -5},
+    {   137,   -331,    586,   -809,    807,   -215,  -2117,  27827,
+       9925,  -4827,   2810,  -1560,    758,   -293,     74,     -4},
+    {   136,   -327,    575,   -783,    758,   -126,  -2276,  27701,
+      10205,  -4894,   2825,  -1557,    750,   -287,     70,     -2},
+    {   135,   -322,    563,   -757,    708,    -39,  -2432,  27573,
+      10486,  -4958,   2838,  -1554,    742,   -280,     66,     -1},
+    {   134,   -318,    551,   -731,    658,     48,  -2584,  27436,
+      10767,  -5020,   2851,  -1549,    734,   -273,     63,      1},
+    {   133,   -314,    540,   -705,    609,    134,  -2733,  27298,
+      11049,  -5081,   2862,  -1544,    725,   -266,     59,      2},
+    {   131,   -309,    527,   -679,    560,    219,  -2878,  27156,
+      11332,  -5140,   2872,  -1538,    716,   -259,     54,      4},
+    {   130,   -305,    515,   -652,    510,    304,  -3020,  27009,
+      11614,  -5197,   2880,  -1531,    706,   -251,     50,      6},
+    {   129,   -300,    503,   -626,    461,    387,  -3158,  26856,
+      11898,  -5251,   2887,  -1523,    696,   -244,     46,      7},
+    {   127,   -295,    490,   -599,    412,    469,  -3293,  26703,
+      12181,  -5304,   2893,  -1515,    685,   -236,     41,      9},
+    {   126,   -290,    477,   -573,    364,    550,  -3424,  26543,
+      12464,  -5355,   2897,  -1505,    674,   -227,     37,     10},
+    {   124,   -285,    465,   -546,    315,    631,  -3552,  26378,
+      12748,  -5403,   2900,  -1495,    663,   -219,     32,     12},
+    {   123,   -280,    452,   -519,    267,    710,  -3677,  26210,
+      13032,  -5450,   2901,  -1484,    651,   -210,     28,     14},
+    {   121,   -275,    439,   -492,    219,    788,  -3797,  26040,
+      13315,  -5494,   2901,  -1472,    638,   -202,     23,     16},
+    {   119,   -269,    426,   -466,    172,    865,  -3915,  25865,
+      13598,  -5536,   2900,  -1459,    625,   -193,     18,     18},
+    {   118,   -264,    412,   -439,    124,    941,  -4029,  25686,
+      13881,  -5575,   2897,  -1445,    612,   -183,     13,     19},
+    {   116,   -259,    399,   -412,     77,   1015,  -4139,  25504,
+      14164,  -5612,   2892,  -1430,    598,   -174,      8,     21},
+    {   114,   -253,    386,   -385,     31,   1089,  -4246,  25315,
+      14447,  -5647,   2886,  -1415,    584,   -164,      3,     23},
+    {   112,   -247,    372,   -359,    -15,   1161,  -4349,  25126,
+      14729,  -5679,   2878,  -1399,    569,   -154,     -2,     25},
+    {   110,   -242,    359,   -332,    -61,   1232,  -4449,  24933,
+      15010,  -5709,   2869,  -1382,    554,   -144,     -7,     27},
+    {   109,   -236,    345,   -306,   -106,   1301,  -4545,  24735,
+      15291,  -5736,   2859,  -1364,    538,   -134,    -12,     29},
+    {   107,   -230,    332,   -279,   -151,   1370,  -4638,  24533,
+      15571,  -5761,   2846,  -1345,    523,   -124,    -17,     31},
+    {   105,   -225,    318,   -253,   -196,   1437,  -4727,  24331,
+      15850,  -5783,   2833,  -1325,    506,   -113,    -23,     33},
+    {   103,   -219,    305,   -227,   -240,   1503,  -4813,  24123,
+      16129,  -5802,   2817,  -1304,    489,   -103,    -28,     35},
+    {   101,   -213,    291,   -200,   -283,   1567,  -4895,  23912,
+      16406,  -5819,   2801,  -1283,    472,    -92,    -34,     37},
+    {    99,   -207,    277,   -174,   -326,   1630,  -4974,  23698,
+      16683,  -5832,   2782,  -1261,    454,    -81,    -39,     39},
+    {    97,   -201,    264,   -149,   -369,   1691,  -5050,  23483,
+      16958,  -5843,   2762,  -1238,    436,    -69,    -45,     41},
+    {    95,   -195,    250,   -123,   -410,   1752,  -5121,  23261,
+      17232,  -5852,   2741,  -1214,    418,    -58,    -51,     43},
+    {    93,   -189,    237,    -97,   -452,   1810,  -5190,  23038,
+      17505,  -5857,   2717,  -1189,    399,    -46,    -56,     45},
+    {    91,   -183,    223,    -72,   -492,   1868,  -5255,  22812,
+      17777,  -5860,   2693,  -1164,    380,    -35,    -62,     47},
+    {    88,   -177,    209,    -47,   -533,   1923,  -5316,  22585,
+      18047,  -5859,   2666,  -1137,    361,    -23,    -68,     49},
+    {    86,   -171,    196,    -22,   -572,   1978,  -5374,  22351,
+      18316,  -5856,   2638,  -1110,    341,    -11,    -74,     52},
+    {    84,   -165,    182,      3,   -611,   2031,  -5429,  22117,
+      18583,  -5849,   2609,  -1082,    320,      1,    -80,     54},
+    {    82,   -158,    169,     27,   -649,   2082,  -5480,  21878,
+      18848,  -5840,   2578,  -1053,    300,     14,    -86,     56},
+    {    80,   -152,    156,     51,   -687,   2132,  -5528,  21639,
+      19112,  -5827,   2545,  -1024,    279,     26,    -92,     58},
+    {    78,   -146,    142,     75,   -724,   2180,  -5573,  21398,
+      19374,  -5812,   2511,   -993,    257,     39,    -98,     60},
+    {    76,   -140,    129,     99,   -760,   2227,  -5614,  21152,
+      19634,  -5793,   2475,   -962,    236,     51,   -104,     62},
+    {    73,   -134,    116,    123,   -795,   2272,  -5652,  20902,
+      19893,  -5771,   2438,   -930,    214,     64,   -110,     65},
+    {    71,   -128,    103,    146,   -830,   2316,  -5687,  20654,
+      20149,  -5746,   2399,   -898,    191,     77,   -116,     67},
+    {    69,   -122,     90,    169,   -864,   2358,  -5718,  20401,
+      20403,  -5718,   2358,   -864,    169,     90,   -122,     69},
+    {    67,   -116,     77,    191,   -898,   2399,  -5746,  20149,
+      20654,  -5687,   2316,   -830,    146,    103,   -128,     71},
+    {    65,   -110,     64,    214,   -930,   2438,  -5771,  19893,
+      20902,  -5652,   2272,   -795,    123,    116,   -134,     73},
+    {    62,   -104,     51,    236,   -962,   2475,  -5793,  19634,
+      21152,  -5614,   2227,   -760,     99,    129,   -140,     76},
+    {    60,    -98,     39,    257,   -993,   2511,  -5812,  19374,
+      21398,  -5573,   2180,   -724,     75,    142,   -146,     78},
+    {    58,    -92,     26,    279,  -1024,   2545,  -5827,  19112,
+      21639,  -5528,   2132,   -687,     51,    156,   -152,     80},
+    {    56,    -86,     14,    300,  -1053,   2578,  -5840,  18848,
+      21878,  -5480,   2082,   -649,     27,    169,   -158,     82},
+    {    54,    -80,      1,    320,  -1082,   2609,  -5849,  18583,
+      22117,  -5429,   2031,   -611,      3,    182,   -165,     84},
+    {    52,    -74,    -11,    341,  -1110,   2638,  -5856,  18316,
+      22351,  -5374,   1978,   -572,    -22,    196,   -171,     86},
+    {    49,    -68,    -23,    361,  -1137,   2666,  -5859,  18047,
+      22585,  -5316,   1923,   -533,    -47,    209,   -177,     88},
+    {    47,    -62,    -35,    380,  -1164,   2693,  -5860,  17777,
+      22812,  -5255,   1868,   -492,    -72,    223,   -183,     91},
+    {    45,    -56,    -46,    399,  -1189,   2717,  -5857,  17505,
+      23038,  -5190,   1810,   -452,    -97,    237,   -189,     93},
+    {    43,    -51,    -58,    418,  -1214,   2741,  -5852,  17232,
+      23261,  -5121,   1752,   -410,   -123,    250,   -195,     95},
+    {    41,    -45,    -69,    436,  -1238,   2762,  -5843,  16958,
+      23483,  -5050,   1691,   -369,   -149,    264,   -201,     97},
+    {    39,    -39,    -81,    454,  -1261,   2782,  -5832,  16683,
+      23698,  -4974,   1630,   -326,   -174,    277,   -207,     99},
+    {    37,    -34,    -92,    472,  -1283,   2801,  -5819,  16406,
+      23912,  -4895,   1567,   -283,   -200,    291,   -213,    101},
+    {    35,    -28,   -103,    489,  -1304,   2817,  -5802,  16129,
+      24123,  -4813,   1503,   -240,   -227,    305,   -219,    103},
+    {    33,    -23,   -113,    506,  -1325,   2833,  -5783,  15850,
+      24331,  -4727,   1437,   -196,   -253,    318,   -225,    105},
+    {    31,    -17,   -124,    523,  -1345,   2846,  -5761,  15571,
+      24533,  -4638,   1370,   -151,   -279,    332,   -230,    107},
+    {    29,    -12,   -134,    538,  -1364,   2859,  -5736,  15291,
+      24735,  -4545,   1301,   -106,   -306,    345,   -236,    109},
+    {    27,     -7,   -144,    554,  -1382,   2869,  -5709,  15010,
+      24933,  -4449,   1232,    -61,   -332,    359,   -242,    110},
+    {    25,     -2,   -154,    569,  -1399,   2878,  -5679,  14729,
+      25126,  -4349,   1161,    -15,   -359,    372,   -247,    112},
+    {    23,      3,   -164,    584,  -1415,   2886,  -5647,  14447,
+      25315,  -4246,   1089,     31,   -385,    386,   -253,    114},
+    {    21,      8,   -174,    598,  -1430,   2892,  -5612,  14164,
+      25504,  -4139,   1015,     77,   -412,    399,   -259,    116},
+    {    19,     13,   -183,    612,  -1445,   2897,  -5575,  13881,
+      25686,  -4029,    941,    124,   -439,    412,   -264,    118},
+    {    18,     18,   -193,    625,  -1459,   2900,  -5536,  13598,
+      25865,  -3915,    865,    172,   -466,    426,   -269,    119},
+    {    16,     23,   -202,    638,  -1472,   2901,  -5494,  13315,
+      26040,  -3797,    788,    219,   -492,    439,   -275,    121},
+    {    14,     28,   -210,    651,  -1484,   2901,  -5450,  13032,
+      26210,  -3677,    710,    267,   -519,    452,   -280,    123},
+    {    12,     32,   -219,    663,  -1495,   2900,  -5403,  12748,
+      26378,  -3552,    631,    315,   -546,    465,   -285,    124},
+    {    10,     37,   -227,    674,  -1505,   2897,  -5355,  12464,
+      26543,  -3424,    550,    364,   -573,    477,   -290,    126},
+    {     9,     41,   -236,    685,  -1515,   2893,  -5304,  12181,
+      26703,  -3293,    469,    412,   -599,    490,   -295,    127},
+    {     7,     46,   -244,    696,  -1523,   2887,  -5251,  11898,
+      26856,  -3158,    387,    461,   -626,    503,   -300,    129},
+    {     6,     50,   -251,    706,  -1531,   2880,  -5197,  11614,
+      27009,  -3020,    304,    510,   -652,    515,   -305,    130},
+    {     4,     54,   -259,    716,  -1538,   2872,  -5140,  11332,
+      27156,  -2878,    219,    560,   -679,    527,   -309,    131},
+    {     2,     59,   -266,    725,  -1544,   2862,  -5081,  11049,
+      27298,  -2733,    134,    609,   -705,    540,   -314,    133},
+    {     1,     63,   -273,    734,  -1549,   2851,  -5020,  10767,
+      27436,  -2584,     48,    658,   -731,    551,   -318,    134},
+    {    -1,     66,   -280,    742,  -1554,   2838,  -4958,  10486,
+      27573,  -2432,    -39,    708,   -757,    563,   -322,    135},
+    {    -2,     70,   -287,    750,  -1557,   2825,  -4894,  10205,
+      27701,  -2276,   -126,    758,   -783,    575,   -327,    136},
+    {    -4,     74,   -293,    758,  -1560,   2810,  -4827,   9925,
+      27827,  -2117,   -215,    807,   -809,    586,   -331,    137},
+    {    -5,     78,   -300,    765,  -1562,   2793,  -4760,   9646,
+      27948,  -1955,   -304,    857,   -834,    598,   -335,    138},
+    {    -6,     81,   -306,    771,  -1563,   2776,  -4690,   9367,
+      28065,  -1790,   -394,    907,   -860,    609,   -338,    139},
+    {    -8,     85,   -311,    777,  -1563,   2757,  -4619,   9090,
+      28176,  -1621,   -485,    957,   -885,    620,   -342,    140},
+    {    -9,     88,   -317,    783,  -1563,   2737,  -4547,   8813,
+      28288,  -1449,   -576,   1006,   -910,    630,   -346,    140},
+    {   -10,     91,   -322,    788,  -1562,   2715,  -4472,   8537,
+      28389,  -1273,   -668,   1056,   -934,    641,   -349,    141},
+    {   -11,     95,   -327,    793,  -1560,   2693,  -4397,   8263,
+      28486,  -1094,   -760,   1105,   -959,    651,   -352,    142},
+    {   -13,     98,   -332,    797,  -1557,   2669,  -4320,   7990,
+      28582,   -913,   -853,   1155,   -983,    661,   -355,    142},
+    {   -14,    101,   -337,    801,  -1553,   2645,  -4242,   7718,
+      28669,   -727,   -946,   1204,  -1007,    671,   -358,    143},
+    {   -15,    103,   -341,    804,  -1549,   2619,  -4162,   7447,
+      28756,   -539,  -1040,   1253,  -1030,    680,   -361,    143},
+    {   -16,    106,   -345,    807,  -1544,   2592,  -4081,   7178,
+      28836,   -348,  -1134,   1302,  -1053,    689,   -364,    143},
+    {   -17,    109,   -349,    809,  -1538,   2564,  -3999,   6910,
+      28911,   -153,  -1229,   1350,  -1076,    698,   -366,    144},
+    {   -18,    111,   -353,    811,  -1532,   2535,  -3916,   6643,
+      28984,     44,  -1323,   1398,  -1099,    707,   -368,    144},
+    {   -19,    114,   -356,    813,  -1525,   2505,  -3831,   6379,
+      29048,    245,  -1419,   1446,  -1121,    715,   -370,    144},
+    {   -20,    116,   -359,    814,  -1517,   2474,  -3746,   6116,
+      29110,    448,  -1514,   1494,  -1143,    723,   -372,    144},
+    {   -21,    119,   -362,    815,  -1508,   2442,  -3660,   5854,
+      29165,    655,  -1609,   1541,  -1164,    731,   -374,    144},
+    {   -22,    121,   -365,    815,  -1499,   2409,  -3572,   5595,
+      29217,    864,  -1705,   1588,  -1185,    739,   -376,    144},
+    {   -22,    123,   -368,    815,  -1489,   2375,  -3484,   5337,
+      29264,   1077,  -1801,   1635,  -1206,    746,   -377,    143},
+    {   -23,    125,   -370,    814,  -1478,   2340,  -3395,   5081,
+      29306,   1292,  -1897,   1681,  -1226,    753,   -378,    143},
+    {   -24,    127,   -372,    813,  -1467,   2304,  -3305,   4827,
+      29343,   1510,  -1992,   1727,  -1246,    759,   -379,    143},
+    {   -25,    128,   -374,    812,  -1455,   2268,  -3215,   4575,
+      29378,   1730,  -2088,   1772,  -1265,    765,   -380,    142},
+    {   -25,    130,   -376,    810,  -1442,   2230,  -3123,   4325,
+      29405,   1954,  -2184,   1817,  -1284,    771,   -381,    141},
+    {   -26,    132,   -377,    808,  -1429,   2192,  -3032,   4078,
+      29425,   2180,  -2279,   1861,  -1302,    777,   -381,    141},
+    {   -27,    133,   -378,    806,  -1415,   2153,  -2939,   3832,
+      29443,   2408,  -2374,   1905,  -1320,    782,   -381,    140},
+    {   -27,    134,   -379,    803,  -1401,   2113,  -2846,   3589,
+      29455,   2640,  -2469,   1948,  -1337,    787,   -381,    139},
+    {   -28,    136,   -380,    799,  -1386,   2073,  -2753,   3348,
+      29466,   2873,  -2564,   1990,  -1354,    791,   -381,    138}
+};
+
+static void resampler_refill(resampler_struct *resampler);
+
+/*!
+    \brief      compute the step from an input rate to an output rate of outclock / outdiv
+    \param[in]  inrate: input sample rate in Hz
+    \param[in]  outclock: clock the output sample rate is derived from in Hz
+    \param[in]  outdiv: divider of the clock giving the output sample rate
+    \param[out] none
+    \retval     input frames per output frame in 32.32 fixed point
+*/
+uint64_t resampler_step_calc(uint32_t inrate, uint32_t outclock, uint32_t outdiv)
+{
+    uint64_t numerator = (uint64_t)inrate * outdiv;
+    uint64_t step;
+
+    /* the integer part and the remainder are divided apart to keep the shift in 64 bits */
+    step = (numerator / outclock) << 32;
+    step += ((numerator % outclock) << 32) / outclock;
+    return step;
+}
+
+/*!
+    \brief      initialize the resampler with a step in 32.32 fixed point
+    \param[in]  resampler: pointer to the resampler
+    \param[in]  step: input frames per output frame in 32.32 fixed point, below 2.0
+    \param[in]  pull: callback delivering the input frames
+    \param[in]  context: context passed to the pull callback
+    \param[out] none
+    \retval     none
+*/
+void resampler_init(resampler_struct *resampler, uint64_t step, resampler_pull_func pull, void *context)
+{
+    memset(resampler, 0, sizeof(resampler_struct));
+    resampler->step_int = (uint32_t)(step >> 32);
+    resampler->step_frac = (uint32_t)step;
+    resampler->pull = pull;
+    resampler->context = context;
+    /* the history starts with silence so that the first input frame is on the centre tap */
+    resampler->count = RESAMPLER_TAPS / 2U - 1U;
+}
+
+/*!
+    \brief      produce interleaved stereo output frames
+    \param[in]  resampler: pointer to the resampler
+    \param[in]  frames: number of output frames
+    \param[out] output: pointer to the interleaved 16-bit output samples
+    \retval     none
+*/
+void resampler_process(resampler_struct *resampler, int16_t *output, uint32_t frames)
+{
+    const int16_t *coef;
+    const int16_t *left;
+    const int16_t *right;
+    uint32_t packed;
+    uint32_t frac;
+    uint32_t tap;
+    int32_t acc_left;
+    int32_t acc_right;
+
+    while(0U != frames--) {
+        while((resampler->position + RESAMPLER_TAPS) > resampler->count) {
+            resampler_refill(resampler);
+        }
+        coef = resampler_coef[resampler->frac >> (32U - RESAMPLER_PHASE_BITS)];
+        left = &resampler->left[resampler->position];
+        right = &resampler->right[resampler->position];
+
+        /* two taps per SMLAD, the accumulators start with the rounding of the Q15 product */
+        acc_left = 1 << 14;
+        acc_right = 1 << 14;
+        for(tap = 0U; tap < RESAMPLER_TAPS; tap += 2U) {
+            packed = dsp_read_q15x2(&coef[tap]);
+            acc_left = dsp_smlad(dsp_read_q15x2(&left[tap]), packed, acc_left);
+            acc_right = dsp_smlad(dsp_read_q15x2(&right[tap]), packed, acc_right);
+        }
+        *output++ = dsp_ssat16(acc_left >> 15);
+        *output++ = dsp_ssat16(acc_right >> 15);
+
+        /* advance by the step, the carry of the fraction moves one more input frame */
+        frac = resampler->frac + resampler->step_frac;
+        resampler->position += resampler->step_int + ((frac < resampler->frac) ? 1U : 0U);
+        resampler->frac = frac;
+    }
+}
+
+/*!
+    \brief      drop the history frames already used and pull a chunk of input frames
+    \param[in]  resampler: pointer to the resampler
+    \param[out] none
+    \retval     none
+*/
+static void resampler_refill(resampler_struct *resampler)
+{
+    uint32_t drop = resampler->position;
+    uint32_t index;
+
+    /* frames before the position are no longer needed, the position may also have
+       stepped over frames not pulled yet */
+    if(drop > resampler->count) {
+        drop = resampler->count;
+    }
+    resampler->count -= drop;
+    resampler->position -= drop;
+    memmove(resampler->left, &resampler->left[drop], resampler->count * sizeof(int16_t));
+    memmove(resampler->right, &resampler->right[drop], resampler->count * sizeof(int16_t));
+
+    resampler->pull(resampler->context, resampler->input, RESAMPLER_CHUNK);
+    for(index = 0U; index < RESAMPLER_CHUNK; index++) {
+        resampler->left[resampler->count + index] = resampler->input[2U * index];
+        resampler->right[resampler->count + index] = resampler->input[2U * index + 1U];
+    }
+    resampler->count += RESAMPLER_CHUNK;
+}
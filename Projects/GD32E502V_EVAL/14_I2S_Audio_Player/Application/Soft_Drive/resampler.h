@@ -0,0 +1,69 @@
+/*!
+    \file    resampler.h
+    \brief   the header file of the polyphase sample rate converter
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+
+#define RESAMPLER_TAPS                16U                 /* taps of each polyphase filter */
+#define RESAMPLER_PHASE_BITS          7U                  /* 128 filter phases between two input frames */
+#define RESAMPLER_CHUNK               64U                 /* input frames pulled at once */
+
+/* pull callback of the input stereo frames, it must always deliver count frames */
+typedef void (*resampler_pull_func)(void *context, int16_t *frames, uint32_t count);
+
+/* polyphase resampler structure */
+typedef struct {
+    int16_t left[RESAMPLER_TAPS + RESAMPLER_CHUNK];     /* history of the left channel */
+    int16_t right[RESAMPLER_TAPS + RESAMPLER_CHUNK];    /* history of the right channel */
+    int16_t input[RESAMPLER_CHUNK * 2U];                /* interleaved frames delivered by the pull callback */
+    uint32_t step_int;                                  /* input frames per output frame, integer part */
+    uint32_t step_frac;                                 /* input frames per output frame, fraction in 1/2^32 */
+    uint32_t frac;                                      /* position between two input frames in 1/2^32 */
+    uint32_t position;                                  /* first history frame of the next output frame */
+    uint32_t count;                                     /* frames in the history */
+    resampler_pull_func pull;                           /* pull callback of the input frames */
+    void *context;                                      /* context passed to the pull callback */
+} resampler_struct;
+
+/* function declarations */
+/* compute the step from an input rate to an output rate of outclock / outdiv */
+uint64_t resampler_step_calc(uint32_t inrate, uint32_t outclock, uint32_t outdiv);
+/* initialize the resampler with a step in 32.32 fixed point */
+void resampler_init(resampler_struct *resampler, uint64_t step, resampler_pull_func pull, void *context);
+/* produce interleaved stereo output frames */
+void resampler_process(resampler_struct *resampler, int16_t *output, uint32_t frames);
+
+#endif /* RESAMPLER_H */
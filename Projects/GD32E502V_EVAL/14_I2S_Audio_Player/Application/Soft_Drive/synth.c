@@ -0,0 +1,294 @@
+/*!
+    \file    synth.c
+    \brief   wavetable synthesizer rendering notes into the audio output
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include <math.h>
+#include "synth.h"
+#include "audio_dsp.h"
+
+/* Q30 level of 1.0 */
+#define SYNTH_LEVEL_MAX     (1 << 30)
+/* bits of the phase below the table index, the upper 15 of them interpolate the table */
+#define SYNTH_FRAC_SHIFT    (32U - SYNTH_TABLE_BITS - 15U)
+
+/* single cycle sine wavetable */
+const int16_t synth_table_sine[SYNTH_TABLE_SIZE + 1U] = {
+    0, 3212, 6393, 9512, 12539, 15446, 18204, 20787,
+    23170, 25329, 27245, 28898, 30273, 31356, 32137, 32609,
+    32767, 32609, 32137, 31356, 30273, 28898, 27245, 25329,
+    23170, 20787, 18204, 15446, 12539, 9512, 6393, 3212,
+    0, -3212, -6393, -9512, -12539, -15446, -18204, -20787,
+    -23170, -25329, -27245, -28898, -30273, -31356, -32137, -32609,
+    -32767, -32609, -32137, -31356, -30273, -28898, -27245, -25329,
+    -23170, -20787, -18204, -15446, -12539, -9512, -6393, -3212,
+    0
+};
+
+static uint32_t synth_frames(const synth_struct *synth, uint16_t time);
+static void synth_stage_next(synth_voice_struct *voice);
+
+/*!
+    \brief      initialize the synthesizer, all the voices are stopped
+    \param[in]  synth: pointer to the synthesizer
+    \param[in]  samplerate: output sample rate in Hz
+    \param[out] none
+    \retval     none
+*/
+void synth_init(synth_struct *synth, uint32_t samplerate)
+{
+    memset(synth, 0, sizeof(synth_struct));
+    synth->samplerate = samplerate;
+}
+
+/*!
+    \brief      set the output sample rate used by the next notes
+    \param[in]  synth: pointer to the synthesizer
+    \param[in]  samplerate: output sample rate in Hz
+    \param[out] none
+    \retval     none
+*/
+void synth_samplerate_set(synth_struct *synth, uint32_t samplerate)
+{
+    synth->samplerate = samplerate;
+}
+
+/*!
+    \brief      get the frequency of a MIDI note number
+    \param[in]  note: MIDI note number, 69 is A4
+    \param[out] none
+    \retval     frequency in Hz
+*/
+float synth_note_frequency(uint8_t note)
+{
+    return 440.0f * powf(2.0f, ((float)note - 69.0f) / 12.0f);
+}
+
+/*!
+    \brief      start a note on a free voice, a voice in its release is taken when none is free
+    \param[in]  synth: pointer to the synthesizer
+    \param[in]  table: one cycle of SYNTH_TABLE_SIZE samples followed by the first sample again
+    \param[in]  frequency: frequency of the note in Hz
+    \param[in]  gain: Q15 gain of the note, SYNTH_GAIN_UNITY for 1.0
+    \param[in]  envelope: ADSR envelope of the note
+    \param[out] none
+    \retval     index of the voice, SYNTH_VOICE_NONE if all the voices are held
+*/
+uint8_t synth_note_on(synth_struct *synth, const int16_t *table, float frequency, int16_t gain, const synth_envelope_struct *envelope)
+{
+    synth_voice_struct *voice;
+    uint8_t index;
+    uint8_t found = SYNTH_VOICE_NONE;
+
+    if((NULL == table) || (NULL == envelope) || (0U == synth->samplerate) || (frequency <= 0.0f)
+            || (frequency >= (float)synth->samplerate / 2.0f)) {
+        return SYNTH_VOICE_NONE;
+    }
+    for(index = 0U; index < SYNTH_VOICES; index++) {
+        if(SYNTH_STAGE_IDLE == synth->voice[index].stage) {
+            found = index;
+            break;
+        }
+        if((SYNTH_VOICE_NONE == found) && (SYNTH_STAGE_RELEASE == synth->voice[index].stage)) {
+            found = index;
+        }
+    }
+    if(SYNTH_VOICE_NONE == found) {
+        return SYNTH_VOICE_NONE;
+    }
+
+    voice = &synth->voice[found];
+    voice->table = table;
+    voice->phase = 0U;
+    voice->increment = (uint32_t)(frequency * 4294967296.0f / (float)synth->samplerate);
+    voice->decay_frames = synth_frames(synth, envelope->decay);
+    voice->release_frames = synth_frames(synth, envelope->release);
+    voice->sustain = (envelope->sustain < 0) ? 0 : envelope->sustain;
+    voice->gain = gain;
+    /* a stolen voice starts its attack from its current level so that no click is heard */
+    if(SYNTH_STAGE_IDLE == voice->stage) {
+        voice->level = 0;
+    }
+    voice->stage = SYNTH_STAGE_ATTACK;
+    voice->remaining = synth_frames(synth, envelope->attack);
+    voice->step = (SYNTH_LEVEL_MAX - voice->level) / (int32_t)voice->remaining;
+    return found;
+}
+
+/*!
+    \brief      release a note, the voice stops at the end of the release
+    \param[in]  synth: pointer to the synthesizer
+    \param[in]  voice: index of the voice
+    \param[out] none
+    \retval     none
+*/
+void synth_note_off(synth_struct *synth, uint8_t voice)
+{
+    synth_voice_struct *note;
+
+    if((voice < SYNTH_VOICES) && (SYNTH_STAGE_IDLE != synth->voice[voice].stage)
+            && (SYNTH_STAGE_RELEASE != synth->voice[voice].stage)) {
+        note = &synth->voice[voice];
+        note->stage = SYNTH_STAGE_RELEASE;
+        note->remaining = note->release_frames;
+        note->step = -(note->level / (int32_t)note->remaining);
+    }
+}
+
+/*!
+    \brief      check whether a voice is playing
+    \param[in]  synth: pointer to the synthesizer
+    \param[in]  voice: index of the voice
+    \param[out] none
+    \retval     1 if the voice is playing, 0 otherwise
+*/
+uint8_t synth_voice_active(const synth_struct *synth, uint8_t voice)
+{
+    if(voice < SYNTH_VOICES) {
+        return (SYNTH_STAGE_IDLE != synth->voice[voice].stage) ? 1U : 0U;
+    }
+    return 0U;
+}
+
+/*!
+    \brief      add the playing notes to interleaved stereo frames
+    \param[in]  synth: pointer to the synthesizer
+    \param[in]  output: pointer to the interleaved 16-bit frames the notes are added to
+    \param[in]  frames: number of stereo frames
+    \param[out] output: the frames with the notes added
+    \retval     number of voice frames rendered, the sum over the voices of the frames each played
+*/
+uint32_t synth_process(synth_struct *synth, int16_t *output, uint32_t frames)
+{
+    synth_voice_struct *voice;
+    int16_t *frame;
+    const int16_t *table;
+    uint32_t index;
+    uint32_t done;
+    uint32_t count;
+    uint32_t phase;
+    uint32_t packed;
+    uint32_t rendered = 0U;
+    int32_t level;
+    int32_t sample;
+    int32_t first;
+
+    for(index = 0U; index < SYNTH_VOICES; index++) {
+        voice = &synth->voice[index];
+        frame = output;
+        done = 0U;
+        while((SYNTH_STAGE_IDLE != voice->stage) && (done < frames)) {
+            /* the block is cut at the end of the envelope stage, the level is a plain ramp inside */
+            count = frames - done;
+            if(voice->remaining < count) {
+                count = voice->remaining;
+            }
+            table = voice->table;
+            phase = voice->phase;
+            level = voice->level;
+            voice->remaining -= count;
+            done += count;
+            while(0U != count) {
+                /* linear interpolation between two samples of the table */
+                first = table[phase >> (32U - SYNTH_TABLE_BITS)];
+                sample = first + (((table[(phase >> (32U - SYNTH_TABLE_BITS)) + 1U] - first)
+                                   * (int32_t)((phase >> SYNTH_FRAC_SHIFT) & 0x7FFFU)) >> 15);
+                sample = (sample * (level >> 15)) >> 15;
+                sample = (sample * voice->gain) >> 15;
+                phase += voice->increment;
+                level += voice->step;
+                packed = dsp_pack((int16_t)sample, (int16_t)sample);
+                packed = dsp_qadd16(dsp_read_q15x2(frame), packed);
+                memcpy(frame, &packed, sizeof(packed));
+                frame += 2U;
+                count--;
+            }
+            voice->phase = phase;
+            voice->level = level;
+            if(0U == voice->remaining) {
+                synth_stage_next(voice);
+            }
+        }
+        rendered += done;
+    }
+    return rendered;
+}
+
+/*!
+    \brief      convert a time to a number of frames, at least one
+    \param[in]  synth: pointer to the synthesizer
+    \param[in]  time: time in ms
+    \param[out] none
+    \retval     number of frames
+*/
+static uint32_t synth_frames(const synth_struct *synth, uint16_t time)
+{
+    uint32_t frames = (uint32_t)(((uint64_t)time * synth->samplerate) / 1000U);
+
+    return (0U == frames) ? 1U : frames;
+}
+
+/*!
+    \brief      move a voice to the next stage of its envelope
+    \param[in]  voice: pointer to the voice
+    \param[out] none
+    \retval     none
+*/
+static void synth_stage_next(synth_voice_struct *voice)
+{
+    switch(voice->stage) {
+    case SYNTH_STAGE_ATTACK:
+        voice->stage = SYNTH_STAGE_DECAY;
+        voice->level = SYNTH_LEVEL_MAX;
+        voice->remaining = voice->decay_frames;
+        voice->step = -((SYNTH_LEVEL_MAX - ((int32_t)voice->sustain << 15)) / (int32_t)voice->decay_frames);
+        break;
+    case SYNTH_STAGE_DECAY:
+        /* the sustain lasts until synth_note_off() */
+        voice->stage = SYNTH_STAGE_SUSTAIN;
+        voice->level = (int32_t)voice->sustain << 15;
+        voice->remaining = 0xFFFFFFFFU;
+        voice->step = 0;
+        if(0 == voice->sustain) {
+            voice->stage = SYNTH_STAGE_IDLE;
+        }
+        break;
+    case SYNTH_STAGE_SUSTAIN:
+        voice->remaining = 0xFFFFFFFFU;
+        break;
+    default:
+        voice->stage = SYNTH_STAGE_IDLE;
+        voice->level = 0;
+        break;
+    }
+}
@@ -0,0 +1,103 @@
+/*!
+    \file    synth.h
+    \brief   the header file of the wavetable synthesizer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+
+#define SYNTH_VOICES                  8U                  /* notes played at the same time */
+#define SYNTH_VOICE_NONE              0xFFU               /* returned when no voice is free */
+#define SYNTH_TABLE_BITS              6U                  /* a wavetable holds 2^6 samples of one cycle */
+#define SYNTH_TABLE_SIZE              (1U << SYNTH_TABLE_BITS)
+#define SYNTH_GAIN_UNITY              32767               /* Q15 gain of 1.0 */
+
+/* envelope stage enum */
+typedef enum {
+    SYNTH_STAGE_IDLE = 0,               /* the voice is free */
+    SYNTH_STAGE_ATTACK,                 /* the level rises to 1.0 */
+    SYNTH_STAGE_DECAY,                  /* the level falls to the sustain level */
+    SYNTH_STAGE_SUSTAIN,                /* the level is held until the note is released */
+    SYNTH_STAGE_RELEASE                 /* the level falls to 0 */
+} synth_stage_enum;
+
+/* ADSR envelope structure, the stages are linear */
+typedef struct {
+    uint16_t attack;                    /* attack time in ms */
+    uint16_t decay;                     /* decay time in ms */
+    int16_t sustain;                    /* Q15 sustain level */
+    uint16_t release;                   /* release time in ms */
+} synth_envelope_struct;
+
+/* synthesizer voice structure */
+typedef struct {
+    const int16_t *table;               /* one cycle of SYNTH_TABLE_SIZE samples followed by the first one again */
+    uint32_t phase;                     /* position in the cycle, the upper SYNTH_TABLE_BITS bits index the table */
+    uint32_t increment;                 /* phase added for each frame */
+    int32_t level;                      /* Q30 level of the envelope */
+    int32_t step;                       /* level added for each frame */
+    uint32_t remaining;                 /* frames left in the envelope stage */
+    uint32_t decay_frames;              /* duration of the decay */
+    uint32_t release_frames;            /* duration of the release */
+    int16_t sustain;                    /* Q15 sustain level */
+    int16_t gain;                       /* Q15 gain of the note */
+    synth_stage_enum stage;             /* envelope stage */
+} synth_voice_struct;
+
+/* synthesizer structure */
+typedef struct {
+    synth_voice_struct voice[SYNTH_VOICES];             /* voices of the synthesizer */
+    uint32_t samplerate;                                /* output sample rate in Hz */
+} synth_struct;
+
+/* single cycle sine wavetable */
+extern const int16_t synth_table_sine[SYNTH_TABLE_SIZE + 1U];
+
+/* function declarations */
+/* initialize the synthesizer, all the voices are stopped */
+void synth_init(synth_struct *synth, uint32_t samplerate);
+/* set the output sample rate used by the next notes */
+void synth_samplerate_set(synth_struct *synth, uint32_t samplerate);
+/* get the frequency of a MIDI note number */
+float synth_note_frequency(uint8_t note);
+/* start a note on a free voice */
+uint8_t synth_note_on(synth_struct *synth, const int16_t *table, float frequency, int16_t gain, const synth_envelope_struct *envelope);
+/* release a note, the voice stops at the end of the release */
+void synth_note_off(synth_struct *synth, uint8_t voice);
+/* check whether a voice is playing */
+uint8_t synth_voice_active(const synth_struct *synth, uint8_t voice);
+/* add the playing notes to interleaved stereo frames */
+uint32_t synth_process(synth_struct *synth, int16_t *output, uint32_t frames);
+
+#endif /* SYNTH_H */
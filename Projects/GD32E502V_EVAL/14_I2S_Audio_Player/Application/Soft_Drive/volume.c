@@ -0,0 +1,175 @@
+/*!
+    \file    volume.c
+    \brief   ramped volume
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "volume.h"
+#include "audio_dsp.h"
+
+static int32_t volume_gain_next(volume_struct *volume);
+
+/*!
+    \brief      initialize the volume at a gain without ramp
+    \param[in]  volume: pointer to the volume
+    \param[in]  gain: gain in Q15, VOLUME_UNITY for 1.0
+    \param[out] none
+    \retval     none
+*/
+void volume_init(volume_struct *volume, uint32_t gain)
+{
+    if(gain > VOLUME_UNITY) {
+        gain = VOLUME_UNITY;
+    }
+    volume->gain = (int32_t)(gain << 15);
+    volume->step = 0;
+    volume->target = gain;
+    volume->remaining = 0U;
+}
+
+/*!
+    \brief      ramp the volume to a new gain, the gain changes a little every frame so that
+                no zipper noise is heard
+    \param[in]  volume: pointer to the volume
+    \param[in]  gain: gain in Q15, VOLUME_UNITY for 1.0
+    \param[out] none
+    \retval     none
+*/
+void volume_set(volume_struct *volume, uint32_t gain)
+{
+    if(gain > VOLUME_UNITY) {
+        gain = VOLUME_UNITY;
+    }
+    volume->target = gain;
+    volume->step = ((int32_t)(gain << 15) - volume->gain) / (int32_t)VOLUME_RAMP_FRAMES;
+    volume->remaining = VOLUME_RAMP_FRAMES;
+}
+
+/*!
+    \brief      apply the volume to interleaved stereo frames in place
+    \param[in]  volume: pointer to the volume
+    \param[in]  frames: pointer to the interleaved 16-bit frames
+    \param[in]  count: number of stereo frames
+    \param[out] frames: the frames at the new volume
+    \retval     none
+*/
+void volume_process(volume_struct *volume, int16_t *frames, uint32_t count)
+{
+    uint32_t packed;
+    uint32_t next;
+    uint32_t gain_left;
+    uint32_t gain_right;
+    uint32_t index = 0U;
+    int32_t gain;
+
+    /* the gain changes on every frame of a ramp, SMULBB and SMULTB scale the left and the
+       right sample of the word by the gain, a frame at VOLUME_UNITY is left as it is */
+    for(; (index < count) && (0U != volume->remaining); index++) {
+        gain = volume_gain_next(volume);
+        if(gain < (int32_t)VOLUME_UNITY) {
+            packed = dsp_read_q15x2(&frames[2U * index]);
+            packed = dsp_pack_bottom((uint32_t)(dsp_smulbb(packed, (uint32_t)gain) >> 15),
+                                     (uint32_t)(dsp_smultb(packed, (uint32_t)gain) >> 15));
+            memcpy(&frames[2U * index], &packed, sizeof(packed));
+        }
+    }
+    if((index == count) || (VOLUME_UNITY == volume->target)) {
+        return;
+    }
+
+    /* below VOLUME_UNITY the gain fits in a half word, one SMUAD of the frame with the gain in
+       the low or in the high half word scales the left or the right sample */
+    gain = volume->gain >> 15;
+    gain_left = dsp_pack((int16_t)gain, 0);
+    gain_right = dsp_pack(0, (int16_t)gain);
+    for(; (index + 1U) < count; index += 2U) {
+        packed = dsp_read_q15x2(&frames[2U * index]);
+        next = dsp_read_q15x2(&frames[2U * index + 2U]);
+        packed = dsp_pack_bottom((uint32_t)(dsp_smuad(packed, gain_left) >> 15),
+                                 (uint32_t)(dsp_smuad(packed, gain_right) >> 15));
+        next = dsp_pack_bottom((uint32_t)(dsp_smuad(next, gain_left) >> 15),
+                               (uint32_t)(dsp_smuad(next, gain_right) >> 15));
+        memcpy(&frames[2U * index], &packed, sizeof(packed));
+        memcpy(&frames[2U * index + 2U], &next, sizeof(next));
+    }
+    if(index < count) {
+        packed = dsp_read_q15x2(&frames[2U * index]);
+        packed = dsp_pack_bottom((uint32_t)(dsp_smuad(packed, gain_left) >> 15),
+                                 (uint32_t)(dsp_smuad(packed, gain_right) >> 15));
+        memcpy(&frames[2U * index], &packed, sizeof(packed));
+    }
+}
+
+/*!
+    \brief      apply the volume to interleaved stereo frames of 32-bit samples in place
+    \param[in]  volume: pointer to the volume
+    \param[in]  frames: pointer to the interleaved 32-bit frames
+    \param[in]  count: number of stereo frames
+    \param[out] frames: the frames at the new volume
+    \retval     none
+*/
+void volume_process32(volume_struct *volume, int32_t *frames, uint32_t count)
+{
+    uint32_t index = 0U;
+    int32_t gain;
+
+    /* the gain changes on every frame of a ramp */
+    for(; (index < count) && (0U != volume->remaining); index++) {
+        gain = volume_gain_next(volume);
+        frames[2U * index] = (int32_t)(((int64_t)frames[2U * index] * gain) >> 15);
+        frames[2U * index + 1U] = (int32_t)(((int64_t)frames[2U * index + 1U] * gain) >> 15);
+    }
+    if(VOLUME_UNITY == volume->target) {
+        return;
+    }
+
+    /* then it is the same for the rest of the block, one SMULL per sample */
+    gain = volume->gain >> 15;
+    for(index *= 2U; index < (2U * count); index++) {
+        frames[index] = (int32_t)(((int64_t)frames[index] * gain) >> 15);
+    }
+}
+
+/*!
+    \brief      move the ramp by one frame
+    \param[in]  volume: pointer to the volume
+    \param[out] none
+    \retval     gain of the frame in Q15
+*/
+static int32_t volume_gain_next(volume_struct *volume)
+{
+    if(0U != volume->remaining) {
+        volume->remaining--;
+        volume->gain = (0U == volume->remaining) ? (int32_t)(volume->target << 15) : (volume->gain + volume->step);
+    }
+    return volume->gain >> 15;
+}
@@ -0,0 +1,61 @@
+/*!
+    \file    volume.h
+    \brief   the header file of the ramped volume
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef VOLUME_H
+#define VOLUME_H
+
+#include <stdint.h>
+
+#define VOLUME_UNITY                  32768U              /* gain of 1.0 */
+#define VOLUME_RAMP_FRAMES            256U                /* frames to reach a new gain */
+
+/* ramped volume structure */
+typedef struct {
+    int32_t gain;                                       /* current gain in Q30 */
+    int32_t step;                                       /* gain change per frame in Q30 */
+    uint32_t target;                                    /* gain reached at the end of the ramp in Q15 */
+    uint32_t remaining;                                 /* frames left in the ramp */
+} volume_struct;
+
+/* function declarations */
+/* initialize the volume at a gain without ramp */
+void volume_init(volume_struct *volume, uint32_t gain);
+/* ramp the volume to a new gain */
+void volume_set(volume_struct *volume, uint32_t gain);
+/* apply the volume to interleaved stereo frames in place */
+void volume_process(volume_struct *volume, int16_t *frames, uint32_t count);
+/* apply the volume to interleaved stereo frames of 32-bit samples in place */
+void volume_process32(volume_struct *volume, int32_t *frames, uint32_t count);
+
+#endif /* VOLUME_H */
@@ -0,0 +1,192 @@
+/*!
+    \file    wave_parser.c
+    \brief   RIFF/WAVE chunk parser
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#include <string.h>
+#include "wave_parser.h"
+
+#define CHUNKHEADERSIZE     8U          /* chunk id and chunk size */
+#define RIFFHEADERSIZE      12U         /* 'RIFF', file length and 'WAVE' */
+#define FORMATCHUNKMAXSIZE  40U         /* size of the extensible fmt chunk */
+
+static uint32_t read_le(const uint8_t *buffer, uint8_t nbrofbytes);
+static uint32_t read_be32(const uint8_t *buffer);
+
+/*!
+    \brief      walk the chunks of a wave file and describe its format and audio data
+    \param[in]  reader: audio file reader, the file is only accessed through the read callback
+    \param[out] wave: format of the file, offset and size of the audio data
+    \retval     errorcode_enum
+*/
+errorcode_enum wave_parse(const wave_reader_struct *reader, wave_file_struct *wave)
+{
+    uint8_t header[FORMATCHUNKMAXSIZE];
+    uint32_t offset = RIFFHEADERSIZE;
+    uint32_t end = 0U;
+    uint32_t chunkid = 0U;
+    uint32_t chunksize = 0U;
+    uint32_t length = 0U;
+    uint8_t fmtfound = 0U;
+    uint8_t datafound = 0U;
+
+    memset(wave, 0, sizeof(wave_file_struct));
+
+    if(RIFFHEADERSIZE != reader->read(reader->context, 0U, header, RIFFHEADERSIZE)) {
+        return(UNVALID_RIFF_ID);
+    }
+    /* read chunkid, must be 'riff' */
+    if(CHUNKID != read_be32(&header[0])) {
+        return(UNVALID_RIFF_ID);
+    }
+    /* read the file length */
+    wave->riffchunksize = read_le(&header[4], 4U);
+    /* read the file format, must be 'wave' */
+    if(FILEFORMAT != read_be32(&header[8])) {
+        return(UNVALID_WAVE_FORMAT);
+    }
+
+    /* the chunks end with the riff chunk or with the file, whichever comes first */
+    end = CHUNKHEADERSIZE + wave->riffchunksize;
+    if(end < wave->riffchunksize) {
+        end = 0xFFFFFFFFU;
+    }
+    if((0U != reader->size) && (reader->size < end)) {
+        end = reader->size;
+    }
+
+    while((0U == fmtfound) || (0U == datafound)) {
+        if((offset > end) || ((end - offset) < CHUNKHEADERSIZE)) {
+            break;
+        }
+        if(CHUNKHEADERSIZE != reader->read(reader->context, offset, header, CHUNKHEADERSIZE)) {
+            break;
+        }
+        chunkid = read_be32(&header[0]);
+        chunksize = read_le(&header[4], 4U);
+        offset += CHUNKHEADERSIZE;
+
+        if(FORMATID == chunkid) {
+            if(chunksize < FORMATCHUNKSIZE) {
+                return(UNVALID_FORMATCHUNK_ID);
+            }
+            /* the fields after the extensible ones are ignored */
+            length = (chunksize < FORMATCHUNKMAXSIZE) ? chunksize : FORMATCHUNKMAXSIZE;
+            if(length != reader->read(reader->context, offset, header, length)) {
+                return(UNVALID_FORMATCHUNK_ID);
+            }
+            wave->formattag = read_le(&header[0], 2U);
+            wave->numchannels = read_le(&header[2], 2U);
+            wave->samplerate = read_le(&header[4], 4U);
+            wave->byterate = read_le(&header[8], 4U);
+            wave->blockalign = read_le(&header[12], 2U);
+            wave->bitspersample = read_le(&header[14], 2U);
+            wave->validbitspersample = wave->bitspersample;
+            /* the extensible format carries the real format tag in its sub format */
+            if((WAVE_FORMAT_EXTENSIBLE == wave->formattag) && (length >= FORMATCHUNKMAXSIZE)
+                    && (read_le(&header[16], 2U) >= 22U)) {
+                wave->validbitspersample = read_le(&header[18], 2U);
+                wave->channelmask = read_le(&header[20], 4U);
+                wave->formattag = read_le(&header[24], 2U);
+            }
+            if((WAVE_FORMAT_IMA_ADPCM == wave->formattag) && (length >= 20U)) {
+                wave->samplesperblock = read_le(&header[18], 2U);
+            }
+            fmtfound = 1U;
+        } else if(DATAID == chunkid) {
+            wave->dataoffset = offset;
+            /* streamed files may not know their data size, clip it to the file */
+            if(chunksize > (end - offset)) {
+                chunksize = end - offset;
+            }
+            wave->datasize = chunksize;
+            datafound = 1U;
+        }
+
+        /* seek over the chunk data and its pad byte */
+        if((end - offset) < chunksize) {
+            break;
+        }
+        offset += chunksize + (chunksize & 1U);
+    }
+
+    if(0U == fmtfound) {
+        return(UNVALID_FORMATCHUNK_ID);
+    }
+    if(0U == datafound) {
+        return(UNVALID_DATACHUNK_ID);
+    }
+    return(VALID_WAVE_FILE);
+}
+
+/*!
+    \brief      read callback for a wave file located in memory
+    \param[in]  context: start address of the file
+    \param[in]  offset: offset of the first byte to read
+    \param[in]  length: number of bytes to read
+    \param[out] buffer: pointer to the buffer receiving the data
+    \retval     number of bytes read
+*/
+uint32_t wave_memory_read(void *context, uint32_t offset, uint8_t *buffer, uint32_t length)
+{
+    memcpy(buffer, (const uint8_t *)context + offset, length);
+    return length;
+}
+
+/*!
+    \brief      read little endian uint data
+    \param[in]  buffer: pointer to the first byte
+    \param[in]  nbrofbytes: number of read bytes
+    \param[out] none
+    \retval     the uint data
+*/
+static uint32_t read_le(const uint8_t *buffer, uint8_t nbrofbytes)
+{
+    uint32_t index = 0U;
+    uint32_t temp = 0U;
+
+    for(index = 0U; index < nbrofbytes; index++) {
+        temp |= (uint32_t)buffer[index] << (index * 8U);
+    }
+    return temp;
+}
+
+/*!
+    \brief      read big endian 32-bit data, used for the chunk ids
+    \param[in]  buffer: pointer to the first byte
+    \param[out] none
+    \retval     the uint data
+*/
+static uint32_t read_be32(const uint8_t *buffer)
+{
+    return ((uint32_t)buffer[0] << 24) | ((uint32_t)buffer[1] << 16) | ((uint32_t)buffer[2] << 8) | buffer[3];
+}
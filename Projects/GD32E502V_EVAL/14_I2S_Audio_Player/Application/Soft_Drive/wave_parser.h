@@ -0,0 +1,137 @@
+/*!
+    \file    wave_parser.h
+    \brief   the header file of the RIFF/WAVE chunk parser
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+#ifndef WAVE_PARSER_H
+#define WAVE_PARSER_H
+
+/* .WAV file format :
+
+  Endian      Offset      Length      Contents
+  big         0           4 bytes     'RIFF'              0x52494646
+  little      4           4 bytes     <file length - 8>
+  big         8           4 bytes     'WAVE'              0x57415645
+
+  The rest of the file is a list of chunks, each one starts with a 8 bytes header:
+
+  big         0           4 bytes     <chunk id>          e.g. 'fmt ', 'fact', 'LIST', 'data'
+  little      4           4 bytes     <chunk size>        size of the chunk data, a pad byte follows odd sizes
+  -           8           *           <chunk data>
+
+  The fmt chunk describes the sample format:
+
+  little      0           2 bytes     <format tag>        1 = PCM, 0xFFFE = extensible
+  little      2           2 bytes     <channels>          channels: 1 = mono, 2 = stereo
+  little      4           4 bytes     <sample rate>       samples per second: e.g., 22050
+  little      8           4 bytes     <bytes/second>      sample rate * block align
+  little      12          2 bytes     <block align>       channels * bits/sample / 8
+  little      14          2 bytes     <bits/sample>       8 or 16
+  little      16          2 bytes     <extra size>        optional, size of the extra format bytes
+  little      18          2 bytes     <samples per block> IMA-ADPCM only
+  little      18          2 bytes     <valid bits>        extensible only
+  little      20          4 bytes     <channel mask>      extensible only
+  little      24          16 bytes    <sub format>        extensible only, starts with the format tag
+
+  The data chunk contains the sample data. The chunks may come in any order, the parser walks
+  them by seeking over their data so unknown chunks of any size cost one header read.
+*/
+
+#include <stdint.h>
+
+/* constants definitions */
+/* audio parsing constants */
+#define CHUNKID             0x52494646  /* correspond to the letters 'RIFF' */
+#define FILEFORMAT          0x57415645  /* correspond to the letters 'WAVE' */
+#define FORMATID            0x666D7420  /* correspond to the letters 'fmt ' */
+#define DATAID              0x64617461  /* correspond to the letters 'data' */
+#define FACTID              0x66616374  /* correspond to the letters 'fact' */
+#define WAVE_FORMAT_PCM     0x01        /* pcm format */
+#define WAVE_FORMAT_IMA_ADPCM 0x11      /* IMA-ADPCM format */
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE   /* extensible format, the format tag is in the sub format */
+#define FORMATCHUNKSIZE     0x10        /* format chunk size */
+#define CHANNEL_MONO        0x01        /* mono channel */
+#define CHANNEL_STEREO      0x02        /* stereo channel */
+#define BITS_PER_SAMPLE_4   4           /* 4 bits per sample */
+#define BITS_PER_SAMPLE_8   8           /* 8 bits per sample */
+#define BITS_PER_SAMPLE_16  16          /* 16 bits per sample */
+#define BITS_PER_SAMPLE_24  24          /* 24 bits per sample */
+#define BITS_PER_SAMPLE_32  32          /* 32 bits per sample */
+
+/* read callback: copy length bytes located at offset into buffer, return the number of bytes copied */
+typedef uint32_t (*wave_read_func)(void *context, uint32_t offset, uint8_t *buffer, uint32_t length);
+
+/* audio file reader structure */
+typedef struct {
+    wave_read_func read;                /* read callback */
+    void *context;                      /* context passed to the read callback */
+    uint32_t size;                      /* size of the file in bytes, 0 if unknown */
+} wave_reader_struct;
+
+/* audio file information structure */
+typedef struct {
+    uint32_t riffchunksize;             /* riff chunk size */
+    uint16_t formattag;                 /* format tag, taken from the sub format for extensible files */
+    uint16_t numchannels;               /* number of channel */
+    uint32_t samplerate;                /* audio sample rate */
+    uint32_t byterate;                  /* byte rate */
+    uint16_t blockalign;                /* block align */
+    uint16_t bitspersample;             /* bits per sample */
+    uint16_t validbitspersample;        /* valid bits per sample */
+    uint32_t channelmask;               /* speaker position mask, 0 if not given */
+    uint16_t samplesperblock;           /* frames per block of compressed formats, 0 if not given */
+    uint32_t dataoffset;                /* offset of the audio data from the start of the file */
+    uint32_t datasize;                  /* audio data size */
+} wave_file_struct;
+
+/* error identification enum */
+typedef enum {
+    VALID_WAVE_FILE = 0,                /* valid wave file */
+    UNVALID_RIFF_ID,                    /* unvalid riff id */
+    UNVALID_WAVE_FORMAT,                /* unvalid wave format */
+    UNVALID_FORMATCHUNK_ID,             /* unvalid format chunk id */
+    UNSUPPORETD_FORMATTAG,              /* unsupporetd format tag */
+    UNSUPPORETD_NUMBER_OF_CHANNEL,      /* unsupporetd number of channel */
+    UNSUPPORETD_SAMPLE_RATE,            /* unsupporetd sample rate */
+    UNSUPPORETD_BITS_PER_SAMPLE,        /* unsupporetd bits per sample */
+    UNVALID_DATACHUNK_ID,               /* unvalid data chunk id */
+    UNSUPPORETD_EXTRAFORMATBYTES,       /* unsupporetd extra format bytes */
+    UNVALID_FACTCHUNK_ID                /* unvalid fact chunk id */
+} errorcode_enum;
+
+/* function declarations */
+/* walk the chunks of a wave file and describe its format and audio data */
+errorcode_enum wave_parse(const wave_reader_struct *reader, wave_file_struct *wave);
+/* read callback for a wave file located in memory, context is the file start address */
+uint32_t wave_memory_read(void *context, uint32_t offset, uint8_t *buffer, uint32_t length);
+
+#endif /* WAVE_PARSER_H */
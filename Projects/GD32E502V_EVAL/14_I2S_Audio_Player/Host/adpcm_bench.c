@@ -0,0 +1,321 @@
+/*!
+    \file    adpcm_bench.c
+    \brief   host test and benchmark of the IMA-ADPCM decoder
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "adpcm.h"
+#include "host_periph.h"
+#include "host_wave.h"
+
+#define TEST_FILE_SIZE          0x40000U            /* largest generated file */
+#define TEST_HEADER_SIZE        48U                 /* RIFF, fmt and data chunk headers of an ADPCM file */
+#define TEST_BLOCKS             64U                 /* blocks of each generated file */
+#define TEST_BENCH_PASSES       50U                 /* passes over the file of the benchmark */
+#define TEST_INDEX_MAX          88
+
+/* step index adjustment for each 4-bit code */
+static const int8_t reference_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/* quantizer step size for each step index */
+static const int16_t reference_step_table[TEST_INDEX_MAX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/* format of a generated file */
+typedef struct {
+    const char *name;                   /* name printed with the results */
+    uint16_t channels;                  /* 1 or 2 */
+    uint32_t samplerate;                /* sample rate in Hz */
+    uint16_t blockalign;                /* bytes of a compressed block */
+    double snr_min;                     /* lowest accepted SNR against the test signal in dB */
+} test_format_struct;
+
+static const test_format_struct test_format[] = {
+    {"stereo 22050 Hz, 1024 byte blocks", 2U, 22050U, 1024U, 25.0},
+    {"stereo 44100 Hz, 512 byte blocks", 2U, 44100U, 512U, 30.0},
+    {"mono 11025 Hz, 256 byte blocks", 1U, 11025U, 256U, 23.0},
+    {"mono 48000 Hz, 1024 byte blocks", 1U, 48000U, 1024U, 26.0}
+};
+
+/* chunk sizes asked from adpcm_decode(), a block ends in the middle of most of them */
+static const uint32_t test_chunk[] = {1U, 7U, 8U, 64U, 255U, 2048U};
+
+static uint8_t file[TEST_FILE_SIZE];
+static adpcm_decoder_struct decoder;
+static int16_t reference[TEST_BLOCKS * ADPCM_BLOCK_ALIGN_MAX * 2U * ADPCM_CHANNELS_MAX];
+static int16_t output[TEST_BLOCKS * ADPCM_BLOCK_ALIGN_MAX * 2U * ADPCM_CHANNELS_MAX];
+
+static uint32_t reference_decode(const test_format_struct *format, const uint8_t *data, int16_t *samples);
+static uint32_t chunk_decode(const test_format_struct *format, const uint8_t *data, int16_t *samples, uint32_t chunk);
+static uint32_t format_check(const test_format_struct *format);
+static uint32_t blockalign_check(void);
+static void decode_benchmark(const test_format_struct *format);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+int main(void)
+{
+    uint32_t failed = 0U;
+    uint32_t index;
+
+    for(index = 0U; index < (sizeof(test_format) / sizeof(test_format[0])); index++) {
+        failed += format_check(&test_format[index]);
+    }
+    failed += blockalign_check();
+    printf("  %-36s %14s %12s\n", "format", "cycles/sample", "ns/sample");
+    for(index = 0U; index < (sizeof(test_format) / sizeof(test_format[0])); index++) {
+        decode_benchmark(&test_format[index]);
+    }
+    return (int)failed;
+}
+
+/*!
+    \brief      decode a file sample by sample, straight from the IMA-ADPCM specification
+    \param[in]  format: format of the file
+    \param[in]  data: first byte of the audio data
+    \param[out] samples: the interleaved decoded samples
+    \retval     number of frames decoded
+*/
+static uint32_t reference_decode(const test_format_struct *format, const uint8_t *data, int16_t *samples)
+{
+    uint32_t samplesperblock = adpcm_samples_per_block(format->blockalign, format->channels);
+    const uint8_t *block;
+    uint32_t position;
+    uint32_t channel;
+    uint32_t sample;
+    uint32_t frame = 0U;
+    uint32_t index;
+    uint32_t nibble;
+    int32_t predictor;
+    int32_t step_index;
+    int32_t step;
+    int32_t diff;
+
+    for(index = 0U; index < TEST_BLOCKS; index++) {
+        block = &data[index * format->blockalign];
+        for(channel = 0U; channel < format->channels; channel++) {
+            predictor = (int16_t)((uint16_t)block[4U * channel] | ((uint16_t)block[4U * channel + 1U] << 8));
+            step_index = (block[4U * channel + 2U] > TEST_INDEX_MAX) ? TEST_INDEX_MAX : block[4U * channel + 2U];
+            samples[(frame * format->channels) + channel] = (int16_t)predictor;
+            for(sample = 1U; sample < samplesperblock; sample++) {
+                /* 8 codes, 4 bytes, of each channel in turn, low nibble first */
+                position = 4U * format->channels + ((sample - 1U) / 8U) * 4U * format->channels
+                           + 4U * channel + ((sample - 1U) % 8U) / 2U;
+                nibble = (0U == ((sample - 1U) % 2U)) ? (block[position] & 0x0FU) : (block[position] >> 4);
+                step = reference_step_table[step_index];
+                /* the shifts of the specification drop the low bits of each term */
+                diff = (step >> 3) + ((nibble & 4U) ? step : 0) + ((nibble & 2U) ? (step >> 1) : 0)
+                       + ((nibble & 1U) ? (step >> 2) : 0);
+                predictor += (0U != (nibble & 8U)) ? -diff : diff;
+                predictor = (predictor > 32767) ? 32767 : ((predictor < -32768) ? -32768 : predictor);
+                step_index += reference_index_table[nibble];
+                step_index = (step_index < 0) ? 0 : ((step_index > TEST_INDEX_MAX) ? TEST_INDEX_MAX : step_index);
+                samples[((frame + sample) * format->channels) + channel] = (int16_t)predictor;
+            }
+        }
+        frame += samplesperblock;
+    }
+    return frame;
+}
+
+/*!
+    \brief      decode a file with adpcm_decode() asking for the same number of frames each time
+    \param[in]  format: format of the file
+    \param[in]  data: first byte of the audio data
+    \param[in]  chunk: frames asked from each call
+    \param[out] samples: the interleaved decoded samples
+    \retval     number of frames decoded
+*/
+static uint32_t chunk_decode(const test_format_struct *format, const uint8_t *data, int16_t *samples, uint32_t chunk)
+{
+    uint32_t frame = 0U;
+    uint32_t block = 0U;
+    uint32_t decoded;
+
+    adpcm_decoder_init(&decoder, format->channels, format->blockalign);
+    while(block <= TEST_BLOCKS) {
+        decoded = adpcm_decode(&decoder, &samples[frame * format->channels], chunk);
+        frame += decoded;
+        if(decoded < chunk) {
+            /* the block ended, the refill path loads the next one */
+            if(TEST_BLOCKS == block) {
+                break;
+            }
+            memcpy(decoder.block, &data[block * format->blockalign], format->blockalign);
+            adpcm_block_start(&decoder);
+            block++;
+        }
+    }
+    return frame;
+}
+
+/*!
+    \brief      decode a generated file, compare it with the reference decoder and with the
+                test signal it was encoded from
+    \param[in]  format: format of the file
+    \param[out] none
+    \retval     1 if a check failed, 0 otherwise
+*/
+static uint32_t format_check(const test_format_struct *format)
+{
+    uint32_t frames;
+    uint32_t decoded;
+    uint32_t index;
+    uint32_t sample;
+    uint32_t failed = 0U;
+    double signal = 0.0;
+    double noise = 0.0;
+    double value;
+    double snr;
+
+    if(0U == host_wave_adpcm(file, sizeof(file), format->channels, format->samplerate, format->blockalign, TEST_BLOCKS)) {
+        printf("FAIL %s: file too large\n", format->name);
+        return 1U;
+    }
+    frames = reference_decode(format, &file[TEST_HEADER_SIZE], reference);
+
+    /* bit exact with the reference whatever the number of frames asked at a time */
+    for(index = 0U; index < (sizeof(test_chunk) / sizeof(test_chunk[0])); index++) {
+        memset(output, 0, sizeof(output));
+        decoded = chunk_decode(format, &file[TEST_HEADER_SIZE], output, test_chunk[index]);
+        if(decoded != frames) {
+            printf("FAIL %s: %u frames decoded by chunks of %u instead of %u\n", format->name,
+                   (unsigned)decoded, (unsigned)test_chunk[index], (unsigned)frames);
+            failed = 1U;
+            continue;
+        }
+        for(sample = 0U; sample < (frames * format->channels); sample++) {
+            if(output[sample] != reference[sample]) {
+                printf("FAIL %s: sample %u decoded by chunks of %u is %d instead of %d\n", format->name,
+                       (unsigned)sample, (unsigned)test_chunk[index], output[sample], reference[sample]);
+                failed = 1U;
+                break;
+            }
+        }
+    }
+
+    /* the coding noise against the floating point signal the file was made from */
+    for(sample = 0U; sample < (frames * format->channels); sample++) {
+        value = host_signal(sample / format->channels, sample % format->channels, format->samplerate) * 32767.0;
+        signal += value * value;
+        noise += (output[sample] - value) * (output[sample] - value);
+    }
+    snr = 10.0 * log10(signal / noise);
+    if(snr < format->snr_min) {
+        printf("FAIL %s: SNR %.1f dB below %.1f dB\n", format->name, snr, format->snr_min);
+        failed = 1U;
+    }
+    if(0U == failed) {
+        printf("ok   %s: bit exact, SNR %.1f dB\n", format->name, snr);
+    }
+    return failed;
+}
+
+/*!
+    \brief      check that only blocks made of the headers and whole groups of codes are accepted
+    \param[in]  none
+    \param[out] none
+    \retval     1 if a check failed, 0 otherwise
+*/
+static uint32_t blockalign_check(void)
+{
+    /* channels, blockalign and the frames expected, 0 for a block to reject */
+    static const uint16_t cases[][3] = {
+        {1U, 3U, 0U}, {1U, 4U, 1U}, {1U, 6U, 0U}, {1U, 8U, 9U}, {1U, 256U, 505U},
+        {2U, 4U, 0U}, {2U, 8U, 1U}, {2U, 12U, 0U}, {2U, 13U, 0U}, {2U, 16U, 9U}, {2U, 1024U, 1017U}
+    };
+    uint32_t index;
+    uint32_t failed = 0U;
+    uint16_t frames;
+
+    for(index = 0U; index < (sizeof(cases) / sizeof(cases[0])); index++) {
+        frames = adpcm_samples_per_block(cases[index][1], cases[index][0]);
+        if(frames != cases[index][2]) {
+            printf("FAIL block of %u bytes, %u channels: %u frames instead of %u\n", (unsigned)cases[index][1],
+                   (unsigned)cases[index][0], (unsigned)frames, (unsigned)cases[index][2]);
+            failed = 1U;
+        }
+    }
+    if(0U == failed) {
+        printf("ok   block sizes: the headers and whole groups of codes only\n");
+    }
+    return failed;
+}
+
+/*!
+    \brief      measure the decoding cost per sample of a format, one whole block per call
+                like the refill path
+    \param[in]  format: format of the file
+    \param[out] none
+    \retval     none
+*/
+static void decode_benchmark(const test_format_struct *format)
+{
+    uint64_t start;
+    uint64_t cycles = 0U;
+    uint32_t samples = 0U;
+    uint32_t pass;
+    uint32_t block;
+
+    host_wave_adpcm(file, sizeof(file), format->channels, format->samplerate, format->blockalign, TEST_BLOCKS);
+    adpcm_decoder_init(&decoder, format->channels, format->blockalign);
+    for(pass = 0U; pass < TEST_BENCH_PASSES; pass++) {
+        for(block = 0U; block < TEST_BLOCKS; block++) {
+            memcpy(decoder.block, &file[TEST_HEADER_SIZE + block * format->blockalign], format->blockalign);
+            adpcm_block_start(&decoder);
+            start = host_cycles();
+            samples += adpcm_decode(&decoder, output, decoder.samplesperblock) * format->channels;
+            cycles += host_cycles() - start;
+        }
+    }
+    printf("  %-36s %14.2f %12.3f\n", format->name, (double)cycles / samples,
+           (double)cycles / samples / host_cycles_per_ns());
+}
@@ -0,0 +1,516 @@
+/*!
+    \file    audio_host.c
+    \brief   host harness of the audio pipeline, plays test files through a fake I2S sink and DMA model, checks the output against golden files and reports the cost of each stage
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "i2s_codec.h"
+#include "host_periph.h"
+#include "host_wave.h"
+
+#define HOST_GOLDEN_STEP        16U                 /* blocks between two CRC lines of a golden file */
+#define HOST_LINES_MAX          64U                 /* lines of a golden file */
+#define HOST_LINE_SIZE          96U
+#define HOST_FILE_SIZE          (600U * 1024U)      /* largest generated wave file */
+#define HOST_CLIP_FRAMES        3000U               /* frames of the clip played on the voices */
+
+/* test scenario structure */
+typedef struct {
+    const char *name;                   /* name of the scenario and of its golden file */
+    errorcode_enum (*start)(void);      /* configure the pipeline and start playing */
+    void (*event)(uint32_t block);      /* change the pipeline while it plays, NULL if nothing changes */
+    uint32_t blocks;                    /* blocks played and checked */
+} host_scenario_struct;
+
+/* output of the fake I2S */
+typedef struct {
+    uint16_t block[AUDIO_BLOCK_SIZE];   /* half words of the block being played */
+    uint32_t count;                     /* half words received in the block */
+    uint32_t blocks;                    /* blocks played */
+    uint32_t crc;                       /* CRC of the blocks played, as the CRC unit computes it */
+    FILE *dump;                         /* raw output file, NULL if not written */
+} host_output_struct;
+
+static const char *stage_name[AUDIO_STAGE_NUM] = {
+    "source", "decode", "convert", "resample", "mix", "synth", "eq", "volume", "meter"
+};
+
+static uint8_t wave_file[HOST_FILE_SIZE];
+static wave_file_struct wave;
+static host_memory_source_struct memory_source;
+static int16_t clip[HOST_CLIP_FRAMES];
+static host_output_struct output;
+static char lines[HOST_LINES_MAX][HOST_LINE_SIZE];
+static uint32_t line_count = 0U;
+
+static void dma_channel0_irq(void);
+static void output_sink(void *context, uint32_t data);
+static uint32_t output_crc(uint32_t crc, const uint16_t *data, uint32_t halfwords);
+static void line_add(const char *format, uint32_t value0, uint32_t value1);
+static int golden_check(const char *path, const host_scenario_struct *scenario);
+static int golden_write(const char *path);
+static void stage_report(void);
+static errorcode_enum file_play(uint32_t size);
+static errorcode_enum wavetestdata_start(void);
+static errorcode_enum pipeline_start(void);
+static void pipeline_event(uint32_t block);
+static errorcode_enum adpcm_start(void);
+static errorcode_enum pcm8_start(void);
+static errorcode_enum pcm24_hires_start(void);
+static void pcm24_hires_event(uint32_t block);
+static errorcode_enum pcm32_start(void);
+
+static const host_scenario_struct scenario_list[] = {
+    {"wavetestdata", wavetestdata_start, NULL, 128U},
+    {"pipeline", pipeline_start, pipeline_event, 256U},
+    {"adpcm_stereo_22k", adpcm_start, NULL, 256U},
+    {"pcm8_mono_11k", pcm8_start, NULL, 128U},
+    {"pcm24_hires_48k", pcm24_hires_start, pcm24_hires_event, 256U},
+    {"pcm32_stereo_44k", pcm32_start, NULL, 256U},
+};
+
+/*!
+    \brief      main function, play one scenario and compare its output with the golden file
+    \param[in]  argc: number of arguments
+    \param[in]  argv: golden directory, scenario name, then --update to rewrite the golden
+                file or --dump <file> to write the raw output
+    \param[out] none
+    \retval     0 if the output matches the golden file
+*/
+int main(int argc, char *argv[])
+{
+    const host_scenario_struct *scenario = NULL;
+    audio_checksum_struct checksum;
+    audio_stats_struct stats;
+    meter_snapshot_struct levels;
+    char path[512];
+    uint32_t index;
+    int update = 0;
+
+    if(argc >= 3) {
+        for(index = 0U; index < (sizeof(scenario_list) / sizeof(scenario_list[0])); index++) {
+            if(0 == strcmp(argv[2], scenario_list[index].name)) {
+                scenario = &scenario_list[index];
+            }
+        }
+    }
+    if(NULL == scenario) {
+        printf("usage: %s <golden directory> <scenario> [--update | --dump <file>]\nscenarios:", argv[0]);
+        for(index = 0U; index < (sizeof(scenario_list) / sizeof(scenario_list[0])); index++) {
+            printf(" %s", scenario_list[index].name);
+        }
+        printf("\n");
+        return 2;
+    }
+    if((argc >= 4) && (0 == strcmp(argv[3], "--update"))) {
+        update = 1;
+    } else if((argc >= 5) && (0 == strcmp(argv[3], "--dump"))) {
+        output.dump = fopen(argv[4], "wb");
+    }
+    snprintf(path, sizeof(path), "%s/%s.txt", argv[1], scenario->name);
+
+    /* the fake I2S collects what the DMA sends, the DMA interrupt runs the callbacks */
+    host_cycles_per_ns();
+    host_irq_handler_set(AUDIO_DMA_IRQn, dma_channel0_irq);
+    host_i2s_sink_set(output_sink, &output);
+    output.crc = 0xFFFFFFFFU;
+    i2s_audio_checksum_start(scenario->blocks);
+    i2s_audio_stats_clear();
+    if(VALID_WAVE_FILE != scenario->start()) {
+        printf("%s: the test file is rejected\n", scenario->name);
+        return 1;
+    }
+
+    /* the main loop refills each block as soon as the DMA has played it */
+    while(output.blocks < scenario->blocks) {
+        if(AUDIO_BLOCK_SIZE != host_dma_run(AUDIO_DMA, AUDIO_DMA_CHANNEL, AUDIO_BLOCK_SIZE)) {
+            printf("%s: the DMA stopped\n", scenario->name);
+            return 1;
+        }
+        if(NULL != scenario->event) {
+            scenario->event(output.blocks);
+        }
+        i2s_audio_process();
+    }
+    i2s_audio_stop();
+    if(NULL != output.dump) {
+        fclose(output.dump);
+    }
+
+    /* the CRC computed by the pipeline covers the blocks in the order they were refilled */
+    i2s_audio_checksum_get(&checksum);
+    if((checksum.blocks != scenario->blocks) || (checksum.crc != output.crc)) {
+        printf("%s: pipeline CRC %08x over %u blocks, I2S output CRC %08x\n", scenario->name,
+               (unsigned)checksum.crc, (unsigned)checksum.blocks, (unsigned)output.crc);
+        return 1;
+    }
+    i2s_audio_stats_get(&stats);
+    line_add("underrun %u source_underrun %u", stats.underrun, stats.source_underrun);
+    i2s_audio_meter_get(&levels);
+    line_add("peak_hold %u %u", levels.peak_hold[0], levels.peak_hold[1]);
+    line_add("clips %u %u", levels.clips[0], levels.clips[1]);
+
+    printf("%s: %u blocks at %u Hz\n", scenario->name, (unsigned)scenario->blocks, (unsigned)i2s_audio_output_rate_get());
+    stage_report();
+    if(0 != update) {
+        return golden_write(path);
+    }
+    return golden_check(path, scenario);
+}
+
+/*!
+    \brief      DMA channel 0 interrupt handler, as in gd32e502_it.c
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void dma_channel0_irq(void)
+{
+    if(SET == dma_interrupt_flag_get(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_HTF)) {
+        dma_interrupt_flag_clear(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_HTF);
+        i2s_audio_half_transfer_callback();
+    }
+    if(SET == dma_interrupt_flag_get(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_FTF)) {
+        dma_interrupt_flag_clear(AUDIO_DMA, AUDIO_DMA_CHANNEL, DMA_INT_FLAG_FTF);
+        i2s_audio_full_transfer_callback();
+    }
+}
+
+/*!
+    \brief      sink of the fake I2S, add each played block to the output CRC
+    \param[in]  context: pointer to the host_output_struct
+    \param[in]  data: half word shifted out
+    \param[out] none
+    \retval     none
+*/
+static void output_sink(void *context, uint32_t data)
+{
+    host_output_struct *out = (host_output_struct *)context;
+
+    out->block[out->count++] = (uint16_t)data;
+    if(AUDIO_BLOCK_SIZE != out->count) {
+        return;
+    }
+    out->count = 0U;
+    out->crc = output_crc(out->crc, out->block, AUDIO_BLOCK_SIZE);
+    out->blocks++;
+    if(NULL != out->dump) {
+        fwrite(out->block, sizeof(uint16_t), AUDIO_BLOCK_SIZE, out->dump);
+    }
+    if(0U == (out->blocks % HOST_GOLDEN_STEP)) {
+        line_add("block %u crc %08x", out->blocks, out->crc);
+    }
+}
+
+/*!
+    \brief      add half words to a CRC, two half words form a little endian word as in memory
+    \param[in]  crc: CRC of the previous data
+    \param[in]  data: pointer to the half words
+    \param[in]  halfwords: number of half words, even
+    \param[out] none
+    \retval     the CRC, polynomial 0x04C11DB7 MSB first
+*/
+static uint32_t output_crc(uint32_t crc, const uint16_t *data, uint32_t halfwords)
+{
+    uint32_t index;
+    uint32_t bit;
+
+    for(index = 0U; index < halfwords; index += 2U) {
+        crc ^= (uint32_t)data[index] | ((uint32_t)data[index + 1U] << 16);
+        for(bit = 0U; bit < 32U; bit++) {
+            crc = (0U != (crc & 0x80000000U)) ? ((crc << 1) ^ 0x04C11DB7U) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*!
+    \brief      add a line to the result of the scenario
+    \param[in]  format: printf format taking two unsigned values
+    \param[in]  value0: first value
+    \param[in]  value1: second value
+    \param[out] none
+    \retval     none
+*/
+static void line_add(const char *format, uint32_t value0, uint32_t value1)
+{
+    if(line_count < HOST_LINES_MAX) {
+        snprintf(lines[line_count], HOST_LINE_SIZE, format, (unsigned)value0, (unsigned)value1);
+        line_count++;
+    }
+}
+
+/*!
+    \brief      compare the result of the scenario with its golden file
+    \param[in]  path: path of the golden file
+    \param[in]  scenario: the scenario
+    \param[out] none
+    \retval     0 if they are identical, 1 otherwise
+*/
+static int golden_check(const char *path, const host_scenario_struct *scenario)
+{
+    char golden[HOST_LINE_SIZE];
+    FILE *file = fopen(path, "r");
+    uint32_t line = 0U;
+    int result = 0;
+
+    if(NULL == file) {
+        printf("%s: no golden file %s, run with --update to create it\n", scenario->name, path);
+        return 1;
+    }
+    while((0 == result) && (NULL != fgets(golden, sizeof(golden), file))) {
+        golden[strcspn(golden, "\r\n")] = '\0';
+        if((line >= line_count) || (0 != strcmp(golden, lines[line]))) {
+            printf("%s:%u: expected \"%s\", got \"%s\"\n", path, (unsigned)(line + 1U), golden,
+                   (line < line_count) ? lines[line] : "end of output");
+            result = 1;
+        }
+        line++;
+    }
+    fclose(file);
+    if((0 == result) && (line != line_count)) {
+        printf("%s:%u: expected the end of the file, got \"%s\"\n", path, (unsigned)(line + 1U), lines[line]);
+        result = 1;
+    }
+    printf("%s: output %s the golden file\n", scenario->name, (0 == result) ? "matches" : "differs from");
+    return result;
+}
+
+/*!
+    \brief      write the result of the scenario as its golden file
+    \param[in]  path: path of the golden file
+    \param[out] none
+    \retval     0 on success
+*/
+static int golden_write(const char *path)
+{
+    FILE *file = fopen(path, "w");
+    uint32_t line;
+
+    if(NULL == file) {
+        printf("cannot write %s\n", path);
+        return 1;
+    }
+    for(line = 0U; line < line_count; line++) {
+        fprintf(file, "%s\n", lines[line]);
+    }
+    fclose(file);
+    printf("golden file %s written\n", path);
+    return 0;
+}
+
+/*!
+    \brief      print the cost of each stage per frame, in host cycles and nanoseconds
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void stage_report(void)
+{
+    audio_stage_stats_struct stats;
+    double cycles;
+    uint32_t stage;
+
+    printf("  %-9s %10s %14s %10s\n", "stage", "frames", "cycles/frame", "ns/frame");
+    for(stage = 0U; stage < AUDIO_STAGE_NUM; stage++) {
+        i2s_audio_stage_stats_get((audio_stage_enum)stage, &stats);
+        if(0U != stats.frames) {
+            cycles = (double)stats.cycles / (double)stats.frames;
+            printf("  %-9s %10u %14.1f %10.2f\n", stage_name[stage], (unsigned)stats.frames, cycles,
+                   cycles / host_cycles_per_ns());
+        }
+    }
+}
+
+/*!
+    \brief      play the wave file built in wave_file from a memory source
+    \param[in]  size: size of the file, 0 if it could not be built
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum file_play(uint32_t size)
+{
+    wave_reader_struct reader;
+    audio_source_struct source;
+    errorcode_enum errorcode = UNVALID_RIFF_ID;
+
+    reader.read = wave_memory_read;
+    reader.context = wave_file;
+    reader.size = size;
+    errorcode = wave_parse(&reader, &wave);
+    if(VALID_WAVE_FILE == errorcode) {
+        memory_source.data = &wave_file[wave.dataoffset];
+        memory_source.size = wave.datasize;
+        memory_source.position = 0U;
+        source.read = host_memory_read;
+        source.context = &memory_source;
+        errorcode = i2s_audio_play_source(&wave, &source);
+    }
+    return errorcode;
+}
+
+/*!
+    \brief      play wave_data.h at the closest I2S sample rate, as the demo does
+    \param[in]  none
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum wavetestdata_start(void)
+{
+    return i2s_audio_play();
+}
+
+/*!
+    \brief      play wave_data.h through every 16-bit stage: resampler, equalizer, voices,
+                synthesizer, volume and meter
+    \param[in]  none
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum pipeline_start(void)
+{
+    uint32_t frame;
+
+    /* a decaying chirp for the voices */
+    for(frame = 0U; frame < HOST_CLIP_FRAMES; frame++) {
+        clip[frame] = (int16_t)lrint(20000.0 * exp(-3.0 * frame / HOST_CLIP_FRAMES)
+                                     * sin(0.02 * frame + 0.00002 * frame * frame));
+    }
+    i2s_audio_resampler_enable();
+    i2s_audio_eq_config(0U, EQ_BAND_LOWSHELF, 200.0f, 6.0f, 0.707f);
+    i2s_audio_eq_config(1U, EQ_BAND_PEAKING, 1000.0f, -4.0f, 1.4f);
+    i2s_audio_eq_config(2U, EQ_BAND_HIGHSHELF, 3000.0f, 3.0f, 0.707f);
+    return i2s_audio_play();
+}
+
+/*!
+    \brief      start and stop voices and notes, and ramp the volume while the pipeline plays
+    \param[in]  block: blocks played so far
+    \param[out] none
+    \retval     none
+*/
+static void pipeline_event(uint32_t block)
+{
+    static const synth_envelope_struct envelope = {10U, 50U, 20000, 100U};
+    static uint8_t voice[2];
+    static uint8_t note;
+
+    switch(block) {
+    case 8U:
+        voice[0] = i2s_audio_voice_start(clip, HOST_CLIP_FRAMES, MIXER_GAIN_UNITY / 2, 1U);
+        break;
+    case 24U:
+        voice[1] = i2s_audio_voice_start(clip, HOST_CLIP_FRAMES, MIXER_GAIN_UNITY, 0U);
+        i2s_audio_voice_gain_set(voice[1], MIXER_GAIN_UNITY / 4, MIXER_GAIN_UNITY);
+        break;
+    case 40U:
+        note = i2s_audio_note_on(synth_table_sine, synth_note_frequency(69U), SYNTH_GAIN_UNITY / 4, &envelope);
+        break;
+    case 100U:
+        i2s_audio_note_off(note);
+        i2s_audio_volume_set(VOLUME_UNITY / 4U);
+        break;
+    case 160U:
+        i2s_audio_voice_stop(voice[0]);
+        i2s_audio_volume_set(VOLUME_UNITY);
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+    \brief      decode a 22.05 kHz stereo IMA-ADPCM file and resample it
+    \param[in]  none
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum adpcm_start(void)
+{
+    i2s_audio_resampler_enable();
+    return file_play(host_wave_adpcm(wave_file, sizeof(wave_file), 2U, 22050U, 1024U, 100U));
+}
+
+/*!
+    \brief      convert an 11.025 kHz 8-bit mono file and resample it
+    \param[in]  none
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum pcm8_start(void)
+{
+    i2s_audio_resampler_enable();
+    return file_play(host_wave_pcm(wave_file, sizeof(wave_file), 8U, 1U, 11025U, 22050U));
+}
+
+/*!
+    \brief      play a 48 kHz 24-bit stereo file with 24-bit I2S frames
+    \param[in]  none
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum pcm24_hires_start(void)
+{
+    i2s_audio_hires_enable();
+    return file_play(host_wave_pcm(wave_file, sizeof(wave_file), 24U, 2U, 48000U, 48000U));
+}
+
+/*!
+    \brief      ramp the volume of the 32-bit samples down and up again
+    \param[in]  block: blocks played so far
+    \param[out] none
+    \retval     none
+*/
+static void pcm24_hires_event(uint32_t block)
+{
+    if(64U == block) {
+        i2s_audio_volume_set(VOLUME_UNITY / 8U);
+    } else if(128U == block) {
+        i2s_audio_volume_set(VOLUME_UNITY);
+    }
+}
+
+/*!
+    \brief      convert a 44.1 kHz 32-bit stereo file to 16-bit samples and resample it
+    \param[in]  none
+    \param[out] none
+    \retval     errorcode_enum
+*/
+static errorcode_enum pcm32_start(void)
+{
+    i2s_audio_resampler_enable();
+    return file_play(host_wave_pcm(wave_file, sizeof(wave_file), 32U, 2U, 44100U, 44100U));
+}
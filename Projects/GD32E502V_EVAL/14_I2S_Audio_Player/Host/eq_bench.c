@@ -0,0 +1,443 @@
+/*!
+    \file    eq_bench.c
+    \brief   host test and benchmark of the equalizer and of the volume
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "equalizer.h"
+#include "volume.h"
+#include "host_periph.h"
+#include "host_wave.h"
+
+#define TEST_PI                 3.14159265358979323846
+#define TEST_FRAMES             256U                /* frames of a block */
+#define TEST_BLOCKS             400U                /* blocks of each check */
+#define TEST_BENCH_BLOCKS       4000U               /* blocks processed by the benchmark */
+#define TEST_SAMPLERATE         48000U              /* sample rate of the checks */
+
+/* settings of the bands of an equalizer check */
+typedef struct {
+    eq_band_enum type;                  /* type of the band */
+    float frequency;                    /* centre or corner frequency in Hz */
+    float gain;                         /* gain in dB */
+    float q;                            /* quality factor */
+} test_band_struct;
+
+/* equalizer check */
+typedef struct {
+    const char *name;                   /* name printed with the results */
+    uint32_t bands;                     /* bands used */
+    test_band_struct band[EQ_BANDS];    /* settings of the bands */
+    double level;                       /* level of the test signal, 1.0 for full scale */
+    uint32_t error_max;                 /* largest accepted error against the fixed point coefficients */
+    double snr_min;                     /* lowest accepted SNR against the floating point design in dB */
+} test_eq_struct;
+
+static const test_eq_struct test_eq[] = {
+    {"4 bands", 4U, {{EQ_BAND_LOWSHELF, 100.0f, 6.0f, 0.707f}, {EQ_BAND_PEAKING, 1000.0f, -6.0f, 1.0f},
+                     {EQ_BAND_PEAKING, 3000.0f, 4.0f, 2.0f}, {EQ_BAND_HIGHSHELF, 10000.0f, -3.0f, 0.707f}},
+     0.25, 10U, 60.0},
+    {"low shelf 40 Hz +9 dB", 1U, {{EQ_BAND_LOWSHELF, 40.0f, 9.0f, 0.707f}}, 0.25, 16U, 50.0},
+    {"peaking 8 kHz -12 dB Q 4", 1U, {{EQ_BAND_PEAKING, 8000.0f, -12.0f, 4.0f}}, 1.0, 2U, 60.0}
+};
+
+/* biquad computed in double, direct form I */
+typedef struct {
+    double b[3];                        /* b0, b1 and b2 */
+    double a[2];                        /* a1 and a2 */
+    double x[2][2];                     /* x[n-1] and x[n-2] of each channel */
+    double y[2][2];                     /* y[n-1] and y[n-2] of each channel */
+} test_biquad_struct;
+
+static eq_struct eq;
+static volume_struct volume;
+static int16_t block[TEST_FRAMES * 2U];
+static int32_t block32[TEST_FRAMES * 2U];
+static test_biquad_struct quantized[EQ_BANDS];
+static test_biquad_struct designed[EQ_BANDS];
+static double reference_quantized[TEST_FRAMES * 2U];
+static double reference_designed[TEST_FRAMES * 2U];
+
+static void biquad_quantized(test_biquad_struct *biquad, const eq_band_struct *band);
+static void biquad_designed(test_biquad_struct *biquad, const eq_band_struct *band, uint32_t samplerate);
+static double biquad_filter(test_biquad_struct *biquad, uint32_t channel, double in);
+static uint32_t eq_check(const test_eq_struct *check);
+static uint32_t volume_check(const char *name, uint32_t bits);
+static void eq_benchmark(void);
+static void volume_benchmark(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+int main(void)
+{
+    uint32_t failed = 0U;
+    uint32_t index;
+
+    for(index = 0U; index < (sizeof(test_eq) / sizeof(test_eq[0])); index++) {
+        failed += eq_check(&test_eq[index]);
+    }
+    failed += volume_check("volume ramps, 16-bit frames", 16U);
+    failed += volume_check("volume ramps, 32-bit frames", 32U);
+    eq_benchmark();
+    volume_benchmark();
+    return (int)failed;
+}
+
+/*!
+    \brief      set a double biquad to the fixed point coefficients of a band
+    \param[in]  band: the band of the equalizer
+    \param[out] biquad: the biquad, its state is cleared
+    \retval     none
+*/
+static void biquad_quantized(test_biquad_struct *biquad, const eq_band_struct *band)
+{
+    double scale = (double)(1UL << (31U - band->shift));
+
+    memset(biquad, 0, sizeof(test_biquad_struct));
+    biquad->b[0] = band->b[0] / scale;
+    biquad->b[1] = band->b[1] / scale;
+    biquad->b[2] = band->b[2] / scale;
+    /* the band stores -a1 and -a2 */
+    biquad->a[0] = -band->a[0] / scale;
+    biquad->a[1] = -band->a[1] / scale;
+}
+
+/*!
+    \brief      set a double biquad to the coefficients of the audio EQ cookbook computed in double
+    \param[in]  band: the band of the equalizer, only its settings are used
+    \param[in]  samplerate: sample rate in Hz
+    \param[out] biquad: the biquad, its state is cleared
+    \retval     none
+*/
+static void biquad_designed(test_biquad_struct *biquad, const eq_band_struct *band, uint32_t samplerate)
+{
+    double a = pow(10.0, band->gain / 40.0);
+    double w0 = 2.0 * TEST_PI * band->frequency / samplerate;
+    double cosw0 = cos(w0);
+    double alpha = sin(w0) / (2.0 * band->q);
+    double root = 2.0 * sqrt(a) * alpha;
+    double a0 = 1.0;
+    double a1 = 0.0;
+    double a2 = 0.0;
+
+    memset(biquad, 0, sizeof(test_biquad_struct));
+    switch(band->type) {
+    case EQ_BAND_LOWSHELF:
+        a0 = (a + 1.0) + (a - 1.0) * cosw0 + root;
+        biquad->b[0] = a * ((a + 1.0) - (a - 1.0) * cosw0 + root);
+        biquad->b[1] = 2.0 * a * ((a - 1.0) - (a + 1.0) * cosw0);
+        biquad->b[2] = a * ((a + 1.0) - (a - 1.0) * cosw0 - root);
+        a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cosw0);
+        a2 = (a + 1.0) + (a - 1.0) * cosw0 - root;
+        break;
+    case EQ_BAND_PEAKING:
+        a0 = 1.0 + alpha / a;
+        biquad->b[0] = 1.0 + alpha * a;
+        biquad->b[1] = -2.0 * cosw0;
+        biquad->b[2] = 1.0 - alpha * a;
+        a1 = -2.0 * cosw0;
+        a2 = 1.0 - alpha / a;
+        break;
+    case EQ_BAND_HIGHSHELF:
+        a0 = (a + 1.0) - (a - 1.0) * cosw0 + root;
+        biquad->b[0] = a * ((a + 1.0) + (a - 1.0) * cosw0 + root);
+        biquad->b[1] = -2.0 * a * ((a - 1.0) + (a + 1.0) * cosw0);
+        biquad->b[2] = a * ((a + 1.0) + (a - 1.0) * cosw0 - root);
+        a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cosw0);
+        a2 = (a + 1.0) - (a - 1.0) * cosw0 - root;
+        break;
+    default:
+        /* a bypassed band */
+        biquad->b[0] = 1.0;
+        break;
+    }
+    biquad->b[0] /= a0;
+    biquad->b[1] /= a0;
+    biquad->b[2] /= a0;
+    biquad->a[0] = a1 / a0;
+    biquad->a[1] = a2 / a0;
+}
+
+/*!
+    \brief      filter one sample with a double biquad
+    \param[in]  biquad: the biquad
+    \param[in]  channel: 0 for left, 1 for right
+    \param[in]  in: the input sample
+    \param[out] none
+    \retval     the output sample
+*/
+static double biquad_filter(test_biquad_struct *biquad, uint32_t channel, double in)
+{
+    double out = biquad->b[0] * in + biquad->b[1] * biquad->x[channel][0] + biquad->b[2] * biquad->x[channel][1]
+                 - biquad->a[0] * biquad->y[channel][0] - biquad->a[1] * biquad->y[channel][1];
+
+    biquad->x[channel][1] = biquad->x[channel][0];
+    biquad->x[channel][0] = in;
+    biquad->y[channel][1] = biquad->y[channel][0];
+    biquad->y[channel][0] = out;
+    return out;
+}
+
+/*!
+    \brief      filter the test signal and compare the output with the same cascade in double,
+                with the fixed point coefficients and with the coefficients of the design
+    \param[in]  check: settings of the equalizer and accepted errors
+    \param[out] none
+    \retval     1 if a check failed, 0 otherwise
+*/
+static uint32_t eq_check(const test_eq_struct *check)
+{
+    uint32_t count;
+    uint32_t frame;
+    uint32_t band;
+    uint32_t sample;
+    uint32_t failed = 0U;
+    double error;
+    double error_max = 0.0;
+    double signal = 0.0;
+    double noise = 0.0;
+    double snr;
+
+    eq_init(&eq, TEST_SAMPLERATE);
+    for(band = 0U; band < check->bands; band++) {
+        eq_band_config(&eq, (uint8_t)band, check->band[band].type, check->band[band].frequency,
+                       check->band[band].gain, check->band[band].q);
+        biquad_quantized(&quantized[band], &eq.band[band]);
+        biquad_designed(&designed[band], &eq.band[band], TEST_SAMPLERATE);
+    }
+
+    for(count = 0U; count < TEST_BLOCKS; count++) {
+        for(sample = 0U; sample < (TEST_FRAMES * 2U); sample++) {
+            frame = count * TEST_FRAMES + sample / 2U;
+            block[sample] = (int16_t)lrint(host_signal(frame, sample % 2U, TEST_SAMPLERATE) * check->level * 32767.0);
+            reference_quantized[sample] = block[sample];
+            reference_designed[sample] = block[sample];
+            for(band = 0U; band < check->bands; band++) {
+                reference_quantized[sample] = biquad_filter(&quantized[band], sample % 2U, reference_quantized[sample]);
+                reference_designed[sample] = biquad_filter(&designed[band], sample % 2U, reference_designed[sample]);
+            }
+        }
+        eq_process(&eq, block, TEST_FRAMES);
+
+        /* the first blocks are skipped while the low frequency bands settle */
+        if(count < 4U) {
+            continue;
+        }
+        for(sample = 0U; sample < (TEST_FRAMES * 2U); sample++) {
+            error = fabs(block[sample] - reference_quantized[sample]);
+            if(error > error_max) {
+                error_max = error;
+            }
+            signal += reference_designed[sample] * reference_designed[sample];
+            noise += (block[sample] - reference_designed[sample]) * (block[sample] - reference_designed[sample]);
+        }
+    }
+
+    snr = 10.0 * log10(signal / noise);
+    if(error_max > check->error_max) {
+        printf("FAIL %s: error %.2f LSB above %u LSB against the fixed point coefficients\n", check->name,
+               error_max, (unsigned)check->error_max);
+        failed = 1U;
+    }
+    if(snr < check->snr_min) {
+        printf("FAIL %s: SNR %.1f dB below %.1f dB against the floating point design\n", check->name, snr,
+               check->snr_min);
+        failed = 1U;
+    }
+    if(0U == failed) {
+        printf("ok   %s: error %.2f LSB, SNR %.1f dB\n", check->name, error_max, snr);
+    }
+    return failed;
+}
+
+/*!
+    \brief      ramp the volume over blocks of various sizes and compare the output with the
+                same ramps computed in double
+    \param[in]  name: name of the check
+    \param[in]  bits: 16 or 32 bits per sample
+    \param[out] none
+    \retval     1 if the check failed, 0 otherwise
+*/
+static uint32_t volume_check(const char *name, uint32_t bits)
+{
+    /* block sizes, a ramp ends inside most blocks */
+    static const uint32_t frames[] = {256U, 100U, 37U, 1U, 255U, 2U};
+    /* gain set before each block, VOLUME_UNITY + 1 keeps the current one */
+    static const uint32_t gains[] = {VOLUME_UNITY + 1U, VOLUME_UNITY + 1U, 3277U, VOLUME_UNITY + 1U,
+                                     VOLUME_UNITY, VOLUME_UNITY + 1U, 0U, 20000U, 5000U, VOLUME_UNITY + 1U,
+                                     32767U, VOLUME_UNITY + 1U};
+    double scale = (16U == bits) ? 32767.0 : 2147483647.0;
+    double lsb = (16U == bits) ? 1.0 : 65536.0;
+    double gain = VOLUME_UNITY / 2U;
+    double step = 0.0;
+    double expected;
+    double error;
+    double error_max = 0.0;
+    double signal = 0.0;
+    double noise = 0.0;
+    double snr;
+    uint32_t remaining = 0U;
+    uint32_t position = 0U;
+    uint32_t count;
+    uint32_t index;
+    uint32_t length;
+    uint32_t sample;
+    int32_t actual;
+
+    volume_init(&volume, VOLUME_UNITY / 2U);
+    for(count = 0U; count < TEST_BLOCKS; count++) {
+        index = count % (sizeof(gains) / sizeof(gains[0]));
+        if(VOLUME_UNITY >= gains[index]) {
+            volume_set(&volume, gains[index]);
+            step = ((double)gains[index] - gain) / VOLUME_RAMP_FRAMES;
+            remaining = VOLUME_RAMP_FRAMES;
+        }
+        length = frames[count % (sizeof(frames) / sizeof(frames[0]))];
+        for(sample = 0U; sample < (2U * length); sample++) {
+            expected = lrint(host_signal(position + sample / 2U, sample % 2U, TEST_SAMPLERATE) * scale);
+            if(16U == bits) {
+                block[sample] = (int16_t)expected;
+            } else {
+                block32[sample] = (int32_t)expected;
+            }
+        }
+        if(16U == bits) {
+            volume_process(&volume, block, length);
+        } else {
+            volume_process32(&volume, block32, length);
+        }
+
+        for(sample = 0U; sample < (2U * length); sample++) {
+            if(0U == (sample & 1U)) {
+                /* the ramp moves once per frame */
+                if(0U != remaining) {
+                    remaining--;
+                    gain = (0U == remaining) ? (double)volume.target : (gain + step);
+                }
+            }
+            expected = lrint(host_signal(position + sample / 2U, sample % 2U, TEST_SAMPLERATE) * scale) * gain / 32768.0;
+            actual = (16U == bits) ? block[sample] : block32[sample];
+            error = fabs(actual - expected) / lsb;
+            if(error > error_max) {
+                error_max = error;
+            }
+            signal += expected * expected;
+            noise += (actual - expected) * (actual - expected);
+        }
+        position += length;
+    }
+
+    snr = 10.0 * log10(signal / noise);
+    if(error_max > 2.0) {
+        printf("FAIL %s: error %.2f LSB above 2 LSB\n", name, error_max);
+        return 1U;
+    }
+    printf("ok   %s: error %.2f LSB of 16 bits, SNR %.1f dB\n", name, error_max, snr);
+    return 0U;
+}
+
+/*!
+    \brief      measure the filtering cost per frame for 1 to 4 bands
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void eq_benchmark(void)
+{
+    const test_eq_struct *check = &test_eq[0];
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t bands;
+    uint32_t band;
+    uint32_t count;
+
+    printf("  %-22s %12s %10s\n", "equalizer", "cycles/frame", "ns/frame");
+    for(bands = 1U; bands <= EQ_BANDS; bands++) {
+        eq_init(&eq, TEST_SAMPLERATE);
+        for(band = 0U; band < bands; band++) {
+            eq_band_config(&eq, (uint8_t)band, check->band[band].type, check->band[band].frequency,
+                           check->band[band].gain, check->band[band].q);
+        }
+        start = host_cycles();
+        for(count = 0U; count < TEST_BENCH_BLOCKS; count++) {
+            eq_process(&eq, block, TEST_FRAMES);
+        }
+        cycles = host_cycles() - start;
+        printf("  %u band%-17s %12.2f %10.3f\n", (unsigned)bands, (1U == bands) ? "" : "s",
+               (double)cycles / (TEST_BENCH_BLOCKS * TEST_FRAMES),
+               (double)cycles / (TEST_BENCH_BLOCKS * TEST_FRAMES) / host_cycles_per_ns());
+    }
+}
+
+/*!
+    \brief      measure the volume cost per frame at a fixed gain, during ramps and at unity
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void volume_benchmark(void)
+{
+    static const char *const names[] = {"gain 0.5", "ramping", "gain 0.5, 32-bit", "ramping, 32-bit", "unity"};
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t mode;
+    uint32_t count;
+
+    printf("  %-22s %12s %10s\n", "volume", "cycles/frame", "ns/frame");
+    for(mode = 0U; mode < (sizeof(names) / sizeof(names[0])); mode++) {
+        volume_init(&volume, (4U == mode) ? VOLUME_UNITY : (VOLUME_UNITY / 2U));
+        start = host_cycles();
+        for(count = 0U; count < TEST_BENCH_BLOCKS; count++) {
+            /* a ramp lasts one block */
+            if(1U == (mode & 1U)) {
+                volume_set(&volume, (0U != (count & 1U)) ? (VOLUME_UNITY / 4U) : (VOLUME_UNITY / 2U));
+            }
+            if(mode < 2U) {
+                volume_process(&volume, block, TEST_FRAMES);
+            } else if(mode < 4U) {
+                volume_process32(&volume, block32, TEST_FRAMES);
+            } else {
+                volume_process(&volume, block, TEST_FRAMES);
+            }
+        }
+        cycles = host_cycles() - start;
+        printf("  %-22s %12.2f %10.3f\n", names[mode], (double)cycles / (TEST_BENCH_BLOCKS * TEST_FRAMES),
+               (double)cycles / (TEST_BENCH_BLOCKS * TEST_FRAMES) / host_cycles_per_ns());
+    }
+}
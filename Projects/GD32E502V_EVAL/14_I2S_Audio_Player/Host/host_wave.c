@@ -0,0 +1,330 @@
+/*!
+    \file    host_wave.c
+    \brief   test wave files and audio sources of the host harness
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <math.h>
+#include <string.h>
+#include "host_wave.h"
+
+#define HOST_PI                 3.14159265358979323846
+#define HOST_SWEEP_SECONDS      2.0         /* duration of one sweep of the test signal */
+#define HOST_SWEEP_START        50.0        /* first frequency of the sweep in Hz */
+#define HOST_ADPCM_INDEX_MAX    88
+
+/* step index adjustment for each 4-bit code */
+static const int8_t adpcm_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/* quantizer step size for each step index */
+static const int16_t adpcm_step_table[HOST_ADPCM_INDEX_MAX + 1] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static uint32_t wave_header(uint8_t *file, uint16_t formattag, uint16_t channels, uint32_t samplerate,
+                            uint32_t byterate, uint16_t blockalign, uint16_t bits, uint16_t samplesperblock,
+                            uint32_t datasize);
+static void write_le(uint8_t *buffer, uint32_t value, uint32_t nbrofbytes);
+static int16_t sample_q15(uint32_t frame, uint32_t channel, uint32_t samplerate);
+static uint8_t adpcm_encode(int32_t sample, int32_t *predictor, int32_t *index);
+
+/*!
+    \brief      get a sample of the test signal: a tone, a logarithmic sweep up to 0.4 times
+                the sample rate and some noise, the two channels differ
+    \param[in]  frame: index of the frame
+    \param[in]  channel: 0 for left, 1 for right
+    \param[in]  samplerate: sample rate in Hz
+    \param[out] none
+    \retval     sample in [-1, 1]
+*/
+double host_signal(uint32_t frame, uint32_t channel, uint32_t samplerate)
+{
+    double t = (double)frame / (double)samplerate;
+    double tone = (0U == channel) ? 440.0 : 660.0;
+    double ratio = log((0.4 * samplerate) / HOST_SWEEP_START);
+    double sweep_t = fmod(t + 0.5 * channel, HOST_SWEEP_SECONDS);
+    double sweep_phase = 2.0 * HOST_PI * HOST_SWEEP_START * HOST_SWEEP_SECONDS / ratio
+                         * (exp(ratio * sweep_t / HOST_SWEEP_SECONDS) - 1.0);
+    uint32_t hash = (frame * 2654435761U) ^ (channel * 0x9E3779B9U);
+
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6DU;
+    hash ^= hash >> 12;
+    return 0.45 * sin(2.0 * HOST_PI * tone * t) + 0.3 * sin(sweep_phase)
+           + 0.05 * (((double)(hash & 0xFFFFU) / 32768.0) - 1.0);
+}
+
+/*!
+    \brief      build a PCM wave file of the test signal
+    \param[in]  size: size of the file buffer in bytes
+    \param[in]  bits: 8, 16, 24 or 32 bits per sample
+    \param[in]  channels: 1 or 2
+    \param[in]  samplerate: sample rate in Hz
+    \param[in]  frames: number of frames
+    \param[out] file: buffer receiving the wave file
+    \retval     size of the file, 0 if the buffer is too small
+*/
+uint32_t host_wave_pcm(uint8_t *file, uint32_t size, uint16_t bits, uint16_t channels, uint32_t samplerate, uint32_t frames)
+{
+    uint32_t width = bits / 8U;
+    uint32_t datasize = frames * channels * width;
+    uint32_t offset = 0U;
+    uint32_t frame;
+    uint32_t channel;
+    double value;
+    int32_t sample;
+
+    if((datasize + 44U) > size) {
+        return 0U;
+    }
+    offset = wave_header(file, 0x0001U, channels, samplerate, samplerate * channels * width,
+                         (uint16_t)(channels * width), bits, 0U, datasize);
+    for(frame = 0U; frame < frames; frame++) {
+        for(channel = 0U; channel < channels; channel++) {
+            value = host_signal(frame, channel, samplerate);
+            if(8U == bits) {
+                /* 8-bit samples are unsigned */
+                file[offset] = (uint8_t)(128 + lrint(value * 127.0));
+            } else {
+                sample = (int32_t)lrint(value * (double)((1UL << (bits - 1U)) - 1U));
+                write_le(&file[offset], (uint32_t)sample, width);
+            }
+            offset += width;
+        }
+    }
+    return offset;
+}
+
+/*!
+    \brief      build an IMA-ADPCM wave file of the test signal
+    \param[in]  size: size of the file buffer in bytes
+    \param[in]  channels: 1 or 2
+    \param[in]  samplerate: sample rate in Hz
+    \param[in]  blockalign: size of one block in bytes, a multiple of 4 times channels
+    \param[in]  blocks: number of blocks
+    \param[out] file: buffer receiving the wave file
+    \retval     size of the file, 0 if the buffer is too small
+*/
+uint32_t host_wave_adpcm(uint8_t *file, uint32_t size, uint16_t channels, uint32_t samplerate, uint16_t blockalign, uint32_t blocks)
+{
+    uint32_t samplesperblock = ((uint32_t)(blockalign - 4U * channels) * 2U) / channels + 1U;
+    uint32_t datasize = blocks * blockalign;
+    uint32_t offset = 0U;
+    uint32_t block;
+    uint32_t channel;
+    uint32_t sample;
+    uint32_t frame;
+    uint8_t *code;
+    uint8_t nibble;
+    int32_t predictor[2];
+    int32_t index[2] = {0, 0};
+
+    if((datasize + 48U) > size) {
+        return 0U;
+    }
+    offset = wave_header(file, 0x0011U, channels, samplerate, (samplerate * blockalign) / samplesperblock,
+                         blockalign, 4U, (uint16_t)samplesperblock, datasize);
+    memset(&file[offset], 0, datasize);
+    for(block = 0U; block < blocks; block++) {
+        frame = block * samplesperblock;
+        for(channel = 0U; channel < channels; channel++) {
+            /* the first sample of the block is stored in the header */
+            predictor[channel] = sample_q15(frame, channel, samplerate);
+            write_le(&file[offset + 4U * channel], (uint32_t)predictor[channel], 2U);
+            file[offset + 4U * channel + 2U] = (uint8_t)index[channel];
+            for(sample = 1U; sample < samplesperblock; sample++) {
+                /* groups of 8 codes, 4 bytes, of each channel in turn */
+                code = &file[offset + 4U * channels + ((sample - 1U) >> 3) * 4U * channels + 4U * channel
+                             + (((sample - 1U) & 7U) >> 1)];
+                nibble = adpcm_encode(sample_q15(frame + sample, channel, samplerate), &predictor[channel], &index[channel]);
+                *code |= (0U == ((sample - 1U) & 1U)) ? nibble : (uint8_t)(nibble << 4);
+            }
+        }
+        offset += blockalign;
+    }
+    return offset;
+}
+
+/*!
+    \brief      read callback of a memory audio source, the data loops forever
+    \param[in]  context: pointer to the host_memory_source_struct
+    \param[in]  length: number of bytes to read
+    \param[out] buffer: pointer to the buffer receiving the data
+    \retval     number of bytes read
+*/
+uint32_t host_memory_read(void *context, uint8_t *buffer, uint32_t length)
+{
+    host_memory_source_struct *source = (host_memory_source_struct *)context;
+    uint32_t count = 0U;
+    uint32_t chunk = 0U;
+
+    while(count < length) {
+        if(source->position >= source->size) {
+            source->position = 0U;
+        }
+        chunk = source->size - source->position;
+        if(chunk > (length - count)) {
+            chunk = length - count;
+        }
+        memcpy(&buffer[count], &source->data[source->position], chunk);
+        source->position += chunk;
+        count += chunk;
+    }
+    return count;
+}
+
+/*!
+    \brief      write the RIFF, fmt and data chunk headers
+    \param[in]  formattag: 0x0001 for PCM, 0x0011 for IMA-ADPCM
+    \param[in]  channels: number of channels
+    \param[in]  samplerate: sample rate in Hz
+    \param[in]  byterate: bytes per second
+    \param[in]  blockalign: bytes of a frame or of a compressed block
+    \param[in]  bits: bits per sample
+    \param[in]  samplesperblock: frames per compressed block, 0 for PCM
+    \param[in]  datasize: bytes of audio data
+    \param[out] file: buffer receiving the headers
+    \retval     offset of the audio data
+*/
+static uint32_t wave_header(uint8_t *file, uint16_t formattag, uint16_t channels, uint32_t samplerate,
+                            uint32_t byterate, uint16_t blockalign, uint16_t bits, uint16_t samplesperblock,
+                            uint32_t datasize)
+{
+    uint32_t fmtsize = (0U != samplesperblock) ? 20U : 16U;
+
+    memcpy(&file[0], "RIFF", 4U);
+    write_le(&file[4], 4U + 8U + fmtsize + 8U + datasize, 4U);
+    memcpy(&file[8], "WAVEfmt ", 8U);
+    write_le(&file[16], fmtsize, 4U);
+    write_le(&file[20], formattag, 2U);
+    write_le(&file[22], channels, 2U);
+    write_le(&file[24], samplerate, 4U);
+    write_le(&file[28], byterate, 4U);
+    write_le(&file[32], blockalign, 2U);
+    write_le(&file[34], bits, 2U);
+    if(0U != samplesperblock) {
+        /* extra format bytes of IMA-ADPCM */
+        write_le(&file[36], 2U, 2U);
+        write_le(&file[38], samplesperblock, 2U);
+    }
+    memcpy(&file[20U + fmtsize], "data", 4U);
+    write_le(&file[24U + fmtsize], datasize, 4U);
+    return 28U + fmtsize;
+}
+
+/*!
+    \brief      write little endian data
+    \param[in]  value: the data
+    \param[in]  nbrofbytes: number of bytes to write
+    \param[out] buffer: pointer to the first byte
+    \retval     none
+*/
+static void write_le(uint8_t *buffer, uint32_t value, uint32_t nbrofbytes)
+{
+    uint32_t index;
+
+    for(index = 0U; index < nbrofbytes; index++) {
+        buffer[index] = (uint8_t)(value >> (8U * index));
+    }
+}
+
+/*!
+    \brief      get a sample of the test signal in Q15
+    \param[in]  frame: index of the frame
+    \param[in]  channel: 0 for left, 1 for right
+    \param[in]  samplerate: sample rate in Hz
+    \param[out] none
+    \retval     the sample
+*/
+static int16_t sample_q15(uint32_t frame, uint32_t channel, uint32_t samplerate)
+{
+    return (int16_t)lrint(host_signal(frame, channel, samplerate) * 32767.0);
+}
+
+/*!
+    \brief      encode one sample, the predictor follows the decoder
+    \param[in]  sample: the 16-bit sample
+    \param[in]  predictor: predictor of the channel, updated
+    \param[in]  index: step index of the channel, updated
+    \param[out] none
+    \retval     the 4-bit code
+*/
+static uint8_t adpcm_encode(int32_t sample, int32_t *predictor, int32_t *index)
+{
+    int32_t step = adpcm_step_table[*index];
+    int32_t diff = sample - *predictor;
+    int32_t delta = step >> 3;
+    uint8_t nibble = 0U;
+
+    if(diff < 0) {
+        nibble = 8U;
+        diff = -diff;
+    }
+    if(diff >= step) {
+        nibble |= 4U;
+        diff -= step;
+        delta += step;
+    }
+    if(diff >= (step >> 1)) {
+        nibble |= 2U;
+        diff -= step >> 1;
+        delta += step >> 1;
+    }
+    if(diff >= (step >> 2)) {
+        nibble |= 1U;
+        delta += step >> 2;
+    }
+    *predictor += (0U != (nibble & 8U)) ? -delta : delta;
+    if(*predictor > 32767) {
+        *predictor = 32767;
+    } else if(*predictor < -32768) {
+        *predictor = -32768;
+    }
+    *index += adpcm_index_table[nibble];
+    if(*index < 0) {
+        *index = 0;
+    } else if(*index > HOST_ADPCM_INDEX_MAX) {
+        *index = HOST_ADPCM_INDEX_MAX;
+    }
+    return nibble;
+}
@@ -0,0 +1,58 @@
+/*!
+    \file    host_wave.h
+    \brief   test wave files and audio sources of the host harness
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef HOST_WAVE_H
+#define HOST_WAVE_H
+
+#include <stdint.h>
+
+/* audio source reading wave data from memory, the data loops forever */
+typedef struct {
+    const uint8_t *data;                /* first byte of the audio data */
+    uint32_t size;                      /* bytes of audio data */
+    uint32_t position;                  /* next byte to read */
+} host_memory_source_struct;
+
+/* function declarations */
+/* get a sample of the test signal */
+double host_signal(uint32_t frame, uint32_t channel, uint32_t samplerate);
+/* build a PCM wave file of the test signal */
+uint32_t host_wave_pcm(uint8_t *file, uint32_t size, uint16_t bits, uint16_t channels, uint32_t samplerate, uint32_t frames);
+/* build an IMA-ADPCM wave file of the test signal */
+uint32_t host_wave_adpcm(uint8_t *file, uint32_t size, uint16_t channels, uint32_t samplerate, uint16_t blockalign, uint32_t blocks);
+/* read callback of a memory audio source */
+uint32_t host_memory_read(void *context, uint8_t *buffer, uint32_t length);
+
+#endif /* HOST_WAVE_H */
@@ -0,0 +1,228 @@
+/*!
+    \file    meter_bench.c
+    \brief   host test and benchmark of the level meter
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "meter.h"
+#include "host_periph.h"
+
+#define TEST_FRAMES             256U                /* frames of a block */
+#define TEST_BENCH_BLOCKS       20000U              /* blocks measured by the benchmark */
+#define TEST_READER_BLOCKS      200000U             /* blocks measured while the reader interrupts */
+#define TEST_READER_PERIOD_US   20                  /* period of the interrupting reader */
+
+static meter_struct meter;
+static int16_t block[TEST_FRAMES * 2U];
+static uint32_t random_state = 1U;
+static volatile uint32_t reader_calls = 0U;
+static volatile uint32_t reader_errors = 0U;
+
+static int16_t random_q15(void);
+static uint32_t levels_check(const char *name, uint32_t count);
+static void reader_interrupt(int signal_number);
+static uint32_t reader_check(void);
+static void meter_benchmark(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+int main(void)
+{
+    uint32_t failed = 0U;
+    uint32_t index;
+
+    meter_init(&meter);
+    for(index = 0U; index < (TEST_FRAMES * 2U); index++) {
+        block[index] = random_q15() / 2;
+    }
+    failed += levels_check("noise, even block", TEST_FRAMES);
+    failed += levels_check("noise, odd block", TEST_FRAMES - 1U);
+    for(index = 0U; index < (TEST_FRAMES * 2U); index += 7U) {
+        block[index] = (0U != (index & 1U)) ? 32767 : -32768;
+    }
+    failed += levels_check("noise with full scale samples", TEST_FRAMES);
+    failed += reader_check();
+    meter_benchmark();
+    return (int)failed;
+}
+
+/*!
+    \brief      get a pseudo random Q15 value
+    \param[in]  none
+    \param[out] none
+    \retval     the value
+*/
+static int16_t random_q15(void)
+{
+    random_state = random_state * 1664525U + 1013904223U;
+    return (int16_t)(random_state >> 16);
+}
+
+/*!
+    \brief      measure the block and compare the snapshot with levels computed in double
+    \param[in]  name: name of the check
+    \param[in]  count: number of frames of the block to measure
+    \param[out] none
+    \retval     1 if the levels differ, 0 otherwise
+*/
+static uint32_t levels_check(const char *name, uint32_t count)
+{
+    meter_snapshot_struct before;
+    meter_snapshot_struct after;
+    double energy[2] = {0.0, 0.0};
+    uint32_t peak[2] = {0U, 0U};
+    uint32_t clips[2] = {0U, 0U};
+    uint32_t channel;
+    uint32_t frame;
+    uint32_t sample;
+    uint32_t rms;
+
+    meter_snapshot_get(&meter, &before);
+    meter_process(&meter, block, count);
+    meter_snapshot_get(&meter, &after);
+    for(frame = 0U; frame < count; frame++) {
+        for(channel = 0U; channel < 2U; channel++) {
+            sample = (uint32_t)abs(block[2U * frame + channel]);
+            energy[channel] += (double)sample * sample;
+            peak[channel] = (sample > peak[channel]) ? sample : peak[channel];
+            clips[channel] += (sample >= 32767U) ? 1U : 0U;
+        }
+    }
+    for(channel = 0U; channel < 2U; channel++) {
+        rms = (uint32_t)sqrt(energy[channel] / count);
+        if((after.peak[channel] != peak[channel]) || (after.clips[channel] != (before.clips[channel] + clips[channel]))
+                || (abs((int)after.rms[channel] - (int)rms) > 1) || (after.blocks != (before.blocks + 1U))
+                || (after.peak_hold[channel] < before.peak_hold[channel]) || (after.peak_hold[channel] < peak[channel])) {
+            printf("FAIL %s: channel %u peak %u/%u rms %u/%u clips %u/%u\n", name, (unsigned)channel,
+                   after.peak[channel], (unsigned)peak[channel], after.rms[channel], (unsigned)rms,
+                   (unsigned)(after.clips[channel] - before.clips[channel]), (unsigned)clips[channel]);
+            return 1U;
+        }
+    }
+    printf("ok   %s\n", name);
+    return 0U;
+}
+
+/*!
+    \brief      read the levels from a timer signal, as an interrupt of the main loop would, and
+                check that the copy belongs to a single block
+    \param[in]  signal_number: SIGALRM
+    \param[out] none
+    \retval     none
+*/
+static void reader_interrupt(int signal_number)
+{
+    meter_snapshot_struct levels;
+
+    (void)signal_number;
+    meter_snapshot_get(&meter, &levels);
+    /* block n has a peak of n modulo 32768 on the left and its complement on the right */
+    if((0U != levels.blocks) && ((levels.peak[0] != (levels.blocks & 0x7FFFU))
+                                 || (levels.peak[1] != (0x7FFFU - (levels.blocks & 0x7FFFU)))
+                                 || (levels.rms[0] != levels.peak[0]) || (levels.rms[1] != levels.peak[1]))) {
+        reader_errors++;
+    }
+    reader_calls++;
+}
+
+/*!
+    \brief      measure blocks while a timer signal reads the levels
+    \param[in]  none
+    \param[out] none
+    \retval     1 if a reader saw a torn snapshot or never ran, 0 otherwise
+*/
+static uint32_t reader_check(void)
+{
+    struct itimerval timer = {{0, TEST_READER_PERIOD_US}, {0, TEST_READER_PERIOD_US}};
+    struct itimerval stop = {{0, 0}, {0, 0}};
+    meter_snapshot_struct levels;
+    uint32_t blocks;
+    uint32_t index;
+    uint32_t level;
+
+    meter_init(&meter);
+    meter_snapshot_get(&meter, &levels);
+    signal(SIGALRM, reader_interrupt);
+    setitimer(ITIMER_REAL, &timer, NULL);
+    for(blocks = levels.blocks + 1U; blocks <= TEST_READER_BLOCKS; blocks++) {
+        level = blocks & 0x7FFFU;
+        for(index = 0U; index < TEST_FRAMES; index++) {
+            block[2U * index] = (int16_t)((0U != (index & 1U)) ? level : -(int32_t)level);
+            block[2U * index + 1U] = (int16_t)(0x7FFFU - level);
+        }
+        meter_process(&meter, block, TEST_FRAMES);
+    }
+    setitimer(ITIMER_REAL, &stop, NULL);
+    signal(SIGALRM, SIG_DFL);
+
+    if((0U != reader_errors) || (0U == reader_calls)) {
+        printf("FAIL interrupting reader: %u torn copies in %u reads\n", (unsigned)reader_errors, (unsigned)reader_calls);
+        return 1U;
+    }
+    printf("ok   interrupting reader: %u reads, no torn copy\n", (unsigned)reader_calls);
+    return 0U;
+}
+
+/*!
+    \brief      measure the cost of the meter per frame
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void meter_benchmark(void)
+{
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t count;
+    uint32_t index;
+
+    for(index = 0U; index < (TEST_FRAMES * 2U); index++) {
+        block[index] = random_q15();
+    }
+    start = host_cycles();
+    for(count = 0U; count < TEST_BENCH_BLOCKS; count++) {
+        meter_process(&meter, block, TEST_FRAMES);
+    }
+    cycles = host_cycles() - start;
+    printf("  meter_process: %.2f cycles/frame, %.3f ns/frame\n", (double)cycles / (TEST_BENCH_BLOCKS * TEST_FRAMES),
+           (double)cycles / (TEST_BENCH_BLOCKS * TEST_FRAMES) / host_cycles_per_ns());
+}
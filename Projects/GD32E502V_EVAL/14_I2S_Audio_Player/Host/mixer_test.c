@@ -0,0 +1,220 @@
+/*!
+    \file    mixer_test.c
+    \brief   host test and benchmark of the voice mixer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <stdio.h>
+#include <string.h>
+#include "mixer.h"
+#include "host_periph.h"
+
+#define TEST_FRAMES             256U                /* frames of a block */
+#define TEST_CLIP_FRAMES        1000U               /* frames of each clip */
+#define TEST_BENCH_BLOCKS       2000U               /* blocks mixed by the benchmark */
+
+static mixer_struct mixer;
+static int16_t clip[MIXER_VOICES][TEST_CLIP_FRAMES];
+static int16_t block[TEST_FRAMES * 2U];
+static int16_t music[TEST_FRAMES * 2U];
+static uint32_t random_state = 1U;
+
+static int16_t random_q15(void);
+static int16_t saturate(int64_t value);
+static uint32_t mix_check(const char *name, uint32_t voices, const int16_t *gain_left, const int16_t *gain_right);
+static void mix_benchmark(void);
+
+/*!
+    \brief      main function
+    \param[in]  none
+    \param[out] none
+    \retval     number of failed checks
+*/
+int main(void)
+{
+    int16_t gain_left[MIXER_VOICES];
+    int16_t gain_right[MIXER_VOICES];
+    uint32_t failed = 0U;
+    uint32_t voice;
+    uint32_t frame;
+
+    /* all the voices at positive and at negative full scale, unity gain */
+    for(voice = 0U; voice < MIXER_VOICES; voice++) {
+        gain_left[voice] = MIXER_GAIN_UNITY;
+        gain_right[voice] = MIXER_GAIN_UNITY;
+        for(frame = 0U; frame < TEST_CLIP_FRAMES; frame++) {
+            clip[voice][frame] = 32767;
+        }
+    }
+    memset(music, 0, sizeof(music));
+    failed += mix_check("8 voices at +full scale", 8U, gain_left, gain_right);
+    failed += mix_check("7 voices at +full scale", 7U, gain_left, gain_right);
+    for(voice = 0U; voice < MIXER_VOICES; voice++) {
+        gain_right[voice] = -32768;
+        for(frame = 0U; frame < TEST_CLIP_FRAMES; frame++) {
+            clip[voice][frame] = -32768;
+        }
+    }
+    failed += mix_check("8 voices at -full scale, inverted right gain", 8U, gain_left, gain_right);
+
+    /* full scale voices cancelling each other: the sum is only exact without wrapping */
+    for(voice = 0U; voice < MIXER_VOICES; voice++) {
+        gain_right[voice] = MIXER_GAIN_UNITY;
+        for(frame = 0U; frame < TEST_CLIP_FRAMES; frame++) {
+            clip[voice][frame] = (0U == (voice & 1U)) ? 32767 : -32768;
+        }
+    }
+    failed += mix_check("8 voices at +/-full scale", 8U, gain_left, gain_right);
+
+    /* full scale noise with random gains over full scale music */
+    for(voice = 0U; voice < MIXER_VOICES; voice++) {
+        gain_left[voice] = random_q15();
+        gain_right[voice] = random_q15();
+        for(frame = 0U; frame < TEST_CLIP_FRAMES; frame++) {
+            clip[voice][frame] = (0U != (random_q15() & 1)) ? 32767 : -32768;
+        }
+    }
+    for(frame = 0U; frame < (TEST_FRAMES * 2U); frame++) {
+        music[frame] = random_q15();
+    }
+    failed += mix_check("8 voices of full scale noise, random gains, over music", 8U, gain_left, gain_right);
+    failed += mix_check("3 voices of full scale noise, random gains, over music", 3U, gain_left, gain_right);
+
+    mix_benchmark();
+    return (int)failed;
+}
+
+/*!
+    \brief      get a pseudo random Q15 value
+    \param[in]  none
+    \param[out] none
+    \retval     the value
+*/
+static int16_t random_q15(void)
+{
+    random_state = random_state * 1664525U + 1013904223U;
+    return (int16_t)(random_state >> 16);
+}
+
+/*!
+    \brief      saturate a value to the signed 16-bit range
+    \param[in]  value: the value
+    \param[out] none
+    \retval     the saturated value
+*/
+static int16_t saturate(int64_t value)
+{
+    if(value > 32767) {
+        value = 32767;
+    } else if(value < -32768) {
+        value = -32768;
+    }
+    return (int16_t)value;
+}
+
+/*!
+    \brief      mix clips over the music and compare with an exact 64-bit reference
+    \param[in]  name: name of the check
+    \param[in]  voices: number of voices
+    \param[in]  gain_left: Q15 gain of each voice on the left channel
+    \param[in]  gain_right: Q15 gain of each voice on the right channel
+    \param[out] none
+    \retval     1 if the output differs from the reference, 0 otherwise
+*/
+static uint32_t mix_check(const char *name, uint32_t voices, const int16_t *gain_left, const int16_t *gain_right)
+{
+    int64_t sum[2];
+    int16_t expected;
+    uint32_t voice;
+    uint32_t frame;
+    uint32_t channel;
+    uint8_t index;
+
+    mixer_init(&mixer);
+    for(voice = 0U; voice < voices; voice++) {
+        index = mixer_voice_start(&mixer, clip[voice], TEST_CLIP_FRAMES, MIXER_GAIN_UNITY, 0U);
+        mixer_voice_gain_set(&mixer, index, gain_left[voice], gain_right[voice]);
+    }
+    memcpy(block, music, sizeof(block));
+    mixer_process(&mixer, block, TEST_FRAMES);
+
+    for(frame = 0U; frame < TEST_FRAMES; frame++) {
+        sum[0] = 1 << 14;
+        sum[1] = 1 << 14;
+        for(voice = 0U; voice < voices; voice++) {
+            sum[0] += (int64_t)clip[voice][frame] * gain_left[voice];
+            sum[1] += (int64_t)clip[voice][frame] * gain_right[voice];
+        }
+        for(channel = 0U; channel < 2U; channel++) {
+            expected = saturate((int64_t)music[2U * frame + channel] + saturate(sum[channel] >> 15));
+            if(expected != block[2U * frame + channel]) {
+                printf("FAIL %s: frame %u channel %u is %d instead of %d\n", name, (unsigned)frame,
+                       (unsigned)channel, block[2U * frame + channel], expected);
+                return 1U;
+            }
+        }
+    }
+    printf("ok   %s\n", name);
+    return 0U;
+}
+
+/*!
+    \brief      measure the mixing cost per voice and per frame for 1 to 8 voices
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+static void mix_benchmark(void)
+{
+    uint64_t start;
+    uint64_t cycles;
+    uint32_t mixed;
+    uint32_t voices;
+    uint32_t voice;
+    uint32_t count;
+
+    printf("  %-6s %16s %12s\n", "voices", "cycles/voice/frame", "ns/voice/frame");
+    for(voices = 1U; voices <= MIXER_VOICES; voices++) {
+        mixer_init(&mixer);
+        for(voice = 0U; voice < voices; voice++) {
+            mixer_voice_start(&mixer, clip[voice], TEST_CLIP_FRAMES, MIXER_GAIN_UNITY / 2, 1U);
+        }
+        mixed = 0U;
+        start = host_cycles();
+        for(count = 0U; count < TEST_BENCH_BLOCKS; count++) {
+            mixed += mixer_process(&mixer, block, TEST_FRAMES);
+        }
+        cycles = host_cycles() - start;
+        printf("  %-6u %18.2f %14.3f\n", (unsigned)voices, (double)cycles / mixed,
+               (double)cycles / mixed / host_cycles_per_ns());
+    }
+}
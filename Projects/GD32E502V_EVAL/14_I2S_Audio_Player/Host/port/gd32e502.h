@@ -0,0 +1,208 @@
+/*!
+    \file    gd32e502.h
+    \brief   host version of the device header used by the audio pipeline harness
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef GD32E502_H
+#define GD32E502_H
+
+/* only the part of the device header and of the peripheral library used by the audio
+   pipeline is declared, the peripherals are modelled by host_periph.c */
+
+#include <stdint.h>
+
+#define __IO                volatile
+#define __I                 volatile const
+#define BIT(x)              ((uint32_t)((uint32_t)0x01U << (x)))
+
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} EventStatus, ControlStatus;
+typedef enum {RESET = 0, SET = !RESET} FlagStatus;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrStatus;
+
+typedef enum {
+    DMA0_Channel0_IRQn = 18,
+    DMA0_Channel1_IRQn = 19,
+    HOST_IRQ_NUM = 64
+} IRQn_Type;
+
+extern uint32_t SystemCoreClock;
+
+/* RCU */
+typedef enum {
+    RCU_DMA0 = 0,
+    RCU_DMAMUX,
+    RCU_CRC,
+    RCU_GPIOC,
+    RCU_GPIOD,
+    RCU_SPI1
+} rcu_periph_enum;
+
+typedef enum {
+    CK_SYS = 0,
+    CK_AHB,
+    CK_APB1,
+    CK_APB2
+} rcu_clock_freq_enum;
+
+void rcu_periph_clock_enable(rcu_periph_enum periph);
+uint32_t rcu_clock_freq_get(rcu_clock_freq_enum clock);
+
+/* GPIO */
+#define GPIOC               0x48000800U
+#define GPIOD               0x48000C00U
+#define GPIO_PIN_6          BIT(6)
+#define GPIO_PIN_7          BIT(7)
+#define GPIO_PIN_13         BIT(13)
+#define GPIO_PIN_14         BIT(14)
+#define GPIO_AF_4           4U
+#define GPIO_MODE_AF        2U
+#define GPIO_PUPD_NONE      0U
+#define GPIO_OTYPE_PP       0U
+#define GPIO_OSPEED_50MHZ   3U
+
+void gpio_af_set(uint32_t gpio_periph, uint32_t alt_func_num, uint32_t pin);
+void gpio_mode_set(uint32_t gpio_periph, uint32_t mode, uint32_t pull_up_down, uint32_t pin);
+void gpio_output_options_set(uint32_t gpio_periph, uint8_t otype, uint32_t speed, uint32_t pin);
+
+/* SPI/I2S */
+#define SPI1                0x40003800U
+#define SPI_DATA(spix)      (*host_spi_data(spix))
+#define SPI_DMA_TRANSMIT    ((uint8_t)0x00U)
+#define SPI_DMA_RECEIVE     ((uint8_t)0x01U)
+#define I2S_FRAMEFORMAT_DT16B_CH16B     0x00000000U
+#define I2S_FRAMEFORMAT_DT16B_CH32B     0x00000001U
+#define I2S_FRAMEFORMAT_DT24B_CH32B     0x00000003U
+#define I2S_FRAMEFORMAT_DT32B_CH32B     0x00000005U
+#define I2S_MCKOUT_ENABLE   0x00000200U
+#define I2S_MCKOUT_DISABLE  0x00000000U
+#define I2S_MODE_MASTERTX   0x00000200U
+#define I2S_STD_MSB         0x00000010U
+#define I2S_CKPL_HIGH       0x00000008U
+
+__IO uint32_t *host_spi_data(uint32_t spi_periph);
+void i2s_init(uint32_t spi_periph, uint32_t i2s_mode, uint32_t i2s_standard, uint32_t i2s_ckpl);
+void i2s_psc_config(uint32_t spi_periph, uint32_t i2s_audiosample, uint32_t i2s_frameformat, uint32_t i2s_mckout);
+void i2s_enable(uint32_t spi_periph);
+void i2s_disable(uint32_t spi_periph);
+void spi_dma_enable(uint32_t spi_periph, uint8_t spi_dma);
+void spi_dma_disable(uint32_t spi_periph, uint8_t spi_dma);
+
+/* DMA */
+#define DMA0                0x40020000U
+#define DMA_REQUEST_SPI1_TX             19U
+#define DMA_PERIPHERAL_TO_MEMORY        ((uint8_t)0x00U)
+#define DMA_MEMORY_TO_PERIPHERAL        ((uint8_t)0x01U)
+#define DMA_PERIPH_INCREASE_DISABLE     ((uint8_t)0x00U)
+#define DMA_MEMORY_INCREASE_ENABLE      ((uint8_t)0x01U)
+#define DMA_PERIPHERAL_WIDTH_8BIT       0x00000000U
+#define DMA_PERIPHERAL_WIDTH_16BIT      0x00000100U
+#define DMA_PERIPHERAL_WIDTH_32BIT      0x00000200U
+#define DMA_MEMORY_WIDTH_8BIT           0x00000000U
+#define DMA_MEMORY_WIDTH_16BIT          0x00000400U
+#define DMA_MEMORY_WIDTH_32BIT          0x00000800U
+#define DMA_PRIORITY_ULTRA_HIGH         0x00003000U
+#define DMA_INT_FLAG_G                  BIT(0)
+#define DMA_INT_FLAG_FTF                BIT(1)
+#define DMA_INT_FLAG_HTF                BIT(2)
+#define DMA_INT_FTF                     BIT(1)
+#define DMA_INT_HTF                     BIT(2)
+
+typedef enum {
+    DMA_CH0 = 0U,
+    DMA_CH1,
+    DMA_CH2,
+    DMA_CH3,
+    DMA_CH4,
+    DMA_CH5,
+    DMA_CH6
+} dma_channel_enum;
+
+typedef enum {
+    DMAMUX_MULTIPLEXER_CH0 = 0,
+    DMAMUX_MULTIPLEXER_CH1
+} dmamux_multiplexer_channel_enum;
+
+typedef struct {
+    uint32_t periph_addr;                 /*!< peripheral base address */
+    uint32_t periph_width;                /*!< transfer data size of peripheral */
+    uint32_t memory_addr;                 /*!< memory base address */
+    uint32_t memory_width;                /*!< transfer data size of memory */
+    uint32_t number;                      /*!< channel transfer number */
+    uint32_t priority;                    /*!< channel priority level */
+    uint8_t periph_inc;                   /*!< peripheral increasing mode */
+    uint8_t memory_inc;                   /*!< memory increasing mode */
+    uint8_t direction;                    /*!< channel data transfer direction */
+    uint32_t request;                     /*!< channel input identification */
+} dma_parameter_struct;
+
+void dma_deinit(uint32_t dma_periph, dma_channel_enum channelx);
+void dma_struct_para_init(dma_parameter_struct *init_struct);
+void dma_init(uint32_t dma_periph, dma_channel_enum channelx, dma_parameter_struct *init_struct);
+void dma_circulation_enable(uint32_t dma_periph, dma_channel_enum channelx);
+void dma_memory_to_memory_disable(uint32_t dma_periph, dma_channel_enum channelx);
+void dma_channel_enable(uint32_t dma_periph, dma_channel_enum channelx);
+void dma_channel_disable(uint32_t dma_periph, dma_channel_enum channelx);
+void dma_interrupt_enable(uint32_t dma_periph, dma_channel_enum channelx, uint32_t source);
+FlagStatus dma_interrupt_flag_get(uint32_t dma_periph, dma_channel_enum channelx, uint32_t int_flag);
+void dma_interrupt_flag_clear(uint32_t dma_periph, dma_channel_enum channelx, uint32_t int_flag);
+void dmamux_synchronization_disable(dmamux_multiplexer_channel_enum channelx);
+
+/* CRC */
+#define INPUT_FORMAT_WORD               0U
+#define INPUT_FORMAT_HALFWORD           1U
+#define INPUT_FORMAT_BYTE               2U
+
+void crc_data_register_reset(void);
+void crc_init_data_register_write(uint32_t init_data);
+uint32_t crc_block_data_calculate(void *array, uint32_t size, uint8_t data_format);
+
+/* DWT cycle counter, each access to DWT reads the host time stamp counter */
+#define DCB_DEMCR_TRCENA_Msk            BIT(24)
+#define DWT_CTRL_CYCCNTENA_Msk          BIT(0)
+
+typedef struct {
+    __IO uint32_t DEMCR;
+} DCB_Type;
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+
+extern DCB_Type host_dcb;
+DWT_Type *host_dwt(void);
+
+#define DCB                 (&host_dcb)
+#define DWT                 (host_dwt())
+
+#endif /* GD32E502_H */
@@ -0,0 +1,623 @@
+/*!
+    \file    host_periph.c
+    \brief   models of the peripherals used by the audio pipeline on a host computer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif /* __x86_64__ || __i386__ */
+#include "host_periph.h"
+
+#define HOST_DMA_CHANNELS   7U
+#define HOST_CALIBRATE_NS   20000000U           /* time measured to calibrate the time stamp counter */
+
+/* DMA channel model */
+typedef struct {
+    dma_parameter_struct config;        /* configuration of dma_init() */
+    uint8_t enabled;                    /* channel enabled */
+    uint8_t circular;                   /* circular mode */
+    uint32_t interrupts;                /* enabled interrupts */
+    uint32_t flags;                     /* interrupt flags */
+    uint32_t position;                  /* data items moved since the start of the buffer */
+} host_dma_channel_struct;
+
+uint32_t SystemCoreClock = 100000000U;
+DCB_Type host_dcb;
+
+static DWT_Type dwt_reg;
+static host_dma_channel_struct dma_channel[HOST_DMA_CHANNELS];
+static host_irq_handler_func irq_handler[HOST_IRQ_NUM];
+/* SPI1 data register, I2S state and receiver of the data sent */
+static __IO uint32_t spi1_data = 0U;
+static uint8_t i2s_enabled = 0U;
+static uint8_t spi1_dma_transmit = 0U;
+static uint32_t i2s_format = I2S_FRAMEFORMAT_DT16B_CH16B;
+static host_i2s_sink_func i2s_sink = NULL;
+static void *i2s_sink_context = NULL;
+/* CRC unit registers */
+static uint32_t crc_idata = 0xFFFFFFFFU;
+static uint32_t crc_data = 0xFFFFFFFFU;
+static double cycles_per_ns = 0.0;
+
+static uint64_t host_ns(void);
+static void dma_flag_set(dma_channel_enum channelx, uint32_t flag, uint32_t interrupt);
+
+/*!
+    \brief      register the handler of an interrupt raised by the models
+    \param[in]  irq: interrupt number
+    \param[in]  handler: handler called when the interrupt is raised, NULL to ignore it
+    \param[out] none
+    \retval     none
+*/
+void host_irq_handler_set(IRQn_Type irq, host_irq_handler_func handler)
+{
+    if((uint32_t)irq < HOST_IRQ_NUM) {
+        irq_handler[irq] = handler;
+    }
+}
+
+/*!
+    \brief      register the sink of the data sent by the I2S
+    \param[in]  sink: called with each data item shifted out, NULL to drop the data
+    \param[in]  context: context passed to the sink
+    \param[out] none
+    \retval     none
+*/
+void host_i2s_sink_set(host_i2s_sink_func sink, void *context)
+{
+    i2s_sink = sink;
+    i2s_sink_context = context;
+}
+
+/*!
+    \brief      get the frame format of the I2S
+    \param[in]  none
+    \param[out] none
+    \retval     frame format given to i2s_psc_config()
+*/
+uint32_t host_i2s_frameformat_get(void)
+{
+    return i2s_format;
+}
+
+/*!
+    \brief      move data items on a DMA channel as its peripheral requests them, the
+                half and full transfer interrupts are raised on the way
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[in]  count: number of data items to move
+    \param[out] none
+    \retval     number of data items moved, less than count if the channel or its request stopped
+*/
+uint32_t host_dma_run(uint32_t dma_periph, dma_channel_enum channelx, uint32_t count)
+{
+    host_dma_channel_struct *channel = &dma_channel[channelx];
+    uintptr_t memory;
+    uint32_t value = 0U;
+    uint32_t moved = 0U;
+
+    (void)dma_periph;
+    while(moved < count) {
+        /* only the I2S1 transmit request is modelled */
+        if((0U == channel->enabled) || (DMA_REQUEST_SPI1_TX != channel->config.request)
+                || (0U == spi1_dma_transmit) || (0U == i2s_enabled) || (0U == channel->config.number)) {
+            break;
+        }
+        /* the addresses were given as 32-bit values, the harness is linked at low addresses */
+        memory = (uintptr_t)channel->config.memory_addr;
+        if(DMA_MEMORY_INCREASE_ENABLE == channel->config.memory_inc) {
+            memory += (uintptr_t)channel->position * ((DMA_MEMORY_WIDTH_32BIT == channel->config.memory_width) ? 4U :
+                      ((DMA_MEMORY_WIDTH_16BIT == channel->config.memory_width) ? 2U : 1U));
+        }
+        if(DMA_MEMORY_WIDTH_32BIT == channel->config.memory_width) {
+            value = *(const uint32_t *)memory;
+        } else if(DMA_MEMORY_WIDTH_16BIT == channel->config.memory_width) {
+            value = *(const uint16_t *)memory;
+        } else {
+            value = *(const uint8_t *)memory;
+        }
+        spi1_data = value;
+        if(NULL != i2s_sink) {
+            i2s_sink(i2s_sink_context, value);
+        }
+        moved++;
+
+        channel->position++;
+        if(channel->position == (channel->config.number / 2U)) {
+            dma_flag_set(channelx, DMA_INT_FLAG_HTF, DMA_INT_HTF);
+        }
+        if(channel->position == channel->config.number) {
+            channel->position = 0U;
+            if(0U == channel->circular) {
+                channel->enabled = 0U;
+            }
+            dma_flag_set(channelx, DMA_INT_FLAG_FTF, DMA_INT_FTF);
+        }
+    }
+    return moved;
+}
+
+/*!
+    \brief      read the host time stamp counter
+    \param[in]  none
+    \param[out] none
+    \retval     time stamp counter, nanoseconds if the host has none
+*/
+uint64_t host_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return host_ns();
+#endif /* __x86_64__ || __i386__ */
+}
+
+/*!
+    \brief      get the number of host time stamp counts in one nanosecond, it is measured
+                on the first call
+    \param[in]  none
+    \param[out] none
+    \retval     time stamp counts per nanosecond
+*/
+double host_cycles_per_ns(void)
+{
+    uint64_t start_ns;
+    uint64_t start_cycles;
+    uint64_t ns;
+
+    if(0.0 == cycles_per_ns) {
+        start_ns = host_ns();
+        start_cycles = host_cycles();
+        do {
+            ns = host_ns() - start_ns;
+        } while(ns < HOST_CALIBRATE_NS);
+        cycles_per_ns = (double)(host_cycles() - start_cycles) / (double)ns;
+    }
+    return cycles_per_ns;
+}
+
+/*!
+    \brief      get the DWT registers, the cycle counter holds the host time stamp counter
+    \param[in]  none
+    \param[out] none
+    \retval     pointer to the DWT registers
+*/
+DWT_Type *host_dwt(void)
+{
+    dwt_reg.CYCCNT = (uint32_t)host_cycles();
+    return &dwt_reg;
+}
+
+/*!
+    \brief      enable the clock of a peripheral, nothing to model
+    \param[in]  periph: the peripheral
+    \param[out] none
+    \retval     none
+*/
+void rcu_periph_clock_enable(rcu_periph_enum periph)
+{
+    (void)periph;
+}
+
+/*!
+    \brief      get the frequency of a clock, all the buses run at the system clock
+    \param[in]  clock: the clock
+    \param[out] none
+    \retval     frequency in Hz
+*/
+uint32_t rcu_clock_freq_get(rcu_clock_freq_enum clock)
+{
+    (void)clock;
+    return SystemCoreClock;
+}
+
+/*!
+    \brief      set the alternate function of pins, nothing to model
+    \param[in]  gpio_periph: GPIO port
+    \param[in]  alt_func_num: alternate function
+    \param[in]  pin: pins
+    \param[out] none
+    \retval     none
+*/
+void gpio_af_set(uint32_t gpio_periph, uint32_t alt_func_num, uint32_t pin)
+{
+    (void)gpio_periph;
+    (void)alt_func_num;
+    (void)pin;
+}
+
+/*!
+    \brief      set the mode of pins, nothing to model
+    \param[in]  gpio_periph: GPIO port
+    \param[in]  mode: pin mode
+    \param[in]  pull_up_down: pull-up or pull-down
+    \param[in]  pin: pins
+    \param[out] none
+    \retval     none
+*/
+void gpio_mode_set(uint32_t gpio_periph, uint32_t mode, uint32_t pull_up_down, uint32_t pin)
+{
+    (void)gpio_periph;
+    (void)mode;
+    (void)pull_up_down;
+    (void)pin;
+}
+
+/*!
+    \brief      set the output options of pins, nothing to model
+    \param[in]  gpio_periph: GPIO port
+    \param[in]  otype: output type
+    \param[in]  speed: output speed
+    \param[in]  pin: pins
+    \param[out] none
+    \retval     none
+*/
+void gpio_output_options_set(uint32_t gpio_periph, uint8_t otype, uint32_t speed, uint32_t pin)
+{
+    (void)gpio_periph;
+    (void)otype;
+    (void)speed;
+    (void)pin;
+}
+
+/*!
+    \brief      get the data register of a SPI
+    \param[in]  spi_periph: SPI1
+    \param[out] none
+    \retval     pointer to the data register
+*/
+__IO uint32_t *host_spi_data(uint32_t spi_periph)
+{
+    (void)spi_periph;
+    return &spi1_data;
+}
+
+/*!
+    \brief      initialize the I2S, only the master transmitter is modelled
+    \param[in]  spi_periph: SPI1
+    \param[in]  i2s_mode: I2S operation mode
+    \param[in]  i2s_standard: I2S standard
+    \param[in]  i2s_ckpl: I2S idle state clock polarity
+    \param[out] none
+    \retval     none
+*/
+void i2s_init(uint32_t spi_periph, uint32_t i2s_mode, uint32_t i2s_standard, uint32_t i2s_ckpl)
+{
+    (void)spi_periph;
+    (void)i2s_mode;
+    (void)i2s_standard;
+    (void)i2s_ckpl;
+}
+
+/*!
+    \brief      configure the I2S prescaler and the frame format
+    \param[in]  spi_periph: SPI1
+    \param[in]  i2s_audiosample: sample rate in Hz
+    \param[in]  i2s_frameformat: data and channel length
+    \param[in]  i2s_mckout: master clock output
+    \param[out] none
+    \retval     none
+*/
+void i2s_psc_config(uint32_t spi_periph, uint32_t i2s_audiosample, uint32_t i2s_frameformat, uint32_t i2s_mckout)
+{
+    (void)spi_periph;
+    (void)i2s_audiosample;
+    (void)i2s_mckout;
+    i2s_format = i2s_frameformat;
+}
+
+/*!
+    \brief      enable the I2S
+    \param[in]  spi_periph: SPI1
+    \param[out] none
+    \retval     none
+*/
+void i2s_enable(uint32_t spi_periph)
+{
+    (void)spi_periph;
+    i2s_enabled = 1U;
+}
+
+/*!
+    \brief      disable the I2S
+    \param[in]  spi_periph: SPI1
+    \param[out] none
+    \retval     none
+*/
+void i2s_disable(uint32_t spi_periph)
+{
+    (void)spi_periph;
+    i2s_enabled = 0U;
+}
+
+/*!
+    \brief      enable a DMA request of the SPI
+    \param[in]  spi_periph: SPI1
+    \param[in]  spi_dma: SPI_DMA_TRANSMIT or SPI_DMA_RECEIVE
+    \param[out] none
+    \retval     none
+*/
+void spi_dma_enable(uint32_t spi_periph, uint8_t spi_dma)
+{
+    (void)spi_periph;
+    if(SPI_DMA_TRANSMIT == spi_dma) {
+        spi1_dma_transmit = 1U;
+    }
+}
+
+/*!
+    \brief      disable a DMA request of the SPI
+    \param[in]  spi_periph: SPI1
+    \param[in]  spi_dma: SPI_DMA_TRANSMIT or SPI_DMA_RECEIVE
+    \param[out] none
+    \retval     none
+*/
+void spi_dma_disable(uint32_t spi_periph, uint8_t spi_dma)
+{
+    (void)spi_periph;
+    if(SPI_DMA_TRANSMIT == spi_dma) {
+        spi1_dma_transmit = 0U;
+    }
+}
+
+/*!
+    \brief      reset a DMA channel
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[out] none
+    \retval     none
+*/
+void dma_deinit(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    (void)dma_periph;
+    memset(&dma_channel[channelx], 0, sizeof(host_dma_channel_struct));
+}
+
+/*!
+    \brief      initialize the DMA parameter structure with the default values
+    \param[in]  none
+    \param[out] init_struct: the initialized structure
+    \retval     none
+*/
+void dma_struct_para_init(dma_parameter_struct *init_struct)
+{
+    memset(init_struct, 0, sizeof(dma_parameter_struct));
+}
+
+/*!
+    \brief      configure a DMA channel
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[in]  init_struct: the channel configuration
+    \param[out] none
+    \retval     none
+*/
+void dma_init(uint32_t dma_periph, dma_channel_enum channelx, dma_parameter_struct *init_struct)
+{
+    (void)dma_periph;
+    dma_channel[channelx].config = *init_struct;
+    dma_channel[channelx].position = 0U;
+}
+
+/*!
+    \brief      enable the circular mode of a DMA channel
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[out] none
+    \retval     none
+*/
+void dma_circulation_enable(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    (void)dma_periph;
+    dma_channel[channelx].circular = 1U;
+}
+
+/*!
+    \brief      disable the memory to memory mode of a DMA channel, nothing to model
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[out] none
+    \retval     none
+*/
+void dma_memory_to_memory_disable(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    (void)dma_periph;
+    (void)channelx;
+}
+
+/*!
+    \brief      enable a DMA channel
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[out] none
+    \retval     none
+*/
+void dma_channel_enable(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    (void)dma_periph;
+    dma_channel[channelx].enabled = 1U;
+}
+
+/*!
+    \brief      disable a DMA channel, it restarts from the start of its buffer
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[out] none
+    \retval     none
+*/
+void dma_channel_disable(uint32_t dma_periph, dma_channel_enum channelx)
+{
+    (void)dma_periph;
+    dma_channel[channelx].enabled = 0U;
+    dma_channel[channelx].position = 0U;
+}
+
+/*!
+    \brief      enable interrupts of a DMA channel
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[in]  source: DMA_INT_HTF, DMA_INT_FTF
+    \param[out] none
+    \retval     none
+*/
+void dma_interrupt_enable(uint32_t dma_periph, dma_channel_enum channelx, uint32_t source)
+{
+    (void)dma_periph;
+    dma_channel[channelx].interrupts |= source;
+}
+
+/*!
+    \brief      get an interrupt flag of a DMA channel
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[in]  int_flag: DMA_INT_FLAG_G, DMA_INT_FLAG_HTF, DMA_INT_FLAG_FTF
+    \param[out] none
+    \retval     FlagStatus: SET or RESET
+*/
+FlagStatus dma_interrupt_flag_get(uint32_t dma_periph, dma_channel_enum channelx, uint32_t int_flag)
+{
+    (void)dma_periph;
+    return (0U != (dma_channel[channelx].flags & int_flag)) ? SET : RESET;
+}
+
+/*!
+    \brief      clear an interrupt flag of a DMA channel, the global flag clears all of them
+    \param[in]  dma_periph: DMA0
+    \param[in]  channelx: DMA channel
+    \param[in]  int_flag: DMA_INT_FLAG_G, DMA_INT_FLAG_HTF, DMA_INT_FLAG_FTF
+    \param[out] none
+    \retval     none
+*/
+void dma_interrupt_flag_clear(uint32_t dma_periph, dma_channel_enum channelx, uint32_t int_flag)
+{
+    (void)dma_periph;
+    if(0U != (int_flag & DMA_INT_FLAG_G)) {
+        dma_channel[channelx].flags = 0U;
+    } else {
+        dma_channel[channelx].flags &= ~int_flag;
+    }
+}
+
+/*!
+    \brief      disable the synchronization of a DMAMUX channel, nothing to model
+    \param[in]  channelx: DMAMUX channel
+    \param[out] none
+    \retval     none
+*/
+void dmamux_synchronization_disable(dmamux_multiplexer_channel_enum channelx)
+{
+    (void)channelx;
+}
+
+/*!
+    \brief      load the data register of the CRC unit with the initial value
+    \param[in]  none
+    \param[out] none
+    \retval     none
+*/
+void crc_data_register_reset(void)
+{
+    crc_data = crc_idata;
+}
+
+/*!
+    \brief      write the initial value of the CRC unit
+    \param[in]  init_data: initial value
+    \param[out] none
+    \retval     none
+*/
+void crc_init_data_register_write(uint32_t init_data)
+{
+    crc_idata = init_data;
+}
+
+/*!
+    \brief      add words to the CRC, polynomial 0x04C11DB7 MSB first as the CRC unit
+    \param[in]  array: pointer to the data
+    \param[in]  size: number of data items
+    \param[in]  data_format: INPUT_FORMAT_WORD, only words are modelled
+    \param[out] none
+    \retval     the CRC value
+*/
+uint32_t crc_block_data_calculate(void *array, uint32_t size, uint8_t data_format)
+{
+    const uint8_t *data = (const uint8_t *)array;
+    uint32_t word;
+    uint32_t index;
+    uint32_t bit;
+
+    (void)data_format;
+    for(index = 0U; index < size; index++) {
+        memcpy(&word, &data[index * 4U], sizeof(word));
+        crc_data ^= word;
+        for(bit = 0U; bit < 32U; bit++) {
+            crc_data = (0U != (crc_data & 0x80000000U)) ? ((crc_data << 1) ^ 0x04C11DB7U) : (crc_data << 1);
+        }
+    }
+    return crc_data;
+}
+
+/*!
+    \brief      read the host monotonic clock
+    \param[in]  none
+    \param[out] none
+    \retval     time in nanoseconds
+*/
+static uint64_t host_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec;
+}
+
+/*!
+    \brief      set an interrupt flag of a DMA channel and call its handler if the interrupt is enabled
+    \param[in]  channelx: DMA channel
+    \param[in]  flag: DMA_INT_FLAG_HTF or DMA_INT_FLAG_FTF
+    \param[in]  interrupt: DMA_INT_HTF or DMA_INT_FTF
+    \param[out] none
+    \retval     none
+*/
+static void dma_flag_set(dma_channel_enum channelx, uint32_t flag, uint32_t interrupt)
+{
+    IRQn_Type irq = (IRQn_Type)((uint32_t)DMA0_Channel0_IRQn + (uint32_t)channelx);
+
+    dma_channel[channelx].flags |= flag | DMA_INT_FLAG_G;
+    if((0U != (dma_channel[channelx].interrupts & interrupt)) && (NULL != irq_handler[irq])) {
+        irq_handler[irq]();
+    }
+}
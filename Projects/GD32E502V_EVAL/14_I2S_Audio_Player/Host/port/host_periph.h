@@ -0,0 +1,60 @@
+/*!
+    \file    host_periph.h
+    \brief   models of the peripherals used by the audio pipeline on a host computer
+
+    \version 2025-02-20, V1.4.0, demo for GD32E502
+*/
+
+/*
+    Copyright (c) 2025, GigaDevice Semiconductor Inc.
+
+    Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+    3. Neither the name of the copyright holder nor the names of its contributors
+       may be used to endorse or promote products derived from this software without
+       specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+OF SUCH DAMAGE.
+*/
+
+
+#ifndef HOST_PERIPH_H
+#define HOST_PERIPH_H
+
+#include "gd32e502.h"
+
+/* receives each data item the fake I2S shifts out */
+typedef void (*host_i2s_sink_func)(void *context, uint32_t data);
+/* interrupt handler called by the models */
+typedef void (*host_irq_handler_func)(void);
+
+/* function declarations */
+/* register the handler of an interrupt raised by the models */
+void host_irq_handler_set(IRQn_Type irq, host_irq_handler_func handler);
+/* register the sink of the data sent by the I2S */
+void host_i2s_sink_set(host_i2s_sink_func sink, void *context);
+/* get the frame format of the I2S */
+uint32_t host_i2s_frameformat_get(void);
+/* move data items on a DMA channel as its peripheral requests them */
+uint32_t host_dma_run(uint32_t dma_periph, dma_channel_enum channelx, uint32_t count);
+/* read the host time stamp counter */
+uint64_t host_cycles(void);
+/* get the number of host time stamp counts in one nanosecond */
+double host_cycles_per_ns(void);
+
+#endif /* HOST_PERIPH_H */